@@ -2,18 +2,26 @@
  * AIRFLOW CALIBRATOR - IMPLEMENTATION
  ***********************************************************************************************/
 #include "AirflowCalibrator.h"
-
-AirflowCalibrator::AirflowCalibrator(Adafruit_PWMServoDriver& pwm)
-  : _pwm(pwm), _currentPercent(0), _step(1) {
+#include "LineReader.h"
+
+AirflowCalibrator::AirflowCalibrator(Actuation::Frame& servos)
+  : _servos(servos), _fingers(nullptr), _output(nullptr), _currentNoteIndex(0),
+    _currentPercent(0), _minPercent(0), _step(STEP_DONE), _confirmed(false), _testUntil(0),
+    _phase(0), _phaseStart(0), _phaseDuration(0), _onTime(0) {
+#if AUTO_CALIBRATION_ENABLED
+  _fundamentalHz = 0.0f;
+#endif
 }
 
-void AirflowCalibrator::calibrateNote(int noteIndex,
-                                      const FingerConfig calibratedFingers[],
-                                      NoteDefinition& output) {
+void AirflowCalibrator::startManual(int noteIndex,
+                                    const FingerConfig calibratedFingers[],
+                                    NoteDefinition& output) {
   _currentNoteIndex = noteIndex;
+  _fingers = calibratedFingers;
+  _output = &output;
+  _confirmed = false;
 
-  // Copier le template de la note
-  output = NOTES_TEMPLATE[noteIndex];
+  const NoteDefinition& note = NOTES_TEMPLATE[noteIndex];
 
   Serial.println(F("\n========================================"));
   Serial.print(F("  CALIBRATION AIRFLOW (Note "));
@@ -22,21 +30,22 @@ void AirflowCalibrator::calibrateNote(int noteIndex,
   Serial.print(NUMBER_NOTES);
   Serial.println(F(")"));
   Serial.println(F("========================================"));
+  char name[6];
   Serial.print(F("Note: "));
-  Serial.print(NOTE_NAMES[noteIndex]);
+  Serial.print(noteName(note.midiNote, name));
   Serial.print(F(" (MIDI "));
-  Serial.print(output.midiNote);
+  Serial.print(note.midiNote);
   Serial.println(F(")"));
 
   Serial.print(F("Doigté: "));
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    Serial.print(output.fingerPattern[i]);
+    Serial.print(getFingerPosition(note.fingerPattern, i));
   }
   Serial.print(F(" ("));
 
   int closedCount = 0;
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    if (output.fingerPattern[i] == 0) closedCount++;
+    if (getFingerPosition(note.fingerPattern, i) == FINGER_CLOSED) closedCount++;
   }
   Serial.print(closedCount);
   Serial.print(F(" fermé"));
@@ -44,72 +53,424 @@ void AirflowCalibrator::calibrateNote(int noteIndex,
   Serial.println(F(")"));
   Serial.println();
 
-  // Préparer le système
+  // Préparer le système (suite dans runPrepare)
   Serial.println(F("PRÉPARATION"));
   Serial.println(F("-----------"));
   Serial.println(F("1. Application doigtés"));
-  applyFingering(output.fingerPattern, calibratedFingers);
-  delay(500);
+  applyFingering(note.fingerPattern, calibratedFingers);
+  startPhase(0, 500);
+  _step = STEP_PREPARE;
+}
 
-  Serial.println(F("2. Ouverture solénoïde"));
-  openSolenoid();
-  delay(200);
+void AirflowCalibrator::startRecordSync(const FingerConfig calibratedFingers[]) {
+  // Salve à plein débit : attaque franche, facile à repérer dans l'enregistrement
+  applyFingering(NOTES_TEMPLATE[0].fingerPattern, calibratedFingers);
+  setAirflowPercent(100);
+  startPhase(0, 300);
+  _step = STEP_RECORD_SYNC;
+}
 
-  Serial.println(F("3. Prêt pour ajustement airflow"));
-  Serial.println();
+void AirflowCalibrator::startRecordNote(int noteIndex, const FingerConfig calibratedFingers[]) {
+  const NoteDefinition& note = NOTES_TEMPLATE[noteIndex];
+  _currentNoteIndex = noteIndex;
+
+  Serial.print(F("# Note "));
+  Serial.print(noteIndex + 1);
+  Serial.print(F("/"));
+  Serial.print(NUMBER_NOTES);
+  Serial.print(F(": "));
+  char name[6];
+  Serial.println(noteName(note.midiNote, name));
+
+  // NOTE <index> <MIDI> <doigté compacté> (recopié dans le NOTES[] généré)
+  Serial.print(F("NOTE "));
+  Serial.print(noteIndex);
+  Serial.print(F(" "));
+  Serial.print(note.midiNote);
+  Serial.print(F(" "));
+  Serial.println(note.fingerPattern);
 
-  // Étape 1 : Calibrer airflowMinPercent
-  calibrateMinPercent();
-  output.airflowMinPercent = _currentPercent;
+  closeSolenoid();
+  applyFingering(note.fingerPattern, calibratedFingers);
+  _currentPercent = 0;
+  setAirflowPercent(0);
+  startPhase(0, 300);
+  _step = STEP_RECORD_NOTE;
+}
 
-  // Étape 2 : Calibrer airflowMaxPercent
-  calibrateMaxPercent(output.airflowMinPercent);
-  output.airflowMaxPercent = _currentPercent;
+bool AirflowCalibrator::update(const char* line) {
+  switch (_step) {
+    case STEP_PREPARE:
+      runPrepare();
+      break;
+
+    case STEP_MIN:
+    case STEP_MAX:
+      updateTest();
+      if (line) handleAdjust(line);
+      break;
+
+    case STEP_CONFIRM:
+      if (line) handleConfirmAnswer(line);
+      break;
+
+    case STEP_RECORD_SYNC:
+      runRecordSync();
+      break;
+
+    case STEP_RECORD_NOTE:
+      runRecordNote();
+      break;
+
+#if AUTO_CALIBRATION_ENABLED
+    case STEP_AUTO_PREPARE:
+    case STEP_AUTO_NOISE:
+    case STEP_AUTO_SETTLE:
+    case STEP_AUTO_CAPTURE:
+    case STEP_AUTO_GAP:
+      runAuto();
+      break;
+#endif
+
+    case STEP_DONE:
+      break;
+  }
+  return _step == STEP_DONE;
+}
 
-  // Vérification finale
-  bool confirmed = verifyConfiguration(output);
+bool AirflowCalibrator::isWaitingForInput() const {
+  return _step == STEP_MIN || _step == STEP_MAX || _step == STEP_CONFIRM;
+}
+
+void AirflowCalibrator::runRecordSync() {
+  if (!phaseElapsed()) return;
+
+  switch (_phase) {
+    case 0:
+      _onTime = millis();
+      setSolenoid(true);
+      startPhase(1, SWEEP_SYNC_MS);
+      break;
+
+    case 1:
+      closeSolenoid();
+      Serial.print(F("SYNC "));
+      Serial.print(_onTime);
+      Serial.print(F(" "));
+      Serial.println(millis());
+
+      setServoAngle(NUM_SERVO_AIRFLOW, SERVO_AIRFLOW_OFF);
+      startPhase(2, 1000);
+      break;
+
+    default:
+      _step = STEP_DONE;
+      break;
+  }
+}
+
+void AirflowCalibrator::runRecordNote() {
+  if (!phaseElapsed()) return;
+
+  switch (_phase) {
+    case 0:
+      // Servo en place, valve fermée
+      setAirflowPercent(_currentPercent);
+      startPhase(1, SWEEP_LOG_GAP_MS);
+      break;
+
+    case 1:
+      _onTime = millis();
+      setSolenoid(true);
+      startPhase(2, SWEEP_LOG_HOLD_MS);
+      break;
+
+    default:
+      closeSolenoid();
+
+      // STEP <ms ouverture> <ms fermeture> <index note> <MIDI> <pourcentage>
+      Serial.print(F("STEP "));
+      Serial.print(_onTime);
+      Serial.print(F(" "));
+      Serial.print(millis());
+      Serial.print(F(" "));
+      Serial.print(_currentNoteIndex);
+      Serial.print(F(" "));
+      Serial.print(NOTES_TEMPLATE[_currentNoteIndex].midiNote);
+      Serial.print(F(" "));
+      Serial.println(_currentPercent);
+
+      _currentPercent += SWEEP_LOG_STEP_PERCENT;
+      if (_currentPercent > 100) {
+        setServoAngle(NUM_SERVO_AIRFLOW, SERVO_AIRFLOW_OFF);
+        _step = STEP_DONE;
+      } else {
+        setAirflowPercent(_currentPercent);
+        startPhase(1, SWEEP_LOG_GAP_MS);
+      }
+      break;
+  }
+}
+
+#if AUTO_CALIBRATION_ENABLED
+void AirflowCalibrator::beginAuto() {
+  _mic.begin();
+}
+
+void AirflowCalibrator::startAuto(int noteIndex,
+                                  const FingerConfig calibratedFingers[],
+                                  NoteDefinition& output) {
+  _currentNoteIndex = noteIndex;
+  _output = &output;
+  _confirmed = false;
+  output = NOTES_TEMPLATE[noteIndex];
+  _startTime = millis();
+
+  Serial.println();
+  Serial.print(F("Note "));
+  Serial.print(noteIndex + 1);
+  Serial.print(F("/"));
+  Serial.print(NUMBER_NOTES);
+  Serial.print(F(": "));
+  char name[6];
+  Serial.print(noteName(output.midiNote, name));
+  Serial.print(F(" (MIDI "));
+  Serial.print(output.midiNote);
+  Serial.println(F(")"));
 
-  // Fermer le solénoïde
   closeSolenoid();
+  applyFingering(output.fingerPattern, calibratedFingers);
+  setAirflowPercent(0);
+  startPhase(0, 300);
+  _step = STEP_AUTO_PREPARE;
+}
+
+void AirflowCalibrator::runAuto() {
+  switch (_step) {
+    case STEP_AUTO_PREPARE:
+      if (!phaseElapsed()) return;
+      _frame = 0;
+      _noiseTotal = 0.0f;
+      _step = STEP_AUTO_NOISE;
+      break;
+
+    case STEP_AUTO_NOISE: {
+      // Énergie valve fermée (pompe, ambiance) : une trame par tour de loop()
+      float sampleRate = _mic.capture(_micBuffer, MIC_BLOCK_SIZE);
+      _detector.configure(sampleRate, PitchDetector::midiToHz(69));
+      _noiseTotal += _detector.analyze(_micBuffer, MIC_BLOCK_SIZE).energy;
+      if (++_frame < AUTO_FRAMES) return;
+
+      // Seuil d'énergie au-dessus du bruit de fond
+      float minEnergy = (_noiseTotal / AUTO_FRAMES) * AUTO_NOISE_FACTOR;
+      if (minEnergy < AUTO_MIN_ENERGY) minEnergy = AUTO_MIN_ENERGY;
+      _detector.setThresholds(minEnergy, AUTO_TONE_RATIO, AUTO_OCTAVE_RATIO);
+      _fundamentalHz = PitchDetector::midiToHz(_output->midiNote);
+
+      // Balayage grossier : début et fin de la plage où la fondamentale est stable
+      _sweepPhase = SWEEP_COARSE;
+      _sweepPercent = 0;
+      _firstFound = -1;
+      _lastFound = -1;
+      _misses = 0;
+      startMeasure();
+      break;
+    }
+
+    case STEP_AUTO_SETTLE:
+      if (!phaseElapsed()) return;
+      _detector.reset();
+      _frame = 0;
+      _step = STEP_AUTO_CAPTURE;
+      break;
+
+    case STEP_AUTO_CAPTURE: {
+      float sampleRate = _mic.capture(_micBuffer, MIC_BLOCK_SIZE);
+      _detector.configure(sampleRate, _fundamentalHz);
+      _lastResult = _detector.analyze(_micBuffer, MIC_BLOCK_SIZE);
+      _detector.addFrame(_lastResult);
+      if (++_frame < AUTO_FRAMES) return;
+
+      // Valve fermée entre deux mesures : chaque mesure est une attaque de note
+      closeSolenoid();
+      PitchClass pitchClass = _detector.stableClass(AUTO_FRAMES, AUTO_STABILITY_SPREAD);
+
+      Serial.print(F("  "));
+      Serial.print(_sweepPercent);
+      Serial.print(F("% : "));
+      printPitchClass(pitchClass);
+      Serial.print(F(" (énergie "));
+      Serial.print(_lastResult.energy, 1);
+      Serial.print(F(", f0 "));
+      Serial.print(_lastResult.fundamentalRatio, 2);
+      Serial.print(F(", octave "));
+      Serial.print(_lastResult.octaveRatio, 2);
+      Serial.println(F(")"));
+
+      // Phase 1 : mesure suivante après la pause, 0 : fin du balayage
+      startPhase(nextSweepPercent(pitchClass) ? 1 : 0, AUTO_GAP_MS);
+      _step = STEP_AUTO_GAP;
+      break;
+    }
+
+    case STEP_AUTO_GAP:
+      if (!phaseElapsed()) return;
+      if (_phase == 1) {
+        startMeasure();
+      } else {
+        finishAuto();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void AirflowCalibrator::startMeasure() {
+  setAirflowPercent(_sweepPercent);
+  setSolenoid(true);
+  startPhase(0, AUTO_SETTLE_MS);
+  _step = STEP_AUTO_SETTLE;
+}
+
+bool AirflowCalibrator::nextSweepPercent(PitchClass pitchClass) {
+  int percent = _sweepPercent;
+
+  switch (_sweepPhase) {
+    case SWEEP_COARSE: {
+      bool endOfRange = false;
+      if (pitchClass == PITCH_FUNDAMENTAL) {
+        if (_firstFound < 0) _firstFound = percent;
+        _lastFound = percent;
+        _misses = 0;
+      } else if (_firstFound >= 0) {
+        // Fin de plage : sur-soufflage, ou deux mesures instables de suite
+        endOfRange = (pitchClass == PITCH_OVERBLOWN || ++_misses >= 2);
+      }
+
+      if (!endOfRange && percent + AUTO_SWEEP_STEP_PERCENT <= 100) {
+        _sweepPercent = percent + AUTO_SWEEP_STEP_PERCENT;
+        return true;
+      }
+      if (_firstFound < 0) return false;  // Aucune plage
+
+      // Affinage à 1% dans les intervalles du balayage grossier
+      _rangeMin = _firstFound;
+      _rangeMax = _lastFound;
+      _sweepPhase = SWEEP_REFINE_MIN;
+      _sweepPercent = _firstFound - AUTO_SWEEP_STEP_PERCENT + 1;
+      if (_sweepPercent < 0) _sweepPercent = 0;
+      if (_sweepPercent < _firstFound) return true;
+      return startRefineMax();
+    }
+
+    case SWEEP_REFINE_MIN:
+      if (pitchClass == PITCH_FUNDAMENTAL) {
+        _rangeMin = percent;
+        return startRefineMax();
+      }
+      if (++_sweepPercent < _firstFound) return true;
+      return startRefineMax();
+
+    case SWEEP_REFINE_MAX:
+      if (pitchClass != PITCH_FUNDAMENTAL) return false;
+      _rangeMax = percent;
+      _sweepPercent = percent + 1;
+      return _sweepPercent < _lastFound + AUTO_SWEEP_STEP_PERCENT && _sweepPercent <= 100;
+  }
+  return false;
+}
+
+bool AirflowCalibrator::startRefineMax() {
+  _sweepPhase = SWEEP_REFINE_MAX;
+  _sweepPercent = _lastFound + 1;
+  return _sweepPercent < _lastFound + AUTO_SWEEP_STEP_PERCENT && _sweepPercent <= 100;
+}
+
+void AirflowCalibrator::finishAuto() {
+  _confirmed = (_firstFound >= 0);
+  if (_confirmed) {
+    int minPercent = _rangeMin;
+    int maxPercent = _rangeMax;
+
+    // Marge de sécurité (plage trop étroite : centre)
+    if (maxPercent - minPercent >= 2 * AUTO_MARGIN_PERCENT) {
+      minPercent += AUTO_MARGIN_PERCENT;
+      maxPercent -= AUTO_MARGIN_PERCENT;
+    } else {
+      minPercent = maxPercent = (minPercent + maxPercent) / 2;
+    }
+
+    _output->airflowMinPercent = minPercent;
+    _output->airflowMaxPercent = maxPercent;
+  }
 
   // Remettre airflow au repos
-  setAirflowPercent(0);
+  closeSolenoid();
   setServoAngle(NUM_SERVO_AIRFLOW, SERVO_AIRFLOW_OFF);
 
-  if (confirmed) {
-    Serial.println();
-    Serial.print(F("✓ Note "));
-    Serial.print(noteIndex + 1);
-    Serial.print(F("/"));
-    Serial.print(NUMBER_NOTES);
-    Serial.println(F(" calibrée!"));
+  if (_confirmed) {
+    Serial.print(F("✓ Plage: "));
+    Serial.print(_output->airflowMinPercent);
+    Serial.print(F("% - "));
+    Serial.print(_output->airflowMaxPercent);
+    Serial.print(F("%"));
   } else {
-    Serial.println(F("❌ Calibration annulée"));
+    Serial.print(F("❌ Aucune plage stable (template conservé)"));
+  }
+  Serial.print(F(" en "));
+  Serial.print((millis() - _startTime) / 1000.0f, 1);
+  Serial.println(F("s"));
+
+  _step = STEP_DONE;
+}
+
+void AirflowCalibrator::printPitchClass(PitchClass pitchClass) {
+  switch (pitchClass) {
+    case PITCH_SILENT:      Serial.print(F("silence     ")); break;
+    case PITCH_NOISY:       Serial.print(F("instable    ")); break;
+    case PITCH_FUNDAMENTAL: Serial.print(F("FONDAMENTALE")); break;
+    case PITCH_OVERBLOWN:   Serial.print(F("OCTAVE      ")); break;
   }
 }
+#endif
 
-void AirflowCalibrator::applyFingering(const bool fingerPattern[],
+void AirflowCalibrator::applyFingering(FingerPattern fingerPattern,
                                        const FingerConfig calibratedFingers[]) {
+  // Angles calculés comme dans FingerController (ServoFluteCore), envoyés en un lot
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    uint16_t angle;
+    const FingerConfig& finger = calibratedFingers[i];
+    _servos.setAngle(finger.pcaChannel,
+                     Actuation::Geometry::angle(finger.closedAngle, finger.direction,
+                                                getFingerPosition(fingerPattern, i),
+                                                finger.halfAngle, finger.quarterAngle));
+  }
+  _servos.flush();
 
-    if (fingerPattern[i] == 0) {
-      // Fermé
-      angle = calibratedFingers[i].closedAngle;
-    } else {
-      // Ouvert
-      angle = calibratedFingers[i].closedAngle +
-              (ANGLE_OPEN * calibratedFingers[i].direction);
-    }
+  Serial.println(F("  [Servos positionnés selon doigté]"));
+}
+
+void AirflowCalibrator::runPrepare() {
+  if (!phaseElapsed()) return;
 
-    setServoAngle(calibratedFingers[i].pcaChannel, angle);
+  if (_phase == 0) {
+    Serial.println(F("2. Ouverture solénoïde"));
+    openSolenoid();
+    startPhase(1, 200);
+    return;
   }
 
-  Serial.println(F("  [Servos positionnés selon doigté]"));
+  Serial.println(F("3. Prêt pour ajustement airflow"));
+  Serial.println();
+  beginMinPercent();
 }
 
-void AirflowCalibrator::calibrateMinPercent() {
+void AirflowCalibrator::beginMinPercent() {
   _currentPercent = 0;
+  _minPercent = 0;
+  _testUntil = 0;
+  _step = STEP_MIN;
 
   Serial.println(F("ÉTAPE 1/2 - Trouver airflowMinPercent"));
   Serial.println(F("--------------------------------------"));
@@ -118,100 +479,29 @@ void AirflowCalibrator::calibrateMinPercent() {
   Serial.println(F("  - Note doit être stable et juste"));
   Serial.println(F("  - Si trop faible: note ne sonne pas"));
   Serial.println();
-  Serial.println(F("Commandes:"));
+  Serial.println(F("Commandes (plusieurs par ligne possible, ex: \">>+s\"):"));
   Serial.println(F("  +         : Augmenter (+1%)"));
   Serial.println(F("  -         : Diminuer (-1%)"));
   Serial.println(F("  > ou ]    : Augmenter rapide (+5%)"));
   Serial.println(F("  < ou [    : Diminuer rapide (-5%)"));
   Serial.println(F("  t         : Tester note (2 secondes)"));
   Serial.println(F("  s         : Sauvegarder"));
+  Serial.println(F("  =N        : Pourcentage direct (ex: =35)"));
   Serial.println();
 
   setAirflowPercent(_currentPercent);
-  uint16_t angle = percentToAngle(_currentPercent);
-  Serial.print(F("Angle actuel: "));
-  Serial.print(angle);
-  Serial.print(F("° - Pourcentage: "));
-  Serial.print(_currentPercent);
-  Serial.println(F("%"));
+  printPercent(false);
   Serial.println();
-
-  bool done = false;
-  while (!done) {
-    if (Serial.available() > 0) {
-      char cmd = Serial.read();
-
-      switch (cmd) {
-        case '+':
-          adjustPercent(1);
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case '-':
-          adjustPercent(-1);
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case '>':
-        case ']':
-          adjustPercent(5);
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case '<':
-        case '[':
-          adjustPercent(-5);
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case 't':
-        case 'T':
-          testNote(2000);
-          break;
-
-        case 's':
-        case 'S':
-          Serial.println();
-          Serial.print(F("airflowMinPercent confirmé: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("%"));
-          done = true;
-          break;
-      }
-    }
-  }
 }
 
-void AirflowCalibrator::calibrateMaxPercent(byte minPercent) {
+void AirflowCalibrator::beginMaxPercent() {
   // Démarrer à 50% pour accélérer
   _currentPercent = 50;
-  if (_currentPercent <= minPercent) {
-    _currentPercent = minPercent + 10;
+  if (_currentPercent <= _minPercent) {
+    _currentPercent = _minPercent + 10;
   }
+  if (_currentPercent > 100) _currentPercent = 100;
+  _step = STEP_MAX;
 
   Serial.println();
   Serial.println(F("ÉTAPE 2/2 - Trouver airflowMaxPercent"));
@@ -222,7 +512,7 @@ void AirflowCalibrator::calibrateMaxPercent(byte minPercent) {
   Serial.println(F("  - Si trop fort: note monte d'octave ou siffle"));
   Serial.println();
   Serial.print(F("Position actuelle: "));
-  Serial.print(minPercent);
+  Serial.print(_minPercent);
   Serial.println(F("% (minimum)"));
   Serial.print(F("Saut automatique à "));
   Serial.print(_currentPercent);
@@ -230,111 +520,123 @@ void AirflowCalibrator::calibrateMaxPercent(byte minPercent) {
   Serial.println();
 
   setAirflowPercent(_currentPercent);
-  uint16_t angle = percentToAngle(_currentPercent);
-  Serial.print(F("Angle: "));
-  Serial.print(angle);
-  Serial.print(F("° - Pourcentage: "));
-  Serial.print(_currentPercent);
-  Serial.println(F("%"));
+  printPercent(false);
   Serial.println();
   Serial.println(F("Commandes: mêmes que étape 1"));
   Serial.println();
+}
 
-  bool done = false;
-  while (!done) {
-    if (Serial.available() > 0) {
-      char cmd = Serial.read();
-
-      switch (cmd) {
-        case '+':
-          adjustPercent(1);
-          if (_currentPercent < minPercent) _currentPercent = minPercent;
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case '-':
-          adjustPercent(-1);
-          if (_currentPercent < minPercent) _currentPercent = minPercent;
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case '>':
-        case ']':
-          adjustPercent(5);
-          if (_currentPercent < minPercent) _currentPercent = minPercent;
-          setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
-          Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case '<':
-        case '[':
-          adjustPercent(-5);
-          if (_currentPercent < minPercent) _currentPercent = minPercent;
+void AirflowCalibrator::handleAdjust(const char* line) {
+  bool moved = false;
+
+  for (const char* c = line; *c; c++) {
+    switch (*c) {
+      case '+':           adjustPercent(1);  moved = true; break;
+      case '-':           adjustPercent(-1); moved = true; break;
+      case '>': case ']': adjustPercent(5);  moved = true; break;
+      case '<': case '[': adjustPercent(-5); moved = true; break;
+
+      case '=':
+        // Valeur absolue (scripts hôte) : fin de ligne
+        adjustPercent(atoi(c + 1) - (int)_currentPercent);
+        moved = true;
+        c += strlen(c) - 1;
+        break;
+
+      case 't':
+      case 'T':
+        if (moved) {
           setAirflowPercent(_currentPercent);
-          angle = percentToAngle(_currentPercent);
-          Serial.print(F("Angle: "));
-          Serial.print(angle);
-          Serial.print(F("° - Pourcentage: "));
+          moved = false;
+          printPercent(true);
+        }
+        testNote(2000);
+        break;
+
+      case 's':
+      case 'S':
+        if (moved) setAirflowPercent(_currentPercent);
+        _testUntil = 0;
+        Serial.println();
+        if (_step == STEP_MIN) {
+          Serial.print(F("airflowMinPercent confirmé: "));
           Serial.print(_currentPercent);
-          Serial.println(F("% [APPLIQUÉ]"));
-          break;
-
-        case 't':
-        case 'T':
-          testNote(2000);
-          break;
-
-        case 's':
-        case 'S':
-          Serial.println();
+          Serial.println(F("%"));
+          _minPercent = _currentPercent;
+          beginMaxPercent();
+        } else {
           Serial.print(F("airflowMaxPercent confirmé: "));
           Serial.print(_currentPercent);
           Serial.println(F("%"));
-          done = true;
-          break;
-      }
+          beginConfirm();
+        }
+        return;  // Reste de la ligne ignoré
     }
+
+    // Max jamais sous le min retenu
+    if (_step == STEP_MAX && _currentPercent < _minPercent) _currentPercent = _minPercent;
+  }
+
+  if (moved) {
+    setAirflowPercent(_currentPercent);
+    printPercent(true);
   }
 }
 
-bool AirflowCalibrator::verifyConfiguration(const NoteDefinition& note) {
+void AirflowCalibrator::beginConfirm() {
+  const NoteDefinition& note = NOTES_TEMPLATE[_currentNoteIndex];
+
   Serial.println();
+  char name[6];
   Serial.print(F("RÉSUMÉ Note "));
-  Serial.println(NOTE_NAMES[_currentNoteIndex]);
+  Serial.println(noteName(note.midiNote, name));
   Serial.println(F("---------------"));
   Serial.print(F("MIDI: "));
   Serial.println(note.midiNote);
   Serial.print(F("Doigté: {"));
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    Serial.print(note.fingerPattern[i]);
+    Serial.print(getFingerPosition(note.fingerPattern, i));
     if (i < NUMBER_SERVOS_FINGER - 1) Serial.print(F(","));
   }
   Serial.println(F("}"));
   Serial.print(F("airflowMinPercent: "));
-  Serial.println(note.airflowMinPercent);
+  Serial.println(_minPercent);
   Serial.print(F("airflowMaxPercent: "));
-  Serial.println(note.airflowMaxPercent);
+  Serial.println(_currentPercent);
   Serial.println();
 
   Serial.print(F("Confirmer? (o/n): "));
-  return waitForConfirmation();
+  _step = STEP_CONFIRM;
+}
+
+void AirflowCalibrator::handleConfirmAnswer(const char* line) {
+  int8_t answer = LineReader::parseYesNo(line);
+  if (answer < 0) return;
+  Serial.println(answer ? F("o") : F("n"));
+
+  // Fermer le solénoïde
+  closeSolenoid();
+
+  // Remettre airflow au repos
+  setAirflowPercent(0);
+  setServoAngle(NUM_SERVO_AIRFLOW, SERVO_AIRFLOW_OFF);
+
+  _confirmed = (answer == 1);
+  if (_confirmed) {
+    *_output = NOTES_TEMPLATE[_currentNoteIndex];
+    _output->airflowMinPercent = _minPercent;
+    _output->airflowMaxPercent = _currentPercent;
+
+    Serial.println();
+    Serial.print(F("✓ Note "));
+    Serial.print(_currentNoteIndex + 1);
+    Serial.print(F("/"));
+    Serial.print(NUMBER_NOTES);
+    Serial.println(F(" calibrée!"));
+  } else {
+    Serial.println(F("❌ Calibration annulée"));
+  }
+  _step = STEP_DONE;
 }
 
 void AirflowCalibrator::setAirflowPercent(byte percent) {
@@ -348,14 +650,20 @@ uint16_t AirflowCalibrator::percentToAngle(byte percent) {
 }
 
 void AirflowCalibrator::openSolenoid() {
-  pinMode(SOLENOID_PIN, OUTPUT);
-  digitalWrite(SOLENOID_PIN, SOLENOID_ACTIVE_HIGH ? HIGH : LOW);
+  setSolenoid(true);
   Serial.println(F("  [Solénoïde ouvert]"));
 }
 
 void AirflowCalibrator::closeSolenoid() {
-  pinMode(SOLENOID_PIN, OUTPUT);
-  digitalWrite(SOLENOID_PIN, SOLENOID_ACTIVE_HIGH ? LOW : HIGH);
+  setSolenoid(false);
+}
+
+void AirflowCalibrator::setSolenoid(bool open) {
+  if (open) {
+    Actuation::Solenoid::open(SOLENOID_PIN);
+  } else {
+    Actuation::Solenoid::close(SOLENOID_PIN);
+  }
 }
 
 void AirflowCalibrator::adjustPercent(int delta) {
@@ -365,6 +673,14 @@ void AirflowCalibrator::adjustPercent(int delta) {
   _currentPercent = (byte)newPercent;
 }
 
+void AirflowCalibrator::printPercent(bool applied) {
+  Serial.print(applied ? F("Angle: ") : F("Angle actuel: "));
+  Serial.print(percentToAngle(_currentPercent));
+  Serial.print(F("° - Pourcentage: "));
+  Serial.print(_currentPercent);
+  Serial.println(applied ? F("% [APPLIQUÉ]") : F("%"));
+}
+
 void AirflowCalibrator::testNote(int durationMs) {
   Serial.print(F("[TEST] Note jouée pendant "));
   Serial.print(durationMs);
@@ -372,33 +688,29 @@ void AirflowCalibrator::testNote(int durationMs) {
   Serial.print(_currentPercent);
   Serial.println(F("%"));
 
-  delay(durationMs);
+  // Fin signalée par updateTest() ; les commandes restent actives pendant le test
+  _testUntil = millis() + durationMs;
+  if (_testUntil == 0) _testUntil = 1;
+}
 
-  Serial.println(F("[TEST] Terminé"));
+void AirflowCalibrator::updateTest() {
+  if (_testUntil != 0 && (long)(millis() - _testUntil) >= 0) {
+    _testUntil = 0;
+    Serial.println(F("[TEST] Terminé"));
+  }
 }
 
 void AirflowCalibrator::setServoAngle(byte pcaChannel, uint16_t angle) {
-  uint16_t pwm = angleToPWM(angle);
-  _pwm.setPWM(pcaChannel, 0, pwm);
+  // Même conversion PWM que le firmware (ServoFluteCore)
+  _servos.writeAngle(pcaChannel, angle);
 }
 
-uint16_t AirflowCalibrator::angleToPWM(uint16_t angle) {
-  return map(angle, 0, 180, SERVO_PULSE_MIN, SERVO_PULSE_MAX);
+void AirflowCalibrator::startPhase(uint8_t phase, unsigned long durationMs) {
+  _phase = phase;
+  _phaseStart = millis();
+  _phaseDuration = durationMs;
 }
 
-bool AirflowCalibrator::waitForConfirmation() {
-  while (true) {
-    while (Serial.available() == 0) {
-      // Attendre
-    }
-
-    char c = Serial.read();
-    if (c == 'o' || c == 'O' || c == 'y' || c == 'Y') {
-      Serial.println(F("o"));
-      return true;
-    } else if (c == 'n' || c == 'N') {
-      Serial.println(F("n"));
-      return false;
-    }
-  }
+bool AirflowCalibrator::phaseElapsed() const {
+  return millis() - _phaseStart >= _phaseDuration;
 }
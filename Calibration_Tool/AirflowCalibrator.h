@@ -2,53 +2,156 @@
  * AIRFLOW CALIBRATOR
  *
  * Gère la calibration des plages airflow pour chaque note (min% et max%).
+ * Mode manuel (clavier) ou automatique (balayage + détection de hauteur au micro).
+ * Machine à états non bloquante : start...() puis update() à chaque tour de loop(),
+ * avec la dernière ligne de commande reçue (ou nullptr).
  ***********************************************************************************************/
 #ifndef AIRFLOW_CALIBRATOR_H
 #define AIRFLOW_CALIBRATOR_H
 
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
 #include "settings_template.h"
+#if AUTO_CALIBRATION_ENABLED
+#include "MicSampler.h"
+#include "PitchDetector.h"
+#endif
 
 class AirflowCalibrator {
 public:
-  AirflowCalibrator(Adafruit_PWMServoDriver& pwm);
+  AirflowCalibrator(Actuation::Frame& servos);
+
+  // Calibration manuelle d'une note (airflowMin% et airflowMax%).
+  // output n'est écrit qu'à la confirmation finale.
+  void startManual(int noteIndex,
+                   const FingerConfig calibratedFingers[],
+                   NoteDefinition& output);
+
+  // Balayage scripté sans micro, pendant un enregistrement externe : journal
+  // horodaté sur Serial (SYNC / STEP, millis) pour tools/sweep_analyzer.py
+  void startRecordSync(const FingerConfig calibratedFingers[]);
+  void startRecordNote(int noteIndex, const FingerConfig calibratedFingers[]);
+
+#if AUTO_CALIBRATION_ENABLED
+  // Initialise l'entrée micro (à appeler avant startAuto)
+  void beginAuto();
+
+  // Calibre une note sans intervention : balayage du débit, la plage retenue est
+  // celle où la fondamentale sonne de façon stable. Sans plage trouvée,
+  // isConfirmed() = false et output garde les valeurs du template.
+  void startAuto(int noteIndex,
+                 const FingerConfig calibratedFingers[],
+                 NoteDefinition& output);
+#endif
 
-  // Calibre une note complète (airflowMin% et airflowMax%)
-  void calibrateNote(int noteIndex,
-                     const FingerConfig calibratedFingers[],
-                     NoteDefinition& output);
+  // Avance le mode en cours ; line = ligne reçue ou nullptr. true quand terminé.
+  bool update(const char* line);
+
+  // Étape en attente d'une commande (sinon les lignes restent en file)
+  bool isWaitingForInput() const;
+
+  // Manuel : confirmée ; automatique : plage trouvée
+  bool isConfirmed() const { return _confirmed; }
+
+  // Primitives (protocole machine, BatchProtocol)
+  void applyFingering(FingerPattern fingerPattern, const FingerConfig calibratedFingers[]);
+  void setAirflowPercent(byte percent);
+  uint16_t percentToAngle(byte percent);
+  void setSolenoid(bool open);
 
 private:
-  Adafruit_PWMServoDriver& _pwm;
+  enum Step {
+    // Manuel
+    STEP_PREPARE,         // Doigté puis solénoïde (phases temporisées)
+    STEP_MIN,             // 1/2 : ajustement min%
+    STEP_MAX,             // 2/2 : ajustement max%
+    STEP_CONFIRM,         // Résumé, confirmer ?
+    // Balayage enregistré
+    STEP_RECORD_SYNC,     // Salve de synchronisation
+    STEP_RECORD_NOTE,     // Paliers d'une note
+#if AUTO_CALIBRATION_ENABLED
+    // Automatique
+    STEP_AUTO_PREPARE,    // Doigté en place, valve fermée
+    STEP_AUTO_NOISE,      // Bruit de fond (une trame par update)
+    STEP_AUTO_SETTLE,     // Valve ouverte, stabilisation
+    STEP_AUTO_CAPTURE,    // Trames de mesure (une par update)
+    STEP_AUTO_GAP,        // Valve fermée entre deux mesures
+#endif
+    STEP_DONE
+  };
+
+  Actuation::Frame& _servos;
+  const FingerConfig* _fingers;
+  NoteDefinition* _output;
 
   // État interne
   int _currentNoteIndex;
   byte _currentPercent;
-  int _step;  // 1=min%, 2=max%
+  byte _minPercent;
+  Step _step;
+  bool _confirmed;
+  unsigned long _testUntil;  // Fin du test de note en cours (0 = aucun)
+
+  // Étapes temporisées (millis, sans delay)
+  uint8_t _phase;
+  unsigned long _phaseStart;
+  unsigned long _phaseDuration;
+  unsigned long _onTime;     // Ouverture valve (journal SYNC / STEP)
+
+#if AUTO_CALIBRATION_ENABLED
+  MicSampler _mic;
+  PitchDetector _detector;
+  uint8_t _micBuffer[MIC_BLOCK_SIZE];
+  float _fundamentalHz;
+
+  // Balayage : grossier, puis affinage à 1% aux deux bords
+  enum SweepPhase { SWEEP_COARSE, SWEEP_REFINE_MIN, SWEEP_REFINE_MAX };
+  SweepPhase _sweepPhase;
+  int _sweepPercent;
+  int _firstFound;
+  int _lastFound;
+  int _rangeMin;             // Plage affinée
+  int _rangeMax;
+  uint8_t _misses;
+  uint8_t _frame;
+  float _noiseTotal;
+  PitchResult _lastResult;
+  unsigned long _startTime;
 
-  // Appliquer le doigté de la note
-  void applyFingering(const bool fingerPattern[], const FingerConfig calibratedFingers[]);
+  void runAuto();
 
-  // Calibrer airflowMinPercent
-  void calibrateMinPercent();
+  // Première mesure (valve ouverte au débit _sweepPercent)
+  void startMeasure();
 
-  // Calibrer airflowMaxPercent
-  void calibrateMaxPercent(byte minPercent);
+  // Mesure terminée : choisit la suivante (true) ou termine le balayage (false)
+  bool nextSweepPercent(PitchClass pitchClass);
+  bool startRefineMax();
+  void finishAuto();
 
-  // Vérification finale
-  bool verifyConfiguration(const NoteDefinition& note);
+  void printPitchClass(PitchClass pitchClass);
+#endif
+
+  // Calibration manuelle
+  void runPrepare();
+  void beginMinPercent();
+  void beginMaxPercent();
+  void handleAdjust(const char* line);
+  void beginConfirm();
+  void handleConfirmAnswer(const char* line);
+
+  // Balayage enregistré
+  void runRecordSync();
+  void runRecordNote();
 
   // Utilitaires
-  void setAirflowPercent(byte percent);
-  uint16_t percentToAngle(byte percent);
   void openSolenoid();
   void closeSolenoid();
   void adjustPercent(int delta);
+  void printPercent(bool applied);
   void testNote(int durationMs);
+  void updateTest();
   void setServoAngle(byte pcaChannel, uint16_t angle);
-  uint16_t angleToPWM(uint16_t angle);
-  bool waitForConfirmation();
+  void startPhase(uint8_t phase, unsigned long durationMs);
+  bool phaseElapsed() const;
 };
 
 #endif
@@ -0,0 +1,320 @@
+/***********************************************************************************************
+ * BATCH PROTOCOL - IMPLEMENTATION
+ ***********************************************************************************************/
+#include "BatchProtocol.h"
+
+BatchProtocol::BatchProtocol(FingerCalibrator& fingerCal,
+                             AirflowCalibrator& airflowCal,
+                             ProfileWriter& profileWriter,
+                             FingerConfig fingers[],
+                             NoteDefinition notes[])
+  : _fingerCal(fingerCal), _airflowCal(airflowCal), _profileWriter(profileWriter),
+    _fingers(fingers), _notes(notes), _busy(BUSY_NONE), _noteIndex(0),
+    _valveStart(0), _valveMs(0) {
+}
+
+void BatchProtocol::handleLine(const char* line, bool idle) {
+  // Copie modifiable : "@CMD args" → commande + arguments
+  char buffer[LINE_BUFFER_SIZE];
+  strncpy(buffer, line + 1, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+
+  char* command = buffer;
+  char* args = buffer;
+  while (*args != '\0' && *args != ' ') args++;
+  if (*args == ' ') *args++ = '\0';
+
+  // Menus interactifs en cours : pas de commande concurrente sur les servos
+  if (!idle || _busy != BUSY_NONE) {
+    replyError(command, F("BUSY"));
+    return;
+  }
+
+  if (strcasecmp(command, "PING") == 0)           cmdPing();
+  else if (strcasecmp(command, "ANGLE") == 0)     cmdAngle(args);
+  else if (strcasecmp(command, "FINGER") == 0)    cmdFinger(args);
+  else if (strcasecmp(command, "FINGERING") == 0) cmdFingering(args);
+  else if (strcasecmp(command, "AIR") == 0)       cmdAir(args);
+  else if (strcasecmp(command, "VALVE") == 0)     cmdValve(args);
+  else if (strcasecmp(command, "NOTE") == 0)      cmdNote(args);
+  else if (strcasecmp(command, "SWEEP") == 0)     cmdSweep(args);
+#if AUTO_CALIBRATION_ENABLED
+  else if (strcasecmp(command, "AUTO") == 0)      cmdAuto(args);
+#endif
+  else if (strcasecmp(command, "DUMP") == 0)      cmdDump();
+  else if (strcasecmp(command, "SAVE") == 0)      cmdSave(args);
+  else if (strcasecmp(command, "RESET") == 0)     cmdReset();
+  else replyError(command, F("UNKNOWN"));
+}
+
+void BatchProtocol::update() {
+  switch (_busy) {
+    case BUSY_VALVE:
+      if (millis() - _valveStart < _valveMs) return;
+      _airflowCal.setSolenoid(false);
+      beginOk(F("VALVE"));
+      Serial.print(F(" on="));
+      Serial.print(_valveStart);
+      Serial.print(F(" off="));
+      Serial.println(millis());
+      _busy = BUSY_NONE;
+      break;
+
+    case BUSY_SWEEP:
+      if (!_airflowCal.update(nullptr)) return;
+      beginOk(F("SWEEP"));
+      Serial.print(F(" note="));
+      Serial.println(_noteIndex);
+      _busy = BUSY_NONE;
+      break;
+
+#if AUTO_CALIBRATION_ENABLED
+    case BUSY_AUTO:
+      if (!_airflowCal.update(nullptr)) return;
+      if (_airflowCal.isConfirmed()) {
+        beginOk(F("AUTO"));
+        Serial.print(F(" note="));
+        Serial.print(_noteIndex);
+        Serial.print(F(" min="));
+        Serial.print(_notes[_noteIndex].airflowMinPercent);
+        Serial.print(F(" max="));
+        Serial.println(_notes[_noteIndex].airflowMaxPercent);
+      } else {
+        replyError("AUTO", F("NOTFOUND"));
+      }
+      _busy = BUSY_NONE;
+      break;
+#endif
+
+    default:
+      break;
+  }
+}
+
+void BatchProtocol::cmdPing() {
+  beginOk(F("PING"));
+  Serial.print(F(" version="));
+  Serial.print(PROTOCOL_VERSION);
+  Serial.print(F(" fingers="));
+  Serial.print(NUMBER_SERVOS_FINGER);
+  Serial.print(F(" notes="));
+  Serial.print(NUMBER_NOTES);
+  Serial.print(F(" profiles="));
+  Serial.print(CONFIG_PROFILE_COUNT);
+  Serial.print(F(" auto="));
+  Serial.println(AUTO_CALIBRATION_ENABLED ? 1 : 0);
+}
+
+void BatchProtocol::cmdAngle(char* args) {
+  // @ANGLE <canal PCA> <degrés> : position brute, sans calibration
+  long v[2];
+  if (!parseArgs(args, v, 2)) { replyError("ANGLE", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] > 15 || v[1] < 0 || v[1] > 180) { replyError("ANGLE", F("RANGE")); return; }
+
+  _fingerCal.setServoAngle(v[0], v[1]);
+  beginOk(F("ANGLE"));
+  Serial.print(F(" channel="));
+  Serial.print(v[0]);
+  Serial.print(F(" angle="));
+  Serial.println(v[1]);
+}
+
+void BatchProtocol::cmdFinger(char* args) {
+  // @FINGER <doigt> <angle fermé> <sens> <demi-trou> (canal PCA du template)
+  long v[4];
+  if (!parseArgs(args, v, 4)) { replyError("FINGER", F("ARGS")); return; }
+
+  long openAngle = v[1] + (long)ANGLE_OPEN * v[2];
+  if (v[0] < 0 || v[0] >= NUMBER_SERVOS_FINGER || v[1] < 0 || v[1] > 180 ||
+      (v[2] != 1 && v[2] != -1) || v[3] < 1 || v[3] >= ANGLE_OPEN ||
+      openAngle < 0 || openAngle > 180) {
+    replyError("FINGER", F("RANGE"));
+    return;
+  }
+
+  FingerConfig& finger = _fingers[v[0]];
+  finger.pcaChannel = FINGERS_TEMPLATE[v[0]].pcaChannel;
+  finger.closedAngle = v[1];
+  finger.direction = v[2];
+  finger.halfAngle = v[3];
+  finger.quarterAngle = v[3] / 2;
+
+  // Doigt fermé à sa nouvelle position
+  _fingerCal.setServoAngle(finger.pcaChannel, finger.closedAngle);
+  printFinger(v[0]);
+  beginOk(F("FINGER"));
+  Serial.println();
+}
+
+void BatchProtocol::cmdFingering(char* args) {
+  // @FINGERING <note> : doigté de la note avec les doigts calibrés
+  long v[1];
+  if (!parseArgs(args, v, 1)) { replyError("FINGERING", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] >= NUMBER_NOTES) { replyError("FINGERING", F("RANGE")); return; }
+
+  _airflowCal.applyFingering(_notes[v[0]].fingerPattern, _fingers);
+  beginOk(F("FINGERING"));
+  Serial.print(F(" note="));
+  Serial.print(v[0]);
+  Serial.print(F(" pattern="));
+  Serial.println(_notes[v[0]].fingerPattern);
+}
+
+void BatchProtocol::cmdAir(char* args) {
+  // @AIR <pourcentage>
+  long v[1];
+  if (!parseArgs(args, v, 1)) { replyError("AIR", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] > 100) { replyError("AIR", F("RANGE")); return; }
+
+  _airflowCal.setAirflowPercent(v[0]);
+  beginOk(F("AIR"));
+  Serial.print(F(" percent="));
+  Serial.print(v[0]);
+  Serial.print(F(" angle="));
+  Serial.println(_airflowCal.percentToAngle(v[0]));
+}
+
+void BatchProtocol::cmdValve(char* args) {
+  // @VALVE <ms> : ouverture temporisée (réponse à la fermeture) ; 0 = fermer
+  long v[1];
+  if (!parseArgs(args, v, 1)) { replyError("VALVE", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] > 10000) { replyError("VALVE", F("RANGE")); return; }
+
+  _valveStart = millis();
+  _valveMs = v[0];
+  _airflowCal.setSolenoid(v[0] > 0);
+  _busy = BUSY_VALVE;
+  update();  // 0 ms : réponse immédiate
+}
+
+void BatchProtocol::cmdNote(char* args) {
+  // @NOTE <note> <min%> <max%>
+  long v[3];
+  if (!parseArgs(args, v, 3)) { replyError("NOTE", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] >= NUMBER_NOTES || v[1] < 0 || v[1] > v[2] || v[2] > 100) {
+    replyError("NOTE", F("RANGE"));
+    return;
+  }
+
+  _notes[v[0]].airflowMinPercent = v[1];
+  _notes[v[0]].airflowMaxPercent = v[2];
+  printNote(v[0]);
+  beginOk(F("NOTE"));
+  Serial.println();
+}
+
+void BatchProtocol::cmdSweep(char* args) {
+  // @SWEEP <note> : balayage enregistré d'une note (lignes STEP, voir Phase 2 ter)
+  long v[1];
+  if (!parseArgs(args, v, 1)) { replyError("SWEEP", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] >= NUMBER_NOTES) { replyError("SWEEP", F("RANGE")); return; }
+
+  _noteIndex = v[0];
+  _airflowCal.startRecordNote(_noteIndex, _fingers);
+  _busy = BUSY_SWEEP;
+}
+
+#if AUTO_CALIBRATION_ENABLED
+void BatchProtocol::cmdAuto(char* args) {
+  // @AUTO <note> : calibration automatique au micro, plage écrite dans la note
+  long v[1];
+  if (!parseArgs(args, v, 1)) { replyError("AUTO", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] >= NUMBER_NOTES) { replyError("AUTO", F("RANGE")); return; }
+
+  _noteIndex = v[0];
+  _airflowCal.startAuto(_noteIndex, _fingers, _notes[_noteIndex]);
+  _busy = BUSY_AUTO;
+}
+#endif
+
+void BatchProtocol::cmdDump() {
+  for (uint8_t i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    printFinger(i);
+  }
+  for (uint8_t i = 0; i < NUMBER_NOTES; i++) {
+    printNote(i);
+  }
+  beginOk(F("DUMP"));
+  Serial.println();
+}
+
+void BatchProtocol::cmdSave(char* args) {
+  // @SAVE <profil> : profil EEPROM (format ConfigStore)
+  long v[1];
+  if (!parseArgs(args, v, 1)) { replyError("SAVE", F("ARGS")); return; }
+  if (v[0] < 0 || v[0] >= CONFIG_PROFILE_COUNT) { replyError("SAVE", F("RANGE")); return; }
+
+  if (!_profileWriter.writeProfile(v[0], _fingers, _notes)) {
+    replyError("SAVE", F("EEPROM"));
+    return;
+  }
+  beginOk(F("SAVE"));
+  Serial.print(F(" profile="));
+  Serial.println(v[0]);
+}
+
+void BatchProtocol::cmdReset() {
+  // Valeurs du template (flûte suivante)
+  for (uint8_t i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    _fingers[i] = FINGERS_TEMPLATE[i];
+  }
+  for (uint8_t i = 0; i < NUMBER_NOTES; i++) {
+    _notes[i] = NOTES_TEMPLATE[i];
+  }
+  beginOk(F("RESET"));
+  Serial.println();
+}
+
+void BatchProtocol::beginOk(const __FlashStringHelper* command) {
+  Serial.print(F("OK "));
+  Serial.print(command);
+}
+
+void BatchProtocol::replyError(const char* command, const __FlashStringHelper* code) {
+  Serial.print(F("ERR "));
+  Serial.print(command);
+  Serial.print(F(" "));
+  Serial.println(code);
+}
+
+void BatchProtocol::printFinger(uint8_t index) {
+  const FingerConfig& finger = _fingers[index];
+  Serial.print(F("FINGER "));
+  Serial.print(index);
+  Serial.print(F(" channel="));
+  Serial.print(finger.pcaChannel);
+  Serial.print(F(" closed="));
+  Serial.print(finger.closedAngle);
+  Serial.print(F(" direction="));
+  Serial.print(finger.direction);
+  Serial.print(F(" half="));
+  Serial.print(finger.halfAngle);
+  Serial.print(F(" quarter="));
+  Serial.println(finger.quarterAngle);
+}
+
+void BatchProtocol::printNote(uint8_t index) {
+  const NoteDefinition& note = _notes[index];
+  Serial.print(F("NOTE "));
+  Serial.print(index);
+  Serial.print(F(" midi="));
+  Serial.print(note.midiNote);
+  Serial.print(F(" pattern="));
+  Serial.print(note.fingerPattern);
+  Serial.print(F(" min="));
+  Serial.print(note.airflowMinPercent);
+  Serial.print(F(" max="));
+  Serial.println(note.airflowMaxPercent);
+}
+
+bool BatchProtocol::parseArgs(char* args, long values[], uint8_t count) {
+  char* p = args;
+  for (uint8_t i = 0; i < count; i++) {
+    char* end;
+    values[i] = strtol(p, &end, 10);
+    if (end == p) return false;  // Argument manquant ou non numérique
+    p = end;
+  }
+  while (*p == ' ') p++;
+  return *p == '\0';
+}
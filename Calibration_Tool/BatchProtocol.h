@@ -0,0 +1,83 @@
+/***********************************************************************************************
+ * BATCH PROTOCOL
+ *
+ * Protocole machine pour piloter l'outil depuis un script hôte (tools/calibration_batch.py),
+ * en parallèle des menus interactifs. Une commande par ligne, préfixe '@' :
+ *
+ *   @<COMMANDE> [arguments]          hôte → outil
+ *   OK <COMMANDE> [clé=valeur ...]   succès (fin de la réponse)
+ *   ERR <COMMANDE> <code>            échec  (fin de la réponse)
+ *
+ * Les lignes de données (FINGER, NOTE, STEP, ...) précèdent le OK ; toute autre ligne est
+ * un message pour l'utilisateur et peut être ignorée. Détail : docs/CALIBRATION_PROTOCOL.md
+ ***********************************************************************************************/
+#ifndef BATCH_PROTOCOL_H
+#define BATCH_PROTOCOL_H
+
+#include <Arduino.h>
+#include "settings_template.h"
+#include "FingerCalibrator.h"
+#include "AirflowCalibrator.h"
+#include "OutputGenerator.h"
+#include "ProfileWriter.h"
+
+class BatchProtocol {
+public:
+  BatchProtocol(FingerCalibrator& fingerCal,
+                AirflowCalibrator& airflowCal,
+                ProfileWriter& profileWriter,
+                FingerConfig fingers[],
+                NoteDefinition notes[]);
+
+  // Traite une ligne "@..." ; idle = aucune calibration interactive en cours
+  void handleLine(const char* line, bool idle);
+
+  // Avance la commande temporisée en cours (valve, balayage)
+  void update();
+
+  // Commande temporisée en cours : les lignes suivantes restent en file
+  bool isBusy() const { return _busy != BUSY_NONE; }
+
+  static const uint8_t PROTOCOL_VERSION = 1;
+
+private:
+  enum Busy { BUSY_NONE, BUSY_VALVE, BUSY_SWEEP, BUSY_AUTO };
+
+  FingerCalibrator& _fingerCal;
+  AirflowCalibrator& _airflowCal;
+  ProfileWriter& _profileWriter;
+  FingerConfig* _fingers;
+  NoteDefinition* _notes;
+
+  Busy _busy;
+  int _noteIndex;
+  unsigned long _valveStart;
+  unsigned long _valveMs;
+
+  // Commandes
+  void cmdPing();
+  void cmdAngle(char* args);
+  void cmdFinger(char* args);
+  void cmdFingering(char* args);
+  void cmdAir(char* args);
+  void cmdValve(char* args);
+  void cmdNote(char* args);
+  void cmdSweep(char* args);
+#if AUTO_CALIBRATION_ENABLED
+  void cmdAuto(char* args);
+#endif
+  void cmdDump();
+  void cmdSave(char* args);
+  void cmdReset();
+
+  // Réponses : "OK <commande>" (champs et fin de ligne ajoutés par l'appelant)
+  void beginOk(const __FlashStringHelper* command);
+  void replyError(const char* command, const __FlashStringHelper* code);
+  void printFinger(uint8_t index);
+  void printNote(uint8_t index);
+
+  // Lit count entiers dans args (false si manquant, en trop ou non numérique)
+  static bool parseArgs(char* args, long values[], uint8_t count);
+};
+
+#endif
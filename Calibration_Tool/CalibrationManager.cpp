@@ -5,10 +5,16 @@
 
 CalibrationManager::CalibrationManager()
   : _pwm(Adafruit_PWMServoDriver()),
-    _fingerCal(_pwm),
-    _airflowCal(_pwm),
+    _servos(),
+    _fingerCal(_servos),
+    _airflowCal(_servos),
+    _protocol(_fingerCal, _airflowCal, _profileWriter, _calibratedFingers, _calibratedNotes),
     _fingersCalibrated(false),
-    _notesCalibrated(false) {
+    _notesCalibrated(false),
+    _state(STATE_MENU),
+    _nextState(STATE_MENU),
+    _index(0),
+    _promptOpen(false) {
 }
 
 void CalibrationManager::begin() {
@@ -36,28 +42,156 @@ void CalibrationManager::begin() {
   // Mettre tous les servos au repos
   Serial.println(F("Positionnement servos au repos..."));
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    uint16_t pwm = map(90, 0, 180, SERVO_PULSE_MIN, SERVO_PULSE_MAX);
-    _pwm.setPWM(i, 0, pwm);
+    _servos.setAngle(FINGERS_TEMPLATE[i].pcaChannel, 90);
   }
 
   // Servo airflow au repos
-  uint16_t pwm = map(SERVO_AIRFLOW_OFF, 0, 180, SERVO_PULSE_MIN, SERVO_PULSE_MAX);
-  _pwm.setPWM(NUM_SERVO_AIRFLOW, 0, pwm);
+  _servos.setAngle(NUM_SERVO_AIRFLOW, SERVO_AIRFLOW_OFF);
+  _servos.flush();
 
   // Solénoïde fermé
-  pinMode(SOLENOID_PIN, OUTPUT);
-  digitalWrite(SOLENOID_PIN, SOLENOID_ACTIVE_HIGH ? LOW : HIGH);
+  Actuation::Solenoid::begin(SOLENOID_PIN);
+
+#if AUTO_CALIBRATION_ENABLED
+  // Entrée micro (calibration automatique)
+  _airflowCal.beginAuto();
+#endif
 
   Serial.println(F("✓ Initialisation terminée!"));
   Serial.println();
 
-  printCalibrationStatus();
+  enterState(STATE_MENU);
+}
+
+void CalibrationManager::update() {
+  // Ligne complète reçue ce tour-ci (nullptr sinon) : rien n'attend le clavier
+  const char* line = (acceptsInput() && _reader.poll(Serial)) ? _reader.line() : nullptr;
+
+  // Protocole machine : commandes "@..." (refusées hors menu)
+  _protocol.update();
+  if (line && line[0] == '@') {
+    if (_promptOpen) {
+      Serial.println();
+      _promptOpen = false;
+    }
+    _protocol.handleLine(line, _state == STATE_MENU);
+    return;
+  }
+
+  switch (_state) {
+    case STATE_MENU:
+      if (line) handleMenuChoice(line);
+      break;
+
+    case STATE_WAIT_ENTER:
+      if (line) enterState(_nextState);
+      break;
+
+    case STATE_FINGERS:
+      if (_fingerCal.update(line)) nextFinger();
+      break;
+
+    case STATE_NOTES_MODE:
+      if (line) handleNotesMode(line);
+      break;
+
+    case STATE_NOTES_MANUAL:
+      if (_airflowCal.update(line)) nextManualNote();
+      break;
+
+#if AUTO_CALIBRATION_ENABLED
+    case STATE_NOTES_AUTO:
+      if (_airflowCal.update(line)) nextAutoNote();
+      break;
+
+    case STATE_NOTES_AUTO_ASK:
+      if (line) handleAutoRetryAnswer(line);
+      break;
+
+    case STATE_NOTES_RETRY:
+      if (_airflowCal.update(line)) nextRetryNote();
+      break;
+#endif
+
+    case STATE_NOTES_RECORD:
+      if (_airflowCal.update(line)) nextRecordStep();
+      break;
+
+    case STATE_GENERATE_ASK:
+      if (line) handleGenerateAnswer(line);
+      break;
+
+    case STATE_PROFILE_SLOT:
+      if (line) handleProfileSlot(line);
+      break;
+  }
+}
+
+void CalibrationManager::enterState(State state) {
+  _state = state;
+
+  switch (state) {
+    case STATE_MENU:
+      printCalibrationStatus();
+      displayMainMenu();
+      break;
+
+    case STATE_FINGERS:
+      _index = 0;
+      _fingerCal.start(_index, _calibratedFingers[_index]);
+      break;
+
+    case STATE_NOTES_MANUAL:
+      _index = 0;
+      _airflowCal.startManual(_index, _calibratedFingers, _calibratedNotes[_index]);
+      break;
+
+#if AUTO_CALIBRATION_ENABLED
+    case STATE_NOTES_AUTO:
+      beginAutoNotes();
+      break;
+#endif
+
+    case STATE_NOTES_RECORD:
+      Serial.println(F("SWEEP_BEGIN"));
+      _index = -1;
+      _airflowCal.startRecordSync(_calibratedFingers);
+      break;
+
+    default:
+      break;
+  }
 }
 
-void CalibrationManager::run() {
-  displayMainMenu();
-  int choice = waitForMenuChoice();
-  handleMenuChoice(choice);
+void CalibrationManager::waitForEnter(State next) {
+  _nextState = next;
+  _state = STATE_WAIT_ENTER;
+}
+
+bool CalibrationManager::acceptsInput() const {
+  if (_protocol.isBusy()) {
+    return false;  // Valve ou balayage du protocole machine en cours
+  }
+
+  switch (_state) {
+    case STATE_FINGERS:
+      return _fingerCal.isWaitingForInput();
+
+    case STATE_NOTES_MANUAL:
+#if AUTO_CALIBRATION_ENABLED
+    case STATE_NOTES_RETRY:
+#endif
+      return _airflowCal.isWaitingForInput();
+
+#if AUTO_CALIBRATION_ENABLED
+    case STATE_NOTES_AUTO:
+#endif
+    case STATE_NOTES_RECORD:
+      return false;  // Balayages : ils suivent leur horaire
+
+    default:
+      return true;
+  }
 }
 
 void CalibrationManager::displayMainMenu() {
@@ -68,22 +202,32 @@ void CalibrationManager::displayMainMenu() {
   Serial.println(F("2. Calibrer plages airflow (NOTES)"));
   Serial.println(F("3. Afficher configuration actuelle"));
   Serial.println(F("4. Générer settings.h final"));
+  Serial.println(F("5. Écrire un profil EEPROM"));
   Serial.println(F("========================================"));
-  Serial.print(F("Votre choix (1-4): "));
+  Serial.print(F("Votre choix (1-5): "));
+  _promptOpen = true;
 }
 
-void CalibrationManager::handleMenuChoice(int choice) {
+void CalibrationManager::handleMenuChoice(const char* line) {
+  if (line[0] == '\0') return;  // Ligne vide : menu toujours affiché
+
+  _promptOpen = false;
+  int choice = atoi(line);
+  if (choice >= 1 && choice <= 5) {
+    Serial.println(choice);
+  }
+
   switch (choice) {
     case 1:
-      calibrateAllFingers();
+      beginFingers();
       break;
 
     case 2:
       if (!_fingersCalibrated) {
         Serial.println(F("\n⚠ ATTENTION: Vous devez calibrer les servos doigts d'abord!"));
-        delay(2000);
+        enterState(STATE_MENU);
       } else {
-        calibrateAllNotes();
+        beginNotes();
       }
       break;
 
@@ -101,34 +245,28 @@ void CalibrationManager::handleMenuChoice(int choice) {
           Serial.println(F("  - Notes: NON calibrées"));
         }
         Serial.println(F("\nVoulez-vous générer quand même? (o/n): "));
-
-        while (true) {
-          while (Serial.available() == 0) { }
-          char c = Serial.read();
-          if (c == 'o' || c == 'O') {
-            Serial.println(F("o"));
-            generateOutput();
-            break;
-          } else if (c == 'n' || c == 'N') {
-            Serial.println(F("n"));
-            break;
-          }
-        }
+        _state = STATE_GENERATE_ASK;
       } else {
         generateOutput();
       }
       break;
 
+    case 5:
+      if (!_fingersCalibrated || !_notesCalibrated) {
+        Serial.println(F("\n⚠ ATTENTION: Calibration incomplète!"));
+        Serial.println(F("Les valeurs du template seront écrites pour les parties non calibrées."));
+      }
+      beginSaveProfile();
+      break;
+
     default:
       Serial.println(F("\n❌ Choix invalide!"));
-      delay(1000);
+      enterState(STATE_MENU);
       break;
   }
-
-  printCalibrationStatus();
 }
 
-void CalibrationManager::calibrateAllFingers() {
+void CalibrationManager::beginFingers() {
   Serial.println();
   Serial.println(F("========================================"));
   Serial.println(F("  CALIBRATION DES SERVOS DOIGTS"));
@@ -138,12 +276,13 @@ void CalibrationManager::calibrateAllFingers() {
   Serial.println();
   Serial.println(F("Appuyez sur ENTRÉE pour commencer..."));
 
-  while (Serial.available() == 0) { }
-  while (Serial.available() > 0) Serial.read(); // Vider buffer
+  waitForEnter(STATE_FINGERS);
+}
 
-  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    _fingerCal.calibrateFinger(i, _calibratedFingers[i]);
-    delay(500);
+void CalibrationManager::nextFinger() {
+  if (++_index < NUMBER_SERVOS_FINGER) {
+    _fingerCal.start(_index, _calibratedFingers[_index]);
+    return;
   }
 
   _fingersCalibrated = true;
@@ -152,10 +291,10 @@ void CalibrationManager::calibrateAllFingers() {
   Serial.println(F("========================================"));
   Serial.println(F("✓ TOUS LES SERVOS DOIGTS SONT CALIBRÉS!"));
   Serial.println(F("========================================"));
-  delay(2000);
+  enterState(STATE_MENU);
 }
 
-void CalibrationManager::calibrateAllNotes() {
+void CalibrationManager::beginNotes() {
   Serial.println();
   Serial.println(F("========================================"));
   Serial.println(F("  CALIBRATION DES PLAGES AIRFLOW"));
@@ -168,14 +307,49 @@ void CalibrationManager::calibrateAllNotes() {
   Serial.println(F("  - Vérifiez l'alimentation air"));
   Serial.println(F("  - Testez chaque note soigneusement"));
   Serial.println();
-  Serial.println(F("Appuyez sur ENTRÉE pour commencer..."));
 
-  while (Serial.available() == 0) { }
-  while (Serial.available() > 0) Serial.read(); // Vider buffer
+  Serial.println(F("Mode de calibration:"));
+  Serial.println(F("  m : manuel (clavier, note par note)"));
+#if AUTO_CALIBRATION_ENABLED
+  Serial.println(F("  a : automatique (micro sur la carte)"));
+#endif
+  Serial.println(F("  e : balayage enregistré (téléphone + tools/sweep_analyzer.py)"));
+  Serial.print(F("Votre choix: "));
 
-  for (int i = 0; i < NUMBER_NOTES; i++) {
-    _airflowCal.calibrateNote(i, _calibratedFingers, _calibratedNotes[i]);
-    delay(500);
+  _state = STATE_NOTES_MODE;
+}
+
+void CalibrationManager::handleNotesMode(const char* line) {
+  char mode = line[0] | 0x20;  // Minuscule
+
+  switch (mode) {
+    case 'm':
+      Serial.println(mode);
+      Serial.println(F("Appuyez sur ENTRÉE pour commencer..."));
+      waitForEnter(STATE_NOTES_MANUAL);
+      break;
+
+#if AUTO_CALIBRATION_ENABLED
+    case 'a':
+      Serial.println(mode);
+      enterState(STATE_NOTES_AUTO);
+      break;
+#endif
+
+    case 'e':
+      Serial.println(mode);
+      beginRecordSweep();
+      break;
+
+    default:
+      break;  // Choix inconnu : question toujours posée
+  }
+}
+
+void CalibrationManager::nextManualNote() {
+  if (++_index < NUMBER_NOTES) {
+    _airflowCal.startManual(_index, _calibratedFingers, _calibratedNotes[_index]);
+    return;
   }
 
   _notesCalibrated = true;
@@ -184,14 +358,136 @@ void CalibrationManager::calibrateAllNotes() {
   Serial.println(F("========================================"));
   Serial.println(F("✓ TOUTES LES NOTES SONT CALIBRÉES!"));
   Serial.println(F("========================================"));
-  delay(2000);
+  enterState(STATE_MENU);
+}
+
+#if AUTO_CALIBRATION_ENABLED
+void CalibrationManager::beginAutoNotes() {
+  Serial.println();
+  Serial.println(F("CALIBRATION AUTOMATIQUE"));
+  Serial.println(F("-----------------------"));
+  Serial.println(F("Balayage du débit pour chaque note, détection au micro."));
+  Serial.println(F("Silence dans la pièce pendant toute la durée (~1 min)."));
+  Serial.println();
+
+  _startTime = millis();
+  _failedCount = 0;
+  _index = 0;
+  _airflowCal.startAuto(_index, _calibratedFingers, _calibratedNotes[_index]);
+}
+
+void CalibrationManager::nextAutoNote() {
+  _failed[_index] = !_airflowCal.isConfirmed();
+  if (_failed[_index]) _failedCount++;
+
+  if (++_index < NUMBER_NOTES) {
+    _airflowCal.startAuto(_index, _calibratedFingers, _calibratedNotes[_index]);
+    return;
+  }
+
+  Serial.println();
+  Serial.println(F("========================================"));
+  Serial.print(F("Calibration automatique terminée en "));
+  Serial.print((millis() - _startTime) / 1000);
+  Serial.println(F("s"));
+  Serial.println(F("========================================"));
+  _outputGen.generateNotesSection(_calibratedNotes);
+
+  // Notes non détectées : calibration manuelle, une par une
+  if (_failedCount > 0) {
+    Serial.print(_failedCount);
+    Serial.println(F(" note(s) sans plage stable détectée."));
+    Serial.print(F("Les calibrer manuellement? (o/n): "));
+    _state = STATE_NOTES_AUTO_ASK;
+    return;
+  }
+
+  _notesCalibrated = true;
+  enterState(STATE_MENU);
+}
+
+void CalibrationManager::handleAutoRetryAnswer(const char* line) {
+  int8_t answer = LineReader::parseYesNo(line);
+  if (answer < 0) return;
+  Serial.println(answer ? F("o") : F("n"));
+
+  if (answer) {
+    _state = STATE_NOTES_RETRY;
+    _index = -1;
+    nextRetryNote();
+  } else {
+    _notesCalibrated = true;
+    enterState(STATE_MENU);
+  }
+}
+
+void CalibrationManager::nextRetryNote() {
+  while (++_index < NUMBER_NOTES) {
+    if (_failed[_index]) {
+      _airflowCal.startManual(_index, _calibratedFingers, _calibratedNotes[_index]);
+      return;
+    }
+  }
+
+  _notesCalibrated = true;
+  enterState(STATE_MENU);
+}
+#endif
+
+void CalibrationManager::beginRecordSweep() {
+  unsigned long stepMs = SWEEP_LOG_HOLD_MS + SWEEP_LOG_GAP_MS;
+  unsigned long totalSec = (NUMBER_NOTES * (100 / SWEEP_LOG_STEP_PERCENT + 1) * stepMs) / 1000;
+
+  Serial.println();
+  Serial.println(F("BALAYAGE ENREGISTRÉ"));
+  Serial.println(F("-------------------"));
+  Serial.println(F("1. Poser le téléphone près de l'embouchure, pièce silencieuse"));
+  Serial.println(F("2. Lancer l'enregistrement (WAV de préférence)"));
+  Serial.println(F("3. Appuyer sur ENTRÉE ; ne pas arrêter avant le second SYNC"));
+  Serial.print(F("Durée: ~"));
+  Serial.print(totalSec);
+  Serial.println(F("s"));
+  Serial.println(F("Copier ensuite tout le journal ci-dessous dans un fichier texte."));
+
+  waitForEnter(STATE_NOTES_RECORD);
+}
+
+void CalibrationManager::nextRecordStep() {
+  // -1 : SYNC de début, 0..NUMBER_NOTES-1 : notes, NUMBER_NOTES : SYNC de fin
+  if (++_index < NUMBER_NOTES) {
+    _airflowCal.startRecordNote(_index, _calibratedFingers);
+    return;
+  }
+  if (_index == NUMBER_NOTES) {
+    _airflowCal.startRecordSync(_calibratedFingers);
+    return;
+  }
+
+  Serial.println(F("SWEEP_END"));
+  Serial.println();
+  Serial.println(F("Analyse sur PC :"));
+  Serial.println(F("  python3 tools/sweep_analyzer.py journal.txt enregistrement.wav"));
+  Serial.println(F("Le NOTES[] produit est à copier dans settings.h (les notes"));
+  Serial.println(F("restent NON calibrées dans cet outil)."));
+  enterState(STATE_MENU);
 }
 
 void CalibrationManager::displayCurrentConfig() {
   _outputGen.displayCurrentConfig(_calibratedFingers, _calibratedNotes);
   Serial.println(F("\nAppuyez sur ENTRÉE pour continuer..."));
-  while (Serial.available() == 0) { }
-  while (Serial.available() > 0) Serial.read();
+  waitForEnter(STATE_MENU);
+}
+
+void CalibrationManager::handleGenerateAnswer(const char* line) {
+  int8_t answer = LineReader::parseYesNo(line);
+  if (answer < 0) return;
+  Serial.println(answer ? F("o") : F("n"));
+
+  if (answer) {
+    generateOutput();
+  } else {
+    enterState(STATE_MENU);
+  }
 }
 
 void CalibrationManager::generateOutput() {
@@ -202,9 +498,46 @@ void CalibrationManager::generateOutput() {
   Serial.println(F("le fichier settings.h de Servo_flute_v3."));
   Serial.println();
   Serial.println(F("Appuyez sur ENTRÉE pour continuer..."));
+  waitForEnter(STATE_MENU);
+}
+
+void CalibrationManager::beginSaveProfile() {
+  Serial.println();
+  Serial.println(F("========================================"));
+  Serial.println(F("  ÉCRITURE PROFIL EEPROM"));
+  Serial.println(F("========================================"));
+  _profileWriter.printProfiles();
+  Serial.println();
+  Serial.print(F("Numéro de profil (0-"));
+  Serial.print(CONFIG_PROFILE_COUNT - 1);
+  Serial.print(F(", autre = annuler): "));
 
-  while (Serial.available() == 0) { }
-  while (Serial.available() > 0) Serial.read();
+  _state = STATE_PROFILE_SLOT;
+}
+
+void CalibrationManager::handleProfileSlot(const char* line) {
+  // Ligne vide ou non numérique : annulation (et non profil 0)
+  int profile = (line[0] >= '0' && line[0] <= '9') ? atoi(line) : -1;
+  Serial.println(profile);
+
+  if (profile < 0 || profile >= CONFIG_PROFILE_COUNT) {
+    Serial.println(F("Annulé."));
+    enterState(STATE_MENU);
+    return;
+  }
+
+  if (_profileWriter.writeProfile(profile, _calibratedFingers, _calibratedNotes)) {
+    Serial.println(F("✓ Profil écrit et vérifié (CRC OK)"));
+    Serial.println();
+    Serial.println(F("Après téléversement de Servo_flute_v3 (l'EEPROM est conservée) :"));
+    Serial.println(F("  - CONFIG_BOOT_PROFILE (0 par défaut) chargé au démarrage"));
+    Serial.println(F("  - Program Change n = profil n (appliqué entre deux notes)"));
+  } else {
+    Serial.println(F("❌ ÉCHEC écriture EEPROM (relecture différente)"));
+  }
+
+  Serial.println(F("\nAppuyez sur ENTRÉE pour continuer..."));
+  waitForEnter(STATE_MENU);
 }
 
 void CalibrationManager::initializeDefaults() {
@@ -218,26 +551,6 @@ void CalibrationManager::initializeDefaults() {
   }
 }
 
-int CalibrationManager::waitForMenuChoice() {
-  while (true) {
-    while (Serial.available() == 0) {
-      // Attendre
-    }
-
-    int choice = Serial.parseInt();
-
-    // Vider le buffer
-    while (Serial.available() > 0) {
-      Serial.read();
-    }
-
-    if (choice >= 1 && choice <= 4) {
-      Serial.println(choice);
-      return choice;
-    }
-  }
-}
-
 void CalibrationManager::printWelcomeBanner() {
   Serial.println(F("\n\n"));
   Serial.println(F("========================================"));
@@ -3,6 +3,10 @@
  *
  * Chef d'orchestre du processus de calibration.
  * Gère le menu principal et coordonne les différents calibrateurs.
+ * Aucune attente bloquante : update() est appelé à chaque tour de loop(), lit les
+ * commandes ligne par ligne et fait avancer l'étape en cours (menu, calibrateur,
+ * question). Une session complète peut ainsi être envoyée d'un bloc par un hôte.
+ * Les lignes "@..." vont au protocole machine (BatchProtocol) quand le menu est affiché.
  ***********************************************************************************************/
 #ifndef CALIBRATION_MANAGER_H
 #define CALIBRATION_MANAGER_H
@@ -11,9 +15,12 @@
 #include <Wire.h>
 #include <Adafruit_PWMServoDriver.h>
 #include "settings_template.h"
+#include "LineReader.h"
 #include "FingerCalibrator.h"
 #include "AirflowCalibrator.h"
 #include "OutputGenerator.h"
+#include "ProfileWriter.h"
+#include "BatchProtocol.h"
 
 class CalibrationManager {
 public:
@@ -22,14 +29,34 @@ public:
   // Initialisation
   void begin();
 
-  // Boucle principale
-  void run();
+  // Boucle principale (non bloquante)
+  void update();
 
 private:
-  Adafruit_PWMServoDriver _pwm;
+  enum State {
+    STATE_MENU,             // Menu affiché, attente du choix
+    STATE_WAIT_ENTER,       // "Appuyez sur ENTRÉE", puis _nextState
+    STATE_FINGERS,          // Doigt _index en cours
+    STATE_NOTES_MODE,       // Choix du mode m / a / e
+    STATE_NOTES_MANUAL,     // Note _index en cours (manuel)
+#if AUTO_CALIBRATION_ENABLED
+    STATE_NOTES_AUTO,       // Note _index en cours (automatique)
+    STATE_NOTES_AUTO_ASK,   // Reprendre les échecs manuellement ?
+    STATE_NOTES_RETRY,      // Note en échec _index (manuel)
+#endif
+    STATE_NOTES_RECORD,     // Balayage enregistré : SYNC, notes, SYNC
+    STATE_GENERATE_ASK,     // Calibration incomplète : générer quand même ?
+    STATE_PROFILE_SLOT      // Numéro de profil EEPROM
+  };
+
+  Adafruit_PWMServoDriver _pwm;     // Initialisation du PCA9685 (fréquence)
+  Actuation::Frame _servos;         // Sorties servos (conversion PWM du firmware)
+  LineReader _reader;
   FingerCalibrator _fingerCal;
   AirflowCalibrator _airflowCal;
   OutputGenerator _outputGen;
+  ProfileWriter _profileWriter;
+  BatchProtocol _protocol;
 
   // Stockage temporaire des calibrations
   FingerConfig _calibratedFingers[NUMBER_SERVOS_FINGER];
@@ -39,19 +66,51 @@ private:
   bool _fingersCalibrated;
   bool _notesCalibrated;
 
+  // Machine à états
+  State _state;
+  State _nextState;
+  int _index;               // Doigt ou note en cours (-1 / NUMBER_NOTES : SYNC)
+  bool _promptOpen;         // "Votre choix" sans fin de ligne (réponses machine à la ligne)
+#if AUTO_CALIBRATION_ENABLED
+  bool _failed[NUMBER_NOTES];
+  int _failedCount;
+  unsigned long _startTime;
+#endif
+
+  // Changement d'état avec action d'entrée (menu, premier doigt, première note...)
+  void enterState(State state);
+  void waitForEnter(State next);
+
+  // Étape en cours prête à traiter une ligne : sinon les commandes envoyées d'avance
+  // (script hôte) restent en file au lieu d'être perdues pendant un mouvement temporisé
+  bool acceptsInput() const;
+
   // Menu principal
   void displayMainMenu();
-  void handleMenuChoice(int choice);
+  void handleMenuChoice(const char* line);
 
   // Modes de calibration
-  void calibrateAllFingers();
-  void calibrateAllNotes();
+  void beginFingers();
+  void nextFinger();
+  void beginNotes();
+  void handleNotesMode(const char* line);
+  void nextManualNote();
+#if AUTO_CALIBRATION_ENABLED
+  void beginAutoNotes();
+  void nextAutoNote();
+  void handleAutoRetryAnswer(const char* line);
+  void nextRetryNote();
+#endif
+  void beginRecordSweep();
+  void nextRecordStep();
   void displayCurrentConfig();
+  void handleGenerateAnswer(const char* line);
   void generateOutput();
+  void beginSaveProfile();
+  void handleProfileSlot(const char* line);
 
   // Utilitaires
   void initializeDefaults();
-  int waitForMenuChoice();
   void printWelcomeBanner();
   void printCalibrationStatus();
 };
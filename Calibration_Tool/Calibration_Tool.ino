@@ -37,6 +37,6 @@ void setup() {
 }
 
 void loop() {
-  // Exécuter le menu principal
-  calibManager.run();
+  // Menu et calibrateurs non bloquants : rien d'autre n'attend ici
+  calibManager.update();
 }
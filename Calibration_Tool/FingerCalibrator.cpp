@@ -2,14 +2,19 @@
  * FINGER CALIBRATOR - IMPLEMENTATION
  ***********************************************************************************************/
 #include "FingerCalibrator.h"
+#include "LineReader.h"
 
-FingerCalibrator::FingerCalibrator(Adafruit_PWMServoDriver& pwm)
-  : _pwm(pwm), _currentAngle(90), _currentDirection(1), _step(1) {
+FingerCalibrator::FingerCalibrator(Actuation::Frame& servos)
+  : _servos(servos), _output(nullptr), _currentFingerIndex(0), _pcaChannel(0),
+    _currentAngle(90), _currentDirection(1), _currentHalfAngle(ANGLE_OPEN / 2),
+    _step(STEP_DONE), _confirmed(false), _phase(0), _phaseStart(0), _phaseDuration(0) {
 }
 
-void FingerCalibrator::calibrateFinger(int fingerIndex, FingerConfig& output) {
+void FingerCalibrator::start(int fingerIndex, FingerConfig& output) {
   _currentFingerIndex = fingerIndex;
-  byte pcaChannel = FINGERS_TEMPLATE[fingerIndex].pcaChannel;
+  _output = &output;
+  _confirmed = false;
+  _pcaChannel = FINGERS_TEMPLATE[fingerIndex].pcaChannel;
 
   Serial.println(F("\n========================================"));
   Serial.print(F("  CALIBRATION SERVO DOIGT "));
@@ -18,7 +23,7 @@ void FingerCalibrator::calibrateFinger(int fingerIndex, FingerConfig& output) {
   Serial.println(NUMBER_SERVOS_FINGER);
   Serial.println(F("========================================"));
   Serial.print(F("Canal PCA9685: "));
-  Serial.println(pcaChannel);
+  Serial.println(_pcaChannel);
   Serial.print(F("Trou: "));
   Serial.print(fingerIndex + 1);
 
@@ -31,226 +36,377 @@ void FingerCalibrator::calibrateFinger(int fingerIndex, FingerConfig& output) {
 
   Serial.println();
 
-  // Étape 1 : Calibrer l'angle fermé
-  calibrateClosedAngle(pcaChannel);
-  uint16_t closedAngle = _currentAngle;
+  beginClosedAngle();
+}
 
-  // Étape 2 : Déterminer le sens de rotation
-  calibrateDirection(pcaChannel, closedAngle);
-  int8_t direction = _currentDirection;
+bool FingerCalibrator::update(const char* line) {
+  switch (_step) {
+    case STEP_CLOSED:
+      if (line) handleClosedAngle(line);
+      break;
 
-  // Étape 3 : Vérification finale
-  bool confirmed = verifyConfiguration(pcaChannel, closedAngle, direction);
+    case STEP_DIRECTION_TEST:
+      runDirectionTest();
+      break;
 
-  if (confirmed) {
-    output.pcaChannel = pcaChannel;
-    output.closedAngle = closedAngle;
-    output.direction = direction;
+    case STEP_DIRECTION_ASK:
+      if (line) handleDirectionAnswer(line);
+      break;
 
-    Serial.println();
-    Serial.print(F("✓ Doigt "));
-    Serial.print(fingerIndex + 1);
-    Serial.print(F("/"));
-    Serial.print(NUMBER_SERVOS_FINGER);
-    Serial.println(F(" calibré!"));
-  } else {
-    Serial.println(F("❌ Calibration annulée"));
+    case STEP_HALF:
+      if (line) handleHalfAngle(line);
+      break;
+
+    case STEP_VERIFY_ASK:
+      if (line) handleVerifyAnswer(line);
+      break;
+
+    case STEP_VERIFY_TEST:
+      runOpenCloseTest();
+      break;
+
+    case STEP_VERIFY_CONFIRM:
+      if (line) handleConfirmAnswer(line);
+      break;
+
+    case STEP_DONE:
+      break;
   }
+  return _step == STEP_DONE;
 }
 
-void FingerCalibrator::calibrateClosedAngle(byte pcaChannel) {
+bool FingerCalibrator::isWaitingForInput() const {
+  return _step != STEP_DIRECTION_TEST && _step != STEP_VERIFY_TEST && _step != STEP_DONE;
+}
+
+void FingerCalibrator::beginClosedAngle() {
   _currentAngle = 90;  // Angle de départ
+  _step = STEP_CLOSED;
 
-  Serial.println(F("ÉTAPE 1/3 - Trouver l'angle FERMÉ"));
+  Serial.println(F("ÉTAPE 1/4 - Trouver l'angle FERMÉ"));
   Serial.println(F("----------------------------------"));
   Serial.println(F("Instructions:"));
   Serial.println(F("  - Le trou doit être complètement BOUCHÉ"));
   Serial.println(F("  - Ajustez jusqu'à fermeture hermétique"));
   Serial.println(F("  - Ne pas forcer le servo"));
   Serial.println();
-  Serial.println(F("Commandes:"));
+  Serial.println(F("Commandes (plusieurs par ligne possible, ex: \"+++s\"):"));
   Serial.println(F("  +         : Augmenter angle (+1°)"));
   Serial.println(F("  -         : Diminuer angle (-1°)"));
   Serial.println(F("  > ou ]    : Augmenter rapide (+5°)"));
   Serial.println(F("  < ou [    : Diminuer rapide (-5°)"));
   Serial.println(F("  t         : Tester position actuelle"));
   Serial.println(F("  s         : Sauvegarder et continuer"));
+  Serial.println(F("  =N        : Angle direct (ex: =92)"));
   Serial.println();
 
-  setServoAngle(pcaChannel, _currentAngle);
+  setServoAngle(_pcaChannel, _currentAngle);
   Serial.print(F("Position actuelle: "));
   Serial.print(_currentAngle);
   Serial.println(F("°"));
   Serial.println();
+}
 
-  bool done = false;
-  while (!done) {
-    if (Serial.available() > 0) {
-      char cmd = Serial.read();
-
-      switch (cmd) {
-        case '+':
-          adjustAngle(1);
-          setServoAngle(pcaChannel, _currentAngle);
-          Serial.print(F("Position: "));
-          Serial.print(_currentAngle);
-          Serial.println(F("° [APPLIQUÉ]"));
-          break;
-
-        case '-':
-          adjustAngle(-1);
-          setServoAngle(pcaChannel, _currentAngle);
-          Serial.print(F("Position: "));
-          Serial.print(_currentAngle);
-          Serial.println(F("° [APPLIQUÉ]"));
-          break;
-
-        case '>':
-        case ']':
-          adjustAngle(5);
-          setServoAngle(pcaChannel, _currentAngle);
-          Serial.print(F("Position: "));
-          Serial.print(_currentAngle);
-          Serial.println(F("° [APPLIQUÉ]"));
-          break;
-
-        case '<':
-        case '[':
-          adjustAngle(-5);
-          setServoAngle(pcaChannel, _currentAngle);
-          Serial.print(F("Position: "));
-          Serial.print(_currentAngle);
-          Serial.println(F("° [APPLIQUÉ]"));
-          break;
-
-        case 't':
-        case 'T':
-          testCurrentPosition(pcaChannel);
-          break;
-
-        case 's':
-        case 'S':
-          Serial.println();
-          Serial.print(F("Angle fermé confirmé: "));
-          Serial.print(_currentAngle);
-          Serial.println(F("°"));
-          done = true;
-          break;
-      }
+void FingerCalibrator::handleClosedAngle(const char* line) {
+  bool moved = false;
+
+  for (const char* c = line; *c; c++) {
+    switch (*c) {
+      case '+':           adjustAngle(1);  moved = true; break;
+      case '-':           adjustAngle(-1); moved = true; break;
+      case '>': case ']': adjustAngle(5);  moved = true; break;
+      case '<': case '[': adjustAngle(-5); moved = true; break;
+
+      case '=':
+        // Valeur absolue (scripts hôte) : fin de ligne
+        adjustAngle(atoi(c + 1) - (int)_currentAngle);
+        moved = true;
+        c += strlen(c) - 1;
+        break;
+
+      case 't':
+      case 'T':
+        testCurrentPosition();
+        break;
+
+      case 's':
+      case 'S':
+        if (moved) setServoAngle(_pcaChannel, _currentAngle);
+        Serial.println();
+        Serial.print(F("Angle fermé confirmé: "));
+        Serial.print(_currentAngle);
+        Serial.println(F("°"));
+
+        Serial.println();
+        Serial.println(F("ÉTAPE 2/4 - Déterminer le SENS de rotation"));
+        Serial.println(F("-------------------------------------------"));
+        Serial.println(F("Instruction:"));
+        Serial.println(F("  - Le servo va s'ouvrir de 30°"));
+        Serial.println(F("  - Vérifiez que le trou S'OUVRE (ne se ferme pas plus)"));
+        Serial.println();
+        beginDirectionTest(1);
+        return;  // Reste de la ligne ignoré
     }
   }
+
+  // Une seule commande servo et un seul affichage par ligne
+  if (moved) {
+    setServoAngle(_pcaChannel, _currentAngle);
+    Serial.print(F("Position: "));
+    Serial.print(_currentAngle);
+    Serial.println(F("° [APPLIQUÉ]"));
+  }
 }
 
-void FingerCalibrator::calibrateDirection(byte pcaChannel, uint16_t closedAngle) {
-  Serial.println();
-  Serial.println(F("ÉTAPE 2/3 - Déterminer le SENS de rotation"));
-  Serial.println(F("-------------------------------------------"));
-  Serial.println(F("Instruction:"));
-  Serial.println(F("  - Le servo va s'ouvrir de 30°"));
-  Serial.println(F("  - Vérifiez que le trou S'OUVRE (ne se ferme pas plus)"));
-  Serial.println();
+void FingerCalibrator::beginDirectionTest(int8_t direction) {
+  _currentDirection = direction;
 
-  // Test sens horaire (+1)
-  Serial.println(F("Test avec sens HORAIRE (+1):"));
+  if (direction == 1) {
+    Serial.println(F("Test avec sens HORAIRE (+1):"));
+  } else {
+    Serial.println(F("Test avec sens ANTI-HORAIRE (-1):"));
+  }
   Serial.print(F("  Fermé: "));
-  Serial.print(closedAngle);
+  Serial.print(_currentAngle);
   Serial.print(F("° → Ouvert: "));
-  Serial.print(closedAngle + ANGLE_OPEN);
+  Serial.print(openAngle());
   Serial.println(F("°"));
   Serial.println();
 
-  setServoAngle(pcaChannel, closedAngle);
-  delay(500);
-  setServoAngle(pcaChannel, closedAngle + ANGLE_OPEN);
-  delay(1000);
-  setServoAngle(pcaChannel, closedAngle);
-  delay(500);
+  // Fermé (500ms) → ouvert (1s) → fermé (500ms), déroulé par runDirectionTest()
+  setServoAngle(_pcaChannel, _currentAngle);
+  startPhase(0, 500);
+  _step = STEP_DIRECTION_TEST;
+}
 
-  Serial.print(F("Le trou s'ouvre-t-il correctement? (o/n): "));
-  bool horaireFonctionne = waitForConfirmation();
+void FingerCalibrator::runDirectionTest() {
+  if (!phaseElapsed()) return;
 
-  if (horaireFunctionne) {
-    _currentDirection = 1;
-    Serial.println(F("Sens confirmé: 1 (horaire)"));
-    return;
+  switch (_phase) {
+    case 0:
+      setServoAngle(_pcaChannel, openAngle());
+      startPhase(1, 1000);
+      break;
+
+    case 1:
+      setServoAngle(_pcaChannel, _currentAngle);
+      startPhase(2, 500);
+      break;
+
+    default:
+      Serial.print(F("Le trou s'ouvre-t-il correctement? (o/n): "));
+      _step = STEP_DIRECTION_ASK;
+      break;
+  }
+}
+
+void FingerCalibrator::handleDirectionAnswer(const char* line) {
+  int8_t answer = LineReader::parseYesNo(line);
+  if (answer < 0) return;
+  Serial.println(answer ? F("o") : F("n"));
+
+  if (answer) {
+    Serial.print(F("Sens confirmé: "));
+    Serial.println(_currentDirection == 1 ? F("1 (horaire)") : F("-1 (anti-horaire)"));
+    beginHalfAngle();
+  } else if (_currentDirection == 1) {
+    Serial.println();
+    beginDirectionTest(-1);
+  } else {
+    Serial.println(F("⚠ ATTENTION: Aucun sens ne semble fonctionner!"));
+    Serial.println(F("Utilisation par défaut: -1 (anti-horaire)"));
+    beginHalfAngle();
   }
+}
 
+void FingerCalibrator::beginHalfAngle() {
+  _currentHalfAngle = ANGLE_OPEN / 2;  // Point de départ
+  _step = STEP_HALF;
+
+  Serial.println();
+  Serial.println(F("ÉTAPE 3/4 - Trouver l'ouverture DEMI-TROU"));
+  Serial.println(F("------------------------------------------"));
+  Serial.println(F("Instructions:"));
+  Serial.println(F("  - Le trou doit être à moitié découvert"));
+  Serial.println(F("  - Sert aux notes chromatiques (C#, D#...)"));
+  Serial.println(F("  - Le quart de trou sera la moitié de cette valeur"));
+  Serial.println();
+  Serial.println(F("Commandes:"));
+  Serial.println(F("  +         : Ouvrir plus (+1°)"));
+  Serial.println(F("  -         : Ouvrir moins (-1°)"));
+  Serial.println(F("  s         : Sauvegarder et continuer"));
+  Serial.println(F("  =N        : Ouverture directe (ex: =14)"));
   Serial.println();
 
-  // Test sens anti-horaire (-1)
-  Serial.println(F("Test avec sens ANTI-HORAIRE (-1):"));
-  Serial.print(F("  Fermé: "));
-  Serial.print(closedAngle);
-  Serial.print(F("° → Ouvert: "));
-  Serial.print(closedAngle - ANGLE_OPEN);
+  setServoAngle(_pcaChannel, _currentAngle + (_currentHalfAngle * _currentDirection));
+  Serial.print(F("Ouverture actuelle: "));
+  Serial.print(_currentHalfAngle);
   Serial.println(F("°"));
-  Serial.println();
+}
 
-  setServoAngle(pcaChannel, closedAngle);
-  delay(500);
-  setServoAngle(pcaChannel, closedAngle - ANGLE_OPEN);
-  delay(1000);
-  setServoAngle(pcaChannel, closedAngle);
-  delay(500);
+void FingerCalibrator::handleHalfAngle(const char* line) {
+  bool moved = false;
+
+  for (const char* c = line; *c; c++) {
+    switch (*c) {
+      case '+':
+        if (_currentHalfAngle < ANGLE_OPEN - 1) _currentHalfAngle++;
+        moved = true;
+        break;
+
+      case '-':
+        if (_currentHalfAngle > 1) _currentHalfAngle--;
+        moved = true;
+        break;
+
+      case '=': {
+        int value = atoi(c + 1);
+        _currentHalfAngle = constrain(value, 1, ANGLE_OPEN - 1);
+        moved = true;
+        c += strlen(c) - 1;
+        break;
+      }
 
-  Serial.print(F("Le trou s'ouvre-t-il correctement? (o/n): "));
-  bool antihoraireFonctionne = waitForConfirmation();
+      case 's':
+      case 'S':
+        Serial.println();
+        Serial.print(F("Demi-trou confirmé: "));
+        Serial.print(_currentHalfAngle);
+        Serial.println(F("°"));
+
+        // Retour en position fermée
+        setServoAngle(_pcaChannel, _currentAngle);
+        beginVerify();
+        return;
+    }
+  }
 
-  if (antihoraireFonctionne) {
-    _currentDirection = -1;
-    Serial.println(F("Sens confirmé: -1 (anti-horaire)"));
-  } else {
-    Serial.println(F("⚠ ATTENTION: Aucun sens ne semble fonctionner!"));
-    Serial.println(F("Utilisation par défaut: -1 (anti-horaire)"));
-    _currentDirection = -1;
+  if (moved) {
+    setServoAngle(_pcaChannel, _currentAngle + (_currentHalfAngle * _currentDirection));
+    Serial.print(F("Ouverture: "));
+    Serial.print(_currentHalfAngle);
+    Serial.println(F("° [APPLIQUÉ]"));
   }
 }
 
-bool FingerCalibrator::verifyConfiguration(byte pcaChannel, uint16_t closedAngle, int8_t direction) {
+void FingerCalibrator::beginVerify() {
   Serial.println();
-  Serial.println(F("ÉTAPE 3/3 - Vérification finale"));
+  Serial.println(F("ÉTAPE 4/4 - Vérification finale"));
   Serial.println(F("--------------------------------"));
   Serial.print(F("Configuration doigt "));
   Serial.print(_currentFingerIndex + 1);
   Serial.println(F(":"));
   Serial.print(F("  Canal PCA: "));
-  Serial.println(pcaChannel);
+  Serial.println(_pcaChannel);
   Serial.print(F("  Angle fermé: "));
-  Serial.print(closedAngle);
+  Serial.print(_currentAngle);
   Serial.println(F("°"));
   Serial.print(F("  Sens: "));
-  Serial.print(direction);
+  Serial.print(_currentDirection);
   Serial.print(F(" ("));
-  Serial.print(direction == 1 ? F("horaire") : F("anti-horaire"));
+  Serial.print(_currentDirection == 1 ? F("horaire") : F("anti-horaire"));
   Serial.println(F(")"));
   Serial.print(F("  Angle ouvert: "));
-  Serial.print(closedAngle + (ANGLE_OPEN * direction));
+  Serial.print(openAngle());
   Serial.print(F("° ("));
-  Serial.print(closedAngle);
+  Serial.print(_currentAngle);
   Serial.print(F("° + "));
   Serial.print(ANGLE_OPEN);
   Serial.print(F("° × "));
-  Serial.print(direction);
+  Serial.print(_currentDirection);
   Serial.println(F(")"));
+  Serial.print(F("  Demi-trou: "));
+  Serial.print(_currentHalfAngle);
+  Serial.print(F("° / Quart: "));
+  Serial.print(_currentHalfAngle / 2);
+  Serial.println(F("°"));
   Serial.println();
 
   Serial.print(F("Tester? (o/n): "));
-  if (waitForConfirmation()) {
-    testOpenClose(pcaChannel, closedAngle, direction);
+  _step = STEP_VERIFY_ASK;
+}
+
+void FingerCalibrator::handleVerifyAnswer(const char* line) {
+  int8_t answer = LineReader::parseYesNo(line);
+  if (answer < 0) return;
+  Serial.println(answer ? F("o") : F("n"));
+
+  if (answer) {
+    // Oscillation ouvert/fermé (3 cycles), déroulée par runOpenCloseTest()
+    Serial.println(F("[TEST] Oscillation ouvert/fermé (3 cycles)"));
+    _phase = 0;
+    _phaseDuration = 0;
+    _step = STEP_VERIFY_TEST;
+    return;
   }
 
   Serial.println();
   Serial.print(F("Confirmer et passer au suivant? (o/n): "));
-  return waitForConfirmation();
+  _step = STEP_VERIFY_CONFIRM;
+}
+
+void FingerCalibrator::runOpenCloseTest() {
+  if (!phaseElapsed()) return;
+
+  // Phases paires : fermé, impaires : ouvert (500ms chacune)
+  if (_phase < 6) {
+    if ((_phase & 1) == 0) {
+      Serial.print(F("  Cycle "));
+      Serial.print(_phase / 2 + 1);
+      Serial.print(F("/3: "));
+      Serial.print(_currentAngle);
+      Serial.print(F("° → "));
+      Serial.print(openAngle());
+      Serial.println(F("°"));
+      setServoAngle(_pcaChannel, _currentAngle);
+    } else {
+      setServoAngle(_pcaChannel, openAngle());
+    }
+    startPhase(_phase + 1, 500);
+    return;
+  }
+
+  // Retour à fermé
+  setServoAngle(_pcaChannel, _currentAngle);
+  Serial.println(F("[TEST] Terminé"));
+
+  Serial.println();
+  Serial.print(F("Confirmer et passer au suivant? (o/n): "));
+  _step = STEP_VERIFY_CONFIRM;
+}
+
+void FingerCalibrator::handleConfirmAnswer(const char* line) {
+  int8_t answer = LineReader::parseYesNo(line);
+  if (answer < 0) return;
+  Serial.println(answer ? F("o") : F("n"));
+
+  _confirmed = (answer == 1);
+  if (_confirmed) {
+    _output->pcaChannel = _pcaChannel;
+    _output->closedAngle = _currentAngle;
+    _output->direction = _currentDirection;
+    _output->halfAngle = _currentHalfAngle;
+    _output->quarterAngle = _currentHalfAngle / 2;
+
+    Serial.println();
+    Serial.print(F("✓ Doigt "));
+    Serial.print(_currentFingerIndex + 1);
+    Serial.print(F("/"));
+    Serial.print(NUMBER_SERVOS_FINGER);
+    Serial.println(F(" calibré!"));
+  } else {
+    Serial.println(F("❌ Calibration annulée"));
+  }
+  _step = STEP_DONE;
 }
 
 void FingerCalibrator::setServoAngle(byte pcaChannel, uint16_t angle) {
-  uint16_t pwm = angleToPWM(angle);
-  _pwm.setPWM(pcaChannel, 0, pwm);
+  // Même conversion PWM que le firmware (ServoFluteCore)
+  _servos.writeAngle(pcaChannel, angle);
 }
 
-uint16_t FingerCalibrator::angleToPWM(uint16_t angle) {
-  return map(angle, 0, 180, SERVO_PULSE_MIN, SERVO_PULSE_MAX);
+uint16_t FingerCalibrator::openAngle() const {
+  return _currentAngle + (ANGLE_OPEN * _currentDirection);
 }
 
 void FingerCalibrator::adjustAngle(int delta) {
@@ -260,50 +416,19 @@ void FingerCalibrator::adjustAngle(int delta) {
   _currentAngle = (uint16_t)newAngle;
 }
 
-void FingerCalibrator::testCurrentPosition(byte pcaChannel) {
+void FingerCalibrator::testCurrentPosition() {
   Serial.print(F("[TEST] Position "));
   Serial.print(_currentAngle);
   Serial.println(F("°"));
-  setServoAngle(pcaChannel, _currentAngle);
+  setServoAngle(_pcaChannel, _currentAngle);
 }
 
-void FingerCalibrator::testOpenClose(byte pcaChannel, uint16_t closedAngle, int8_t direction) {
-  uint16_t openAngle = closedAngle + (ANGLE_OPEN * direction);
-
-  Serial.println(F("[TEST] Oscillation ouvert/fermé (3 cycles)"));
-  for (int i = 0; i < 3; i++) {
-    Serial.print(F("  Cycle "));
-    Serial.print(i + 1);
-    Serial.print(F("/3: "));
-    Serial.print(closedAngle);
-    Serial.print(F("° → "));
-    Serial.print(openAngle);
-    Serial.println(F("°"));
-
-    setServoAngle(pcaChannel, closedAngle);
-    delay(500);
-    setServoAngle(pcaChannel, openAngle);
-    delay(500);
-  }
-
-  // Retour à fermé
-  setServoAngle(pcaChannel, closedAngle);
-  Serial.println(F("[TEST] Terminé"));
+void FingerCalibrator::startPhase(uint8_t phase, unsigned long durationMs) {
+  _phase = phase;
+  _phaseStart = millis();
+  _phaseDuration = durationMs;
 }
 
-bool FingerCalibrator::waitForConfirmation() {
-  while (true) {
-    while (Serial.available() == 0) {
-      // Attendre
-    }
-
-    char c = Serial.read();
-    if (c == 'o' || c == 'O' || c == 'y' || c == 'Y') {
-      Serial.println(F("o"));
-      return true;
-    } else if (c == 'n' || c == 'N') {
-      Serial.println(F("n"));
-      return false;
-    }
-  }
+bool FingerCalibrator::phaseElapsed() const {
+  return millis() - _phaseStart >= _phaseDuration;
 }
@@ -2,47 +2,89 @@
  * FINGER CALIBRATOR
  *
  * Gère la calibration des servos doigts (angle fermé + sens de rotation).
+ * Machine à états non bloquante : start() puis update() à chaque tour de loop(),
+ * avec la dernière ligne de commande reçue (ou nullptr).
  ***********************************************************************************************/
 #ifndef FINGER_CALIBRATOR_H
 #define FINGER_CALIBRATOR_H
 
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
 #include "settings_template.h"
 
 class FingerCalibrator {
 public:
-  FingerCalibrator(Adafruit_PWMServoDriver& pwm);
+  FingerCalibrator(Actuation::Frame& servos);
 
-  // Calibre un doigt complet (angle fermé + sens)
-  void calibrateFinger(int fingerIndex, FingerConfig& output);
+  // Lance la calibration d'un doigt complet (angle fermé + sens + demi-trou).
+  // output n'est écrit qu'à la confirmation finale.
+  void start(int fingerIndex, FingerConfig& output);
+
+  // Avance la calibration ; line = ligne reçue ou nullptr. true quand terminée.
+  bool update(const char* line);
+
+  // Étape en attente d'une commande (sinon les lignes restent en file)
+  bool isWaitingForInput() const;
+
+  // Calibration terminée confirmée (false = annulée)
+  bool isConfirmed() const { return _confirmed; }
+
+  // Primitive (protocole machine, BatchProtocol) : angle brut sur un canal PCA
+  void setServoAngle(byte pcaChannel, uint16_t angle);
 
 private:
-  Adafruit_PWMServoDriver& _pwm;
+  enum Step {
+    STEP_CLOSED,          // 1/4 : ajustement angle fermé
+    STEP_DIRECTION_TEST,  // 2/4 : mouvement fermé → ouvert → fermé en cours
+    STEP_DIRECTION_ASK,   // 2/4 : le trou s'ouvre-t-il ?
+    STEP_HALF,            // 3/4 : ajustement demi-trou
+    STEP_VERIFY_ASK,      // 4/4 : tester ?
+    STEP_VERIFY_TEST,     // 4/4 : oscillation en cours
+    STEP_VERIFY_CONFIRM,  // 4/4 : confirmer ?
+    STEP_DONE
+  };
+
+  Actuation::Frame& _servos;
+  FingerConfig* _output;
 
   // État interne
   int _currentFingerIndex;
+  byte _pcaChannel;
   uint16_t _currentAngle;
   int8_t _currentDirection;
-  int _step;  // 1=angle fermé, 2=sens, 3=vérification
+  uint8_t _currentHalfAngle;
+  Step _step;
+  bool _confirmed;
+
+  // Mouvements temporisés (millis, sans delay)
+  uint8_t _phase;
+  unsigned long _phaseStart;
+  unsigned long _phaseDuration;
 
   // Étape 1 : Calibrer angle fermé
-  void calibrateClosedAngle(byte pcaChannel);
+  void beginClosedAngle();
+  void handleClosedAngle(const char* line);
 
   // Étape 2 : Déterminer sens de rotation
-  void calibrateDirection(byte pcaChannel, uint16_t closedAngle);
+  void beginDirectionTest(int8_t direction);
+  void runDirectionTest();
+  void handleDirectionAnswer(const char* line);
 
-  // Étape 3 : Vérification finale
-  bool verifyConfiguration(byte pcaChannel, uint16_t closedAngle, int8_t direction);
+  // Étape 3 : Trouver l'ouverture demi-trou
+  void beginHalfAngle();
+  void handleHalfAngle(const char* line);
+
+  // Étape 4 : Vérification finale
+  void beginVerify();
+  void handleVerifyAnswer(const char* line);
+  void runOpenCloseTest();
+  void handleConfirmAnswer(const char* line);
 
   // Utilitaires
-  void setServoAngle(byte pcaChannel, uint16_t angle);
-  uint16_t angleToPWM(uint16_t angle);
+  uint16_t openAngle() const;
   void adjustAngle(int delta);
-  void testCurrentPosition(byte pcaChannel);
-  void testOpenClose(byte pcaChannel, uint16_t closedAngle, int8_t direction);
-  char waitForCommand();
-  bool waitForConfirmation();
+  void testCurrentPosition();
+  void startPhase(uint8_t phase, unsigned long durationMs);
+  bool phaseElapsed() const;
 };
 
 #endif
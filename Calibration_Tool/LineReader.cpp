@@ -0,0 +1,53 @@
+/***********************************************************************************************
+ * LINE READER - IMPLEMENTATION
+ ***********************************************************************************************/
+#include "LineReader.h"
+
+LineReader::LineReader()
+  : _length(0), _lastWasCR(false), _lastCharTime(0) {
+  _buffer[0] = '\0';
+  _line[0] = '\0';
+}
+
+bool LineReader::poll(Stream& stream) {
+  while (stream.available() > 0) {
+    char c = stream.read();
+    _lastCharTime = millis();
+
+    if (c == '\n' && _lastWasCR) {
+      _lastWasCR = false;
+      continue;
+    }
+    _lastWasCR = (c == '\r');
+
+    if (c == '\r' || c == '\n') {
+      completeLine();
+      return true;  // Caractères suivants lus au prochain appel
+    }
+
+    // Ligne trop longue : la fin est ignorée
+    if (_length < LINE_BUFFER_SIZE - 1) {
+      _buffer[_length++] = c;
+    }
+  }
+
+  // Moniteur série sans fin de ligne : ligne close après un silence
+  if (_length > 0 && millis() - _lastCharTime >= LINE_IDLE_TIMEOUT_MS) {
+    completeLine();
+    return true;
+  }
+  return false;
+}
+
+int8_t LineReader::parseYesNo(const char* line) {
+  while (*line == ' ') line++;
+  if (*line == 'o' || *line == 'O' || *line == 'y' || *line == 'Y') return 1;
+  if (*line == 'n' || *line == 'N') return 0;
+  return -1;
+}
+
+void LineReader::completeLine() {
+  memcpy(_line, _buffer, _length);
+  _line[_length] = '\0';
+  _length = 0;
+}
@@ -0,0 +1,37 @@
+/***********************************************************************************************
+ * LINE READER
+ *
+ * Lecture non bloquante des commandes série, ligne par ligne. Appelé à chaque tour de
+ * loop() : accumule les caractères reçus et signale chaque ligne complète (CR, LF ou
+ * CR+LF, ou silence de LINE_IDLE_TIMEOUT_MS sans fin de ligne).
+ ***********************************************************************************************/
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <Arduino.h>
+#include "settings_template.h"
+
+class LineReader {
+public:
+  LineReader();
+
+  // Lit les caractères disponibles ; true quand une ligne complète est prête
+  bool poll(Stream& stream);
+
+  // Dernière ligne complète (sans fin de ligne, valide jusqu'au prochain poll())
+  const char* line() const { return _line; }
+
+  // Réponse o/n en tête de ligne : 1 = oui, 0 = non, -1 = autre
+  static int8_t parseYesNo(const char* line);
+
+private:
+  char _buffer[LINE_BUFFER_SIZE];
+  char _line[LINE_BUFFER_SIZE];
+  uint8_t _length;
+  bool _lastWasCR;                  // LF juste après CR : même fin de ligne
+  unsigned long _lastCharTime;
+
+  void completeLine();
+};
+
+#endif
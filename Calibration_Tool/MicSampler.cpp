@@ -0,0 +1,48 @@
+/***********************************************************************************************
+ * MIC SAMPLER - IMPLEMENTATION
+ ***********************************************************************************************/
+#include "MicSampler.h"
+
+MicSampler::MicSampler()
+  : _channel(0) {
+}
+
+void MicSampler::begin() {
+  pinMode(MIC_PIN, INPUT);
+  _channel = analogPinToChannel(MIC_PIN);
+}
+
+float MicSampler::capture(uint8_t* buffer, uint16_t count) {
+  uint8_t savedAdcsra = ADCSRA;
+  uint8_t savedAdcsrb = ADCSRB;
+  uint8_t savedAdmux = ADMUX;
+
+  // Référence AVcc, résultat aligné à gauche (8 bits de poids fort dans ADCH)
+  ADMUX = _BV(REFS0) | _BV(ADLAR) | (_channel & 0x07);
+  if (_channel & 0x08) {
+    ADCSRB |= _BV(MUX5);
+  } else {
+    ADCSRB &= ~_BV(MUX5);
+  }
+  ADCSRB &= ~0x07;  // Déclenchement free-running
+
+  // Prescaler 32 : horloge ADC 500 kHz, 13 cycles par conversion ≈ 38.5 kHz
+  ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIF) | _BV(ADPS2) | _BV(ADPS0);
+
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < count; i++) {
+    while (!(ADCSRA & _BV(ADIF))) { }
+    ADCSRA |= _BV(ADIF);  // Effacement du drapeau (écriture de 1)
+    buffer[i] = ADCH;
+  }
+  unsigned long elapsed = micros() - start;
+
+  ADCSRA = savedAdcsra;
+  ADCSRB = savedAdcsrb;
+  ADMUX = savedAdmux;
+
+  if (elapsed == 0) {
+    return MIC_NOMINAL_SAMPLE_RATE;
+  }
+  return count * 1000000.0f / elapsed;
+}
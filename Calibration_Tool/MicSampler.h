@@ -0,0 +1,28 @@
+/***********************************************************************************************
+ * MIC SAMPLER
+ *
+ * Capture de blocs audio sur l'ADC (micro analogique à sortie amplifiée, ex. MAX9814),
+ * en mode free-running 8 bits (~38 kHz) : assez rapide pour l'octave des notes aiguës
+ * (G7 = 3136 Hz, octave 6272 Hz). L'ATmega32U4 n'a pas d'I2S.
+ ***********************************************************************************************/
+#ifndef MIC_SAMPLER_H
+#define MIC_SAMPLER_H
+
+#include <Arduino.h>
+#include "settings_template.h"
+
+class MicSampler {
+public:
+  MicSampler();
+
+  void begin();
+
+  // Remplit le tampon (bloquant, count / sampleRate secondes) puis rend l'ADC
+  // à analogRead(). Retourne la fréquence d'échantillonnage mesurée (Hz).
+  float capture(uint8_t* buffer, uint16_t count);
+
+private:
+  uint8_t _channel;   // Canal ADC du MIC_PIN
+};
+
+#endif
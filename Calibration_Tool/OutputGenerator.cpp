@@ -31,8 +31,8 @@ void OutputGenerator::generateCppCode(const FingerConfig fingers[],
 void OutputGenerator::generateFingersSection(const FingerConfig fingers[]) {
   printSectionHeader("CONFIGURATION SERVOS DOIGTS");
 
-  Serial.println(F("const FingerConfig FINGERS[NUMBER_SERVOS_FINGER] = {"));
-  Serial.println(F("  // PCA  Fermé  Sens"));
+  Serial.println(F("const FingerConfig FINGERS[NUMBER_SERVOS_FINGER] PROGMEM = {"));
+  Serial.println(F("  // PCA  Fermé  Sens  Demi  Quart"));
 
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
     Serial.print(F("  {  "));
@@ -43,7 +43,16 @@ void OutputGenerator::generateFingersSection(const FingerConfig fingers[]) {
     Serial.print(fingers[i].closedAngle);
     Serial.print(F(",   "));
 
+    if (fingers[i].direction == 1) Serial.print(F(" "));
     Serial.print(fingers[i].direction);
+    Serial.print(F(",   "));
+
+    if (fingers[i].halfAngle < 10) Serial.print(F(" "));
+    Serial.print(fingers[i].halfAngle);
+    Serial.print(F(",   "));
+
+    if (fingers[i].quarterAngle < 10) Serial.print(F(" "));
+    Serial.print(fingers[i].quarterAngle);
     Serial.print(F("  }"));
 
     if (i < NUMBER_SERVOS_FINGER - 1) {
@@ -64,8 +73,8 @@ void OutputGenerator::generateFingersSection(const FingerConfig fingers[]) {
 void OutputGenerator::generateNotesSection(const NoteDefinition notes[]) {
   printSectionHeader("CONFIGURATION DES NOTES JOUABLES");
 
-  Serial.println(F("const NoteDefinition NOTES[NUMBER_NOTES] = {"));
-  Serial.println(F("  // MIDI  Doigtés (6 trous)  Min%  Max%"));
+  Serial.println(F("const NoteDefinition NOTES[NUMBER_NOTES] PROGMEM = {"));
+  Serial.println(F("  // MIDI  Doigtés                       Min%  Max%"));
 
   for (int i = 0; i < NUMBER_NOTES; i++) {
     Serial.print(F("  {  "));
@@ -73,14 +82,14 @@ void OutputGenerator::generateNotesSection(const NoteDefinition notes[]) {
     // MIDI
     if (notes[i].midiNote < 100) Serial.print(F(" "));
     Serial.print(notes[i].midiNote);
-    Serial.print(F(",  {"));
+    Serial.print(F(",  fingering("));
 
-    // Doigtés
+    // Doigtés (0=fermé, 1=ouvert, 2=demi, 3=quart)
     for (int j = 0; j < NUMBER_SERVOS_FINGER; j++) {
-      Serial.print(notes[i].fingerPattern[j]);
+      Serial.print(getFingerPosition(notes[i].fingerPattern, j));
       if (j < NUMBER_SERVOS_FINGER - 1) Serial.print(F(","));
     }
-    Serial.print(F("},  "));
+    Serial.print(F("),  "));
 
     // Min%
     if (notes[i].airflowMinPercent < 10) Serial.print(F(" "));
@@ -97,25 +106,14 @@ void OutputGenerator::generateNotesSection(const NoteDefinition notes[]) {
       Serial.print(F(","));
     }
 
+    char name[6];
     Serial.print(F("  // "));
-    Serial.print(NOTE_NAMES[i]);
+    Serial.print(noteName(notes[i].midiNote, name));
 
     // Ajouter description
-    if (i == 0) Serial.println(F(" (La#5)"));
-    else if (i == 1) Serial.println(F(" (Si5)"));
-    else if (i == 2) Serial.println(F(" (Do6)"));
-    else if (i == 3) Serial.println(F(" (Ré6)"));
-    else if (i == 4) Serial.println(F(" (Mi6)"));
-    else if (i == 5) Serial.println(F(" (Fa6)"));
-    else if (i == 6) Serial.println(F(" (Sol6)"));
-    else if (i == 7) Serial.println(F(" (La6)"));
-    else if (i == 8) Serial.println(F(" (Si6)"));
-    else if (i == 9) Serial.println(F(" (Do7)"));
-    else if (i == 10) Serial.println(F(" (Ré7)"));
-    else if (i == 11) Serial.println(F(" (Mi7)"));
-    else if (i == 12) Serial.println(F(" (Fa7)"));
-    else if (i == 13) Serial.println(F(" (Sol7)"));
-    else Serial.println();
+    Serial.print(F(" ("));
+    Serial.print(noteName(notes[i].midiNote, name, true));
+    Serial.println(F(")"));
   }
 
   Serial.println(F("};"));
@@ -130,8 +128,8 @@ void OutputGenerator::displayCurrentConfig(const FingerConfig fingers[],
   Serial.println();
 
   Serial.println(F("SERVOS DOIGTS:"));
-  Serial.println(F("  Trou | PCA | Fermé | Sens | Ouvert"));
-  Serial.println(F("  -----|-----|-------|------|-------"));
+  Serial.println(F("  Trou | PCA | Fermé | Sens | Ouvert | Demi | Quart"));
+  Serial.println(F("  -----|-----|-------|------|--------|------|------"));
 
   for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
     Serial.print(F("    "));
@@ -151,6 +149,14 @@ void OutputGenerator::displayCurrentConfig(const FingerConfig fingers[],
     uint16_t openAngle = fingers[i].closedAngle + (ANGLE_OPEN * fingers[i].direction);
     if (openAngle < 100) Serial.print(F(" "));
     Serial.print(openAngle);
+    Serial.print(F("°   |  "));
+
+    if (fingers[i].halfAngle < 10) Serial.print(F(" "));
+    Serial.print(fingers[i].halfAngle);
+    Serial.print(F("° |  "));
+
+    if (fingers[i].quarterAngle < 10) Serial.print(F(" "));
+    Serial.print(fingers[i].quarterAngle);
     Serial.println(F("°"));
   }
 
@@ -160,10 +166,11 @@ void OutputGenerator::displayCurrentConfig(const FingerConfig fingers[],
   Serial.println(F("  -----|------|------------|------|-----"));
 
   for (int i = 0; i < NUMBER_NOTES; i++) {
+    char name[6];
     Serial.print(F("  "));
-    Serial.print(NOTE_NAMES[i]);
+    Serial.print(noteName(notes[i].midiNote, name));
 
-    if (strlen(NOTE_NAMES[i]) == 2) Serial.print(F(" "));
+    if (strlen(name) == 2) Serial.print(F(" "));
 
     Serial.print(F(" |  "));
 
@@ -172,7 +179,7 @@ void OutputGenerator::displayCurrentConfig(const FingerConfig fingers[],
     Serial.print(F("  | "));
 
     for (int j = 0; j < NUMBER_SERVOS_FINGER; j++) {
-      Serial.print(notes[i].fingerPattern[j]);
+      Serial.print(getFingerPosition(notes[i].fingerPattern, j));
     }
     Serial.print(F("     |  "));
 
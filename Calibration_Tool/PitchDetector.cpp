@@ -0,0 +1,121 @@
+/***********************************************************************************************
+ * PITCH DETECTOR - IMPLEMENTATION
+ ***********************************************************************************************/
+#include "PitchDetector.h"
+#include <math.h>
+
+PitchDetector::PitchDetector()
+  : _sampleRate(1.0f), _fundamentalHz(0.0f),
+    _minEnergy(4.0f), _toneRatio(0.3f), _octaveRatio(1.0f) {
+  reset();
+}
+
+void PitchDetector::configure(float sampleRate, float fundamentalHz) {
+  _sampleRate = sampleRate;
+  _fundamentalHz = fundamentalHz;
+}
+
+void PitchDetector::setThresholds(float minEnergy, float toneRatio, float octaveRatio) {
+  _minEnergy = minEnergy;
+  _toneRatio = toneRatio;
+  _octaveRatio = octaveRatio;
+}
+
+PitchResult PitchDetector::analyze(const uint8_t* samples, uint16_t count) {
+  PitchResult result = { 0.0f, 0.0f, 0.0f, PITCH_SILENT };
+  if (count == 0) {
+    return result;
+  }
+
+  // Composante continue (polarisation du micro) et énergie du bloc
+  float sum = 0.0f;
+  for (uint16_t i = 0; i < count; i++) {
+    sum += samples[i];
+  }
+  float mean = sum / count;
+
+  float energy = 0.0f;
+  for (uint16_t i = 0; i < count; i++) {
+    float x = samples[i] - mean;
+    energy += x * x;
+  }
+  result.energy = energy / count;
+
+  if (result.energy < _minEnergy) {
+    return result;  // Silence : inutile de calculer les bins
+  }
+
+  // Puissance Goertzel normalisée par l'énergie : 1.0 pour un son pur à la fréquence
+  float norm = energy * count / 2.0f;
+  result.fundamentalRatio = goertzelPower(samples, count, mean, _fundamentalHz) / norm;
+
+  // Octave au-delà de Nyquist : impossible à mesurer, considérée nulle
+  if (_fundamentalHz * 2.0f < _sampleRate / 2.0f) {
+    result.octaveRatio = goertzelPower(samples, count, mean, _fundamentalHz * 2.0f) / norm;
+  }
+
+  if (result.octaveRatio >= _toneRatio &&
+      result.octaveRatio >= result.fundamentalRatio * _octaveRatio) {
+    result.pitchClass = PITCH_OVERBLOWN;
+  } else if (result.fundamentalRatio >= _toneRatio) {
+    result.pitchClass = PITCH_FUNDAMENTAL;
+  } else {
+    result.pitchClass = PITCH_NOISY;
+  }
+  return result;
+}
+
+void PitchDetector::reset() {
+  _frames = 0;
+  _lastClass = PITCH_SILENT;
+  _consistent = true;
+  _minTone = 0.0f;
+  _maxTone = 0.0f;
+}
+
+void PitchDetector::addFrame(const PitchResult& result) {
+  if (_frames == 0) {
+    _lastClass = result.pitchClass;
+    _minTone = _maxTone = result.fundamentalRatio * result.energy;
+  } else {
+    if (result.pitchClass != _lastClass) {
+      _consistent = false;
+    }
+    float tone = result.fundamentalRatio * result.energy;
+    if (tone < _minTone) _minTone = tone;
+    if (tone > _maxTone) _maxTone = tone;
+  }
+  if (_frames < 255) _frames++;
+}
+
+PitchClass PitchDetector::stableClass(uint8_t minFrames, float maxSpread) const {
+  if (_frames < minFrames || !_consistent) {
+    return PITCH_NOISY;
+  }
+
+  // Fondamentale qui fluctue (note au bord de l'accroche) : instable
+  if (_lastClass == PITCH_FUNDAMENTAL && _maxTone > _minTone * maxSpread) {
+    return PITCH_NOISY;
+  }
+  return _lastClass;
+}
+
+float PitchDetector::midiToHz(uint8_t midiNote) {
+  return 440.0f * powf(2.0f, (midiNote - 69) / 12.0f);
+}
+
+float PitchDetector::goertzelPower(const uint8_t* samples, uint16_t count,
+                                   float mean, float frequency) const {
+  // Coefficient à la fréquence exacte (pas d'arrondi au bin le plus proche)
+  float coeff = 2.0f * cosf(2.0f * (float)M_PI * frequency / _sampleRate);
+  float s1 = 0.0f;
+  float s2 = 0.0f;
+
+  for (uint16_t i = 0; i < count; i++) {
+    float s0 = (samples[i] - mean) + coeff * s1 - s2;
+    s2 = s1;
+    s1 = s0;
+  }
+
+  return s1 * s1 + s2 * s2 - coeff * s1 * s2;
+}
@@ -0,0 +1,73 @@
+/***********************************************************************************************
+ * PITCH DETECTOR
+ *
+ * Détecteur de hauteur léger pour la calibration automatique : banc de Goertzel sur la
+ * fondamentale attendue et son octave, plus un suivi de stabilité sur plusieurs blocs.
+ *
+ * Indépendant du matériel (ni Arduino.h ni registres) : compilé tel quel sur PC par
+ * tools/pitch_wav_check.cpp pour vérifier les seuils sur des enregistrements WAV.
+ ***********************************************************************************************/
+#ifndef PITCH_DETECTOR_H
+#define PITCH_DETECTOR_H
+
+#include <stdint.h>
+
+// Classification d'un bloc audio
+enum PitchClass {
+  PITCH_SILENT = 0,     // Énergie sous le seuil (note ne sonne pas)
+  PITCH_NOISY,          // Souffle sans fondamentale nette
+  PITCH_FUNDAMENTAL,    // Note juste (fondamentale dominante)
+  PITCH_OVERBLOWN       // Octave supérieure dominante (sur-soufflage)
+};
+
+struct PitchResult {
+  float energy;           // Énergie moyenne du bloc (composante continue retirée)
+  float fundamentalRatio; // Part de l'énergie à la fondamentale (0..1 pour un son pur)
+  float octaveRatio;      // Part de l'énergie à l'octave
+  PitchClass pitchClass;
+};
+
+class PitchDetector {
+public:
+  PitchDetector();
+
+  // Fréquence d'échantillonnage réelle et fondamentale attendue (Hz)
+  void configure(float sampleRate, float fundamentalHz);
+
+  // Seuils : énergie minimale, part tonale minimale, rapport octave/fondamentale
+  void setThresholds(float minEnergy, float toneRatio, float octaveRatio);
+
+  // Analyse un bloc d'échantillons 8 bits non signés (ADC, centre 128)
+  PitchResult analyze(const uint8_t* samples, uint16_t count);
+
+  // Suivi de stabilité : reset() puis un addFrame() par bloc analysé
+  void reset();
+  void addFrame(const PitchResult& result);
+
+  // Classe commune aux derniers blocs si au moins minFrames concordent et que
+  // l'énergie de la fondamentale varie peu (maxSpread = rapport max/min) ;
+  // PITCH_NOISY sinon (son instable)
+  PitchClass stableClass(uint8_t minFrames, float maxSpread) const;
+
+  // Fréquence MIDI → Hz (La4 = 440 Hz)
+  static float midiToHz(uint8_t midiNote);
+
+private:
+  float _sampleRate;
+  float _fundamentalHz;
+  float _minEnergy;
+  float _toneRatio;
+  float _octaveRatio;
+
+  // Stabilité
+  uint8_t _frames;
+  PitchClass _lastClass;
+  bool _consistent;
+  float _minTone;
+  float _maxTone;
+
+  // Puissance normalisée à une fréquence (Goertzel)
+  float goertzelPower(const uint8_t* samples, uint16_t count, float mean, float frequency) const;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/***********************************************************************************************
+ * PROFILE WRITER - IMPLEMENTATION
+ ***********************************************************************************************/
+#include "ProfileWriter.h"
+#include <EEPROM.h>
+
+ProfileWriter::ProfileWriter() {
+}
+
+bool ProfileWriter::writeProfile(uint8_t profile,
+                                 const FingerConfig fingers[],
+                                 const NoteDefinition notes[]) {
+  if (profile >= CONFIG_PROFILE_COUNT) {
+    return false;
+  }
+
+  ProfileData data;
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    data.fingers[i] = fingers[i];
+  }
+  for (int i = 0; i < NUMBER_NOTES; i++) {
+    data.notes[i] = notes[i];
+  }
+  data.timing.servoToSolenoidDelayMs = SERVO_TO_SOLENOID_DELAY_MS;
+  data.timing.minNoteIntervalForValveCloseMs = MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS;
+  data.timing.solenoidPwmActivation = SOLENOID_PWM_ACTIVATION;
+  data.timing.solenoidPwmHolding = SOLENOID_PWM_HOLDING;
+
+  ProfileHeader header;
+  header.magic = PROFILE_MAGIC;
+  header.version = PROFILE_VERSION;
+  header.size = sizeof(ProfileData);
+  header.crc = 0xFFFF;
+  const uint8_t* bytes = (const uint8_t*)&data;
+  for (uint16_t i = 0; i < sizeof(ProfileData); i++) {
+    header.crc = crc16Update(header.crc, bytes[i]);
+  }
+
+  // Données d'abord, en-tête ensuite : un profil interrompu reste invalide
+  uint16_t address = profileAddress(profile);
+  EEPROM.put(address + sizeof(ProfileHeader), data);
+  EEPROM.put(address, header);
+
+  return isProfileValid(profile);
+}
+
+void ProfileWriter::printProfiles() {
+  for (uint8_t p = 0; p < CONFIG_PROFILE_COUNT; p++) {
+    Serial.print(F("  Profil "));
+    Serial.print(p);
+    Serial.println(isProfileValid(p) ? F(": valide") : F(": vide"));
+  }
+}
+
+uint16_t ProfileWriter::profileAddress(uint8_t profile) {
+  return CONFIG_EEPROM_ADDRESS + (uint16_t)profile * CONFIG_PROFILE_SIZE;
+}
+
+bool ProfileWriter::isProfileValid(uint8_t profile) {
+  uint16_t address = profileAddress(profile);
+  ProfileHeader header;
+  EEPROM.get(address, header);
+
+  if (header.magic != PROFILE_MAGIC || header.version != PROFILE_VERSION ||
+      header.size != sizeof(ProfileData)) {
+    return false;
+  }
+
+  uint16_t crc = 0xFFFF;
+  address += sizeof(ProfileHeader);
+  for (uint16_t i = 0; i < sizeof(ProfileData); i++) {
+    crc = crc16Update(crc, EEPROM.read(address + i));
+  }
+  return crc == header.crc;
+}
+
+// CRC-16 CCITT (identique à ConfigStore::crc16)
+uint16_t ProfileWriter::crc16Update(uint16_t crc, uint8_t data) {
+  crc ^= (uint16_t)data << 8;
+  for (uint8_t bit = 0; bit < 8; bit++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
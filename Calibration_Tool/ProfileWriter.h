@@ -0,0 +1,55 @@
+/***********************************************************************************************
+ * PROFILE WRITER
+ *
+ * Écrit la calibration en EEPROM sous forme de profil binaire (en-tête versionné + CRC-16),
+ * chargé directement par Servo_flute_v3 au démarrage ou par Program Change.
+ * Format identique à ConfigStore (Servo_flute_v3) : toute modification doit être faite des
+ * deux côtés.
+ ***********************************************************************************************/
+#ifndef PROFILE_WRITER_H
+#define PROFILE_WRITER_H
+
+#include <Arduino.h>
+#include "settings_template.h"
+
+class ProfileWriter {
+public:
+  ProfileWriter();
+
+  // Écrit doigts + notes (+ délais par défaut) dans un profil, puis relit pour vérification.
+  // Retourne false si le profil est hors plage ou si la relecture diffère.
+  bool writeProfile(uint8_t profile,
+                    const FingerConfig fingers[],
+                    const NoteDefinition notes[]);
+
+  // Affiche l'état des profils (vide / valide)
+  void printProfiles();
+
+private:
+  // Même disposition mémoire que ConfigStore::LiveConfig
+  struct ProfileData {
+    FingerConfig fingers[NUMBER_SERVOS_FINGER];
+    NoteDefinition notes[NUMBER_NOTES];
+    TimingConfig timing;
+  };
+
+  // Même en-tête que ConfigStore::EepromHeader
+  struct ProfileHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t size;
+    uint16_t crc;
+  };
+
+  static_assert(sizeof(ProfileHeader) + sizeof(ProfileData) <= CONFIG_PROFILE_SIZE,
+                "CONFIG_PROFILE_SIZE trop petit pour les tables");
+
+  static const uint16_t PROFILE_MAGIC = 0x5346;  // "SF"
+  static const uint8_t PROFILE_VERSION = 1;
+
+  uint16_t profileAddress(uint8_t profile);
+  bool isProfileValid(uint8_t profile);
+  uint16_t crc16Update(uint16_t crc, uint8_t data);
+};
+
+#endif
@@ -9,15 +9,21 @@
 #define SETTINGS_TEMPLATE_H
 
 #include <Arduino.h>
+#include <ServoFluteCore.h>  // Actionneurs partagés avec Servo_flute_v3 (libraries/)
 
 /*******************************************************************************
 -------------------------   CONFIGURATION INSTRUMENT  ------------------------
+Même profil que Servo_flute_v3/settings.h (ServoFluteCore/InstrumentProfiles.h) :
+IrishFluteC, SopranoRecorder, TinWhistleD ou LowWhistleD.
+Les doigtés et % de départ de NOTES_TEMPLATE viennent du profil.
 ******************************************************************************/
+typedef IrishFluteC Instrument;
+
 // Nombre de servos pour les doigts
-#define NUMBER_SERVOS_FINGER 6
+#define NUMBER_SERVOS_FINGER (Instrument::FINGERS)
 
 // Nombre de notes jouables
-#define NUMBER_NOTES 14
+#define NUMBER_NOTES (Instrument::NOTES)
 
 /*******************************************************************************
 ---------------------------   HARDWARE SETTINGS       ------------------------
@@ -35,10 +41,74 @@
 // Servos doigts
 #define ANGLE_OPEN 30             // Angle d'ouverture du trou (degrés)
 
-// Servo PWM
-#define SERVO_PULSE_MIN 550
-#define SERVO_PULSE_MAX 2450
-#define SERVO_FREQUENCY 50
+// Servo PWM : mêmes valeurs que Servo_flute_v3/settings.h, la conversion
+// angle → PWM (ServoFluteCore) donne alors exactement les mêmes impulsions
+#define SERVO_PULSE_MIN 550       // Impulsion à 0° (µs)
+#define SERVO_PULSE_MAX 2450      // Impulsion à 180° (µs)
+#define SERVO_FREQUENCY 50        // Fréquence PWM servos (Hz)
+
+// Actionneurs (valve tout-ou-rien pendant la calibration)
+typedef ActuationCore<SERVO_PULSE_MIN, SERVO_PULSE_MAX, SERVO_FREQUENCY, ANGLE_OPEN,
+                      SOLENOID_ACTIVE_HIGH, false> Actuation;
+
+/*******************************************************************************
+-----------------------   INTERFACE SÉRIE (LIGNES)   -------------------------
+Les commandes sont lues ligne par ligne sans bloquer la boucle : plusieurs
+commandes par ligne ("+++s") et scripts envoyés d'un bloc par un hôte.
+Sans fin de ligne (moniteur série en "Pas de fin de ligne"), une ligne est
+close après LINE_IDLE_TIMEOUT_MS sans nouveau caractère.
+******************************************************************************/
+#define LINE_BUFFER_SIZE 48               // Caractères max par ligne
+#define LINE_IDLE_TIMEOUT_MS 100          // Ligne sans fin de ligne : validée après ce délai
+
+/*******************************************************************************
+-----------------   CALIBRATION AUTOMATIQUE (MICRO)   ------------------------
+Balayage du débit d'air avec détection de hauteur (Goertzel sur fondamentale
+et octave). Micro analogique amplifié (MAX9814, MAX4466...) sur MIC_PIN,
+polarisé à VCC/2 : l'ATmega32U4 n'a pas d'entrée I2S.
+Seuils vérifiables sur PC avec tools/pitch_wav_check.cpp.
+******************************************************************************/
+#define AUTO_CALIBRATION_ENABLED true
+#define MIC_PIN A0
+#define MIC_NOMINAL_SAMPLE_RATE 38461.0f  // ADC free-running, prescaler 32
+#define MIC_BLOCK_SIZE 256                // Échantillons par bloc (~6.7ms)
+
+#define AUTO_SWEEP_STEP_PERCENT 4         // Pas du balayage grossier (affiné à 1%)
+#define AUTO_SETTLE_MS 80                 // Servo + accroche de la note avant mesure
+#define AUTO_GAP_MS 30                    // Valve fermée entre deux mesures
+#define AUTO_FRAMES 3                     // Blocs concordants pour valider une mesure
+#define AUTO_NOISE_FACTOR 4.0f            // Seuil d'énergie = bruit de fond x facteur
+#define AUTO_MIN_ENERGY 4.0f              // Seuil d'énergie minimal (ADC 8 bits)
+#define AUTO_TONE_RATIO 0.30f             // Part tonale minimale (0..1)
+#define AUTO_OCTAVE_RATIO 1.0f            // Octave / fondamentale => sur-soufflage
+#define AUTO_STABILITY_SPREAD 2.0f        // Variation max de la fondamentale (x2 = 3dB)
+#define AUTO_MARGIN_PERCENT 2             // Marge de sécurité sur min% et max%
+
+/*******************************************************************************
+-------------------   BALAYAGE ENREGISTRÉ (SANS MICRO)   ---------------------
+Balayage scripté joué pendant un enregistrement externe (téléphone). Le journal
+horodaté (lignes SYNC / STEP) et le WAV sont analysés par
+tools/sweep_analyzer.py, qui produit NOTES[].
+******************************************************************************/
+#define SWEEP_LOG_STEP_PERCENT 5          // Pas du balayage (%)
+#define SWEEP_LOG_HOLD_MS 400             // Valve ouverte par pas
+#define SWEEP_LOG_GAP_MS 200              // Valve fermée entre deux pas
+#define SWEEP_SYNC_MS 300                 // Salve de synchronisation (début et fin)
+
+/*******************************************************************************
+----------------   PROFILS EEPROM (lus par Servo_flute_v3)   ----------------
+Doit rester identique à la section CONFIGURATION EN DIRECT de
+Servo_flute_v3/settings.h : même adresse, même taille de profil.
+Les délais de la valve ne sont pas calibrés ici : valeurs par défaut du sketch.
+******************************************************************************/
+#define CONFIG_EEPROM_ADDRESS 0           // Début des profils EEPROM
+#define CONFIG_PROFILE_COUNT 4            // Profils disponibles (Program Change 0-3)
+#define CONFIG_PROFILE_SIZE 160           // Octets par profil
+
+#define SERVO_TO_SOLENOID_DELAY_MS  105
+#define MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS  50
+#define SOLENOID_PWM_ACTIVATION 255
+#define SOLENOID_PWM_HOLDING    128
 
 /*******************************************************************************
 ------------------   TEMPLATE SERVOS DOIGTS (À CALIBRER)  --------------------
@@ -47,53 +117,54 @@ struct FingerConfig {
   byte pcaChannel;      // Canal PCA9685
   uint16_t closedAngle; // Angle position fermée (À CALIBRER)
   int8_t direction;     // 1=horaire, -1=anti-horaire (À CALIBRER)
+  uint8_t halfAngle;    // Ouverture demi-trou en degrés (À CALIBRER)
+  uint8_t quarterAngle; // Ouverture quart de trou en degrés (= demi / 2)
 };
 
 // TEMPLATE - Uniquement les canaux PCA sont fixes
-// closedAngle et direction seront calibrés
+// closedAngle, direction et halfAngle seront calibrés
 const FingerConfig FINGERS_TEMPLATE[NUMBER_SERVOS_FINGER] = {
-  // PCA  Fermé  Sens
-  {  0,   90,    1  },  // Trou 1 (haut, main gauche - index)
-  {  1,   90,    1  },  // Trou 2 (main gauche - majeur)
-  {  2,   90,    1  },  // Trou 3 (main gauche - annulaire)
-  {  3,   90,    1  },  // Trou 4 (main droite - index)
-  {  4,   90,    1  },  // Trou 5 (main droite - majeur)
-  {  5,   90,    1  }   // Trou 6 (bas, main droite - annulaire)
+  // PCA  Fermé  Sens  Demi  Quart
+  {  0,   90,    1,   15,    8  },  // Trou 1 (haut, main gauche - index)
+  {  1,   90,    1,   15,    8  },  // Trou 2 (main gauche - majeur)
+  {  2,   90,    1,   15,    8  },  // Trou 3 (main gauche - annulaire)
+  {  3,   90,    1,   15,    8  },  // Trou 4 (main droite - index)
+  {  4,   90,    1,   15,    8  },  // Trou 5 (main droite - majeur)
+  {  5,   90,    1,   15,    8  }   // Trou 6 (bas, main droite - annulaire)
 };
 
 /*******************************************************************************
 -------------   TEMPLATE NOTES JOUABLES (DOIGTÉS FIXES)  --------------------
+Table du profil : doigtés théoriques (0=fermé, 1=ouvert, 2=demi, 3=quart,
+voir ServoFluteCore/InstrumentProfile.h), airflowMinPercent et
+airflowMaxPercent seront calibrés.
 ******************************************************************************/
-struct NoteDefinition {
-  byte midiNote;                            // Numéro MIDI
-  bool fingerPattern[NUMBER_SERVOS_FINGER]; // Doigtés (0=fermé, 1=ouvert)
-  byte airflowMinPercent;                   // % min servo flow (À CALIBRER)
-  byte airflowMaxPercent;                   // % max servo flow (À CALIBRER)
-};
+const NoteDefinition* const NOTES_TEMPLATE = Instrument::notes();
 
-// TEMPLATE - Les doigtés sont théoriques (Irish Flute standard)
-// airflowMinPercent et airflowMaxPercent seront calibrés
-const NoteDefinition NOTES_TEMPLATE[NUMBER_NOTES] = {
-  // MIDI  Doigtés (6 trous)  Min%  Max%
-  {  82,  {0,1,1,1,1,1},  10,  60  },  // A#5 (La#5) - 1 fermé
-  {  83,  {1,1,1,1,1,1},  0,   50  },  // B5  (Si5) - Tous ouverts
-  {  84,  {0,0,0,0,0,0},  20,  75  },  // C6  (Do6) - Tous fermés
-  {  86,  {0,0,0,0,0,1},  15,  70  },  // D6  (Ré6) - 5 fermés
-  {  88,  {0,0,0,0,1,1},  10,  65  },  // E6  (Mi6) - 4 fermés
-  {  89,  {0,0,0,1,1,1},  10,  60  },  // F6  (Fa6) - 3 fermés
-  {  91,  {0,0,1,1,1,1},  5,   55  },  // G6  (Sol6) - 2 fermés
-  {  93,  {0,1,1,1,1,1},  5,   50  },  // A6  (La6) - 1 fermé
-  {  95,  {1,1,1,1,1,1},  0,   45  },  // B6  (Si6) - Tous ouverts
-  {  96,  {0,0,0,0,0,0},  50,  100 },  // C7  (Do7) - Tous fermés, octave haute
-  {  98,  {0,0,0,0,0,1},  45,  95  },  // D7  (Ré7)
-  {  100, {0,0,0,0,1,1},  40,  90  },  // E7  (Mi7)
-  {  101, {0,0,0,1,1,1},  35,  85  },  // F7  (Fa7)
-  {  103, {0,0,1,1,1,1},  30,  80  }   // G7  (Sol7)
+/*******************************************************************************
+-------------   DÉLAIS VALVE (copie de TimingConfig du sketch)   -------------
+******************************************************************************/
+struct TimingConfig {
+  uint16_t servoToSolenoidDelayMs;
+  uint16_t minNoteIntervalForValveCloseMs;
+  uint8_t solenoidPwmActivation;
+  uint8_t solenoidPwmHolding;
 };
 
-// Noms des notes (pour affichage)
-const char* NOTE_NAMES[NUMBER_NOTES] = {
-  "A#5", "B5", "C6", "D6", "E6", "F6", "G6", "A6", "B6", "C7", "D7", "E7", "F7", "G7"
-};
+// Nom d'une note MIDI pour l'affichage ("C#6", ou "Do#6" en français)
+// buf : 6 caractères minimum
+inline const char* noteName(byte midiNote, char* buf, bool french = false) {
+  static const char* const NAMES[12] = {
+    "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
+  };
+  static const char* const NAMES_FR[12] = {
+    "Do", "Do#", "Ré", "Ré#", "Mi", "Fa", "Fa#", "Sol", "Sol#", "La", "La#", "Si"
+  };
+  strcpy(buf, (french ? NAMES_FR : NAMES)[midiNote % 12]);
+  uint8_t len = strlen(buf);
+  buf[len] = '0' + (midiNote / 12 - 1) % 10;   // Octave (MIDI 60 = C4)
+  buf[len + 1] = '\0';
+  return buf;
+}
 
 #endif
@@ -1,5 +1,9 @@
 #include "AirflowController.h"
 
+#if SOLENOID_HOLD_TIMER_ENABLED
+#include <util/atomic.h>
+#endif
+
 // Lookup table pour sin() - 256 entrées pour une période complète [0, 2π]
 // Valeurs: -127 à +127 (représente -1.0 à +1.0)
 const int8_t SIN_LUT[256] PROGMEM = {
@@ -32,24 +36,40 @@ inline float fastSin(unsigned long timeMs, float frequency) {
   return pgm_read_byte(&SIN_LUT[index]) / 127.0;  // Retour -1.0 à +1.0
 }
 
-AirflowController::AirflowController(Adafruit_PWMServoDriver& pwm)
-  : _pwm(pwm), _solenoidOpen(false), _solenoidOpenTime(0),
+// PWM qui donne le courant nominal de pwm quand le courant obtenu vaut ratio
+inline uint8_t compensatePwm(uint8_t pwm, float ratio) {
+  if (pwm == 0) {
+    return 0;
+  }
+  float compensated = pwm / ratio + 0.5;
+  return compensated >= 255.0 ? 255 : (compensated < 1.0 ? 1 : (uint8_t)compensated);
+}
+
+AirflowController::AirflowController(Actuation::Frame& servos, byte solenoidPin, PowerBudget& power)
+  : _servos(servos), _solenoidPin(solenoidPin), _power(power), _airflowAngle(SERVO_AIRFLOW_OFF),
+    _airflowSettleTime(0), _awaitingOnset(false),
+    _solenoidOpen(false), _solenoidOpenTime(0), _solenoidPwm(0),
+    _activationMs(SOLENOID_ACTIVATION_TIME_MS), _plannedHoldingPwm(0), _holdLoadMa(0),
+#if SOLENOID_HOLD_TIMER_ENABLED
+    _holdSlot(0),
+#endif
+#if SOLENOID_THERMAL_ENABLED
+    _thermalLevel(THERMAL_NORMAL),
+#endif
+    _activeNote(0),
     _ccVolume(CC_VOLUME_DEFAULT), _ccExpression(CC_EXPRESSION_DEFAULT), _ccModulation(CC_MODULATION_DEFAULT),
-    _ccBreath(CC_BREATH_DEFAULT),
-    _cc2BufferIndex(0), _cc2BufferCount(0), _lastCC2Time(0), _lastVelocity(64),
+    _ccBreath(CC_BREATH_DEFAULT), _pitchBend(0),
+    _cc2Smoother(CC2_SMOOTHING_BUFFER_SIZE), _lastCC2Time(0), _lastVelocity(64),
     _baseAngleWithoutVibrato(SERVO_AIRFLOW_OFF), _vibratoActive(false),
     _currentMinAngle(SERVO_AIRFLOW_MIN), _currentMaxAngle(SERVO_AIRFLOW_MAX) {
-  // Initialiser buffer CC2 avec valeur par défaut
-  for (uint8_t i = 0; i < CC2_SMOOTHING_BUFFER_SIZE; i++) {
-    _cc2SmoothingBuffer[i] = CC_BREATH_DEFAULT;
-  }
 }
 
 void AirflowController::begin() {
-  // Configurer le pin du solénoïde en sortie
-  pinMode(SOLENOID_PIN, OUTPUT);
-
-  // Fermer le solénoïde au démarrage
+  // Pin du solénoïde en sortie, valve fermée
+  Actuation::Solenoid::begin(_solenoidPin);
+  #if SOLENOID_HOLD_TIMER_ENABLED && SOLENOID_USE_PWM
+  _holdSlot = SolenoidHoldTimer::attach(_solenoidPin);
+  #endif
   closeSolenoid();
 
   // Positionner le servo de débit en position repos
@@ -60,9 +80,9 @@ void AirflowController::begin() {
     #if SOLENOID_USE_PWM
     Serial.println("DEBUG: AirflowController - Mode PWM activé");
     Serial.print("DEBUG:   - PWM activation: ");
-    Serial.println(SOLENOID_PWM_ACTIVATION);
+    Serial.println(solenoidPwmActivation());
     Serial.print("DEBUG:   - PWM maintien: ");
-    Serial.println(SOLENOID_PWM_HOLDING);
+    Serial.println(solenoidPwmHolding());
     #else
     Serial.println("DEBUG: AirflowController - Mode GPIO simple");
     #endif
@@ -70,6 +90,9 @@ void AirflowController::begin() {
 }
 
 void AirflowController::setAirflowVelocity(byte velocity) {
+  // Débit fixe (legato entre deux notes) : plus de note à recalculer
+  _activeNote = 0;
+
   // Mapper la vélocité MIDI (1-127) vers l'angle du servo
   uint16_t angle;
 
@@ -90,27 +113,70 @@ void AirflowController::setAirflowVelocity(byte velocity) {
   }
 }
 
-void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
+void AirflowController::noteAirflowRange(byte midiNote, uint16_t& minAngle, uint16_t& maxAngle) const {
   // Rechercher la note pour obtenir ses pourcentages airflow
-  const NoteDefinition* note = getNoteByMidi(midiNote);
+  int noteIndex = getNoteIndex(midiNote);
+
+  if (noteIndex >= 0) {
+    minAngle = SERVO_AIRFLOW_MIN + ((SERVO_AIRFLOW_MAX - SERVO_AIRFLOW_MIN) * noteAirflowMin(noteIndex) / 100);
+    maxAngle = SERVO_AIRFLOW_MIN + ((SERVO_AIRFLOW_MAX - SERVO_AIRFLOW_MIN) * noteAirflowMax(noteIndex) / 100);
+  } else {
+    // Note non trouvée, utiliser plage par défaut
+    minAngle = SERVO_AIRFLOW_MIN;
+    maxAngle = SERVO_AIRFLOW_MAX;
+  }
+}
+
+uint16_t AirflowController::airflowAngle(byte airflowSource, uint16_t minAngle, uint16_t maxAngle,
+                                         uint16_t& effectiveMaxAngle, uint16_t& baseAngle) const {
+  // 1. CC7 (Volume) RÉDUIT la limite haute de la note
+  //    CC7 = 127 → maxAngle (volume max, plage complète)
+  //    CC7 = 0   → minAngle (volume minimum, pas d'air)
+  //    Le volume définit le maxAngle effectif disponible
+  float volumeFactor = _ccVolume / 127.0;
+  effectiveMaxAngle = minAngle + (maxAngle - minAngle) * volumeFactor;
+
+  // 3. AIRFLOW SOURCE (CC2 ou velocity) définit l'angle de base dans [minAngle, effectiveMaxAngle]
+  //    La source airflow utilise la plage réduite par le volume
+  baseAngle = map(airflowSource, 1, 127, minAngle, effectiveMaxAngle);
 
+  // 4. CC11 (Expression) module DANS la plage [minAngle, baseAngle]
+  //    CC11 = 127 → baseAngle (pleine expression selon airflowSource)
+  //    CC11 = 0   → minAngle (expression minimum de la note)
+  float expressionFactor = _ccExpression / 127.0;
+  float finalAngleWithoutVibrato = minAngle + (baseAngle - minAngle) * expressionFactor;
+
+  #if PITCH_BEND_ENABLED
+  // 5. Pitch bend : souffle plus fort = son plus aigu
+  //    Décalage proportionnel à la plage de la note, sans jamais en sortir
+  float bendOffset = (_pitchBend / 8192.0) * (maxAngle - minAngle) * (PITCH_BEND_AIRFLOW_PERCENT / 100.0);
+  finalAngleWithoutVibrato += bendOffset;
+  if (finalAngleWithoutVibrato < minAngle) finalAngleWithoutVibrato = minAngle;
+  if (finalAngleWithoutVibrato > maxAngle) finalAngleWithoutVibrato = maxAngle;
+  #endif
+
+  // 6. Limiter dans les bornes valides
+  if (finalAngleWithoutVibrato < SERVO_AIRFLOW_MIN) finalAngleWithoutVibrato = SERVO_AIRFLOW_MIN;
+  if (finalAngleWithoutVibrato > SERVO_AIRFLOW_MAX) finalAngleWithoutVibrato = SERVO_AIRFLOW_MAX;
+
+  return (uint16_t)(finalAngleWithoutVibrato + 0.5);  // Arrondi
+}
+
+bool AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
   uint16_t minAngle, maxAngle;
-  uint16_t baseAngle;
+  uint16_t effectiveMaxAngle, baseAngle;
 
   if (velocity == 0) {
+    _activeNote = 0;
     setAirflowServoAngle(SERVO_AIRFLOW_OFF);
-    return;
+    return false;
   }
 
+  // Note en cours : les CC reçus pendant la note recalculent son débit
+  _activeNote = midiNote;
+
   // Calculer les angles min/max de la note
-  if (note != nullptr) {
-    minAngle = SERVO_AIRFLOW_MIN + ((SERVO_AIRFLOW_MAX - SERVO_AIRFLOW_MIN) * note->airflowMinPercent / 100);
-    maxAngle = SERVO_AIRFLOW_MIN + ((SERVO_AIRFLOW_MAX - SERVO_AIRFLOW_MIN) * note->airflowMaxPercent / 100);
-  } else {
-    // Note non trouvée, utiliser plage par défaut
-    minAngle = SERVO_AIRFLOW_MIN;
-    maxAngle = SERVO_AIRFLOW_MAX;
-  }
+  noteAirflowRange(midiNote, minAngle, maxAngle);
 
   // Stocker les bornes originales pour limiter le vibrato ultérieurement
   _currentMinAngle = minAngle;
@@ -121,19 +187,14 @@ void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
   // Stocker velocity pour fallback si CC2 timeout
   _lastVelocity = velocity;
 
-  // 1. CC7 (Volume) RÉDUIT la limite haute de la note
-  //    CC7 = 127 → maxAngle (volume max, plage complète)
-  //    CC7 = 0   → minAngle (volume minimum, pas d'air)
-  //    Le volume définit le maxAngle effectif disponible
-  float volumeFactor = _ccVolume / 127.0;
-  uint16_t effectiveMaxAngle = minAngle + (maxAngle - minAngle) * volumeFactor;
+  // 1. CC7 (Volume) : voir airflowAngle()
 
   // 2. DÉTERMINER SOURCE AIRFLOW : CC2 (Breath Controller) ou VELOCITY
   //    CC2 remplace velocity pour contrôle dynamique du souffle
   byte airflowSource;
 
   #if CC2_ENABLED
-  if (_cc2BufferCount > 0) {
+  if (!_cc2Smoother.isEmpty()) {
     // Vérifier timeout : si CC2 absent > CC2_TIMEOUT_MS, fallback sur velocity
     unsigned long timeSinceCC2 = millis() - _lastCC2Time;
     if (CC2_TIMEOUT_MS > 0 && timeSinceCC2 > CC2_TIMEOUT_MS) {
@@ -146,12 +207,8 @@ void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
         Serial.println(velocity);
       }
     } else {
-      // Calculer moyenne lissée du buffer CC2
-      uint16_t sum = 0;
-      for (uint8_t i = 0; i < _cc2BufferCount; i++) {
-        sum += _cc2SmoothingBuffer[i];
-      }
-      byte smoothedCC2 = sum / _cc2BufferCount;
+      // Moyenne lissée du buffer CC2
+      byte smoothedCC2 = _cc2Smoother.average();
 
       // Seuil silence : CC2 < CC2_SILENCE_THRESHOLD → considérer comme silence (0)
       if (smoothedCC2 < CC2_SILENCE_THRESHOLD) {
@@ -189,25 +246,12 @@ void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
   if (airflowSource == 0) {
     setAirflowServoAngle(SERVO_AIRFLOW_OFF);
     closeSolenoid();
-    return;
+    return false;
   }
 
-  // 3. AIRFLOW SOURCE (CC2 ou velocity) définit l'angle de base dans [minAngle, effectiveMaxAngle]
-  //    La source airflow utilise la plage réduite par le volume
-  baseAngle = map(airflowSource, 1, 127, minAngle, effectiveMaxAngle);
-
-  // 4. CC11 (Expression) module DANS la plage [minAngle, baseAngle]
-  //    CC11 = 127 → baseAngle (pleine expression selon airflowSource)
-  //    CC11 = 0   → minAngle (expression minimum de la note)
-  float expressionFactor = _ccExpression / 127.0;
-  float finalAngleWithoutVibrato = minAngle + (baseAngle - minAngle) * expressionFactor;
-
-  // 5. Limiter dans les bornes valides
-  if (finalAngleWithoutVibrato < SERVO_AIRFLOW_MIN) finalAngleWithoutVibrato = SERVO_AIRFLOW_MIN;
-  if (finalAngleWithoutVibrato > SERVO_AIRFLOW_MAX) finalAngleWithoutVibrato = SERVO_AIRFLOW_MAX;
-
+  // 3-6. Angle dans la plage de la note (volume, source, expression, pitch bend)
   // Stocker l'angle de base (sans vibrato) pour update continu
-  _baseAngleWithoutVibrato = (uint16_t)(finalAngleWithoutVibrato + 0.5);  // Arrondi
+  _baseAngleWithoutVibrato = airflowAngle(airflowSource, minAngle, maxAngle, effectiveMaxAngle, baseAngle);
 
   // Activer vibrato si CC1 > 0
   _vibratoActive = (_ccModulation > 0);
@@ -220,7 +264,7 @@ void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
 
     // Afficher source airflow (CC2 ou velocity)
     #if CC2_ENABLED
-    if (_cc2BufferCount > 0 && (CC2_TIMEOUT_MS == 0 || (millis() - _lastCC2Time <= CC2_TIMEOUT_MS))) {
+    if (!_cc2Smoother.isEmpty() && (CC2_TIMEOUT_MS == 0 || (millis() - _lastCC2Time <= CC2_TIMEOUT_MS))) {
       Serial.print(" | CC2: ");
       Serial.print(_ccBreath);
       Serial.print(" → AirflowSrc: ");
@@ -248,6 +292,10 @@ void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
     Serial.print(baseAngle);
     Serial.print("° | CC11: ");
     Serial.print(_ccExpression);
+    #if PITCH_BEND_ENABLED
+    Serial.print(" | PB: ");
+    Serial.print(_pitchBend);
+    #endif
     Serial.print(" → Final(no vib): ");
     Serial.print(_baseAngleWithoutVibrato);
     Serial.print("° | CC1: ");
@@ -259,26 +307,63 @@ void AirflowController::setAirflowForNote(byte midiNote, byte velocity) {
   }
 
   // Appliquer immédiatement (update() ajoutera vibrato si nécessaire)
-  if (_vibratoActive) {
+  if (_vibratoActive && _solenoidOpen) {
     // update() gérera le vibrato en continu
     update();  // Premier calcul immédiat
   } else {
+    // Vibrato seulement une fois la valve ouverte (débit préparé : angle de base)
     setAirflowServoAngle(_baseAngleWithoutVibrato);
   }
+
+  return true;
 }
 
-void AirflowController::openSolenoid() {
+void AirflowController::openSolenoid(uint16_t sustainMs) {
+  _awaitingOnset = false;
+
+  #if SOLENOID_USE_PWM
+  // Attaque de cette note : courant nominal malgré alim et température,
+  // activation écourtée si la note est courte
+  float ratio = currentRatio();
+  uint8_t activationPwm = compensatePwm(solenoidPwmActivation(), ratio);
+  _activationMs = activationTimeMs(activationPwm, ratio, sustainMs);
+  _plannedHoldingPwm = holdingPwm();
+  #else
+  _activationMs = SOLENOID_ACTIVATION_TIME_MS;
+  #endif
+
+  #if POWER_BUDGET_ENABLED
+  // Appel de courant à l'ouverture puis courant de maintien permanent, au
+  // PWM de maintien réellement prévu (retiré tel quel à la fermeture)
+  if (!_solenoidOpen) {
+    unsigned long now = millis();
+    _holdLoadMa = POWER_SOLENOID_HOLD_MA(_plannedHoldingPwm);
+    _power.addLoad(nullptr, POWER_SOLENOID_ACTIVATION_MA - _holdLoadMa,
+                   now, now + _activationMs);
+    _power.addContinuousLoad(_holdLoadMa);
+  }
+  #endif
+
+  #if TELEMETRY_ENABLED
+  if (!_solenoidOpen) {
+    telemetry.solenoidChanged(true);
+  }
+  #endif
+
   #if SOLENOID_USE_PWM
     // Mode PWM : démarrer à pleine puissance pour ouverture rapide
-    setSolenoidPWM(SOLENOID_PWM_ACTIVATION);
+    writeSolenoidPwm(activationPwm);
     _solenoidOpenTime = millis();  // Sauvegarder timestamp pour réduction ultérieure
+    #if SOLENOID_HOLD_TIMER_ENABLED
+    // Maintien écrit par l'interruption à l'échéance exacte
+    SolenoidHoldTimer::arm(_holdSlot, _plannedHoldingPwm, _activationMs);
+    #endif
   #else
-    // Mode GPIO simple
-    if (SOLENOID_ACTIVE_HIGH) {
-      digitalWrite(SOLENOID_PIN, HIGH);
-    } else {
-      digitalWrite(SOLENOID_PIN, LOW);
-    }
+    Actuation::Solenoid::open(_solenoidPin);
+    _solenoidPwm = 255;
+    #if SOLENOID_THERMAL_ENABLED
+    _thermal.setPwm(255, millis());
+    #endif
   #endif
 
   _solenoidOpen = true;
@@ -286,7 +371,13 @@ void AirflowController::openSolenoid() {
   if (DEBUG) {
     #if SOLENOID_USE_PWM
     Serial.print("DEBUG: AirflowController - Solénoïde OUVERT (PWM=");
-    Serial.print(SOLENOID_PWM_ACTIVATION);
+    Serial.print(activationPwm);
+    Serial.print(" pendant ");
+    Serial.print(_activationMs);
+    Serial.print("ms puis ");
+    Serial.print(_plannedHoldingPwm);
+    Serial.print(", courant x");
+    Serial.print(ratio);
     Serial.println(")");
     #else
     Serial.println("DEBUG: AirflowController - Solénoïde OUVERT");
@@ -295,16 +386,27 @@ void AirflowController::openSolenoid() {
 }
 
 void AirflowController::closeSolenoid() {
-  #if SOLENOID_USE_PWM
-    // Mode PWM : mettre à 0
-    setSolenoidPWM(0);
-  #else
-    // Mode GPIO simple
-    if (SOLENOID_ACTIVE_HIGH) {
-      digitalWrite(SOLENOID_PIN, LOW);
-    } else {
-      digitalWrite(SOLENOID_PIN, HIGH);
-    }
+  #if POWER_BUDGET_ENABLED
+  if (_solenoidOpen) {
+    _power.addContinuousLoad(-(int16_t)_holdLoadMa);
+    _holdLoadMa = 0;
+  }
+  #endif
+
+  #if TELEMETRY_ENABLED
+  if (_solenoidOpen) {
+    telemetry.solenoidChanged(false);
+  }
+  #endif
+
+  #if SOLENOID_HOLD_TIMER_ENABLED && SOLENOID_USE_PWM
+  SolenoidHoldTimer::cancel(_holdSlot);  // Note plus courte que l'activation
+  #endif
+
+  Actuation::Solenoid::close(_solenoidPin);
+  _solenoidPwm = 0;
+  #if SOLENOID_THERMAL_ENABLED
+  _thermal.setPwm(0, millis());
   #endif
 
   _solenoidOpen = false;
@@ -319,7 +421,180 @@ bool AirflowController::isSolenoidOpen() const {
   return _solenoidOpen;
 }
 
+bool AirflowController::prepareAirflowForNote(byte midiNote, byte velocity, unsigned long wakeDelay) {
+  _awaitingOnset = true;
+
+  uint16_t previousAngle = _airflowAngle;
+  bool flowing = setAirflowForNote(midiNote, velocity);
+
+  // Servos encore hors tension (réveil) : la course commence au réveil
+  if (_airflowAngle != previousAngle) {
+    _airflowSettleTime += wakeDelay;
+  }
+
+  if (DEBUG) {
+    Serial.print("DEBUG: AirflowController - Débit préparé pendant le positionnement (en place dans ");
+    long remaining = (long)(_airflowSettleTime - millis());
+    Serial.print(remaining > 0 ? remaining : 0);
+    Serial.println("ms)");
+  }
+
+  return flowing;
+}
+
+bool AirflowController::isAirflowSettled() const {
+  return (long)(millis() - _airflowSettleTime) >= 0;
+}
+
+unsigned long AirflowController::predictSettleTimeForNote(byte midiNote, byte velocity) const {
+  uint16_t target = SERVO_AIRFLOW_OFF;
+
+  if (velocity > 0) {
+    // Débit de la vélocité avec les CC actuels (le souffle CC2, lissé et
+    // variable, n'est pas anticipé)
+    uint16_t minAngle, maxAngle, effectiveMaxAngle, baseAngle;
+    noteAirflowRange(midiNote, minAngle, maxAngle);
+    target = airflowAngle(velocity, minAngle, maxAngle, effectiveMaxAngle, baseAngle);
+  }
+
+  uint16_t distance = (target > _airflowAngle) ? target - _airflowAngle : _airflowAngle - target;
+  return ServoMotionPlanner::predictDuration(distance * 10);
+}
+
+uint16_t AirflowController::valveCloseIntervalMs() const {
+  uint16_t interval = minNoteIntervalForValveCloseMs();
+
+  #if SOLENOID_THERMAL_ENABLED && SOLENOID_USE_PWM
+  // Bobine chaude : garder la valve ouverte tant que le maintien pendant le
+  // silence chauffe moins que l'impulsion d'activation qu'il évite
+  // (silence x maintien² < durée d'activation x (activation² - maintien²))
+  if (_thermal.getLevel() != THERMAL_NORMAL) {
+    uint32_t hold2 = (uint32_t)holdingPwm() * holdingPwm();
+    uint32_t activation2 = (uint32_t)solenoidPwmActivation() * solenoidPwmActivation();
+    if (hold2 > 0 && activation2 > hold2) {
+      uint32_t breakEven = SOLENOID_ACTIVATION_TIME_MS * (activation2 - hold2) / hold2;
+      if (breakEven > SOLENOID_THERMAL_KEEP_OPEN_MS) {
+        breakEven = SOLENOID_THERMAL_KEEP_OPEN_MS;
+      }
+      if (breakEven > interval) {
+        interval = breakEven;
+      }
+    }
+  }
+  #endif
+
+  return interval;
+}
+
+void AirflowController::writeSolenoidPwm(uint8_t pwm) {
+  #if SOLENOID_HOLD_TIMER_ENABLED
+  // Registres des timers PWM partagés avec l'interruption de maintien
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    Actuation::Solenoid::write(_solenoidPin, pwm);
+  }
+  #else
+  Actuation::Solenoid::write(_solenoidPin, pwm);
+  #endif
+  _solenoidPwm = pwm;
+  #if SOLENOID_THERMAL_ENABLED
+  _thermal.setPwm(pwm, millis());
+  #endif
+}
+
+uint8_t AirflowController::holdingPwm() const {
+  #if SOLENOID_THERMAL_ENABLED
+  uint8_t holding = _thermal.holdingPwm(solenoidPwmHolding());
+  #else
+  uint8_t holding = solenoidPwmHolding();
+  #endif
+  return compensatePwm(holding, currentRatio());
+}
+
+float AirflowController::currentRatio() const {
+  float ratio = 1.0;
+
+  #if POWER_SUPPLY_SENSE_ENABLED
+  ratio = (float)_power.getSupplyMillivolts() / POWER_SUPPLY_NOMINAL_MV;
+  #endif
+
+  #if SOLENOID_THERMAL_ENABLED
+  // Résistance du cuivre : +0.39 % par °C au-dessus de l'ambiante de réglage
+  ratio /= 1.0 + 0.0039 * (_thermal.getTemperature() - SOLENOID_THERMAL_AMBIENT_C);
+  #endif
+
+  // Mesure aberrante (ADC, alim coupée) : correction bornée
+  return constrain(ratio, 0.5f, 1.5f);
+}
+
+uint16_t AirflowController::activationTimeMs(uint8_t activationPwm, float ratio, uint16_t sustainMs) const {
+  float ms = SOLENOID_ACTIVATION_TIME_MS;
+
+  // PWM plafonné à 255 : courant d'appel sous le nominal, attraction plus
+  // lente (durée ~ inverse du courant)
+  if (solenoidPwmActivation() > 0) {
+    float reached = ratio * activationPwm / solenoidPwmActivation();
+    if (reached < 1.0) {
+      ms /= reached;
+    }
+  }
+
+  // Note courte connue : passer au maintien avant sa fin (relâchement plus
+  // rapide depuis le courant de maintien)
+  if (sustainMs > 0 && ms > (long)sustainMs - SOLENOID_RELEASE_HOLD_MS) {
+    ms = (long)sustainMs - SOLENOID_RELEASE_HOLD_MS;
+  }
+
+  return (uint16_t)constrain(ms, (float)SOLENOID_ACTIVATION_MIN_MS, (float)SOLENOID_ACTIVATION_MAX_MS);
+}
+
+void AirflowController::holdingStarted(unsigned long when) {
+  _solenoidPwm = _plannedHoldingPwm;
+  #if SOLENOID_THERMAL_ENABLED
+  _thermal.setPwm(_plannedHoldingPwm, when);
+  #endif
+
+  if (DEBUG) {
+    Serial.print("DEBUG: AirflowController - PWM réduit à ");
+    Serial.print(_solenoidPwm);
+    Serial.print(" (maintien, après ");
+    Serial.print(when - _solenoidOpenTime);
+    Serial.println("ms)");
+  }
+
+  _solenoidOpenTime = 0;  // Reset pour ne faire qu'une fois
+}
+
+void AirflowController::updateThermal() {
+  #if SOLENOID_THERMAL_ENABLED
+  #if SOLENOID_USE_PWM
+  // Maintien en cours : suivre la réduction (activation jamais réduite)
+  if (_solenoidOpen && _solenoidOpenTime == 0 && _solenoidPwm != holdingPwm()) {
+    writeSolenoidPwm(holdingPwm());
+  }
+  #endif
+
+  ThermalLevel level = _thermal.getLevel();
+  if (level != _thermalLevel) {
+    _thermalLevel = level;
+    if (DEBUG) {
+      Serial.print("ALERTE: AirflowController - Bobine ~");
+      Serial.print((int)_thermal.getTemperature());
+      Serial.print("°C, niveau thermique ");
+      Serial.print((int)level);
+      Serial.print(", PWM maintien ");
+      Serial.println(holdingPwm());
+    }
+  }
+
+  #if TELEMETRY_ENABLED
+  telemetry.solenoidThermal(_thermal.getTemperature(), holdingPwm(), level);
+  #endif
+  #endif
+}
+
 void AirflowController::setAirflowToRest() {
+  _activeNote = 0;
+  _awaitingOnset = false;
   setAirflowServoAngle(SERVO_AIRFLOW_OFF);
 
   if (DEBUG) {
@@ -329,21 +604,27 @@ void AirflowController::setAirflowToRest() {
 
 void AirflowController::update() {
   #if SOLENOID_USE_PWM
-  // Gérer la réduction PWM après SOLENOID_ACTIVATION_TIME_MS
+  // Réduction PWM pour maintien (économie énergie/chaleur) après _activationMs
   if (_solenoidOpen && _solenoidOpenTime > 0) {
-    unsigned long elapsed = millis() - _solenoidOpenTime;
-
-    if (elapsed >= SOLENOID_ACTIVATION_TIME_MS) {
-      // Réduire le PWM pour maintien (économie énergie/chaleur)
-      setSolenoidPWM(SOLENOID_PWM_HOLDING);
-      _solenoidOpenTime = 0;  // Reset pour ne faire qu'une fois
-
-      if (DEBUG) {
-        Serial.print("DEBUG: AirflowController - PWM réduit à ");
-        Serial.print(SOLENOID_PWM_HOLDING);
-        Serial.println(" (maintien)");
-      }
+    #if SOLENOID_HOLD_TIMER_ENABLED
+    // Déjà écrite par l'interruption : en tenir compte
+    unsigned long switchedAt;
+    if (SolenoidHoldTimer::takeFired(_holdSlot, switchedAt)) {
+      holdingStarted(switchedAt);
+    }
+    #else
+    if (millis() - _solenoidOpenTime >= _activationMs) {
+      writeSolenoidPwm(_plannedHoldingPwm);
+      holdingStarted(millis());
     }
+    #endif
+  }
+  #endif
+
+  #if SOLENOID_THERMAL_ENABLED
+  // Modèle thermique de la bobine (un pas toutes les SOLENOID_THERMAL_PERIOD_MS)
+  if (_thermal.update(millis())) {
+    updateThermal();
   }
   #endif
 
@@ -371,34 +652,44 @@ void AirflowController::update() {
 }
 
 void AirflowController::setAirflowServoAngle(uint16_t angle) {
-  uint16_t pwmValue = angleToPWM(angle);
-  _pwm.setPWM(NUM_SERVO_AIRFLOW, 0, pwmValue);
-}
+  #if POWER_BUDGET_ENABLED
+  // Consommation du servo débit (non décalable : réservations prolongées
+  // tant qu'il bouge, ex. vibrato ou CC2)
+  if (angle != _airflowAngle) {
+    uint16_t distance = (angle > _airflowAngle) ? angle - _airflowAngle : _airflowAngle - angle;
+    unsigned long accelMs, travelMs;
+    ServoMotionPlanner::predictPhases(distance * 10, accelMs, travelMs);
+
+    unsigned long now = millis();
+    _power.addLoad(this, POWER_SERVO_STARTUP_MA, now, now + accelMs);
+    _power.addLoad(this, POWER_SERVO_MOVING_MA, now + accelMs, now + travelMs);
+  }
+  #endif
 
-uint16_t AirflowController::angleToPWM(uint16_t angle) {
-  // Limiter l'angle entre min et max
-  if (angle < SERVO_MIN_ANGLE) angle = SERVO_MIN_ANGLE;
-  if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
+  // Servo débit prévu en place (la valve attend ce moment quand le débit est préparé)
+  if (angle != _airflowAngle) {
+    uint16_t distance = (angle > _airflowAngle) ? angle - _airflowAngle : _airflowAngle - angle;
+    _airflowSettleTime = millis() + ServoMotionPlanner::predictDuration(distance * 10);
+  }
+  _airflowAngle = angle;
 
-  // Convertir angle en largeur d'impulsion (µs)
-  uint16_t pulse = map(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE,
-                       SERVO_PULSE_MIN, SERVO_PULSE_MAX);
+  // Envoi immédiat (les doigts en attente partent dans la même transaction)
+  _servos.writeAngle(NUM_SERVO_AIRFLOW, angle);
+}
 
-  // Convertir impulsion en valeur PWM pour PCA9685
-  float pulseDuration = (float)pulse / 1000000.0;
-  float pwmValue = pulseDuration * SERVO_FREQUENCY * 4096.0;
+void AirflowController::applyControlChanges() {
+  if (_activeNote == 0) {
+    return;
+  }
 
-  return (uint16_t)pwmValue;
-}
+  // Recalculer avec les derniers CC (volume, expression, vibrato, souffle)
+  bool flowing = setAirflowForNote(_activeNote, _lastVelocity);
 
-void AirflowController::setSolenoidPWM(uint8_t pwmValue) {
-  #if SOLENOID_USE_PWM
-    if (SOLENOID_ACTIVE_HIGH) {
-      analogWrite(SOLENOID_PIN, pwmValue);
-    } else {
-      analogWrite(SOLENOID_PIN, 255 - pwmValue);  // Inverser si active low
-    }
-  #endif
+  // Souffle (CC2) revenu au-dessus du seuil après un silence : rouvrir la valve
+  // (pas pendant le positionnement : le séquenceur ouvrira à l'heure de la note)
+  if (flowing && !_solenoidOpen && !_awaitingOnset) {
+    openSolenoid();
+  }
 }
 
 void AirflowController::setCCValues(byte ccVolume, byte ccExpression, byte ccModulation) {
@@ -410,15 +701,7 @@ void AirflowController::setCCValues(byte ccVolume, byte ccExpression, byte ccMod
 void AirflowController::updateCC2Breath(byte ccBreath) {
   #if CC2_ENABLED
   // Stocker la valeur CC2 dans le buffer circulaire pour lissage
-  _cc2SmoothingBuffer[_cc2BufferIndex] = ccBreath;
-
-  // Avancer l'index circulaire
-  _cc2BufferIndex = (_cc2BufferIndex + 1) % CC2_SMOOTHING_BUFFER_SIZE;
-
-  // Incrémenter compteur jusqu'à remplissage complet du buffer
-  if (_cc2BufferCount < CC2_SMOOTHING_BUFFER_SIZE) {
-    _cc2BufferCount++;
-  }
+  _cc2Smoother.push(ccBreath);
 
   // Mettre à jour timestamp pour gestion timeout fallback
   _lastCC2Time = millis();
@@ -430,9 +713,22 @@ void AirflowController::updateCC2Breath(byte ccBreath) {
     Serial.print("DEBUG: CC2 (Breath) reçu: ");
     Serial.print(ccBreath);
     Serial.print(" | Buffer: ");
-    Serial.print(_cc2BufferCount);
+    Serial.print(_cc2Smoother.getCount());
     Serial.print("/");
     Serial.println(CC2_SMOOTHING_BUFFER_SIZE);
   }
   #endif
 }
+
+bool AirflowController::settleCC2Breath() {
+  #if CC2_ENABLED
+  // Dernière valeur recopiée (timeout inchangé : compté depuis le dernier CC2 reçu)
+  return _cc2Smoother.settle();
+  #else
+  return false;
+  #endif
+}
+
+void AirflowController::setPitchBend(int16_t pitchBend) {
+  _pitchBend = pitchBend;
+}
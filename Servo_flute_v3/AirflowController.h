@@ -2,12 +2,17 @@
 #define AIRFLOW_CONTROLLER_H
 
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
 #include "settings.h"
+#include "PowerBudget.h"
+#include "ServoMotionPlanner.h"
+#include "SolenoidHoldTimer.h"
+#include "SolenoidThermal.h"
+#include "BreathSmoother.h"
+#include "Telemetry.h"
 
 class AirflowController {
 public:
-  AirflowController(Adafruit_PWMServoDriver& pwm);
+  AirflowController(Actuation::Frame& servos, byte solenoidPin, PowerBudget& power);
 
   // Initialise le servo débit et le solénoïde
   void begin();
@@ -16,10 +21,29 @@ public:
   void setAirflowVelocity(byte velocity);
 
   // Définit le débit d'air pour une note spécifique avec vélocité
-  void setAirflowForNote(byte midiNote, byte velocity);
+  // Retourne false si le débit est nul (vélocité 0 ou CC2 sous le seuil de silence)
+  bool setAirflowForNote(byte midiNote, byte velocity);
+
+  // Prépare le débit d'une note pendant le positionnement des doigts (valve
+  // fermée) : le servo débit part tout de suite, en parallèle des doigts.
+  // wakeDelay : servos encore hors tension (ms). Retourne comme setAirflowForNote
+  bool prepareAirflowForNote(byte midiNote, byte velocity, unsigned long wakeDelay);
+
+  // Servo débit prévu en place (fin de course + SERVO_SETTLE_MS)
+  bool isAirflowSettled() const;
+
+  // Durée prévue (ms, stabilisation comprise) pour amener le servo débit au
+  // débit de cette note depuis sa position actuelle
+  unsigned long predictSettleTimeForNote(byte midiNote, byte velocity) const;
+
+  // Recalcule le débit de la note en cours avec les derniers CC
+  // (appelé à chaque période de contrôle où un CC a changé)
+  void applyControlChanges();
 
   // Ouvre le solénoïde (permet circulation d'air)
-  void openSolenoid();
+  // sustainMs : durée restante de la note si son Note Off est connu (0 = inconnue),
+  // raccourcit l'activation d'une note courte
+  void openSolenoid(uint16_t sustainMs = 0);
 
   // Ferme le solénoïde (bloque circulation d'air)
   void closeSolenoid();
@@ -27,6 +51,11 @@ public:
   // Retourne l'état actuel du solénoïde
   bool isSolenoidOpen() const;
 
+  // Silence en dessous duquel la valve reste ouverte entre deux notes :
+  // MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS, allongé quand la bobine chauffe
+  // (jusqu'au point où maintenir coûte autant qu'une nouvelle activation)
+  uint16_t valveCloseIntervalMs() const;
+
   // Positionne le servo débit en position repos
   void setAirflowToRest();
 
@@ -39,21 +68,46 @@ public:
   // Met à jour CC2 (Breath Controller) avec lissage et fallback velocity
   void updateCC2Breath(byte ccBreath);
 
+  // Période de contrôle sans CC2 : le lissage converge vers la dernière valeur
+  // reçue. true si le souffle lissé a bougé (applyControlChanges à appeler)
+  bool settleCC2Breath();
+
+  // Met à jour le pitch bend (-8192 à +8191), appliqué au prochain recalcul
+  void setPitchBend(int16_t pitchBend);
+
 private:
-  Adafruit_PWMServoDriver& _pwm;
+  Actuation::Frame& _servos;        // Trame PCA9685 de la flûte (partagée avec les doigts)
+  byte _solenoidPin;                // Pin du solénoïde de cette flûte
+  PowerBudget& _power;              // Budget de courant partagé (alim commune)
+  uint16_t _airflowAngle;           // Dernier angle envoyé au servo débit
+  unsigned long _airflowSettleTime; // Servo débit prévu en place (millis)
+  bool _awaitingOnset;              // Débit préparé, valve fermée jusqu'à l'heure de la note
   bool _solenoidOpen;
   unsigned long _solenoidOpenTime;  // Timestamp ouverture solénoïde (pour PWM)
+  uint8_t _solenoidPwm;             // PWM appliqué (0 = fermé)
+  uint16_t _activationMs;           // Durée d'activation choisie à l'ouverture
+  uint8_t _plannedHoldingPwm;       // Maintien prévu à la fin de l'activation
+  uint16_t _holdLoadMa;             // Courant de maintien ajouté au budget à l'ouverture
+
+  #if SOLENOID_HOLD_TIMER_ENABLED
+  uint8_t _holdSlot;                // Échéance du passage au maintien (Timer3)
+  #endif
+
+  #if SOLENOID_THERMAL_ENABLED
+  SolenoidThermal _thermal;         // Température estimée de la bobine
+  ThermalLevel _thermalLevel;       // Dernier niveau signalé
+  #endif
+  byte _activeNote;                 // Note dont le débit suit les CC (0 = aucune)
 
   // Valeurs Control Change MIDI
   byte _ccVolume;       // CC 7  (multiplicateur global)
   byte _ccExpression;   // CC 11 (expression dynamique)
   byte _ccModulation;   // CC 1  (vibrato)
   byte _ccBreath;       // CC 2  (breath controller)
+  int16_t _pitchBend;   // Pitch bend (-8192 à +8191, 0 = centre)
 
   // Breath Controller (CC2) - Lissage et fallback
-  byte _cc2SmoothingBuffer[CC2_SMOOTHING_BUFFER_SIZE];  // Buffer circulaire pour moyenne glissante
-  uint8_t _cc2BufferIndex;                              // Index actuel dans buffer circulaire
-  uint8_t _cc2BufferCount;                              // Nombre valeurs dans buffer (0-CC2_SMOOTHING_BUFFER_SIZE)
+  BreathSmoother _cc2Smoother;                          // Moyenne glissante sur CC2_SMOOTHING_BUFFER_SIZE périodes
   unsigned long _lastCC2Time;                           // Timestamp dernier CC2 reçu (pour timeout fallback)
   byte _lastVelocity;                                   // Velocity stockée pour fallback si CC2 absent
 
@@ -66,11 +120,32 @@ private:
   // Positionne le servo de débit à un angle spécifique
   void setAirflowServoAngle(uint16_t angle);
 
-  // Convertit un angle en valeur PWM pour le PCA9685
-  uint16_t angleToPWM(uint16_t angle);
+  // Plage d'angles [min, max] de la note (pourcentages du doigté)
+  void noteAirflowRange(byte midiNote, uint16_t& minAngle, uint16_t& maxAngle) const;
+
+  // Angle sans vibrato pour une source de souffle (CC2 ou vélocité) :
+  // CC7 réduit la plage, CC11 module, pitch bend décale
+  uint16_t airflowAngle(byte airflowSource, uint16_t minAngle, uint16_t maxAngle,
+                        uint16_t& effectiveMaxAngle, uint16_t& baseAngle) const;
+
+  // Écrit le PWM du solénoïde (et le signale au modèle thermique)
+  void writeSolenoidPwm(uint8_t pwm);
+
+  // PWM de maintien, réduit si la bobine chauffe, corrigé par currentRatio()
+  uint8_t holdingPwm() const;
+
+  // Courant obtenu / courant nominal à PWM égal : tension d'alimentation
+  // mesurée et résistance de la bobine selon sa température estimée
+  float currentRatio() const;
+
+  // Durée d'activation pour ce courant et cette durée de note (0 = inconnue)
+  uint16_t activationTimeMs(uint8_t activationPwm, float ratio, uint16_t sustainMs) const;
+
+  // Passage au maintien effectué (échéance Timer3 ou fin d'activation)
+  void holdingStarted(unsigned long when);
 
-  // Contrôle solénoïde via GPIO ou PWM
-  void setSolenoidPWM(uint8_t pwmValue);
+  // Pas du modèle thermique : réduction du maintien en cours, alertes
+  void updateThermal();
 };
 
 #endif
@@ -0,0 +1,44 @@
+#include "BreathSmoother.h"
+
+BreathSmoother::BreathSmoother(uint8_t size)
+  : _size(size) {
+  _buffer = new uint8_t[size];
+  clear();
+}
+
+void BreathSmoother::clear() {
+  _index = 0;
+  _count = 0;
+  _latest = 0;
+}
+
+void BreathSmoother::push(uint8_t value) {
+  _buffer[_index] = value;
+  _index = (_index + 1) % _size;
+  if (_count < _size) {
+    _count++;
+  }
+  _latest = value;
+}
+
+bool BreathSmoother::settle() {
+  if (_count == 0 || average() == _latest) {
+    return false;
+  }
+
+  // Au plus size - 1 périodes : le buffer ne contient alors que _latest
+  push(_latest);
+  return true;
+}
+
+uint8_t BreathSmoother::average() const {
+  if (_count == 0) {
+    return 0;
+  }
+
+  uint16_t sum = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    sum += _buffer[i];
+  }
+  return sum / _count;
+}
@@ -0,0 +1,42 @@
+#ifndef BREATH_SMOOTHER_H
+#define BREATH_SMOOTHER_H
+
+#include <stdint.h>  // Indépendant du matériel : compilé sur PC par tools/breath_smoothing_check.cpp
+
+// Lissage du souffle (CC2, aftertouch canal) : moyenne glissante des size
+// dernières périodes de contrôle. Une période sans nouvelle valeur recopie la
+// dernière reçue (settle) jusqu'à ce que la moyenne l'atteigne : un balayage
+// rapide regroupé en une seule période (127 → 0) finit toujours sur sa
+// dernière valeur, même si plus aucun CC2 n'arrive ensuite.
+class BreathSmoother {
+public:
+  BreathSmoother(uint8_t size);
+
+  // Valeur reçue pendant la période de contrôle
+  void push(uint8_t value);
+
+  // Période sans valeur reçue : recopie la dernière tant que la moyenne ne
+  // l'a pas atteinte. true si une valeur a été recopiée (débit à recalculer)
+  bool settle();
+
+  // Moyenne des valeurs du buffer (0 si vide)
+  uint8_t average() const;
+
+  // Dernière valeur reçue
+  uint8_t latest() const { return _latest; }
+
+  // Aucune valeur reçue : le souffle suit la vélocité
+  bool isEmpty() const { return _count == 0; }
+  uint8_t getCount() const { return _count; }
+
+  void clear();
+
+private:
+  uint8_t* _buffer;    // Buffer circulaire
+  uint8_t _size;
+  uint8_t _index;      // Prochaine case écrite
+  uint8_t _count;      // Valeurs dans le buffer (0-size)
+  uint8_t _latest;
+};
+
+#endif
@@ -0,0 +1,328 @@
+#include "ConfigStore.h"
+
+#if LIVE_CONFIG_ENABLED
+
+#include <EEPROM.h>
+
+#ifdef E2END
+static_assert(CONFIG_EEPROM_ADDRESS + (uint32_t)CONFIG_PROFILE_COUNT * CONFIG_PROFILE_SIZE <= E2END + 1UL,
+              "Profils au-delà de l'EEPROM");
+#endif
+
+// Tables actives lues par les accesseurs de settings.h
+const FingerConfig* liveFingers = nullptr;
+const NoteDefinition* liveNotes = nullptr;
+const TimingConfig* liveTiming = nullptr;
+
+ConfigStore configStore;
+
+ConfigStore::ConfigStore()
+  : _active(0), _swapPending(false), _loadedFromEeprom(false),
+    _pendingFromEeprom(false), _profile(CONFIG_BOOT_PROFILE) {
+  // Valeurs flash dans les deux copies : accesseurs valides dès le démarrage
+  loadFlashDefaults(_buffers[0]);
+  _buffers[1] = _buffers[0];
+  publish();
+}
+
+void ConfigStore::begin() {
+  // Profil de démarrage absent, corrompu ou issu d'autres tables : valeurs flash
+  if (selectProfile(CONFIG_BOOT_PROFILE) == CONFIG_OK) {
+    swap();
+  }
+}
+
+const FingerConfig& ConfigStore::getFinger(uint8_t index) const {
+  return _buffers[_active].fingers[index];
+}
+
+const NoteDefinition& ConfigStore::getNote(uint8_t index) const {
+  return _buffers[_active].notes[index];
+}
+
+const TimingConfig& ConfigStore::getTiming() const {
+  return _buffers[_active].timing;
+}
+
+ConfigStatus ConfigStore::beginEdit() {
+  if (_swapPending) {
+    return CONFIG_ERR_BUSY;
+  }
+  staging() = _buffers[_active];
+  return CONFIG_OK;
+}
+
+ConfigStatus ConfigStore::loadDefaults() {
+  if (_swapPending) {
+    return CONFIG_ERR_BUSY;
+  }
+  loadFlashDefaults(staging());
+  return CONFIG_OK;
+}
+
+ConfigStatus ConfigStore::selectProfile(uint8_t profile) {
+  if (profile >= CONFIG_PROFILE_COUNT) {
+    return CONFIG_ERR_INDEX;
+  }
+  if (_swapPending && !_pendingFromEeprom) {
+    return CONFIG_ERR_BUSY;  // APPLY accepté : appliqué avant tout profil
+  }
+  if (!isProfileValid(profile)) {
+    return CONFIG_ERR_EEPROM;  // Profil vide : configuration inchangée
+  }
+
+  LiveConfig& candidate = staging();
+  EEPROM.get(profileAddress(profile) + sizeof(EepromHeader), candidate);
+
+  // CRC correct mais valeurs refusées (règles plus strictes que l'outil)
+  ConfigStatus status = validate(candidate);
+  if (status != CONFIG_OK) {
+    if (_swapPending) {
+      // Profil déjà en attente relu tel quel (EEPROM inchangée : save()
+      // refusé tant qu'un échange attend) : il reste en attente
+      EEPROM.get(profileAddress(_profile) + sizeof(EepromHeader), candidate);
+    } else {
+      candidate = _buffers[_active];
+    }
+    return status;
+  }
+
+  _swapPending = true;
+  _pendingFromEeprom = true;
+  _profile = profile;
+
+  if (DEBUG) {
+    Serial.print("DEBUG: ConfigStore - Profil ");
+    Serial.print(profile);
+    Serial.println(" chargé (échange au prochain silence)");
+  }
+  return CONFIG_OK;
+}
+
+ConfigStatus ConfigStore::setFinger(uint8_t index, const FingerConfig& finger) {
+  if (_swapPending) return CONFIG_ERR_BUSY;
+  if (index >= NUMBER_SERVOS_FINGER) return CONFIG_ERR_INDEX;
+
+  ConfigStatus status = validateFinger(finger);
+  if (status == CONFIG_OK) {
+    staging().fingers[index] = finger;
+  }
+  return status;
+}
+
+ConfigStatus ConfigStore::setNote(uint8_t index, const NoteDefinition& note) {
+  if (_swapPending) return CONFIG_ERR_BUSY;
+  if (index >= NUMBER_NOTES) return CONFIG_ERR_INDEX;
+
+  ConfigStatus status = validateNote(note);
+  if (status == CONFIG_OK) {
+    staging().notes[index] = note;
+  }
+  return status;
+}
+
+ConfigStatus ConfigStore::setTiming(const TimingConfig& timing) {
+  if (_swapPending) return CONFIG_ERR_BUSY;
+
+  ConfigStatus status = validateTiming(timing);
+  if (status == CONFIG_OK) {
+    staging().timing = timing;
+  }
+  return status;
+}
+
+ConfigStatus ConfigStore::apply() {
+  if (_swapPending) {
+    return CONFIG_ERR_BUSY;
+  }
+
+  // Contrôles croisés (ordre des notes, canaux uniques) avant tout échange
+  ConfigStatus status = validate(staging());
+  if (status == CONFIG_OK) {
+    _swapPending = true;
+    _pendingFromEeprom = false;
+  }
+  return status;
+}
+
+void ConfigStore::swap() {
+  _active ^= 1;
+  publish();
+  _swapPending = false;
+  _loadedFromEeprom = _pendingFromEeprom;
+
+  // Nouvelle préparation = copie de la configuration active
+  staging() = _buffers[_active];
+
+  if (DEBUG) {
+    Serial.println("DEBUG: ConfigStore - Nouvelle configuration active");
+  }
+}
+
+ConfigStatus ConfigStore::save() {
+  return save(_profile);
+}
+
+ConfigStatus ConfigStore::save(uint8_t profile) {
+  if (profile >= CONFIG_PROFILE_COUNT) {
+    return CONFIG_ERR_INDEX;
+  }
+  if (_swapPending) {
+    return CONFIG_ERR_BUSY;  // Sauvegarder après l'échange
+  }
+  uint16_t address = profileAddress(profile);
+
+  const LiveConfig& config = _buffers[_active];
+  EepromHeader header;
+  header.magic = EEPROM_MAGIC;
+  header.version = EEPROM_VERSION;
+  header.size = sizeof(LiveConfig);
+  header.crc = crc16((const uint8_t*)&config, sizeof(LiveConfig));
+
+  // put() n'écrit que les octets modifiés (usure EEPROM limitée)
+  EEPROM.put(address + sizeof(EepromHeader), config);
+  EEPROM.put(address, header);
+
+  // Relecture en EEPROM (en-tête + CRC)
+  bool ok = isProfileValid(profile);
+  if (ok) {
+    _profile = profile;
+    _loadedFromEeprom = true;
+  }
+
+  if (DEBUG) {
+    Serial.print("DEBUG: ConfigStore - Sauvegarde profil ");
+    Serial.print(profile);
+    Serial.println(ok ? " OK" : " ÉCHEC");
+  }
+  return ok ? CONFIG_OK : CONFIG_ERR_EEPROM;
+}
+
+bool ConfigStore::isProfileValid(uint8_t profile) {
+  uint16_t address = profileAddress(profile);
+  EepromHeader header;
+  EEPROM.get(address, header);
+
+  if (header.magic != EEPROM_MAGIC || header.version != EEPROM_VERSION ||
+      header.size != sizeof(LiveConfig)) {
+    return false;  // Rien de sauvegardé (ou tables changées)
+  }
+
+  // CRC calculé octet par octet : rien n'est écrasé en RAM si le profil est corrompu
+  uint16_t crc = 0xFFFF;
+  address += sizeof(EepromHeader);
+  for (uint16_t i = 0; i < sizeof(LiveConfig); i++) {
+    crc = crc16Update(crc, EEPROM.read(address + i));
+  }
+  return crc == header.crc;
+}
+
+void ConfigStore::loadFlashDefaults(LiveConfig& config) {
+  memcpy_P(config.fingers, FINGERS, sizeof(config.fingers));
+  memcpy_P(config.notes, NOTES, sizeof(config.notes));
+
+  config.timing.servoToSolenoidDelayMs = SERVO_TO_SOLENOID_DELAY_MS;
+  config.timing.minNoteIntervalForValveCloseMs = MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS;
+  config.timing.solenoidPwmActivation = SOLENOID_PWM_ACTIVATION;
+  config.timing.solenoidPwmHolding = SOLENOID_PWM_HOLDING;
+}
+
+ConfigStatus ConfigStore::validateFinger(const FingerConfig& finger) {
+  if (finger.pcaChannel > 15 || finger.pcaChannel == NUM_SERVO_AIRFLOW) {
+    return CONFIG_ERR_FINGER;
+  }
+  if (finger.direction != 1 && finger.direction != -1) {
+    return CONFIG_ERR_FINGER;
+  }
+  if (finger.halfAngle > ANGLE_OPEN || finger.quarterAngle > finger.halfAngle) {
+    return CONFIG_ERR_FINGER;
+  }
+
+  // Position ouverte atteignable par le servo
+  int16_t openAngle = (int16_t)finger.closedAngle + ANGLE_OPEN * finger.direction;
+  if (finger.closedAngle > 180 || openAngle < 0 || openAngle > 180) {
+    return CONFIG_ERR_FINGER;
+  }
+  return CONFIG_OK;
+}
+
+ConfigStatus ConfigStore::validateNote(const NoteDefinition& note) {
+  // Note 0 réservée ("aucune note" dans les contrôleurs)
+  if (note.midiNote == 0 || note.midiNote > 127) {
+    return CONFIG_ERR_NOTE;
+  }
+  if (note.airflowMinPercent > note.airflowMaxPercent || note.airflowMaxPercent > 100) {
+    return CONFIG_ERR_NOTE;
+  }
+
+  // Aucun doigt au-delà de ceux du profil
+  if (note.fingerPattern & ~Instrument::PATTERN_MASK) {
+    return CONFIG_ERR_NOTE;
+  }
+  return CONFIG_OK;
+}
+
+ConfigStatus ConfigStore::validateTiming(const TimingConfig& timing) {
+  if (timing.servoToSolenoidDelayMs == 0 || timing.servoToSolenoidDelayMs > 1000) {
+    return CONFIG_ERR_TIMING;
+  }
+  if (timing.minNoteIntervalForValveCloseMs > 1000) {
+    return CONFIG_ERR_TIMING;
+  }
+  if (timing.solenoidPwmActivation == 0 || timing.solenoidPwmHolding > timing.solenoidPwmActivation) {
+    return CONFIG_ERR_TIMING;
+  }
+  return CONFIG_OK;
+}
+
+ConfigStatus ConfigStore::validate(const LiveConfig& config) {
+  ConfigStatus status;
+
+  for (uint8_t i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    status = validateFinger(config.fingers[i]);
+    if (status != CONFIG_OK) return status;
+
+    // Un canal PCA par doigt
+    for (uint8_t j = 0; j < i; j++) {
+      if (config.fingers[j].pcaChannel == config.fingers[i].pcaChannel) {
+        return CONFIG_ERR_FINGER;
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < NUMBER_NOTES; i++) {
+    status = validateNote(config.notes[i]);
+    if (status != CONFIG_OK) return status;
+
+    // FIRST_MIDI_NOTE et NoteRemapper supposent une table croissante
+    if (i > 0 && config.notes[i].midiNote <= config.notes[i - 1].midiNote) {
+      return CONFIG_ERR_ORDER;
+    }
+  }
+
+  return validateTiming(config.timing);
+}
+
+uint16_t ConfigStore::crc16(const uint8_t* data, uint16_t length) {
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < length; i++) {
+    crc = crc16Update(crc, data[i]);
+  }
+  return crc;
+}
+
+uint16_t ConfigStore::crc16Update(uint16_t crc, uint8_t data) {
+  crc ^= (uint16_t)data << 8;
+  for (uint8_t bit = 0; bit < 8; bit++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+void ConfigStore::publish() {
+  liveFingers = _buffers[_active].fingers;
+  liveNotes = _buffers[_active].notes;
+  liveTiming = &_buffers[_active].timing;
+}
+
+#endif
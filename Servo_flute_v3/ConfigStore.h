@@ -0,0 +1,134 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Résultat d'une écriture / validation de configuration (renvoyé par SysEx)
+enum ConfigStatus {
+  CONFIG_OK = 0,
+  CONFIG_ERR_INDEX,       // Index doigt/note hors table
+  CONFIG_ERR_FINGER,      // Doigt invalide (canal, angles, sens)
+  CONFIG_ERR_NOTE,        // Note invalide (MIDI, doigté, débit)
+  CONFIG_ERR_ORDER,       // Notes non strictement croissantes
+  CONFIG_ERR_TIMING,      // Délais / PWM valve invalides
+  CONFIG_ERR_BUSY,        // Échange déjà en attente
+  CONFIG_ERR_EEPROM,      // Sauvegarde / relecture EEPROM échouée
+  CONFIG_ERR_FORMAT       // Message mal formé
+};
+
+// Configuration modifiable en direct : copie RAM de FINGERS[], NOTES[] et des
+// délais de la valve. Double buffer : les écritures SysEx vont dans la copie
+// de préparation, validée puis échangée avec la copie active entre deux notes
+// (les accesseurs finger*()/note*() lisent toujours une table cohérente).
+class ConfigStore {
+public:
+  ConfigStore();
+
+  // Charge le profil CONFIG_BOOT_PROFILE s'il est valide (sinon conserve
+  // les tables flash). Appelé au tout début de setup().
+  void begin();
+
+  // true si la configuration active est un profil relu de l'EEPROM
+  bool isLoadedFromEeprom() const { return _loadedFromEeprom; }
+
+  // Profil courant : cible par défaut de save()
+  uint8_t getProfile() const { return _profile; }
+
+  // Lecture de la configuration active
+  const FingerConfig& getFinger(uint8_t index) const;
+  const NoteDefinition& getNote(uint8_t index) const;
+  const TimingConfig& getTiming() const;
+
+  // Préparation : repart de la configuration active ou des valeurs flash
+  ConfigStatus beginEdit();
+  ConfigStatus loadDefaults();
+
+  // Écritures dans la copie de préparation (valeurs vérifiées une à une)
+  ConfigStatus setFinger(uint8_t index, const FingerConfig& finger);
+  ConfigStatus setNote(uint8_t index, const NoteDefinition& note);
+  ConfigStatus setTiming(const TimingConfig& timing);
+
+  // Valide la préparation complète ; l'échange a lieu au prochain swap()
+  ConfigStatus apply();
+
+  // Charge un profil EEPROM dans la préparation (échange au prochain swap()).
+  // Remplace un profil déjà en attente (le dernier demandé gagne) ; refusé
+  // (CONFIG_ERR_BUSY) si un APPLY attend. Profil refusé : l'échange déjà en
+  // attente est conservé.
+  ConfigStatus selectProfile(uint8_t profile);
+
+  // Échange en attente (appliqué par InstrumentManager entre deux notes)
+  bool isSwapPending() const { return _swapPending; }
+
+  // Rend la préparation active (à appeler quand aucune note ne joue)
+  void swap();
+
+  // Sauvegarde la configuration active dans un profil EEPROM (relue pour
+  // vérification) ; sans argument : profil courant
+  ConfigStatus save();
+  ConfigStatus save(uint8_t profile);
+
+private:
+  struct LiveConfig {
+    FingerConfig fingers[NUMBER_SERVOS_FINGER];
+    NoteDefinition notes[NUMBER_NOTES];
+    TimingConfig timing;
+  };
+
+  // En-tête EEPROM (devant la configuration de chaque profil). Même format
+  // écrit par Calibration_Tool (ProfileWriter) : à garder identique.
+  struct EepromHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t size;       // sizeof(LiveConfig) : détecte un changement de tables
+    uint16_t crc;
+  };
+
+  static_assert(sizeof(LiveConfig) < 256, "EepromHeader.size sur 8 bits : LiveConfig trop grand");
+
+  static_assert(sizeof(EepromHeader) + sizeof(LiveConfig) <= CONFIG_PROFILE_SIZE,
+                "CONFIG_PROFILE_SIZE trop petit pour les tables");
+  static_assert(CONFIG_BOOT_PROFILE < CONFIG_PROFILE_COUNT, "CONFIG_BOOT_PROFILE hors profils");
+
+  static const uint16_t EEPROM_MAGIC = 0x5346;  // "SF"
+  static const uint8_t EEPROM_VERSION = 1;
+
+  LiveConfig _buffers[2];
+  uint8_t _active;          // Index de la copie active (l'autre = préparation)
+  bool _swapPending;
+  bool _loadedFromEeprom;
+  bool _pendingFromEeprom;  // Préparation = profil relu (selectProfile)
+  uint8_t _profile;         // Profil courant (dernier chargé ou sauvegardé)
+
+  LiveConfig& staging() { return _buffers[_active ^ 1]; }
+
+  // Adresse EEPROM d'un profil
+  static uint16_t profileAddress(uint8_t profile) {
+    return CONFIG_EEPROM_ADDRESS + (uint16_t)profile * CONFIG_PROFILE_SIZE;
+  }
+
+  // En-tête et CRC d'un profil vérifiés directement en EEPROM (sans tampon RAM)
+  static bool isProfileValid(uint8_t profile);
+
+  // Remplit une copie avec les tables flash (FINGERS[], NOTES[], #define)
+  static void loadFlashDefaults(LiveConfig& config);
+
+  // Contrôles de cohérence
+  static ConfigStatus validateFinger(const FingerConfig& finger);
+  static ConfigStatus validateNote(const NoteDefinition& note);
+  static ConfigStatus validateTiming(const TimingConfig& timing);
+  static ConfigStatus validate(const LiveConfig& config);
+
+  // CRC-16 CCITT d'un bloc mémoire
+  static uint16_t crc16(const uint8_t* data, uint16_t length);
+  static uint16_t crc16Update(uint16_t crc, uint8_t data);
+
+  // Met à jour les pointeurs liveFingers / liveNotes / liveTiming
+  void publish();
+};
+
+// Instance unique : les accesseurs de settings.h lisent sa copie active
+extern ConfigStore configStore;
+
+#endif
@@ -0,0 +1,91 @@
+#include "DinMidiInput.h"
+
+#if DIN_MIDI_ENABLED
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+volatile uint8_t DinMidiInput::_data[DIN_MIDI_BUFFER_SIZE];
+volatile uint8_t DinMidiInput::_stamp[DIN_MIDI_BUFFER_SIZE];
+volatile uint8_t DinMidiInput::_head = 0;
+volatile uint8_t DinMidiInput::_tail = 0;
+volatile uint16_t DinMidiInput::_lost = 0;
+
+DinMidiInput::DinMidiInput() : _messageStamp(0) {
+}
+
+void DinMidiInput::begin() {
+  // 31250 bauds à 16 MHz : UBRR = 16e6 / (16 × 31250) - 1 = 31 (exact)
+  UCSR1B = 0;
+  UCSR1A = 0;
+  UBRR1 = (F_CPU / 16UL / 31250UL) - 1;
+  UCSR1C = (1 << UCSZ11) | (1 << UCSZ10);    // 8 bits, sans parité, 1 stop
+  pinMode(0, INPUT_PULLUP);                   // RX1 : ligne au repos sans prise branchée
+  UCSR1B = (1 << RXEN1) | (1 << RXCIE1);      // Réception seule, interruption
+
+  if (DEBUG) {
+    Serial.println("DEBUG: DinMidiInput - Entrée MIDI DIN active (RX1, 31250 bauds)");
+  }
+}
+
+void DinMidiInput::receive(uint8_t data, bool error) {
+  if (error) {
+    _lost++;     // Trame invalide : octet inutilisable
+    return;
+  }
+
+  uint8_t next = (_head + 1) & BUFFER_MASK;
+  if (next == _tail) {
+    _lost++;     // Tampon plein
+    return;
+  }
+  _data[_head] = data;
+  _stamp[_head] = (uint8_t)millis();
+  _head = next;
+}
+
+ISR(USART1_RX_vect) {
+  uint8_t status = UCSR1A;   // Lire les erreurs avant UDR1
+  uint8_t data = UDR1;
+  if (status & (1 << DOR1)) {
+    DinMidiInput::receive(0, true);   // Octet(s) écrasé(s) dans l'USART
+  }
+  DinMidiInput::receive(data, (status & (1 << FE1)) != 0);
+}
+
+bool DinMidiInput::read(MidiStreamPacket& packet, unsigned long& arrivalMs) {
+  while (_tail != _head) {
+    uint8_t data = _data[_tail];
+    uint8_t stamp = _stamp[_tail];
+    _tail = (_tail + 1) & BUFFER_MASK;
+
+    // Heure d'un message = arrivée de son 1er octet : statut, ou donnée en
+    // running status (un octet temps réel est daté seul)
+    if (data < 0xF8 && ((data & 0x80) || _parser.idle())) {
+      _messageStamp = stamp;
+    }
+
+    if (_parser.parse(data, packet)) {
+      uint8_t messageStamp = (data >= 0xF8) ? stamp : _messageStamp;
+      // millis() sur 8 bits : âge exact tant que l'octet a moins de 256 ms
+      unsigned long now = millis();
+      arrivalMs = now - (uint8_t)((uint8_t)now - messageStamp);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8_t DinMidiInput::available() const {
+  return (_head - _tail) & BUFFER_MASK;
+}
+
+uint16_t DinMidiInput::lostBytes() const {
+  uint16_t lost;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    lost = _lost;
+  }
+  return lost;
+}
+
+#endif
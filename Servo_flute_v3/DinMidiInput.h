@@ -0,0 +1,57 @@
+#ifndef DIN_MIDI_INPUT_H
+#define DIN_MIDI_INPUT_H
+
+#include <Arduino.h>
+#include "MidiStreamParser.h"
+#include "settings.h"
+
+#if DIN_MIDI_ENABLED
+
+/***********************************************************************************************
+ * Entrée MIDI DIN (USART1, broche RX1 = 0 sur Leonardo) à 31250 bauds.
+ *
+ * L'interruption de réception range chaque octet et son heure d'arrivée dans un tampon
+ * circulaire (quelques µs par octet) ; read() analyse le tampon dans la boucle principale.
+ * À pleine densité (3125 octets/s) le tampon couvre DIN_MIDI_BUFFER_SIZE × 0.32 ms de
+ * boucle bloquée sans perte.
+ *
+ * Reprend l'interruption RX de l'USART1 : Serial1 ne doit pas être utilisé.
+ ***********************************************************************************************/
+class DinMidiInput {
+public:
+  DinMidiInput();
+
+  // Configure l'USART1 (31250 bauds 8N1, réception seule sous interruption)
+  void begin();
+
+  // Prochain message complet (false si aucun) ; arrivalMs = réception de son 1er octet
+  bool read(MidiStreamPacket& packet, unsigned long& arrivalMs);
+
+  // Octets en attente dans le tampon
+  uint8_t available() const;
+
+  // Octets perdus (tampon plein, débordement ou erreur de trame USART)
+  uint16_t lostBytes() const;
+
+  // Appelé par l'interruption de réception
+  static void receive(uint8_t data, bool error);
+
+private:
+  static_assert((DIN_MIDI_BUFFER_SIZE & (DIN_MIDI_BUFFER_SIZE - 1)) == 0 && DIN_MIDI_BUFFER_SIZE <= 128,
+                "DIN_MIDI_BUFFER_SIZE : puissance de 2, 128 maximum");
+  static const uint8_t BUFFER_MASK = DIN_MIDI_BUFFER_SIZE - 1;
+
+  // Tampon rempli par l'interruption (octet + millis() & 0xFF à la réception)
+  static volatile uint8_t _data[DIN_MIDI_BUFFER_SIZE];
+  static volatile uint8_t _stamp[DIN_MIDI_BUFFER_SIZE];
+  static volatile uint8_t _head;     // Écrit par l'interruption
+  static volatile uint8_t _tail;     // Écrit par read()
+  static volatile uint16_t _lost;
+
+  MidiStreamParser _parser;
+  uint8_t _messageStamp;             // Arrivée du 1er octet du message en cours
+};
+
+#endif
+
+#endif
@@ -37,6 +37,13 @@ MidiEvent* EventQueue::peek() {
   return &_events[_tail];
 }
 
+MidiEvent* EventQueue::peekAt(int offset) {
+  if (offset < 0 || offset >= _count) {
+    return nullptr;
+  }
+  return &_events[(_tail + offset) % _capacity];
+}
+
 void EventQueue::dequeue() {
   if (isEmpty()) {
     return;
@@ -34,6 +34,9 @@ public:
   // Récupère le prochain événement sans le retirer
   MidiEvent* peek();
 
+  // Récupère l'événement à la position offset (0 = prochain) sans le retirer
+  MidiEvent* peekAt(int offset);
+
   // Retire le prochain événement de la queue
   void dequeue();
 
@@ -1,7 +1,11 @@
 #include "FingerController.h"
 
-FingerController::FingerController(Adafruit_PWMServoDriver& pwm)
-  : _pwm(pwm) {
+FingerController::FingerController(Actuation::Frame& servos, PowerBudget& power)
+  : _servos(servos), _power(power), _currentPattern(0), _basePattern(0), _shading(false),
+    _lastFrameTime(0), _servosReadyTime(0) {
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    _writtenPosition[i] = 0xFFFF;  // Aucune position envoyée
+  }
 }
 
 void FingerController::begin() {
@@ -16,16 +20,15 @@ void FingerController::begin() {
   closeAllFingers();
 }
 
-void FingerController::setFingerPattern(const bool pattern[NUMBER_SERVOS_FINGER]) {
-  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    uint16_t angle = calculateServoAngle(i, pattern[i]);
-    setServoAngle(i, angle);
-  }
+void FingerController::setFingerPattern(FingerPattern pattern) {
+  _basePattern = pattern;
+  pattern = shadePattern(pattern);
+  applyPattern(pattern, false);
 
   if (DEBUG) {
     Serial.print("DEBUG: FingerController - Pattern appliqué: ");
     for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-      Serial.print(pattern[i]);
+      Serial.print(getFingerPosition(pattern, i));
       Serial.print(" ");
     }
     Serial.println();
@@ -34,9 +37,9 @@ void FingerController::setFingerPattern(const bool pattern[NUMBER_SERVOS_FINGER]
 
 void FingerController::setFingerPatternForNote(byte midiNote) {
   // Rechercher la note dans le tableau NOTES
-  const NoteDefinition* note = getNoteByMidi(midiNote);
+  int noteIndex = getNoteIndex(midiNote);
 
-  if (note == nullptr) {
+  if (noteIndex < 0) {
     if (DEBUG) {
       Serial.print("DEBUG: FingerController - Note non trouvée: ");
       Serial.println(midiNote);
@@ -45,7 +48,7 @@ void FingerController::setFingerPatternForNote(byte midiNote) {
   }
 
   // Applique le pattern correspondant
-  setFingerPattern(note->fingerPattern);
+  setFingerPattern(noteFingering(noteIndex));
 
   if (DEBUG) {
     Serial.print("DEBUG: FingerController - Note MIDI: ");
@@ -54,9 +57,8 @@ void FingerController::setFingerPatternForNote(byte midiNote) {
 }
 
 void FingerController::closeAllFingers() {
-  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    setServoAngle(i, FINGERS[i].closedAngle);
-  }
+  _basePattern = 0;
+  applyPattern(0, true);  // Tous fermés
 
   if (DEBUG) {
     Serial.println("DEBUG: FingerController - Tous les doigts fermés");
@@ -64,55 +66,235 @@ void FingerController::closeAllFingers() {
 }
 
 void FingerController::openAllFingers() {
-  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    uint16_t openAngle = calculateServoAngle(i, true);  // true = ouvert
-    setServoAngle(i, openAngle);
-  }
+  _basePattern = Instrument::ALL_OPEN;
+  applyPattern(Instrument::ALL_OPEN, true);
 
   if (DEBUG) {
     Serial.println("DEBUG: FingerController - Tous les doigts ouverts");
   }
 }
 
-uint16_t FingerController::calculateServoAngle(int fingerIndex, bool isOpen) {
-  uint16_t baseAngle = FINGERS[fingerIndex].closedAngle;
+FingerPattern FingerController::getCurrentPattern() const {
+  return _currentPattern;
+}
+
+void FingerController::refreshPositions() {
+  // Même doigté, nouveaux angles : trajectoire vers les nouvelles positions
+  applyPattern(_currentPattern, true);
+}
+
+void FingerController::setShading(bool shading) {
+  if (shading == _shading) {
+    return;
+  }
+  _shading = shading;
+
+  // Seul le doigt ombré bouge (applyPattern ne commande que les changements)
+  applyPattern(shadePattern(_basePattern), false);
+
+  if (DEBUG) {
+    Serial.print("DEBUG: FingerController - Ombrage ");
+    Serial.println(shading ? "ON" : "OFF");
+  }
+}
+
+FingerPattern FingerController::shadePattern(FingerPattern pattern) const {
+  if (!_shading) {
+    return pattern;
+  }
+
+  // Le premier trou non fermé depuis l'embouchure fixe la hauteur :
+  // le couvrir partiellement baisse la note (ouvert → demi, demi → quart)
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    uint8_t position = getFingerPosition(pattern, i);
+    if (position == FINGER_CLOSED) {
+      continue;
+    }
+
+    uint8_t shaded = position;
+    if (position == FINGER_OPEN && fingerHalfAngle(i) > 0) {
+      shaded = FINGER_HALF;
+    } else if (position == FINGER_HALF && fingerQuarterAngle(i) > 0) {
+      shaded = FINGER_QUARTER;
+    }
+    return pattern ^ ((FingerPattern)(position ^ shaded) << (i * 2));
+  }
+  return pattern;  // Tous fermés : rien à ombrer
+}
+
+void FingerController::applyPattern(FingerPattern pattern, bool force) {
+  // Champs 2 bits non nuls = doigts à déplacer
+  FingerPattern changed = fingerChanges(_currentPattern, pattern);
+
+  // Départs planifiés (décalés si le budget de courant l'exige)
+  unsigned long startTimes[NUMBER_SERVOS_FINGER];
+  schedulePattern(pattern, millis(), startTimes, true);
+
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    if (force || getFingerPosition(changed, i) != 0) {
+      uint16_t angle = calculateServoAngle(i, getFingerPosition(pattern, i));
+      setServoAngle(i, angle, startTimes[i]);
+    }
+  }
+  _servos.flush();  // Sauts directs : un seul envoi I2C pour tous les doigts
+  _currentPattern = pattern;
+}
+
+unsigned long FingerController::schedulePattern(FingerPattern pattern, unsigned long now,
+                                                unsigned long* startTimes, bool commit) {
+  // Servos en cours de réveil : premier départ possible après la reprise
+  unsigned long earliest = now + getWakeDelay();
+
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    startTimes[i] = earliest;
+  }
+
+  #if SERVO_MOTION_PROFILE
+  // Doigts à déplacer, triés par course décroissante : les plus longues
+  // courses partent d'abord, les courtes ont de la marge pour être décalées
+  uint8_t order[NUMBER_SERVOS_FINGER];
+  uint16_t distances[NUMBER_SERVOS_FINGER];
+  uint8_t moving = 0;
+
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    if (!_planner.isKnown(i)) {
+      return servoToSolenoidDelayMs() + (earliest - now);  // Position inconnue (démarrage)
+    }
+
+    uint16_t from = _planner.getTarget(i);
+    uint16_t to = calculateServoAngle(i, getFingerPosition(pattern, i)) * 10;
+    uint16_t distance = (to > from) ? to - from : from - to;
+    distances[i] = distance;
+    if (distance == 0) {
+      continue;
+    }
+
+    // Tri par insertion (8 doigts max)
+    uint8_t k = moving++;
+    while (k > 0 && distances[order[k - 1]] < distance) {
+      order[k] = order[k - 1];
+      k--;
+    }
+    order[k] = i;
+  }
+
+  #if POWER_BUDGET_ENABLED
+  uint8_t checkpoint = _power.checkpoint(now);
+  #endif
+
+  // Au minimum, attendre la reprise de position des servos réveillés
+  unsigned long longest = earliest - now;
+  for (uint8_t k = 0; k < moving; k++) {
+    uint8_t i = order[k];
+    unsigned long accelMs, travelMs;
+    ServoMotionPlanner::predictPhases(distances[i], accelMs, travelMs);
+
+    #if POWER_BUDGET_ENABLED
+    startTimes[i] = _power.schedule(POWER_SERVO_STARTUP_MA, accelMs,
+                                    POWER_SERVO_MOVING_MA, travelMs - accelMs,
+                                    earliest, earliest + POWER_MAX_STAGGER_MS);
+    if (commit) {
+      _power.recordStagger(startTimes[i] - earliest);
+    }
+    #endif
+
+    unsigned long settle = (startTimes[i] - now) + travelMs + SERVO_SETTLE_MS;
+    if (settle > longest) {
+      longest = settle;
+    }
+  }
+
+  #if POWER_BUDGET_ENABLED
+  // Planification à blanc (prédiction) : annuler les réservations
+  if (!commit) {
+    _power.rollback(checkpoint);
+  }
+  #endif
+
+  return longest;
+  #else
+  (void)pattern;
+  (void)commit;
+  return servoToSolenoidDelayMs() + (earliest - now);
+  #endif
+}
+
+void FingerController::update() {
+  #if SERVO_MOTION_PROFILE
+  unsigned long now = millis();
 
-  if (!isOpen) {
-    // Fermé : utiliser l'angle de base
-    return baseAngle;
-  } else {
-    // Ouvert : ajouter/soustraire ANGLE_OPEN selon le sens de rotation
-    int16_t angle = baseAngle + (ANGLE_OPEN * FINGERS[fingerIndex].direction);
+  // Le PCA9685 ne rafraîchit l'impulsion qu'une fois par trame
+  if (now - _lastFrameTime < SERVO_FRAME_MS) {
+    return;
+  }
+  _lastFrameTime = now;
 
-    // Limiter l'angle entre 0 et 180°
-    if (angle < 0) angle = 0;
-    if (angle > 180) angle = 180;
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    uint16_t position;
+    _planner.sample(i, now, position);
 
-    return (uint16_t)angle;
+    // N'écrire que les doigts dont la position a changé (fin de trajectoire incluse)
+    if (position != _writtenPosition[i]) {
+      writeServoPosition(i, position);
+    }
   }
+  _servos.flush();  // Doigts en mouvement : une transaction I2C par trame
+  #endif
 }
 
-void FingerController::setServoAngle(int fingerIndex, uint16_t angle) {
-  // Utiliser directement le canal PCA depuis la structure FINGERS
-  int pcaChannel = FINGERS[fingerIndex].pcaChannel;
+bool FingerController::isSettled() const {
+  return _planner.isSettled(millis());
+}
 
-  uint16_t pwmValue = angleToPWM(angle);
-  _pwm.setPWM(pcaChannel, 0, pwmValue);
+void FingerController::setServoReadyTime(unsigned long readyTime) {
+  _servosReadyTime = readyTime;
 }
 
-uint16_t FingerController::angleToPWM(uint16_t angle) {
-  // Limiter l'angle entre min et max
-  if (angle < SERVO_MIN_ANGLE) angle = SERVO_MIN_ANGLE;
-  if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
+unsigned long FingerController::getWakeDelay() const {
+  long remaining = (long)(_servosReadyTime - millis());
+  return (remaining > 0) ? (unsigned long)remaining : 0;
+}
 
-  // Convertir angle en largeur d'impulsion (µs)
-  uint16_t pulse = map(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE,
-                       SERVO_PULSE_MIN, SERVO_PULSE_MAX);
+unsigned long FingerController::predictSettleTimeForNote(byte midiNote) {
+  int noteIndex = getNoteIndex(midiNote);
+  if (noteIndex < 0) {
+    return servoToSolenoidDelayMs();
+  }
 
-  // Convertir impulsion en valeur PWM pour PCA9685
-  // Formule: (pulse_µs / 1000000) * fréquence * 4096
-  float pulseDuration = (float)pulse / 1000000.0;
-  float pwmValue = pulseDuration * SERVO_FREQUENCY * 4096.0;
+  // Planification à blanc : courses + décalages imposés par le budget de courant
+  unsigned long startTimes[NUMBER_SERVOS_FINGER];
+  return schedulePattern(shadePattern(noteFingering(noteIndex)), millis(), startTimes, false);
+}
+
+uint16_t FingerController::calculateServoAngle(int fingerIndex, uint8_t position) const {
+  // Même calcul que Calibration_Tool (ServoFluteCore) : ouverture selon la
+  // position, dans le sens de rotation du doigt, bornée à 0-180°
+  return Actuation::Geometry::angle(fingerClosedAngle(fingerIndex), fingerDirection(fingerIndex),
+                                    position, fingerHalfAngle(fingerIndex),
+                                    fingerQuarterAngle(fingerIndex));
+}
+
+void FingerController::setServoAngle(int fingerIndex, uint16_t angle, unsigned long startTime) {
+  unsigned long now = millis();
+
+  #if SERVO_MOTION_PROFILE
+  if (_planner.isKnown(fingerIndex)) {
+    // Trajectoire : les positions intermédiaires sont envoyées par update()
+    _planner.moveTo(fingerIndex, angle * 10, startTime);
+    _lastFrameTime = now - SERVO_FRAME_MS;  // Première trame au prochain update()
+    return;
+  }
+  #else
+  (void)startTime;
+  #endif
+
+  // Position de départ inconnue (démarrage) ou profil désactivé : saut direct
+  _planner.jumpTo(fingerIndex, angle * 10, now);
+  writeServoPosition(fingerIndex, angle * 10);
+}
 
-  return (uint16_t)pwmValue;
+void FingerController::writeServoPosition(int fingerIndex, uint16_t angleDeci) {
+  // Canal PCA de la table FINGERS (configuration active)
+  _servos.setAngleDeci(fingerChannel(fingerIndex), angleDeci);
+  _writtenPosition[fingerIndex] = angleDeci;
 }
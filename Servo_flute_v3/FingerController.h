@@ -2,18 +2,20 @@
 #define FINGER_CONTROLLER_H
 
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
 #include "settings.h"
+#include "ServoMotionPlanner.h"
+#include "PowerBudget.h"
 
 class FingerController {
 public:
-  FingerController(Adafruit_PWMServoDriver& pwm);
+  FingerController(Actuation::Frame& servos, PowerBudget& power);
 
   // Initialise les servos en position fermée
   void begin();
 
-  // Applique un pattern de doigtés binaire (false=fermé, true=ouvert)
-  void setFingerPattern(const bool pattern[NUMBER_SERVOS_FINGER]);
+  // Applique un doigté compacté (2 bits/doigt : fermé/ouvert/demi/quart)
+  // Seuls les doigts dont la position change sont commandés
+  void setFingerPattern(FingerPattern pattern);
 
   // Applique un pattern pour une note MIDI spécifique
   void setFingerPatternForNote(byte midiNote);
@@ -24,17 +26,66 @@ public:
   // Ouvre tous les doigts
   void openAllFingers();
 
+  // Retourne le doigté actuellement commandé (ombrage compris)
+  FingerPattern getCurrentPattern() const;
+
+  // Ombrage du premier trou non fermé (pitch bend vers le bas)
+  // Le doigté en cours est recommandé si l'état change
+  void setShading(bool shading);
+
+  // Recommande le doigté en cours (angles FINGERS[] modifiés en direct)
+  void refreshPositions();
+
+  // Avance les trajectoires des doigts (appelé dans loop(), 1 trame PWM max)
+  void update();
+
+  // true si tous les doigts sont prévus en place (profil de mouvement)
+  bool isSettled() const;
+
+  // Alimentation servos rétablie : aucun départ avant readyTime
+  void setServoReadyTime(unsigned long readyTime);
+
+  // Temps restant (ms) avant que les servos ne soient opérationnels
+  unsigned long getWakeDelay() const;
+
+  // Durée prévue (ms) pour que les doigts atteignent le doigté d'une note
+  // depuis la position actuelle, décalages de budget de courant compris
+  // (0 si aucun doigt ne bouge)
+  unsigned long predictSettleTimeForNote(byte midiNote);
+
 private:
-  Adafruit_PWMServoDriver& _pwm;
+  Actuation::Frame& _servos;      // Trame PCA9685 de la flûte (partagée avec l'airflow)
+  PowerBudget& _power;            // Budget de courant partagé (alim commune)
+  FingerPattern _currentPattern;  // Dernier doigté envoyé aux servos
+  FingerPattern _basePattern;     // Doigté demandé (avant ombrage)
+  bool _shading;                  // Ombrage actif (pitch bend vers le bas)
+  ServoMotionPlanner _planner;    // Trajectoires et prédiction de stabilisation
+  unsigned long _lastFrameTime;   // Dernière trame de trajectoire envoyée
+  unsigned long _servosReadyTime; // Fin de reprise de position après réveil
+  uint16_t _writtenPosition[NUMBER_SERVOS_FINGER];  // Dernière position envoyée (1/10°)
+
+  // Calcule l'angle pour un servo donné selon sa position (FINGER_*)
+  uint16_t calculateServoAngle(int fingerIndex, uint8_t position) const;
+
+  // Doigté avec le premier trou non fermé ombré si l'ombrage est actif
+  FingerPattern shadePattern(FingerPattern pattern) const;
+
+  // Applique un doigté (force = commander aussi les doigts inchangés)
+  void applyPattern(FingerPattern pattern, bool force);
 
-  // Calcule l'angle pour un servo donné selon son état (false=fermé, true=ouvert)
-  uint16_t calculateServoAngle(int fingerIndex, bool isOpen);
+  // Planifie les départs des doigts vers un doigté (plus longues courses
+  // d'abord, décalage si budget de courant dépassé). commit = false :
+  // planification à blanc. Retourne la durée prévue jusqu'à stabilisation.
+  unsigned long schedulePattern(FingerPattern pattern, unsigned long now,
+                                unsigned long* startTimes, bool commit);
 
-  // Envoie une commande d'angle à un servo spécifique
-  void setServoAngle(int servoIndex, uint16_t angle);
+  // Commande un servo vers un angle à partir de startTime
+  // (trajectoire si SERVO_MOTION_PROFILE)
+  void setServoAngle(int servoIndex, uint16_t angle, unsigned long startTime);
 
-  // Convertit un angle en valeur PWM pour le PCA9685
-  uint16_t angleToPWM(uint16_t angle);
+  // Note une position (dixièmes de degré) dans la trame PCA9685
+  // (envoyée par lot au _servos.flush() suivant)
+  void writeServoPosition(int servoIndex, uint16_t angleDeci);
 };
 
 #endif
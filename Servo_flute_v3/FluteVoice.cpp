@@ -0,0 +1,136 @@
+#include "FluteVoice.h"
+
+FluteVoice::FluteVoice(const FluteConfig& config, PowerBudget& power)
+  : _config(config),
+    _pwm(Adafruit_PWMServoDriver(config.pcaAddress)),
+    _servos(config.pcaAddress),
+    _eventQueue(EVENT_QUEUE_SIZE),
+    _notes(HELD_NOTE_STACK_SIZE, HELD_NOTE_PRIORITY),
+    _fingerCtrl(_servos, power),
+    _airflowCtrl(_servos, config.solenoidPin, power),
+    _sequencer(_eventQueue, _fingerCtrl, _airflowCtrl) {
+}
+
+void FluteVoice::begin() {
+  if (DEBUG) {
+    Serial.print("DEBUG: FluteVoice - Initialisation PCA9685 @0x");
+    Serial.println(_config.pcaAddress, HEX);
+  }
+
+  // Initialiser le PCA9685 de cette flûte
+  _pwm.begin();
+  _pwm.setPWMFreq(SERVO_FREQUENCY);
+
+  // Vérifier la communication I2C
+  delay(10);
+
+  // Initialiser les contrôleurs
+  _fingerCtrl.begin();
+  _airflowCtrl.begin();
+
+  // Initialiser le séquenceur
+  _sequencer.begin();
+}
+
+void FluteVoice::update() {
+  // Avancer les trajectoires des doigts (une trame PWM max)
+  _fingerCtrl.update();
+
+  // Mettre à jour le séquenceur (state machine)
+  _sequencer.update();
+
+  // Mettre à jour le contrôleur d'air (gestion PWM solénoïde)
+  _airflowCtrl.update();
+}
+
+bool FluteVoice::noteOn(byte midiNote, byte velocity, unsigned long time) {
+  NoteChange change;
+  _notes.press(midiNote, velocity, change);
+  return queueChange(change, time);
+}
+
+bool FluteVoice::noteOff(byte midiNote, unsigned long time) {
+  NoteChange change;
+  _notes.release(midiNote, change);
+  return queueChange(change, time);
+}
+
+bool FluteVoice::queueChange(const NoteChange& change, unsigned long time) {
+  if (change.offNote == 0 && change.onNote == 0) {
+    return true;  // Tenue ou relâchement sans effet sur la note qui sonne
+  }
+
+  bool success = true;
+  if (change.offNote != 0) {
+    success = _eventQueue.enqueue(EVENT_NOTE_OFF, change.offNote, 0, time);
+  }
+  if (change.onNote != 0) {
+    success = _eventQueue.enqueue(EVENT_NOTE_ON, change.onNote, change.onVelocity, time) && success;
+  }
+
+  #if TELEMETRY_ENABLED
+  telemetry.eventQueueDepth(_eventQueue.getCount());
+  #endif
+  return success;
+}
+
+bool FluteVoice::isBusy() const {
+  // Trajectoire en cours (ex. fermeture après All Sound Off) : garder l'alimentation
+  return !_eventQueue.isEmpty() || _sequencer.getState() != STATE_IDLE || !_fingerCtrl.isSettled();
+}
+
+bool FluteVoice::isBetweenNotes() const {
+  return _sequencer.getState() == STATE_IDLE && _fingerCtrl.isSettled();
+}
+
+void FluteVoice::reloadConfig() {
+  _fingerCtrl.refreshPositions();
+}
+
+void FluteVoice::allSoundOff() {
+  // Vider la queue d'événements et oublier les notes tenues
+  _eventQueue.clear();
+  _notes.clear();
+
+  // Stopper le séquenceur
+  _sequencer.stop();
+
+  // Fermer la valve et mettre airflow au repos
+  _airflowCtrl.closeSolenoid();
+  _airflowCtrl.setAirflowToRest();
+
+  // Mettre tous les servos doigts en position repos (tous fermés)
+  _fingerCtrl.closeAllFingers();
+}
+
+void FluteVoice::setCCValues(byte ccVolume, byte ccExpression, byte ccModulation) {
+  _airflowCtrl.setCCValues(ccVolume, ccExpression, ccModulation);
+}
+
+void FluteVoice::updateCC2Breath(byte ccBreath) {
+  _airflowCtrl.updateCC2Breath(ccBreath);
+}
+
+bool FluteVoice::settleCC2Breath() {
+  return _airflowCtrl.settleCC2Breath();
+}
+
+void FluteVoice::setPitchBend(int16_t pitchBend) {
+  _airflowCtrl.setPitchBend(pitchBend);
+
+  #if PITCH_BEND_SHADING_ENABLED
+  _fingerCtrl.setShading(pitchBend <= -PITCH_BEND_SHADING_THRESHOLD);
+  #endif
+}
+
+void FluteVoice::applyControlChanges() {
+  _airflowCtrl.applyControlChanges();
+}
+
+void FluteVoice::notifyServoWake(unsigned long readyTime) {
+  _fingerCtrl.setServoReadyTime(readyTime);
+}
+
+NoteSequencer& FluteVoice::getSequencer() {
+  return _sequencer;
+}
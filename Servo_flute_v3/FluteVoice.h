@@ -0,0 +1,89 @@
+#ifndef FLUTE_VOICE_H
+#define FLUTE_VOICE_H
+
+#include <Arduino.h>
+#include <Adafruit_PWMServoDriver.h>
+#include "EventQueue.h"
+#include "FingerController.h"
+#include "AirflowController.h"
+#include "NoteSequencer.h"
+#include "PowerBudget.h"
+#include "NoteArbiter.h"
+#include "Telemetry.h"
+#include "settings.h"
+
+// Une flûte physique : carte PCA9685 + doigts + airflow + séquenceur
+// Mode ensemble : InstrumentManager possède NUMBER_FLUTES voix
+class FluteVoice {
+public:
+  FluteVoice(const FluteConfig& config, PowerBudget& power);
+
+  // Initialise la carte PCA9685 et les contrôleurs
+  void begin();
+
+  // Méthode update appelée dans loop() (trajectoires doigts + séquenceur + PWM solénoïde)
+  void update();
+
+  // Touche enfoncée : ajoute Note Off/On à la queue si la note qui sonne change
+  // (priorité HELD_NOTE_PRIORITY) ; même note : re-déclenchement (Note Off puis On)
+  bool noteOn(byte midiNote, byte velocity, unsigned long time);
+
+  // Touche relâchée : si c'était la note qui sonne, Note Off puis reprise de
+  // la note tenue prioritaire (Note On), sinon rien à jouer
+  bool noteOff(byte midiNote, unsigned long time);
+
+  // Note tenue par cette flûte (qu'elle sonne ou non)
+  bool isHolding(byte midiNote) const { return _notes.isHolding(midiNote); }
+
+  // Note qui sonne (dernière envoyée au séquenceur, 0 = silence)
+  byte getSoundingNote() const { return _notes.getSoundingNote(); }
+
+  // Retourne true si la flûte joue ou a des événements en attente
+  bool isBusy() const;
+
+  // Retourne true si aucune note n'est en cours (séquenceur au repos, doigts en place)
+  bool isBetweenNotes() const;
+
+  // Configuration en direct échangée : doigts recommandés aux nouveaux angles
+  void reloadConfig();
+
+  // Coupe immédiatement le son (All Sound Off)
+  void allSoundOff();
+
+  // Transmet les valeurs CC à l'AirflowController
+  void setCCValues(byte ccVolume, byte ccExpression, byte ccModulation);
+
+  // Transmet CC2 (Breath Controller) à l'AirflowController
+  void updateCC2Breath(byte ccBreath);
+
+  // Période sans CC2 : lissage vers la dernière valeur (true si le souffle a bougé)
+  bool settleCC2Breath();
+
+  // Pitch bend (-8192 à +8191) : airflow de la note et ombrage d'un trou
+  void setPitchBend(int16_t pitchBend);
+
+  // Applique les CC à la note en cours (débit recalculé)
+  void applyControlChanges();
+
+  // Alimentation servos rétablie : servos opérationnels à readyTime
+  void notifyServoWake(unsigned long readyTime);
+
+  NoteSequencer& getSequencer();
+
+private:
+  const FluteConfig& _config;
+  Adafruit_PWMServoDriver _pwm;     // Initialisation du PCA9685 (fréquence)
+  Actuation::Frame _servos;         // Sorties servos, écrites par lots
+  EventQueue _eventQueue;
+  NoteArbiter _notes;               // Touches enfoncées attribuées à cette flûte, note qui sonne
+  static_assert(HELD_NOTE_STACK_SIZE >= 2 && HELD_NOTE_STACK_SIZE < 255,
+                "HELD_NOTE_STACK_SIZE : 2 à 254 (pile pleine : une note autre que celle qui sonne est oubliée)");
+  FingerController _fingerCtrl;
+  AirflowController _airflowCtrl;
+  NoteSequencer _sequencer;
+
+  // Met en queue les événements d'une touche (Note Off puis Note On)
+  bool queueChange(const NoteChange& change, unsigned long time);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "HeldNoteStack.h"
+
+HeldNoteStack::HeldNoteStack(uint8_t capacity)
+  : _capacity(capacity) {
+  _entries = new Entry[capacity];
+  clear();
+}
+
+void HeldNoteStack::clear() {
+  _newest = NONE;
+  _oldest = NONE;
+  _count = 0;
+
+  // Toutes les entrées dans la liste libre
+  for (uint8_t i = 0; i < _capacity; i++) {
+    _entries[i].older = (i + 1 < _capacity) ? i + 1 : NONE;
+  }
+  _free = 0;
+}
+
+void HeldNoteStack::press(uint8_t midiNote, uint8_t velocity, uint8_t keepNote) {
+  uint8_t index = find(midiNote);
+
+  if (index != NONE) {
+    unlink(index);                 // Re-déclenchement : remonte au sommet
+  } else if (_free != NONE) {
+    index = _free;
+    _free = _entries[index].older;
+  } else {
+    index = _oldest;               // Pile pleine : la plus ancienne est oubliée,
+    if (_entries[index].midiNote == keepNote && _entries[index].newer != NONE) {
+      index = _entries[index].newer;  // sauf la note qui sonne (elle resterait bloquée)
+    }
+    unlink(index);
+  }
+
+  _entries[index].midiNote = midiNote;
+  _entries[index].velocity = velocity;
+  _entries[index].older = _newest;
+  _entries[index].newer = NONE;
+  if (_newest != NONE) {
+    _entries[_newest].newer = index;
+  } else {
+    _oldest = index;
+  }
+  _newest = index;
+  _count++;
+}
+
+bool HeldNoteStack::release(uint8_t midiNote) {
+  uint8_t index = find(midiNote);
+  if (index == NONE) {
+    return false;
+  }
+
+  unlink(index);
+  _entries[index].older = _free;
+  _free = index;
+  return true;
+}
+
+bool HeldNoteStack::contains(uint8_t midiNote) const {
+  return find(midiNote) != NONE;
+}
+
+uint8_t HeldNoteStack::select(NotePriority priority, uint8_t& velocity) const {
+  if (_newest == NONE) {
+    velocity = 0;
+    return 0;
+  }
+
+  uint8_t best = _newest;
+  if (priority != NOTE_PRIORITY_LAST) {
+    // Une entrée par note : jamais d'égalité
+    for (uint8_t i = _entries[_newest].older; i != NONE; i = _entries[i].older) {
+      bool higher = _entries[i].midiNote > _entries[best].midiNote;
+      if (higher == (priority == NOTE_PRIORITY_HIGH)) {
+        best = i;
+      }
+    }
+  }
+
+  velocity = _entries[best].velocity;
+  return _entries[best].midiNote;
+}
+
+uint8_t HeldNoteStack::find(uint8_t midiNote) const {
+  for (uint8_t i = _newest; i != NONE; i = _entries[i].older) {
+    if (_entries[i].midiNote == midiNote) {
+      return i;
+    }
+  }
+  return NONE;
+}
+
+void HeldNoteStack::unlink(uint8_t index) {
+  const Entry& entry = _entries[index];
+
+  if (entry.newer != NONE) {
+    _entries[entry.newer].older = entry.older;
+  } else {
+    _newest = entry.older;
+  }
+  if (entry.older != NONE) {
+    _entries[entry.older].newer = entry.newer;
+  } else {
+    _oldest = entry.newer;
+  }
+  _count--;
+}
@@ -0,0 +1,63 @@
+#ifndef HELD_NOTE_STACK_H
+#define HELD_NOTE_STACK_H
+
+#include <stdint.h>  // Indépendant du matériel : compilé sur PC par tools/note_arbiter_check.cpp
+
+// Priorité de la note qui sonne parmi les notes tenues
+enum NotePriority {
+  NOTE_PRIORITY_LAST,   // Dernière enfoncée
+  NOTE_PRIORITY_HIGH,   // Plus aiguë
+  NOTE_PRIORITY_LOW     // Plus grave
+};
+
+// Pile des notes tenues d'une flûte (touches enfoncées, de la plus récente à
+// la plus ancienne). Liste doublement chaînée dans un tableau fixe : enfoncer,
+// retirer et lire le sommet sans décaler d'éléments ; la recherche d'une note
+// (relâchement) et les priorités aiguë/grave parcourent au plus capacity
+// entrées. 4 octets par entrée + 7 octets (AVR).
+class HeldNoteStack {
+public:
+  HeldNoteStack(uint8_t capacity);
+
+  // Note enfoncée (déjà tenue : remontée au sommet, vélocité mise à jour)
+  // Pile pleine : la plus ancienne est oubliée, sauf keepNote (note qui
+  // sonne) : c'est alors la suivante
+  void press(uint8_t midiNote, uint8_t velocity, uint8_t keepNote = 0);
+
+  // Note relâchée (false si elle n'était pas tenue)
+  bool release(uint8_t midiNote);
+
+  // Note tenue ?
+  bool contains(uint8_t midiNote) const;
+
+  // Note à faire sonner selon la priorité (0 = aucune), avec sa vélocité
+  uint8_t select(NotePriority priority, uint8_t& velocity) const;
+
+  bool isEmpty() const { return _count == 0; }
+  uint8_t getCount() const { return _count; }
+
+  // Oublie toutes les notes (All Sound Off)
+  void clear();
+
+private:
+  static const uint8_t NONE = 0xFF;
+
+  struct Entry {
+    uint8_t midiNote;
+    uint8_t velocity;
+    uint8_t older;    // Entrée enfoncée juste avant (NONE = la plus ancienne)
+    uint8_t newer;    // Entrée enfoncée juste après (NONE = sommet)
+  };
+
+  Entry* _entries;
+  uint8_t _capacity;
+  uint8_t _newest;    // Sommet de la pile
+  uint8_t _oldest;
+  uint8_t _free;      // Entrées libres, chaînées par older
+  uint8_t _count;
+
+  uint8_t find(uint8_t midiNote) const;
+  void unlink(uint8_t index);
+};
+
+#endif
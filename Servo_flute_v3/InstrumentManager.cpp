@@ -1,23 +1,31 @@
 #include "InstrumentManager.h"
 
+// Registres CC modifiés depuis la dernière période de contrôle
+#define CC_DIRTY_MODULATION 0x01
+#define CC_DIRTY_BREATH     0x02
+#define CC_DIRTY_VOLUME     0x04
+#define CC_DIRTY_EXPRESSION 0x08
+#define CC_DIRTY_PITCH_BEND 0x10
+
 InstrumentManager::InstrumentManager()
-  : _pwm(Adafruit_PWMServoDriver()),
-    _eventQueue(EVENT_QUEUE_SIZE),
-    _fingerCtrl(_pwm),
-    _airflowCtrl(_pwm),
-    _sequencer(_eventQueue, _fingerCtrl, _airflowCtrl),
-    _lastActivityTime(0),
+  : _lastActivityTime(0),
     _servosPowered(false),
+    _powerStateSince(0),
+    _servoPoweredTime(0),
+    _servoGatedTime(0),
+    _servoWakeCount(0),
     _ccVolume(CC_VOLUME_DEFAULT),
     _ccExpression(CC_EXPRESSION_DEFAULT),
     _ccModulation(CC_MODULATION_DEFAULT),
     _ccBreath(CC_BREATH_DEFAULT),
     _ccBrightness(CC_BRIGHTNESS_DEFAULT),
-    _lastCCTime(0),
-    _ccCount(0),
-    _ccWindowStart(0),
-    _cc2Count(0),
-    _cc2WindowStart(0) {
+    _pitchBend(0),
+    _ccDirty(0),
+    _lastCCApplyTime(0) {
+  // Une voix par flûte (carte PCA9685 + solénoïde dédiés)
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v] = new FluteVoice(FLUTES[v], _power);
+  }
 }
 
 void InstrumentManager::begin() {
@@ -27,24 +35,19 @@ void InstrumentManager::begin() {
 
   // Configurer le pin de contrôle d'alimentation des servos
   pinMode(PIN_SERVOS_OFF, OUTPUT);
+  _powerStateSince = millis();
   powerOnServos();
 
-  // Initialiser le PCA9685
-  _pwm.begin();
-  _pwm.setPWMFreq(SERVO_FREQUENCY);
-
-  // Vérifier la communication I2C
-  delay(10);
-
-  // Initialiser les contrôleurs
-  _fingerCtrl.begin();
-  _airflowCtrl.begin();
+  // Construire la table de transposition/repli des notes
+  _remapper.begin();
 
-  // Initialiser les valeurs CC dans AirflowController
-  _airflowCtrl.setCCValues(_ccVolume, _ccExpression, _ccModulation);
+  // Initialiser chaque flûte (PCA9685, contrôleurs, séquenceur)
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v]->begin();
+  }
 
-  // Initialiser le séquenceur
-  _sequencer.begin();
+  // Initialiser les valeurs CC dans les AirflowController
+  applyCCToVoices();
 
   _lastActivityTime = millis();
 
@@ -54,19 +57,36 @@ void InstrumentManager::begin() {
 }
 
 void InstrumentManager::update() {
-  // Mettre à jour le séquenceur (state machine)
-  _sequencer.update();
+  // Mettre à jour chaque flûte (state machine + PWM solénoïde)
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v]->update();
+  }
+
+  // Appliquer les derniers CC reçus (cadence fixe)
+  if (millis() - _lastCCApplyTime >= CC_CONTROL_PERIOD_MS) {
+    _lastCCApplyTime = millis();
+    applyPendingCC();
+  }
+
+  #if LIVE_CONFIG_ENABLED
+  // Configuration SysEx validée : échange entre deux notes uniquement
+  if (configStore.isSwapPending() && areVoicesBetweenNotes()) {
+    applyLiveConfig();
+  }
+  #endif
 
-  // Mettre à jour le contrôleur d'air (gestion PWM solénoïde)
-  _airflowCtrl.update();
+  // Statistiques du budget de courant (pic estimé, dépassements)
+  _power.update();
 
   // Gérer l'alimentation des servos
   managePower();
 }
 
-void InstrumentManager::noteOn(byte midiNote, byte velocity) {
-  // Vérifier si la note est jouable
-  if (!isNotePlayable(midiNote)) {
+void InstrumentManager::noteOn(byte channel, byte midiNote, byte velocity, unsigned long arrivalMs) {
+  // Transposition + repli d'octave + substitution (une lecture de table),
+  // note jouée mémorisée pour le Note Off de cette touche
+  byte playedNote = _remapper.press(channel, midiNote);
+  if (playedNote == 0) {
     if (DEBUG) {
       Serial.print("DEBUG: InstrumentManager - Note hors plage: ");
       Serial.println(midiNote);
@@ -74,13 +94,37 @@ void InstrumentManager::noteOn(byte midiNote, byte velocity) {
     return;
   }
 
-  // Ajouter l'événement à la queue avec timestamp actuel
-  bool success = _eventQueue.enqueue(EVENT_NOTE_ON, midiNote, velocity, millis());
+  if (DEBUG && playedNote != midiNote) {
+    Serial.print("DEBUG: InstrumentManager - Note ");
+    Serial.print(midiNote);
+    Serial.print(" remplacée par ");
+    Serial.println(playedNote);
+  }
+  midiNote = playedNote;
+
+  // Note déjà tenue (même sans sonner) : même flûte, sinon la moins de
+  // servos à déplacer. Flûte volée : sa note reste tenue dans sa pile et
+  // reprend au relâchement de la nouvelle (HeldNoteStack)
+  int voice = findHoldingVoice(midiNote);
+  if (voice < 0) {
+    byte stolenNote = 0;
+    voice = _allocator.allocate(midiNote, stolenNote);
+  }
+
+  // Alimenter les servos avant que le séquenceur ne les commande
+  wakeServos();
+
+  // Ajouter la touche à la flûte (événements datés à l'arrivée du message)
+  bool success = _voices[voice]->noteOn(midiNote, velocity, arrivalMs);
+  _allocator.assign(voice, _voices[voice]->getSoundingNote());
 
   if (!success) {
     if (DEBUG) {
       Serial.println("ERREUR: InstrumentManager - Queue pleine, événement perdu!");
     }
+    #if TELEMETRY_ENABLED
+    telemetry.eventDropped();
+    #endif
   } else {
     if (DEBUG) {
       Serial.print("DEBUG: InstrumentManager - Note On ajoutée: ");
@@ -95,14 +139,46 @@ void InstrumentManager::noteOn(byte midiNote, byte velocity) {
   _lastActivityTime = millis();
 }
 
-void InstrumentManager::noteOff(byte midiNote) {
-  // Ajouter l'événement à la queue avec timestamp actuel
-  bool success = _eventQueue.enqueue(EVENT_NOTE_OFF, midiNote, 0, millis());
+void InstrumentManager::noteOff(byte channel, byte midiNote, unsigned long arrivalMs) {
+  // Note jouée au Note On de cette touche (transposition, repli ou profil
+  // ont pu changer depuis)
+  bool shared;
+  midiNote = _remapper.release(channel, midiNote, shared);
+  if (midiNote == 0) {
+    return;
+  }
+
+  // Autre touche repliée sur la même note encore enfoncée : la note continue
+  if (shared) {
+    if (DEBUG) {
+      Serial.print("DEBUG: InstrumentManager - Note Off ignorée (note encore tenue par une autre touche): ");
+      Serial.println(midiNote);
+    }
+    return;
+  }
+
+  // Retrouver la flûte qui tient cette note (qu'elle sonne ou non)
+  int voice = findHoldingVoice(midiNote);
+  if (voice < 0) {
+    if (DEBUG) {
+      Serial.print("DEBUG: InstrumentManager - Note Off ignorée (non tenue): ");
+      Serial.println(midiNote);
+    }
+    return;
+  }
+
+  // Relâcher la touche (Note Off, puis reprise d'une note encore tenue)
+  wakeServos();
+  bool success = _voices[voice]->noteOff(midiNote, arrivalMs);
+  _allocator.assign(voice, _voices[voice]->getSoundingNote());
 
   if (!success) {
     if (DEBUG) {
       Serial.println("ERREUR: InstrumentManager - Queue pleine, événement perdu!");
     }
+    #if TELEMETRY_ENABLED
+    telemetry.eventDropped();
+    #endif
   } else {
     if (DEBUG) {
       Serial.print("DEBUG: InstrumentManager - Note Off ajoutée: ");
@@ -114,18 +190,127 @@ void InstrumentManager::noteOff(byte midiNote) {
   _lastActivityTime = millis();
 }
 
+int InstrumentManager::findHoldingVoice(byte midiNote) const {
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    if (_voices[v]->isHolding(midiNote)) {
+      return v;
+    }
+  }
+  return -1;
+}
+
 bool InstrumentManager::isNotePlayable(byte midiNote) const {
   // Vérifier si la note existe dans le tableau NOTES
-  return (getNoteByMidi(midiNote) != nullptr);
+  return (getNoteIndex(midiNote) >= 0);
 }
 
 NoteSequencer& InstrumentManager::getSequencer() {
-  return _sequencer;
+  return _voices[0]->getSequencer();
+}
+
+FluteVoice& InstrumentManager::getVoice(int index) {
+  return *_voices[index];
+}
+
+PowerBudget& InstrumentManager::getPowerBudget() {
+  return _power;
+}
+
+bool InstrumentManager::isAnyVoiceBusy() const {
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    if (_voices[v]->isBusy()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#if LIVE_CONFIG_ENABLED
+bool InstrumentManager::areVoicesBetweenNotes() const {
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    if (!_voices[v]->isBetweenNotes()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void InstrumentManager::applyLiveConfig() {
+  configStore.swap();
+
+  // Notes jouables changées : reconstruire la table de correspondance
+  _remapper.begin();
+
+  // Angles des doigts changés : recommander le doigté en cours
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v]->reloadConfig();
+  }
+}
+#endif
+
+void InstrumentManager::applyCCToVoices() {
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v]->setCCValues(_ccVolume, _ccExpression, _ccModulation);
+  }
+}
+
+unsigned long InstrumentManager::getServoPoweredTime() const {
+  unsigned long total = _servoPoweredTime;
+  if (_servosPowered) {
+    total += millis() - _powerStateSince;
+  }
+  return total;
+}
+
+unsigned long InstrumentManager::getServoGatedTime() const {
+  unsigned long total = _servoGatedTime;
+  if (!_servosPowered) {
+    total += millis() - _powerStateSince;
+  }
+  return total;
+}
+
+void InstrumentManager::wakeServos() {
+  if (!_servosPowered) {
+    powerOnServos();
+  }
+  _lastActivityTime = millis();
+}
+
+void InstrumentManager::applyPendingCC() {
+  if (_ccDirty & (CC_DIRTY_MODULATION | CC_DIRTY_VOLUME | CC_DIRTY_EXPRESSION)) {
+    applyCCToVoices();
+  }
+
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    bool changed = (_ccDirty != 0);
+
+    // CC2 : un échantillon par période de contrôle dans le buffer de lissage ;
+    // sans nouvelle valeur, la dernière y est recopiée jusqu'à ce que la
+    // moyenne l'atteigne (fin de balayage rapide : souffle coupé appliqué)
+    if (_ccDirty & CC_DIRTY_BREATH) {
+      _voices[v]->updateCC2Breath(_ccBreath);
+    } else if (_voices[v]->settleCC2Breath()) {
+      changed = true;
+    }
+
+    // Pitch bend : décalage airflow + ombrage éventuel d'un trou
+    if (_ccDirty & CC_DIRTY_PITCH_BEND) {
+      _voices[v]->setPitchBend(_pitchBend);
+    }
+
+    // Recalculer le débit de la note en cours avec les nouvelles valeurs
+    if (changed) {
+      _voices[v]->applyControlChanges();
+    }
+  }
+
+  _ccDirty = 0;
 }
 
 void InstrumentManager::managePower() {
-  // Si le séquenceur joue une note, garder l'alimentation
-  if (_sequencer.isPlaying() || _sequencer.getState() != STATE_IDLE) {
+  // Si une flûte joue une note ou a des événements en attente, garder l'alimentation
+  if (isAnyVoiceBusy()) {
     if (!_servosPowered) {
       powerOnServos();
     }
@@ -140,8 +325,18 @@ void InstrumentManager::managePower() {
 }
 
 void InstrumentManager::powerOnServos() {
+  unsigned long now = millis();
   digitalWrite(PIN_SERVOS_OFF, LOW);  // OE à LOW = servos activés
+  _servoGatedTime += now - _powerStateSince;
+  _powerStateSince = now;
   _servosPowered = true;
+  _servoWakeCount++;
+
+  // Les servos reprennent leur position pendant SERVO_RELOCK_MS :
+  // les doigts ne partent qu'ensuite (latence incluse dans l'anticipation)
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v]->notifyServoWake(now + SERVO_RELOCK_MS);
+  }
 
   if (DEBUG) {
     Serial.println("DEBUG: InstrumentManager - Servos ACTIVÉS");
@@ -149,15 +344,23 @@ void InstrumentManager::powerOnServos() {
 }
 
 void InstrumentManager::powerOffServos() {
+  unsigned long now = millis();
   digitalWrite(PIN_SERVOS_OFF, HIGH);  // OE à HIGH = servos désactivés
+  _servoPoweredTime += now - _powerStateSince;
+  _powerStateSince = now;
   _servosPowered = false;
 
   if (DEBUG) {
-    Serial.println("DEBUG: InstrumentManager - Servos DÉSACTIVÉS (anti-bruit)");
+    Serial.print("DEBUG: InstrumentManager - Servos DÉSACTIVÉS (anti-bruit) | Alimentés: ");
+    Serial.print(_servoPoweredTime);
+    Serial.print("ms | Coupés: ");
+    Serial.print(_servoGatedTime);
+    Serial.print("ms | Réveils: ");
+    Serial.println(_servoWakeCount);
   }
 }
 
-void InstrumentManager::handleControlChange(byte ccNumber, byte ccValue) {
+void InstrumentManager::handleControlChange(byte channel, byte ccNumber, byte ccValue) {
   // Validation sécurité: ccValue doit être dans [0, 127]
   if (ccValue > 127) {
     if (DEBUG) {
@@ -167,53 +370,19 @@ void InstrumentManager::handleControlChange(byte ccNumber, byte ccValue) {
     return;  // Ignorer message invalide
   }
 
-  // Rate limiting: Maximum CC_RATE_LIMIT_PER_SECOND CC par seconde
-  // CC2 (Breath Controller) a son propre rate limit plus élevé (CC2_RATE_LIMIT_PER_SECOND)
-  unsigned long currentTime = millis();
-
-  // Rate limiting pour CC2 (Breath Controller) - limite séparée haute fréquence
-  if (ccNumber == 2) {
-    #if CC2_ENABLED
-    // Réinitialiser compteur CC2 si nouvelle fenêtre
-    if (currentTime - _cc2WindowStart >= 1000) {
-      _cc2WindowStart = currentTime;
-      _cc2Count = 0;
-    }
-
-    _cc2Count++;
-    if (_cc2Count > CC2_RATE_LIMIT_PER_SECOND) {
-      if (DEBUG) {
-        Serial.println("ATTENTION: Rate limit CC2 dépassé, message ignoré");
-      }
-      return;  // Ignorer si rate limit CC2 dépassé
-    }
-    #endif
-  } else {
-    // Rate limiting normal pour autres CC
-    // Réinitialiser le compteur si nouvelle fenêtre d'une seconde
-    if (currentTime - _ccWindowStart >= 1000) {
-      _ccWindowStart = currentTime;
-      _ccCount = 0;
-    }
-
-    // Vérifier le rate limit (sauf pour CC urgents: 120, 121, 123)
-    if (ccNumber != 120 && ccNumber != 121 && ccNumber != 123) {
-      _ccCount++;
-      if (_ccCount > CC_RATE_LIMIT_PER_SECOND) {
-        if (DEBUG) {
-          Serial.println("ATTENTION: Rate limit CC dépassé, message ignoré");
-        }
-        return;  // Ignorer si rate limit dépassé
-      }
-    }
+  // Configuration par canal (RPN transposition, repli) : jamais limitée
+  // (une séquence RPN incomplète laisserait le canal dans un état incohérent)
+  if (_remapper.handleControlChange(channel, ccNumber, ccValue)) {
+    return;
   }
 
-  _lastCCTime = currentTime;
-
+  // CC continus : la valeur est seulement mémorisée (dernière valeur gagnante),
+  // applyPendingCC() l'applique à la prochaine période de contrôle.
+  // CC urgents (120, 121, 123) : exécutés immédiatement.
   switch (ccNumber) {
     case 1:  // Modulation (Vibrato)
       _ccModulation = ccValue;
-      _airflowCtrl.setCCValues(_ccVolume, _ccExpression, _ccModulation);
+      _ccDirty |= CC_DIRTY_MODULATION;
       if (DEBUG) {
         Serial.print("DEBUG: CC 1 (Modulation) = ");
         Serial.println(ccValue);
@@ -223,7 +392,9 @@ void InstrumentManager::handleControlChange(byte ccNumber, byte ccValue) {
     case 2:  // Breath Controller
       _ccBreath = ccValue;
       // CC2 remplace velocity pour contrôle dynamique du souffle en temps réel
-      _airflowCtrl.updateCC2Breath(ccValue);
+      #if CC2_ENABLED
+      _ccDirty |= CC_DIRTY_BREATH;
+      #endif
       if (DEBUG) {
         Serial.print("DEBUG: CC 2 (Breath Controller) = ");
         Serial.println(ccValue);
@@ -232,7 +403,7 @@ void InstrumentManager::handleControlChange(byte ccNumber, byte ccValue) {
 
     case 7:  // Volume
       _ccVolume = ccValue;
-      _airflowCtrl.setCCValues(_ccVolume, _ccExpression, _ccModulation);
+      _ccDirty |= CC_DIRTY_VOLUME;
       if (DEBUG) {
         Serial.print("DEBUG: CC 7 (Volume) = ");
         Serial.println(ccValue);
@@ -241,7 +412,7 @@ void InstrumentManager::handleControlChange(byte ccNumber, byte ccValue) {
 
     case 11: // Expression
       _ccExpression = ccValue;
-      _airflowCtrl.setCCValues(_ccVolume, _ccExpression, _ccModulation);
+      _ccDirty |= CC_DIRTY_EXPRESSION;
       if (DEBUG) {
         Serial.print("DEBUG: CC 11 (Expression) = ");
         Serial.println(ccValue);
@@ -285,21 +456,66 @@ void InstrumentManager::handleControlChange(byte ccNumber, byte ccValue) {
   }
 }
 
-void InstrumentManager::allSoundOff() {
-  // Vider la queue d'événements
-  while (!_eventQueue.isEmpty()) {
-    _eventQueue.dequeue();
+void InstrumentManager::handlePitchBend(byte channel, int16_t pitchBend) {
+  (void)channel;  // Filtrage canal fait par MidiHandler
+
+  #if PITCH_BEND_ENABLED
+  // Dernière valeur gagnante, appliquée à la prochaine période de contrôle
+  _pitchBend = pitchBend;
+  _ccDirty |= CC_DIRTY_PITCH_BEND;
+
+  if (DEBUG) {
+    Serial.print("DEBUG: Pitch Bend = ");
+    Serial.println(pitchBend);
+  }
+  #else
+  (void)pitchBend;
+  #endif
+}
+
+void InstrumentManager::handleChannelPressure(byte channel, byte pressure) {
+  (void)channel;  // Filtrage canal fait par MidiHandler
+
+  #if CC2_ENABLED && CHANNEL_PRESSURE_AS_BREATH
+  // Même registre que CC2 : lissage, seuil de silence et timeout partagés
+  _ccBreath = pressure;
+  _ccDirty |= CC_DIRTY_BREATH;
+
+  if (DEBUG) {
+    Serial.print("DEBUG: Channel Pressure (Breath) = ");
+    Serial.println(pressure);
   }
+  #else
+  (void)pressure;
+  #endif
+}
+
+void InstrumentManager::handleProgramChange(byte channel, byte program) {
+  (void)channel;  // Filtrage canal fait par MidiHandler
 
-  // Stopper le séquenceur
-  _sequencer.stop();
+  #if LIVE_CONFIG_ENABLED && PROGRAM_CHANGE_SELECTS_PROFILE
+  // Profil lu et vérifié tout de suite, échangé dans update() au prochain silence
+  ConfigStatus status = configStore.selectProfile(program);
 
-  // Fermer la valve et mettre airflow au repos
-  _airflowCtrl.closeSolenoid();
-  _airflowCtrl.setAirflowToRest();
+  if (DEBUG) {
+    Serial.print("DEBUG: Program Change ");
+    Serial.print(program);
+    Serial.println(status == CONFIG_OK ? " -> profil en attente" : " ignoré (profil absent ou invalide)");
+  }
+  #else
+  (void)program;
+  #endif
+}
 
-  // Mettre tous les servos doigts en position repos (tous fermés)
-  _fingerCtrl.closeAllFingers();
+void InstrumentManager::allSoundOff() {
+  // Vider les queues, fermer les valves, doigts au repos (toutes les flûtes)
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _voices[v]->allSoundOff();
+  }
+
+  // Plus aucune note tenue
+  _allocator.reset();
+  _remapper.clearKeys();
 
   if (DEBUG) {
     Serial.println("DEBUG: InstrumentManager - All Sound Off exécuté");
@@ -313,9 +529,13 @@ void InstrumentManager::resetAllControllers() {
   _ccModulation = CC_MODULATION_DEFAULT;
   _ccBreath = CC_BREATH_DEFAULT;
   _ccBrightness = CC_BRIGHTNESS_DEFAULT;
+  _pitchBend = 0;
+
+  // Mettre à jour les AirflowController à la prochaine période de contrôle
+  _ccDirty = CC_DIRTY_MODULATION | CC_DIRTY_VOLUME | CC_DIRTY_EXPRESSION | CC_DIRTY_PITCH_BEND;
 
-  // Mettre à jour l'AirflowController
-  _airflowCtrl.setCCValues(_ccVolume, _ccExpression, _ccModulation);
+  // Transposition et repli par défaut sur tous les canaux
+  _remapper.reset();
 
   if (DEBUG) {
     Serial.println("DEBUG: InstrumentManager - Reset All Controllers exécuté");
@@ -2,11 +2,11 @@
 #define INSTRUMENT_MANAGER_H
 
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
-#include "EventQueue.h"
-#include "FingerController.h"
-#include "AirflowController.h"
-#include "NoteSequencer.h"
+#include "FluteVoice.h"
+#include "VoiceAllocator.h"
+#include "NoteRemapper.h"
+#include "PowerBudget.h"
+#include "ConfigStore.h"
 #include "settings.h"
 
 class InstrumentManager {
@@ -19,20 +19,41 @@ public:
   // Méthode update appelée dans loop()
   void update();
 
-  // Ajoute un événement Note On à la queue
-  void noteOn(byte midiNote, byte velocity);
+  // Ajoute un événement Note On à la queue (note transposée/repliée)
+  // arrivalMs : heure de réception du message MIDI (millis())
+  void noteOn(byte channel, byte midiNote, byte velocity, unsigned long arrivalMs);
 
-  // Ajoute un événement Note Off à la queue
-  void noteOff(byte midiNote);
+  // Ajoute un événement Note Off à la queue (note jouée au Note On de la touche)
+  void noteOff(byte channel, byte midiNote, unsigned long arrivalMs);
 
   // Vérifie si une note est dans la plage jouable
   bool isNotePlayable(byte midiNote) const;
 
-  // Retourne le séquenceur (pour debug/monitoring)
+  // Retourne le séquenceur de la première flûte (pour debug/monitoring)
   NoteSequencer& getSequencer();
 
+  // Retourne une flûte de l'ensemble (0 à NUMBER_FLUTES-1)
+  FluteVoice& getVoice(int index);
+
+  // Budget de courant partagé par toutes les flûtes (statistiques)
+  PowerBudget& getPowerBudget();
+
+  // Statistiques d'alimentation servos (ms cumulées depuis le démarrage)
+  unsigned long getServoPoweredTime() const;
+  unsigned long getServoGatedTime() const;
+  uint16_t getServoWakeCount() const { return _servoWakeCount; }
+
   // Gère les Control Change MIDI
-  void handleControlChange(byte ccNumber, byte ccValue);
+  void handleControlChange(byte channel, byte ccNumber, byte ccValue);
+
+  // Pitch bend (-8192 à +8191) : airflow et ombrage, à la période de contrôle
+  void handlePitchBend(byte channel, int16_t pitchBend);
+
+  // Channel pressure (aftertouch canal) : source de souffle alternative au CC2
+  void handleChannelPressure(byte channel, byte pressure);
+
+  // Program Change : sélection d'un profil EEPROM (appliqué entre deux notes)
+  void handleProgramChange(byte channel, byte program);
 
   // Accesseurs pour les valeurs CC (pour AirflowController)
   byte getCCVolume() const { return _ccVolume; }
@@ -40,6 +61,7 @@ public:
   byte getCCModulation() const { return _ccModulation; }
   byte getCCBreath() const { return _ccBreath; }
   byte getCCBrightness() const { return _ccBrightness; }
+  int16_t getPitchBend() const { return _pitchBend; }
 
   // All Sound Off
   void allSoundOff();
@@ -48,34 +70,59 @@ public:
   void resetAllControllers();
 
 private:
-  Adafruit_PWMServoDriver _pwm;
-  EventQueue _eventQueue;
-  FingerController _fingerCtrl;
-  AirflowController _airflowCtrl;
-  NoteSequencer _sequencer;
+  PowerBudget _power;                  // Alimentation 5V commune
+  FluteVoice* _voices[NUMBER_FLUTES];  // Une voix par flûte physique
+  VoiceAllocator _allocator;
+  NoteRemapper _remapper;
 
   unsigned long _lastActivityTime;
   bool _servosPowered;
 
+  // Statistiques alimentation servos
+  unsigned long _powerStateSince;     // Début de l'état alimenté/coupé actuel
+  unsigned long _servoPoweredTime;    // Temps cumulé alimenté (ms)
+  unsigned long _servoGatedTime;      // Temps cumulé coupé (ms)
+  uint16_t _servoWakeCount;           // Nombre de réveils
+
   // Valeurs Control Change MIDI
   byte _ccVolume;       // CC 7  - Volume (défaut: 127 = 100%)
   byte _ccExpression;   // CC 11 - Expression (défaut: 127 = 100%)
   byte _ccModulation;   // CC 1  - Modulation/Vibrato (défaut: 0 = pas de modulation)
   byte _ccBreath;       // CC 2  - Breath Controller (défaut: 127 = 100%)
   byte _ccBrightness;   // CC 74 - Brightness/Timbre (défaut: 64 = neutre)
+  int16_t _pitchBend;   // Pitch bend (défaut: 0 = centre)
 
-  // Rate limiting des Control Changes
-  unsigned long _lastCCTime;
-  uint16_t _ccCount;
-  unsigned long _ccWindowStart;
+  // Registres CC "dernière valeur gagnante" : bits CC_DIRTY_* à appliquer
+  uint8_t _ccDirty;
+  unsigned long _lastCCApplyTime;     // Dernière application (période de contrôle)
 
-  // Rate limiting séparé pour CC2 (Breath Controller) - haute fréquence
-  uint16_t _cc2Count;
-  unsigned long _cc2WindowStart;
+  // Retourne true si au moins une flûte joue ou a des événements en attente
+  bool isAnyVoiceBusy() const;
+
+  // Transmet les valeurs CC courantes à toutes les flûtes
+  void applyCCToVoices();
+
+  // Applique les registres CC modifiés et fait converger le souffle lissé
+  // vers la dernière valeur (une fois par CC_CONTROL_PERIOD_MS)
+  void applyPendingCC();
+
+  #if LIVE_CONFIG_ENABLED
+  // true si aucune flûte n'est au milieu d'une note (échange de configuration)
+  bool areVoicesBetweenNotes() const;
+
+  // Rend active la configuration reçue par SysEx (table de notes, doigts)
+  void applyLiveConfig();
+  #endif
+
+  // Flûte dont la pile tient cette note (-1 si aucune)
+  int findHoldingVoice(byte midiNote) const;
 
   // Gère l'alimentation des servos (power management)
   void managePower();
 
+  // Réveille les servos dès qu'un événement est mis en queue
+  void wakeServos();
+
   // Active l'alimentation des servos
   void powerOnServos();
 
@@ -1,25 +1,94 @@
 #include "MidiHandler.h"
 
 MidiHandler::MidiHandler(InstrumentManager& instrument)
-  : _instrument(instrument) {
+  : _instrument(instrument)
+#if LIVE_CONFIG_ENABLED
+  , _sysex(configStore)
+#endif
+{
+  #if LIVE_CONFIG_ENABLED
+  for (uint8_t i = 0; i < MIDI_SOURCE_COUNT; i++) {
+    _sysexInputs[i].length = 0;
+    _sysexInputs[i].active = false;
+    _sysexInputs[i].overflow = false;
+  }
+  #endif
+
   if (DEBUG) {
     Serial.println("DEBUG: MidiHandler - Création");
   }
 }
 
+void MidiHandler::begin() {
+  #if DIN_MIDI_ENABLED
+  _din.begin();
+  #endif
+}
+
 void MidiHandler::readMidi() {
-  midiEventPacket_t midiEvent;
+  ingest();
+  dispatch();
+}
+
+void MidiHandler::ingest() {
+  #if DIN_MIDI_ENABLED
+  // DIN d'abord : ses octets sont datés par l'interruption, donc avant la
+  // lecture USB qui suit. Au plus un message par octet présent à l'entrée.
+  MidiStreamPacket dinPacket;
+  unsigned long dinTime;
+  uint8_t dinBudget = _din.available();
+  while (dinBudget > 0 && !_queue.isFull() && _din.read(dinPacket, dinTime)) {
+    // Source portée par le numéro de câble (4 bits hauts)
+    midiEventPacket_t event = { (uint8_t)((MIDI_SOURCE_DIN << 4) | (dinPacket.header & 0x0F)),
+                                dinPacket.byte1, dinPacket.byte2, dinPacket.byte3 };
+    _queue.push(event, dinTime);
+    dinBudget--;
+  }
+  #endif
+
+  // USB : vider l'endpoint en une fois, tous les paquets datés maintenant.
+  // File pleine : le reste attend dans l'endpoint (l'hôte est ralenti, rien n'est perdu).
+  unsigned long now = millis();
+  while (!_queue.isFull()) {
+    midiEventPacket_t usbEvent = MidiUSB.read();
+    if (usbEvent.header == 0) {
+      break;
+    }
+    usbEvent.header &= 0x0F;  // Câble 0 = MIDI_SOURCE_USB
+    _queue.push(usbEvent, now);
+  }
+
+  #if TELEMETRY_ENABLED
+  telemetry.inputQueueDepth(_queue.getCount());
+  #endif
+}
+
+void MidiHandler::dispatch() {
+  midiEventPacket_t event;
+  unsigned long arrivalMs;
 
-  // Lire tous les événements MIDI en attente (non-bloquant)
-  do {
-    midiEvent = MidiUSB.read();
-    if (midiEvent.header != 0) {
-      processMidiEvent(midiEvent);
+  // Budget borné : le séquenceur garde la main pendant une rafale
+  for (uint8_t i = 0; i < MIDI_DISPATCH_BUDGET && _queue.pop(event, arrivalMs); i++) {
+    uint8_t source = event.header >> 4;
+    if (source >= MIDI_SOURCE_COUNT) {
+      continue;
     }
-  } while (midiEvent.header != 0);
+    processMidiEvent(event, (MidiSource)source, arrivalMs);
+  }
 }
 
-void MidiHandler::processMidiEvent(midiEventPacket_t midiEvent) {
+void MidiHandler::processMidiEvent(midiEventPacket_t midiEvent, MidiSource source, unsigned long arrivalMs) {
+  #if LIVE_CONFIG_ENABLED
+  // SysEx : reconnu au Code Index Number USB-MIDI, pas au statut (pas de canal)
+  byte cin = midiEvent.header & 0x0F;
+  if (cin >= 0x4 && cin <= 0x7) {
+    processSysexPacket(midiEvent, _sysexInputs[source]);
+    return;
+  }
+  #else
+  (void)source;
+  #endif
+
   byte messageType = midiEvent.byte1 & 0xF0;
   byte channel = midiEvent.byte1 & 0x0F;
   byte note = midiEvent.byte2;
@@ -33,34 +102,45 @@ void MidiHandler::processMidiEvent(midiEventPacket_t midiEvent) {
   switch (messageType) {
     case 0x90:  // Note On
       if (velocity > 0) {
-        _instrument.noteOn(note, velocity);
+        _instrument.noteOn(channel, note, velocity, arrivalMs);
       } else {
         // Velocity 0 = Note Off
-        _instrument.noteOff(note);
+        _instrument.noteOff(channel, note, arrivalMs);
       }
       break;
 
     case 0x80:  // Note Off
-      _instrument.noteOff(note);
+      _instrument.noteOff(channel, note, arrivalMs);
       break;
 
-    case 0xA0:  // Channel Pressure (Aftertouch)
-      // Non implémenté pour l'instant
+    case 0xA0:  // Polyphonic Key Pressure
+      // Non implémenté (une seule note par flûte : voir Channel Pressure)
       break;
 
-    case 0xD0:  // Polyphonic Key Pressure
-      // Non implémenté pour l'instant
+    case 0xC0:  // Program Change : 1 octet de données (numéro de profil)
+      _instrument.handleProgramChange(channel, midiEvent.byte2);
+      break;
+
+    case 0xD0:  // Channel Pressure (Aftertouch) : 1 octet de données
+      _instrument.handleChannelPressure(channel, midiEvent.byte2);
+      break;
+
+    case 0xE0:  // Pitch Bend : LSB puis MSB (7 bits chacun), centre = 8192
+      {
+        int16_t pitchBend = (int16_t)(((uint16_t)(midiEvent.byte3 & 0x7F) << 7) | (midiEvent.byte2 & 0x7F)) - 8192;
+        _instrument.handlePitchBend(channel, pitchBend);
+      }
       break;
 
     case 0xB0:  // Control Change
       {
         byte ccNumber = midiEvent.byte2;
         byte ccValue = midiEvent.byte3;
-        _instrument.handleControlChange(ccNumber, ccValue);
+        _instrument.handleControlChange(channel, ccNumber, ccValue);
       }
       break;
 
-    case 0xF0:  // System Common or System Real-Time
+    case 0xF0:  // System Common or System Real-Time (SysEx traité plus haut)
       // Non implémenté pour l'instant
       break;
 
@@ -69,6 +149,68 @@ void MidiHandler::processMidiEvent(midiEventPacket_t midiEvent) {
   }
 }
 
+#if LIVE_CONFIG_ENABLED
+void MidiHandler::processSysexPacket(midiEventPacket_t midiEvent, SysexInput& input) {
+  byte cin = midiEvent.header & 0x0F;
+
+  switch (cin) {
+    case 0x4:  // SysEx début ou suite : 3 octets
+      appendSysexByte(midiEvent.byte1, input);
+      appendSysexByte(midiEvent.byte2, input);
+      appendSysexByte(midiEvent.byte3, input);
+      break;
+
+    case 0x5:  // Fin sur 1 octet (F7) ou System Common 1 octet (ignoré)
+      appendSysexByte(midiEvent.byte1, input);
+      break;
+
+    case 0x6:  // Fin sur 2 octets
+      appendSysexByte(midiEvent.byte1, input);
+      appendSysexByte(midiEvent.byte2, input);
+      break;
+
+    case 0x7:  // Fin sur 3 octets
+      appendSysexByte(midiEvent.byte1, input);
+      appendSysexByte(midiEvent.byte2, input);
+      appendSysexByte(midiEvent.byte3, input);
+      break;
+  }
+}
+
+void MidiHandler::appendSysexByte(byte data, SysexInput& input) {
+  if (data == 0xF0) {
+    // Début de message (un F0 sans F7 précédent abandonne l'ancien)
+    input.active = true;
+    input.overflow = false;
+    input.length = 0;
+    return;
+  }
+
+  if (!input.active) {
+    return;
+  }
+
+  if (data == 0xF7) {
+    input.active = false;
+    if (!input.overflow) {
+      _sysex.handleMessage(input.buffer, input.length);
+    }
+    return;
+  }
+
+  if (data & 0x80) {
+    input.active = false;   // Statut dans un SysEx (Tune Request DIN) : message abandonné
+    return;
+  }
+
+  if (input.length < SYSEX_BUFFER_SIZE) {
+    input.buffer[input.length++] = data;
+  } else {
+    input.overflow = true;  // Message trop long pour ce protocole
+  }
+}
+#endif
+
 bool MidiHandler::isChannelAccepted(byte channel) {
   // MIDI_CHANNEL = 0 : Omni mode (accepte tous les canaux)
   // MIDI_CHANNEL = 1-16 : Canal spécifique (channel MIDI est 0-15, donc MIDI_CHANNEL - 1)
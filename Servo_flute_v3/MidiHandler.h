@@ -4,20 +4,70 @@
 #include <Arduino.h>
 #include <MIDIUSB.h>
 #include "InstrumentManager.h"
+#include "SysexHandler.h"
+#include "DinMidiInput.h"
+#include "MidiInputQueue.h"
+#include "Telemetry.h"
 #include "settings.h"
 
+// Sources MIDI (une reconstitution SysEx par source)
+enum MidiSource {
+  MIDI_SOURCE_USB = 0,
+#if DIN_MIDI_ENABLED
+  MIDI_SOURCE_DIN,
+#endif
+  MIDI_SOURCE_COUNT
+};
+
 class MidiHandler {
 public:
   MidiHandler(InstrumentManager& instrument);
 
-  // Lit et traite les événements MIDI depuis USB
+  // Démarre les entrées qui en ont besoin (MIDI DIN)
+  void begin();
+
+  // Vide les entrées MIDI (USB et DIN) dans la file, puis traite au plus
+  // MIDI_DISPATCH_BUDGET paquets dans l'ordre d'arrivée
   void readMidi();
 
+  // Remplissage maximal de la file depuis le démarrage
+  uint8_t getQueueHighWater() const { return _queue.getHighWater(); }
+
 private:
   InstrumentManager& _instrument;
+  MidiInputQueue _queue;                    // Paquets reçus, datés, en attente
+
+  #if DIN_MIDI_ENABLED
+  DinMidiInput _din;
+  #endif
+
+  #if LIVE_CONFIG_ENABLED
+  // Message SysEx en cours de reconstitution (un par source)
+  struct SysexInput {
+    byte buffer[SYSEX_BUFFER_SIZE];         // Message en cours (sans F0/F7)
+    uint8_t length;
+    bool active;                            // F0 reçu, F7 attendu
+    bool overflow;                          // Message trop long : ignoré
+  };
+
+  SysexHandler _sysex;                      // Configuration en direct
+  SysexInput _sysexInputs[MIDI_SOURCE_COUNT];
+
+  // Assemble les paquets USB-MIDI SysEx (CIN 0x4 à 0x7)
+  void processSysexPacket(midiEventPacket_t midiEvent, SysexInput& input);
+
+  // Ajoute un octet au message SysEx en cours (F0/F7 gérés)
+  void appendSysexByte(byte data, SysexInput& input);
+  #endif
+
+  // Transfère les paquets en attente (DIN puis USB) dans la file, jusqu'à la remplir
+  void ingest();
+
+  // Traite les paquets de la file (au plus MIDI_DISPATCH_BUDGET)
+  void dispatch();
 
-  // Traite un événement MIDI reçu
-  void processMidiEvent(midiEventPacket_t midiEvent);
+  // Traite un événement MIDI reçu (paquet USB-MIDI, quelle que soit la source)
+  void processMidiEvent(midiEventPacket_t midiEvent, MidiSource source, unsigned long arrivalMs);
 
   // Vérifie si le message MIDI doit être traité selon le canal configuré
   bool isChannelAccepted(byte channel);
@@ -0,0 +1,39 @@
+#include "MidiInputQueue.h"
+
+MidiInputQueue::MidiInputQueue()
+  : _head(0), _tail(0), _count(0), _highWater(0), _lastArrival(0) {
+}
+
+bool MidiInputQueue::push(const midiEventPacket_t& packet, unsigned long arrivalMs) {
+  if (isFull()) {
+    return false;
+  }
+
+  if ((long)(arrivalMs - _lastArrival) < 0) {
+    arrivalMs = _lastArrival;  // Sources fusionnées : jamais avant le paquet précédent
+  }
+  _lastArrival = arrivalMs;
+
+  _entries[_head].packet = packet;
+  _entries[_head].arrival = (uint16_t)arrivalMs;
+  _head = (_head + 1) % MIDI_INPUT_QUEUE_SIZE;
+  _count++;
+  if (_count > _highWater) {
+    _highWater = _count;
+  }
+  return true;
+}
+
+bool MidiInputQueue::pop(midiEventPacket_t& packet, unsigned long& arrivalMs) {
+  if (isEmpty()) {
+    return false;
+  }
+
+  packet = _entries[_tail].packet;
+  // Heure complète : maintenant moins l'âge du paquet (sur 16 bits)
+  unsigned long now = millis();
+  arrivalMs = now - (uint16_t)((uint16_t)now - _entries[_tail].arrival);
+  _tail = (_tail + 1) % MIDI_INPUT_QUEUE_SIZE;
+  _count--;
+  return true;
+}
@@ -0,0 +1,43 @@
+#ifndef MIDI_INPUT_QUEUE_H
+#define MIDI_INPUT_QUEUE_H
+
+#include <Arduino.h>
+#include <MIDIUSB.h>
+#include "settings.h"
+
+// File FIFO des paquets MIDI reçus (USB et DIN), horodatés à l'arrivée.
+// La source est portée par le numéro de câble du paquet (4 bits hauts du header).
+// L'heure est gardée sur 16 bits (ms) : exacte pour un paquet de moins de 65 s.
+class MidiInputQueue {
+public:
+  MidiInputQueue();
+
+  // Ajoute un paquet (false si la file est pleine)
+  // Heures croissantes : un paquet daté avant le précédent prend l'heure du précédent
+  bool push(const midiEventPacket_t& packet, unsigned long arrivalMs);
+
+  // Retire le plus ancien paquet (false si la file est vide)
+  bool pop(midiEventPacket_t& packet, unsigned long& arrivalMs);
+
+  bool isEmpty() const { return _count == 0; }
+  bool isFull() const { return _count >= MIDI_INPUT_QUEUE_SIZE; }
+  uint8_t getCount() const { return _count; }
+
+  // Remplissage maximal atteint depuis le démarrage (dimensionnement)
+  uint8_t getHighWater() const { return _highWater; }
+
+private:
+  struct Entry {
+    midiEventPacket_t packet;
+    uint16_t arrival;        // millis() & 0xFFFF
+  };
+
+  Entry _entries[MIDI_INPUT_QUEUE_SIZE];
+  uint8_t _head;             // Index d'écriture
+  uint8_t _tail;             // Index de lecture
+  uint8_t _count;
+  uint8_t _highWater;
+  unsigned long _lastArrival;  // Heure du dernier paquet ajouté
+};
+
+#endif
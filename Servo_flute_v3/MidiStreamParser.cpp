@@ -0,0 +1,132 @@
+#include "MidiStreamParser.h"
+
+MidiStreamParser::MidiStreamParser() {
+  reset();
+}
+
+void MidiStreamParser::reset() {
+  _status = 0;
+  _expected = 0;
+  _count = 0;
+  _sysex = false;
+}
+
+uint8_t MidiStreamParser::dataLength(uint8_t status) {
+  switch (status & 0xF0) {
+    case 0xC0:  // Program Change
+    case 0xD0:  // Channel Pressure
+      return 1;
+    case 0xF0:
+      switch (status) {
+        case 0xF1:  // MTC Quarter Frame
+        case 0xF3:  // Song Select
+          return 1;
+        case 0xF2:  // Song Position Pointer
+          return 2;
+        case 0xF6:  // Tune Request
+          return 0;
+        default:    // F4/F5 non définis
+          return 0xFF;
+      }
+    default:    // Note Off/On, Poly Pressure, Control Change, Pitch Bend
+      return 2;
+  }
+}
+
+void MidiStreamParser::make(MidiStreamPacket& packet, uint8_t cin, uint8_t b1, uint8_t b2, uint8_t b3) {
+  packet.header = cin;
+  packet.byte1 = b1;
+  packet.byte2 = b2;
+  packet.byte3 = b3;
+}
+
+bool MidiStreamParser::parse(uint8_t data, MidiStreamPacket& packet) {
+  // Temps réel (F8-FF) : un octet, accepté n'importe où, sans toucher au message en cours
+  if (data >= 0xF8) {
+    if (data == 0xF9 || data == 0xFD) {
+      return false;  // Non définis
+    }
+    make(packet, 0x0F, data, 0, 0);
+    return true;
+  }
+
+  if (data & 0x80) {
+    // Fin de SysEx : octets restants + F7 (CIN 0x5 à 0x7 selon leur nombre)
+    if (data == 0xF7) {
+      bool wasSysex = _sysex;
+      uint8_t count = _count;
+      reset();
+      if (!wasSysex) {
+        return false;  // F7 isolé
+      }
+      if (count == 0) {
+        make(packet, 0x05, 0xF7, 0, 0);
+      } else if (count == 1) {
+        make(packet, 0x06, _data[0], 0xF7, 0);
+      } else {
+        make(packet, 0x07, _data[0], _data[1], 0xF7);
+      }
+      return true;
+    }
+
+    // Tout autre statut termine un SysEx inachevé (abandonné)
+    _sysex = false;
+    _count = 0;
+
+    if (data == 0xF0) {
+      _status = 0;
+      _sysex = true;
+      _data[0] = 0xF0;
+      _count = 1;
+      return false;
+    }
+
+    uint8_t length = dataLength(data);
+    if (length == 0xFF) {
+      _status = 0;   // Statut inconnu : ses données seront ignorées
+      return false;
+    }
+    if (length == 0) {
+      _status = 0;
+      make(packet, 0x05, data, 0, 0);   // Tune Request
+      return true;
+    }
+    _status = data;   // Les messages système (F1-F3) annulent le running status
+    _expected = length;
+    return false;
+  }
+
+  // Octet de données
+  if (_sysex) {
+    _data[_count++] = data;
+    if (_count == 3) {
+      make(packet, 0x04, _data[0], _data[1], _data[2]);
+      _count = 0;
+    }
+    return _count == 0;
+  }
+
+  if (_status == 0) {
+    return false;  // Donnée sans statut (début de flux, statut inconnu)
+  }
+
+  _data[_count++] = data;
+  if (_count < _expected) {
+    return false;
+  }
+
+  uint8_t cin;
+  if (_status < 0xF0) {
+    cin = _status >> 4;
+  } else {
+    cin = (_expected == 1) ? 0x02 : 0x03;
+  }
+  make(packet, cin, _status, _data[0], (_expected > 1) ? _data[1] : 0);
+  _count = 0;
+
+  // Running status : seuls les messages de canal le gardent
+  if (_status >= 0xF0) {
+    _status = 0;
+  }
+  return true;
+}
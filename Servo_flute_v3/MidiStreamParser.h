@@ -0,0 +1,51 @@
+/***********************************************************************************************
+ * MIDI STREAM PARSER
+ *
+ * Analyse d'un flux MIDI série (prise DIN) octet par octet : running status, octets temps
+ * réel intercalés (même au milieu d'un message ou d'un SysEx), messages système et SysEx.
+ * Les messages complets sont rendus au format des paquets USB-MIDI (Code Index Number +
+ * 3 octets) : MidiHandler les traite exactement comme ceux de MidiUSB.read().
+ *
+ * Indépendant du matériel (ni Arduino.h ni registres) : compilé tel quel sur PC par
+ * tools/midi_stream_fuzz.cpp.
+ ***********************************************************************************************/
+#ifndef MIDI_STREAM_PARSER_H
+#define MIDI_STREAM_PARSER_H
+
+#include <stdint.h>
+
+// Paquet USB-MIDI (même disposition que midiEventPacket_t, câble 0)
+struct MidiStreamPacket {
+  uint8_t header;   // Code Index Number (CIN)
+  uint8_t byte1;
+  uint8_t byte2;
+  uint8_t byte3;
+};
+
+class MidiStreamParser {
+public:
+  MidiStreamParser();
+
+  // Oublie le message en cours et le running status
+  void reset();
+
+  // Ajoute un octet reçu ; true si un paquet est complet (rendu dans packet)
+  bool parse(uint8_t data, MidiStreamPacket& packet);
+
+  // Aucun message commencé : le prochain octet ouvre un nouveau message
+  bool idle() const { return _count == 0 && !_sysex; }
+
+private:
+  uint8_t _status;      // Statut du message en cours (running status pour 0x80-0xEF)
+  uint8_t _expected;    // Octets de données attendus pour _status
+  uint8_t _data[3];     // Message en cours (SysEx : octets non encore envoyés)
+  uint8_t _count;       // Octets de données reçus
+  bool _sysex;          // Entre F0 et F7
+
+  // Nombre d'octets de données d'un statut (0xFF = statut non défini, ignoré)
+  static uint8_t dataLength(uint8_t status);
+
+  static void make(MidiStreamPacket& packet, uint8_t cin, uint8_t b1, uint8_t b2, uint8_t b3);
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "NoteArbiter.h"
+
+NoteArbiter::NoteArbiter(uint8_t capacity, NotePriority priority)
+  : _held(capacity), _priority(priority), _soundingNote(0) {
+}
+
+void NoteArbiter::press(uint8_t midiNote, uint8_t velocity, NoteChange& change) {
+  change.offNote = 0;
+  change.onNote = 0;
+  change.onVelocity = 0;
+
+  // Pile pleine : la note qui sonne n'est jamais oubliée (son Note Off
+  // serait ignoré et elle resterait bloquée)
+  _held.press(midiNote, velocity, _soundingNote);
+
+  uint8_t selectedVelocity;
+  if (_held.select(_priority, selectedVelocity) != midiNote) {
+    return;  // Tenue sans sonner : une note prioritaire sonne déjà
+  }
+
+  // Nouvelle note ou re-déclenchement de la même : terminer celle qui sonne
+  // (elle reste tenue), le séquenceur n'accepte un Note On qu'après son Note Off
+  change.offNote = _soundingNote;
+  change.onNote = midiNote;
+  change.onVelocity = velocity;
+  _soundingNote = midiNote;
+}
+
+void NoteArbiter::release(uint8_t midiNote, NoteChange& change) {
+  change.offNote = 0;
+  change.onNote = 0;
+  change.onVelocity = 0;
+
+  if (!_held.release(midiNote) || midiNote != _soundingNote) {
+    return;  // Note non tenue ou tenue sans sonner : rien à jouer
+  }
+
+  // Reprise de la note encore tenue prioritaire (synthé monophonique)
+  change.offNote = midiNote;
+  _soundingNote = _held.select(_priority, change.onVelocity);
+  change.onNote = _soundingNote;
+}
+
+void NoteArbiter::clear() {
+  _held.clear();
+  _soundingNote = 0;
+}
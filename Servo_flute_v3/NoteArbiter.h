@@ -0,0 +1,46 @@
+#ifndef NOTE_ARBITER_H
+#define NOTE_ARBITER_H
+
+#include <stdint.h>  // Indépendant du matériel : compilé sur PC par tools/note_arbiter_check.cpp
+#include "HeldNoteStack.h"
+
+// Événements à mettre en queue pour une touche, dans cet ordre :
+// Note Off de offNote puis Note On de onNote (0 = pas d'événement)
+struct NoteChange {
+  uint8_t offNote;
+  uint8_t onNote;
+  uint8_t onVelocity;
+};
+
+// Monophonie d'une flûte : touches tenues (HeldNoteStack) et note qui sonne.
+// Chaque touche devient au plus un Note Off de la note qui sonne suivi d'un
+// Note On : la queue du séquenceur ne reçoit que des Note On/Off alternés pour
+// la note qui sonne, y compris quand la même note est enfoncée deux fois
+// (re-déclenchement : Note Off puis Note On).
+class NoteArbiter {
+public:
+  NoteArbiter(uint8_t capacity, NotePriority priority);
+
+  // Touche enfoncée : change reçoit les événements à mettre en queue
+  void press(uint8_t midiNote, uint8_t velocity, NoteChange& change);
+
+  // Touche relâchée : Note Off si c'était la note qui sonne, puis reprise
+  // de la note encore tenue prioritaire (Note On)
+  void release(uint8_t midiNote, NoteChange& change);
+
+  // Note tenue (qu'elle sonne ou non)
+  bool isHolding(uint8_t midiNote) const { return _held.contains(midiNote); }
+
+  // Note qui sonne (dernier Note On rendu, 0 = silence)
+  uint8_t getSoundingNote() const { return _soundingNote; }
+
+  // Oublie toutes les notes (All Sound Off)
+  void clear();
+
+private:
+  HeldNoteStack _held;
+  NotePriority _priority;
+  uint8_t _soundingNote;
+};
+
+#endif
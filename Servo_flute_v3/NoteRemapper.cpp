@@ -0,0 +1,179 @@
+#include "NoteRemapper.h"
+
+NoteRemapper::NoteRemapper() : _keyCount(0) {
+  reset();
+}
+
+void NoteRemapper::begin() {
+  // Bornes de la plage jouable
+  byte lowest = 127;
+  byte highest = 0;
+  for (int i = 0; i < NUMBER_NOTES; i++) {
+    if (noteMidi(i) < lowest) lowest = noteMidi(i);
+    if (noteMidi(i) > highest) highest = noteMidi(i);
+  }
+
+  for (int n = 0; n < 128; n++) {
+    // Note exacte
+    if (getNoteIndex(n) >= 0) {
+      _table[n] = n | REMAP_EXACT;
+      continue;
+    }
+
+    // Repli d'octave dans la plage jouable
+    int folded = n;
+    while (folded > highest) folded -= 12;
+    while (folded < lowest) folded += 12;
+
+    // Note jouable la plus proche (à égalité : la plus grave)
+    byte best = noteMidi(0);
+    int bestDistance = 128;
+    for (int i = 0; i < NUMBER_NOTES; i++) {
+      byte candidate = noteMidi(i);
+      int distance = abs((int)candidate - folded);
+      if (distance < bestDistance ||
+          (distance == bestDistance && candidate < best)) {
+        bestDistance = distance;
+        best = candidate;
+      }
+    }
+    _table[n] = best;
+  }
+
+  if (DEBUG) {
+    Serial.print("DEBUG: NoteRemapper - Table construite (plage ");
+    Serial.print(lowest);
+    Serial.print("-");
+    Serial.print(highest);
+    Serial.println(")");
+  }
+}
+
+void NoteRemapper::setTranspose(byte channel, int8_t semitones) {
+  _transpose[channel & 0x0F] = semitones;
+
+  if (DEBUG) {
+    Serial.print("DEBUG: NoteRemapper - Canal ");
+    Serial.print(channel + 1);
+    Serial.print(" transposition: ");
+    Serial.println(semitones);
+  }
+}
+
+void NoteRemapper::setFoldEnabled(byte channel, bool enabled) {
+  if (enabled) {
+    _foldMask |= (1 << (channel & 0x0F));
+  } else {
+    _foldMask &= ~(1 << (channel & 0x0F));
+  }
+
+  if (DEBUG) {
+    Serial.print("DEBUG: NoteRemapper - Canal ");
+    Serial.print(channel + 1);
+    Serial.print(" repli: ");
+    Serial.println(enabled ? "ON" : "OFF");
+  }
+}
+
+bool NoteRemapper::handleControlChange(byte channel, byte ccNumber, byte ccValue) {
+  channel &= 0x0F;
+
+  switch (ccNumber) {
+    case 101:  // RPN MSB
+      _rpnMsb[channel] = ccValue;
+      return true;
+
+    case 100:  // RPN LSB
+      _rpnLsb[channel] = ccValue;
+      return true;
+
+    case 6:    // Data Entry MSB
+      // RPN 0x0002 = Coarse Tuning (64 = pas de transposition)
+      if (_rpnMsb[channel] == 0 && _rpnLsb[channel] == 2) {
+        setTranspose(channel, (int8_t)ccValue - 64);
+      }
+      return true;
+
+    case 38:   // Data Entry LSB (Coarse Tuning n'utilise que le MSB)
+      return true;
+
+    case NOTE_FOLD_CC:
+      setFoldEnabled(channel, ccValue >= 64);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+void NoteRemapper::reset() {
+  for (int ch = 0; ch < 16; ch++) {
+    _transpose[ch] = NOTE_TRANSPOSE_DEFAULT;
+    _rpnMsb[ch] = 127;  // RPN nul
+    _rpnLsb[ch] = 127;
+  }
+  _foldMask = NOTE_FOLD_DEFAULT ? 0xFFFF : 0x0000;
+}
+
+byte NoteRemapper::press(byte channel, byte midiNote) {
+  channel &= 0x0F;
+  byte playedNote = remap(channel, midiNote);
+
+  int8_t index = findKey(channel, midiNote);
+  if (playedNote == 0) {
+    // Touche redevenue non jouable (Note On répété) : plus rien à relâcher
+    if (index >= 0) {
+      _keys[index] = _keys[--_keyCount];
+    }
+    return 0;
+  }
+
+  if (index < 0) {
+    if (_keyCount >= NOTE_REMAP_HELD_KEYS) {
+      // Table pleine : le Note Off retombera sur la correspondance courante
+      return playedNote;
+    }
+    index = _keyCount++;
+    _keys[index].channel = channel;
+    _keys[index].midiNote = midiNote;
+  }
+  _keys[index].playedNote = playedNote;
+  return playedNote;
+}
+
+byte NoteRemapper::release(byte channel, byte midiNote, bool& shared) {
+  channel &= 0x0F;
+  shared = false;
+
+  int8_t index = findKey(channel, midiNote);
+  if (index < 0) {
+    // Touche non mémorisée (table pleine) : correspondance courante
+    return remap(channel, midiNote);
+  }
+
+  byte playedNote = _keys[index].playedNote;
+  _keys[index] = _keys[--_keyCount];
+
+  // Deux touches repliées sur la même note : la note sonne jusqu'au
+  // relâchement de la dernière
+  for (uint8_t i = 0; i < _keyCount; i++) {
+    if (_keys[i].playedNote == playedNote) {
+      shared = true;
+      break;
+    }
+  }
+  return playedNote;
+}
+
+void NoteRemapper::clearKeys() {
+  _keyCount = 0;
+}
+
+int8_t NoteRemapper::findKey(byte channel, byte midiNote) const {
+  for (uint8_t i = 0; i < _keyCount; i++) {
+    if (_keys[i].channel == channel && _keys[i].midiNote == midiNote) {
+      return i;
+    }
+  }
+  return -1;
+}
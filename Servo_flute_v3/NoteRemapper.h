@@ -0,0 +1,77 @@
+#ifndef NOTE_REMAPPER_H
+#define NOTE_REMAPPER_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Convertit une note MIDI entrante en note jouable par l'instrument.
+// Table 128 entrées précalculée (repli d'octave + note la plus proche) :
+// le chemin critique ne fait qu'une addition (transposition) et une lecture.
+class NoteRemapper {
+public:
+  NoteRemapper();
+
+  // Construit la table de correspondance à partir de NOTES[]
+  void begin();
+
+  // Retourne la note jouable pour (canal, note), 0 si non jouable
+  inline byte remap(byte channel, byte midiNote) const {
+    int16_t transposed = (int16_t)midiNote + _transpose[channel];
+    if (transposed < 0 || transposed > 127) {
+      return 0;
+    }
+
+    byte entry = _table[transposed];
+    if (!(entry & REMAP_EXACT) && !(_foldMask & (1 << channel))) {
+      return 0;  // Repli désactivé sur ce canal : notes exactes uniquement
+    }
+    return entry & 0x7F;
+  }
+
+  // Transposition d'un canal en demi-tons
+  void setTranspose(byte channel, int8_t semitones);
+
+  // Active/désactive le repli d'octave + substitution sur un canal
+  void setFoldEnabled(byte channel, bool enabled);
+
+  // Traite les CC RPN (101/100/6/38) et NOTE_FOLD_CC
+  // Retourne true si le CC a été consommé
+  bool handleControlChange(byte channel, byte ccNumber, byte ccValue);
+
+  // Remet la configuration par défaut sur tous les canaux
+  // (les touches enfoncées restent mémorisées)
+  void reset();
+
+  // Note On : note jouable de la touche, mémorisée jusqu'à son Note Off
+  // (0 si non jouable)
+  byte press(byte channel, byte midiNote);
+
+  // Note Off : note jouée au Note On de la touche (0 si non jouable).
+  // shared = true si une autre touche enfoncée joue encore cette note
+  byte release(byte channel, byte midiNote, bool& shared);
+
+  // Oublie toutes les touches enfoncées (All Sound Off)
+  void clearKeys();
+
+private:
+  static const byte REMAP_EXACT = 0x80;  // Bit "note exacte" dans la table
+
+  struct HeldKey {
+    byte channel;
+    byte midiNote;    // Note reçue
+    byte playedNote;  // Note jouée au Note On
+  };
+
+  byte _table[128];       // note transposée -> note jouable (| REMAP_EXACT)
+  int8_t _transpose[16];  // Transposition par canal (demi-tons)
+  uint16_t _foldMask;     // Bit n = repli actif sur le canal n
+  byte _rpnMsb[16];       // RPN sélectionné (CC 101) par canal
+  byte _rpnLsb[16];       // RPN sélectionné (CC 100) par canal
+  HeldKey _keys[NOTE_REMAP_HELD_KEYS];  // Touches enfoncées
+  uint8_t _keyCount;
+
+  // Index de la touche (canal, note reçue), -1 si non mémorisée
+  int8_t findKey(byte channel, byte midiNote) const;
+};
+
+#endif
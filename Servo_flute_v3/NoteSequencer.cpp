@@ -3,7 +3,8 @@
 NoteSequencer::NoteSequencer(EventQueue& eventQueue, FingerController& fingerCtrl, AirflowController& airflowCtrl)
   : _eventQueue(eventQueue), _fingerCtrl(fingerCtrl), _airflowCtrl(airflowCtrl),
     _currentState(STATE_IDLE), _currentNote(0), _currentVelocity(0),
-    _stateStartTime(0), _eventScheduledTime(0), _playbackStartTime(0) {
+    _stateStartTime(0), _eventScheduledTime(0), _playbackStartTime(0),
+    _positioningDelay(servoToSolenoidDelayMs()), _ornamentActive(false), _airflowPrepared(false) {
 }
 
 void NoteSequencer::begin() {
@@ -48,19 +49,40 @@ void NoteSequencer::handleIdle() {
 }
 
 void NoteSequencer::handlePositioning() {
+  #if SERVO_MOTION_PROFILE
+  // Dernier doigt en mouvement prévu en place, sans devancer le timing MIDI
+  bool ready = _fingerCtrl.isSettled() && (long)(millis() - _eventScheduledTime) >= 0;
+  #else
   // Vérifier si le délai total est écoulé (servos + stabilisation)
-  unsigned long elapsed = millis() - _stateStartTime;
+  bool ready = (millis() - _stateStartTime) >= _positioningDelay;
+  #endif
 
-  if (elapsed >= SERVO_TO_SOLENOID_DELAY_MS) {
-    // Activer le servo de débit selon la note et la vélocité
-    _airflowCtrl.setAirflowForNote(_currentNote, _currentVelocity);
+  // Débit préparé : attendre aussi le servo débit
+  if (_airflowPrepared && !_airflowCtrl.isAirflowSettled()) {
+    ready = false;
+  }
+
+  if (ready) {
+    // Valve restée ouverte (legato, ornement) : le débit n'a pas pu partir en
+    // avance sans faire sonner le doigté en transition, le cibler maintenant
+    if (!_airflowPrepared) {
+      _airflowCtrl.setAirflowForNote(_currentNote, _currentVelocity);
+    }
 
     // Ouvrir le solénoïde -> SON PRODUIT
-    _airflowCtrl.openSolenoid();
+    // (déjà ouvert en legato/ornement : pas de nouvelle impulsion d'activation)
+    if (!_airflowCtrl.isSolenoidOpen()) {
+      _airflowCtrl.openSolenoid(knownSustainMs());
+    }
 
     // Transition vers état PLAYING
     transitionTo(STATE_PLAYING);
 
+    #if TELEMETRY_ENABLED
+    // Note sonnée : écart entre l'ouverture réelle et l'heure MIDI prévue
+    telemetry.noteSounded(_currentNote, _currentVelocity, (long)(millis() - _eventScheduledTime));
+    #endif
+
     if (DEBUG) {
       unsigned long actualTime = millis() - _playbackStartTime;
       unsigned long targetTime = _eventScheduledTime - _playbackStartTime;
@@ -88,6 +110,32 @@ void NoteSequencer::handlePlaying() {
   if (nextEvent != nullptr && nextEvent->type == EVENT_NOTE_OFF &&
       nextEvent->midiNote == _currentNote) {
 
+    // ORNEMENT : Note On suivante rapprochée et proche en doigté
+    // -> démarrer ses doigts en avance sans couper l'air
+    MidiEvent* followingEvent = _eventQueue.peekAt(1);
+    if (followingEvent != nullptr && followingEvent->type == EVENT_NOTE_ON &&
+        isOrnamentTransition(nextEvent, followingEvent, 1)) {
+      unsigned long onAbsoluteTime = _playbackStartTime + followingEvent->timestamp;
+
+      #if SERVO_MOTION_PROFILE
+      unsigned long leadTime = _fingerCtrl.predictSettleTimeForNote(followingEvent->midiNote);
+      #else
+      unsigned long leadTime = ORNAMENT_SERVO_DELAY_MS;
+      #endif
+
+      if (millis() + leadTime >= onAbsoluteTime) {
+        byte note = followingEvent->midiNote;
+        byte velocity = followingEvent->velocity;
+
+        // Retirer le Note Off puis le Note On (enchaînement legato)
+        _eventQueue.dequeue();
+        _eventQueue.dequeue();
+
+        startOrnamentNote(note, velocity, onAbsoluteTime);
+      }
+      return;
+    }
+
     // Vérifier si le timing du noteOff est atteint
     unsigned long eventAbsoluteTime = _playbackStartTime + nextEvent->timestamp;
 
@@ -123,15 +171,32 @@ void NoteSequencer::processNextEvent() {
   }
 
   // ANTICIPATION : Calculer le délai mécanique total
-  const unsigned long MECHANICAL_DELAY = SERVO_TO_SOLENOID_DELAY_MS;
+  // (profil de mouvement : temps prévu pour le doigt le plus lent à bouger)
+  #if SERVO_MOTION_PROFILE
+  unsigned long mechanicalDelay = (event->type == EVENT_NOTE_ON)
+      ? _fingerCtrl.predictSettleTimeForNote(event->midiNote)
+      : 0;
+  #else
+  unsigned long mechanicalDelay = servoToSolenoidDelayMs() + _fingerCtrl.getWakeDelay();
+  #endif
+
+  // Valve fermée : le servo débit se place en parallèle des doigts, le plus
+  // lent des deux fixe l'avance
+  if (event->type == EVENT_NOTE_ON && !_airflowCtrl.isSolenoidOpen()) {
+    unsigned long airflowDelay = _fingerCtrl.getWakeDelay() +
+        _airflowCtrl.predictSettleTimeForNote(event->midiNote, event->velocity);
+    if (airflowDelay > mechanicalDelay) {
+      mechanicalDelay = airflowDelay;
+    }
+  }
 
   // Pour les NoteOn : démarrer la séquence en avance pour compenser le délai mécanique
   // Pour les NoteOff : exécuter au timing exact
   unsigned long startTime;
   if (event->type == EVENT_NOTE_ON) {
-    // Anticiper : démarrer MECHANICAL_DELAY ms avant le timing prévu
-    if (eventAbsoluteTime > MECHANICAL_DELAY) {
-      startTime = eventAbsoluteTime - MECHANICAL_DELAY;
+    // Anticiper : démarrer mechanicalDelay ms avant le timing prévu
+    if (eventAbsoluteTime > mechanicalDelay) {
+      startTime = eventAbsoluteTime - mechanicalDelay;
     } else {
       startTime = 0;  // Impossible d'anticiper, démarrer immédiatement
     }
@@ -172,10 +237,23 @@ void NoteSequencer::startNoteSequence(byte note, byte velocity, unsigned long sc
   _currentNote = note;
   _currentVelocity = velocity;
   _eventScheduledTime = scheduledTime;
+  #if SERVO_MOTION_PROFILE
+  _positioningDelay = _fingerCtrl.predictSettleTimeForNote(note);
+  #else
+  _positioningDelay = servoToSolenoidDelayMs() + _fingerCtrl.getWakeDelay();
+  #endif
 
   // Positionner les servos doigts
   _fingerCtrl.setFingerPatternForNote(note);
 
+  // Valve fermée : commander le servo débit tout de suite, en parallèle des
+  // doigts (sinon il ne partait qu'à l'ouverture : attaque avec le débit
+  // précédent, en retard ou qui craque)
+  _airflowPrepared = !_airflowCtrl.isSolenoidOpen();
+  if (_airflowPrepared) {
+    _airflowCtrl.prepareAirflowForNote(note, velocity, _fingerCtrl.getWakeDelay());
+  }
+
   // Transition vers POSITIONING
   transitionTo(STATE_POSITIONING);
 
@@ -189,11 +267,77 @@ void NoteSequencer::startNoteSequence(byte note, byte velocity, unsigned long sc
     Serial.print("ms | Son prévu à t=");
     Serial.print(targetTime);
     Serial.print("ms (dans ");
-    Serial.print(SERVO_TO_SOLENOID_DELAY_MS);
+    Serial.print(_positioningDelay);
     Serial.println("ms)");
   }
 }
 
+void NoteSequencer::startOrnamentNote(byte note, byte velocity, unsigned long scheduledTime) {
+  if (DEBUG && !_ornamentActive) {
+    Serial.print("DEBUG: NoteSequencer - Mode ORNEMENT ");
+    Serial.print(_currentNote);
+    Serial.print(" <-> ");
+    Serial.println(note);
+  }
+
+  _ornamentActive = true;
+  _airflowPrepared = false;
+  _currentNote = note;
+  _currentVelocity = velocity;
+  _eventScheduledTime = scheduledTime;
+
+  #if SERVO_MOTION_PROFILE
+  _positioningDelay = _fingerCtrl.predictSettleTimeForNote(note);
+  #else
+  _positioningDelay = ORNAMENT_SERVO_DELAY_MS;
+  #endif
+
+  // Positionner les doigts (seuls ceux qui diffèrent bougent physiquement)
+  _fingerCtrl.setFingerPatternForNote(note);
+
+  // Valve et débit restent en place : handlePositioning() re-cible l'airflow
+  transitionTo(STATE_POSITIONING);
+}
+
+bool NoteSequencer::isOrnamentTransition(const MidiEvent* noteOff, const MidiEvent* nextOn, int offset) {
+  #if ORNAMENT_ENABLED
+  if (nextOn->midiNote == _currentNote) {
+    return false;
+  }
+
+  // Enchaînement legato (pas de silence réel entre les deux notes)
+  if (nextOn->timestamp - noteOff->timestamp >= minNoteIntervalForValveCloseMs()) {
+    return false;
+  }
+
+  // Attaques rapprochées
+  unsigned long nextAbsoluteTime = _playbackStartTime + nextOn->timestamp;
+  if (nextAbsoluteTime - _eventScheduledTime > ORNAMENT_MAX_INTERVAL_MS) {
+    return false;
+  }
+
+  // Doigtés voisins (trille : un ou deux trous)
+  if (countFingerChanges(_currentNote, nextOn->midiNote) > ORNAMENT_MAX_FINGER_CHANGES) {
+    return false;
+  }
+
+  // Ornement déjà engagé : on continue tant que les conditions tiennent
+  if (_ornamentActive) {
+    return true;
+  }
+
+  // Sinon exiger une alternance A-B-A : retour rapide à la note courante
+  for (int i = offset + 1; i < _eventQueue.getCount(); i++) {
+    MidiEvent* event = _eventQueue.peekAt(i);
+    if (event->type == EVENT_NOTE_ON) {
+      return event->midiNote == _currentNote &&
+             event->timestamp - nextOn->timestamp <= ORNAMENT_MAX_INTERVAL_MS;
+    }
+  }
+  #endif
+  return false;
+}
+
 bool NoteSequencer::shouldCloseValveBetweenNotes() {
   // Regarder la prochaine note dans la queue
   MidiEvent* nextEvent = _eventQueue.peek();
@@ -208,11 +352,12 @@ bool NoteSequencer::shouldCloseValveBetweenNotes() {
   unsigned long nextNoteTime = _playbackStartTime + nextEvent->timestamp;
 
   // Si la prochaine note doit démarrer dans moins de MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS
-  // on garde la valve ouverte pour économiser usure et améliorer fluidité
+  // (plus longtemps si la bobine chauffe) on garde la valve ouverte pour
+  // économiser usure, chaleur et améliorer fluidité
   if (nextNoteTime > currentTime) {
     unsigned long interval = nextNoteTime - currentTime;
 
-    if (interval < MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS) {
+    if (interval < _airflowCtrl.valveCloseIntervalMs()) {
       if (DEBUG) {
         Serial.print("DEBUG: NoteSequencer - Valve GARDÉE ouverte (note suivante dans ");
         Serial.print(interval);
@@ -225,7 +370,21 @@ bool NoteSequencer::shouldCloseValveBetweenNotes() {
   return true;  // Fermer la valve
 }
 
+uint16_t NoteSequencer::knownSustainMs() {
+  MidiEvent* nextEvent = _eventQueue.peek();
+  if (nextEvent == nullptr || nextEvent->type != EVENT_NOTE_OFF ||
+      nextEvent->midiNote != _currentNote) {
+    return 0;
+  }
+
+  long remaining = (long)(_playbackStartTime + nextEvent->timestamp - millis());
+  return (uint16_t)constrain(remaining, 1L, 65535L);
+}
+
 void NoteSequencer::stopCurrentNote() {
+  // Fin d'ornement éventuel : retour au cycle complet
+  _ornamentActive = false;
+
   // Vérifier s'il faut fermer la valve ou la garder ouverte
   bool closeValve = shouldCloseValveBetweenNotes();
 
@@ -270,6 +429,7 @@ void NoteSequencer::stop() {
   // Forcer l'arrêt immédiat (pour All Sound Off)
   _currentNote = 0;
   _currentVelocity = 0;
+  _ornamentActive = false;
   transitionTo(STATE_IDLE);
 
   if (DEBUG) {
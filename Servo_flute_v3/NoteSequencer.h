@@ -5,6 +5,7 @@
 #include "EventQueue.h"
 #include "FingerController.h"
 #include "AirflowController.h"
+#include "Telemetry.h"
 #include "settings.h"
 
 // États de la machine à états pour une note
@@ -45,6 +46,9 @@ private:
   unsigned long _stateStartTime;      // Timestamp de début de l'état actuel
   unsigned long _eventScheduledTime;  // Timestamp absolu où l'événement doit être joué
   unsigned long _playbackStartTime;   // Timestamp de début de la lecture (millis absolu)
+  unsigned long _positioningDelay;    // Délai servos→solénoïde de la note en cours (prévu)
+  bool _ornamentActive;               // Mode ornement (trille, cut, roll) en cours
+  bool _airflowPrepared;              // Servo débit parti avec les doigts (valve fermée)
 
   // Traite le prochain événement dans la queue
   void processNextEvent();
@@ -67,11 +71,22 @@ private:
   // Démarre la séquence de jeu d'une note
   void startNoteSequence(byte note, byte velocity, unsigned long scheduledTime);
 
+  // Enchaîne la note suivante d'un ornement (air maintenu, doigts seulement)
+  void startOrnamentNote(byte note, byte velocity, unsigned long scheduledTime);
+
+  // Vérifie si le passage vers nextOn (position offset dans la queue)
+  // fait partie d'une alternance rapide entre deux notes
+  bool isOrnamentTransition(const MidiEvent* noteOff, const MidiEvent* nextOn, int offset);
+
   // Arrête la note en cours
   void stopCurrentNote();
 
   // Vérifie s'il faut fermer la valve entre deux notes (optimisation)
   bool shouldCloseValveBetweenNotes();
+
+  // Durée restante de la note courante si son Note Off est déjà en queue
+  // (0 = inconnue : jeu en direct sans anticipation suffisante)
+  uint16_t knownSustainMs();
 };
 
 #endif
@@ -0,0 +1,210 @@
+#include "PowerBudget.h"
+
+PowerBudget::PowerBudget()
+  : _count(0),
+    _continuousMa(POWER_BASE_MA + NUMBER_FLUTES * (NUMBER_SERVOS_FINGER + 1) * POWER_SERVO_IDLE_MA),
+    _peakCurrent(0), _staggerCount(0), _maxStaggerMs(0), _overBudgetCount(0), _overBudget(false),
+    _supplyMv(POWER_SUPPLY_NOMINAL_MV), _supplySamples(0) {
+}
+
+unsigned long PowerBudget::schedule(uint16_t peakMa, unsigned long peakMs,
+                                    uint16_t runMa, unsigned long runMs,
+                                    unsigned long earliest, unsigned long latest) {
+  unsigned long bestStart = earliest;
+  uint16_t bestPeak = 0xFFFF;
+
+  for (unsigned long start = earliest; (long)(latest - start) >= 0; start += POWER_STAGGER_STEP_MS) {
+    uint32_t peak = (uint32_t)peakOver(start, start + peakMs) + peakMa;
+    if (runMs > 0) {
+      uint32_t run = (uint32_t)peakOver(start + peakMs, start + peakMs + runMs) + runMa;
+      if (run > peak) peak = run;
+    }
+
+    if (peak <= POWER_BUDGET_MA) {
+      bestStart = start;
+      break;
+    }
+    // Pas de place : retenir le départ le moins chargé
+    if (peak < bestPeak) {
+      bestPeak = peak;
+      bestStart = start;
+    }
+  }
+
+  append(nullptr, peakMa, bestStart, bestStart + peakMs);
+  if (runMs > 0) {
+    append(nullptr, runMa, bestStart + peakMs, bestStart + peakMs + runMs);
+  }
+  return bestStart;
+}
+
+void PowerBudget::addLoad(const void* owner, uint16_t mA, unsigned long from, unsigned long until) {
+  // Prolonger la réservation en cours du même owner (vibrato, CC2...)
+  if (owner != nullptr) {
+    for (uint8_t i = 0; i < _count; i++) {
+      Reservation& r = _reservations[i];
+      if (r.owner == owner && r.mA == mA &&
+          (long)(from - r.start) >= 0 && (long)(r.end - from) >= 0) {
+        if ((long)(until - r.end) > 0) {
+          r.end = until;
+        }
+        return;
+      }
+    }
+  }
+  append(owner, mA, from, until);
+}
+
+void PowerBudget::addContinuousLoad(int16_t deltaMa) {
+  if (deltaMa < 0 && (uint16_t)(-deltaMa) > _continuousMa) {
+    _continuousMa = 0;
+  } else {
+    _continuousMa += deltaMa;
+  }
+}
+
+uint16_t PowerBudget::currentAt(unsigned long t) const {
+  uint32_t total = _continuousMa;
+  for (uint8_t i = 0; i < _count; i++) {
+    const Reservation& r = _reservations[i];
+    if ((long)(t - r.start) >= 0 && (long)(r.end - t) > 0) {
+      total += r.mA;
+    }
+  }
+  return (total > 0xFFFF) ? 0xFFFF : (uint16_t)total;
+}
+
+uint16_t PowerBudget::peakOver(unsigned long from, unsigned long until) const {
+  // Le maximum est atteint au début de la fenêtre ou au début d'une réservation
+  uint16_t peak = currentAt(from);
+  for (uint8_t i = 0; i < _count; i++) {
+    unsigned long s = _reservations[i].start;
+    if ((long)(s - from) > 0 && (long)(until - s) > 0) {
+      uint16_t current = currentAt(s);
+      if (current > peak) peak = current;
+    }
+  }
+  return peak;
+}
+
+void PowerBudget::append(const void* owner, uint16_t mA, unsigned long from, unsigned long until) {
+  if ((long)(until - from) <= 0) {
+    return;
+  }
+
+  // Pas de purge ici : un rollback() doit retrouver les indices du checkpoint()
+  if (_count >= POWER_MAX_RESERVATIONS) {
+    if (DEBUG) {
+      Serial.println("DEBUG: PowerBudget - Table de réservations pleine");
+    }
+    return;
+  }
+
+  _reservations[_count].start = from;
+  _reservations[_count].end = until;
+  _reservations[_count].mA = mA;
+  _reservations[_count].owner = owner;
+  _count++;
+}
+
+void PowerBudget::purge(unsigned long now) {
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if ((long)(_reservations[i].end - now) > 0) {
+      _reservations[kept++] = _reservations[i];
+    }
+  }
+  _count = kept;
+}
+
+uint8_t PowerBudget::checkpoint(unsigned long now) {
+  purge(now);
+  return _count;
+}
+
+void PowerBudget::rollback(uint8_t checkpoint) {
+  if (checkpoint < _count) {
+    _count = checkpoint;
+  }
+}
+
+void PowerBudget::update() {
+  unsigned long now = millis();
+  purge(now);
+
+  #if POWER_SUPPLY_SENSE_ENABLED
+  sampleSupply();
+  #endif
+
+  uint16_t current = currentAt(now);
+
+  if (current > _peakCurrent) {
+    _peakCurrent = current;
+
+    if (DEBUG) {
+      Serial.print("DEBUG: PowerBudget - Nouveau pic estimé: ");
+      Serial.print(_peakCurrent);
+      Serial.println("mA");
+    }
+  }
+
+  // Dépassement : compté une fois par épisode
+  bool over = current > POWER_BUDGET_MA;
+  if (over && !_overBudget) {
+    _overBudgetCount++;
+
+    if (DEBUG) {
+      Serial.print("DEBUG: PowerBudget - ⚠️ Budget dépassé: ");
+      Serial.print(current);
+      Serial.print("mA > ");
+      Serial.print(POWER_BUDGET_MA);
+      Serial.println("mA");
+    }
+  }
+  _overBudget = over;
+}
+
+void PowerBudget::recordStagger(unsigned long delayMs) {
+  if (delayMs == 0) {
+    return;
+  }
+  _staggerCount++;
+  if (delayMs > _maxStaggerMs) {
+    _maxStaggerMs = delayMs;
+  }
+}
+
+void PowerBudget::resetStats() {
+  _peakCurrent = 0;
+  _staggerCount = 0;
+  _maxStaggerMs = 0;
+  _overBudgetCount = 0;
+}
+
+#if POWER_SUPPLY_SENSE_ENABLED
+void PowerBudget::sampleSupply() {
+  if (_supplySamples == 0) {
+    // Entrée = référence interne 1.1 V, référence de conversion = AVCC :
+    // VCC = 1.1 V x 1023 / mesure (aucun câblage)
+    ADMUX = _BV(REFS0) | 0x1E;
+    ADCSRB &= ~_BV(MUX5);
+  } else {
+    if (ADCSRA & _BV(ADSC)) {
+      return;  // Conversion en cours (~110 µs)
+    }
+    uint8_t low = ADCL;  // ADCL d'abord : verrouille ADCH
+    uint16_t reading = ((uint16_t)ADCH << 8) | low;
+
+    // 1re conversion après le choix d'entrée : référence pas encore établie
+    if (_supplySamples > 1 && reading > 0) {
+      int32_t mv = (uint32_t)POWER_SUPPLY_BANDGAP_MV * 1023UL / reading;
+      _supplyMv += (mv - (int32_t)_supplyMv) / 4;
+    }
+  }
+
+  if (_supplySamples < 2) {
+    _supplySamples++;
+  }
+  ADCSRA |= _BV(ADSC);
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef POWER_BUDGET_H
+#define POWER_BUDGET_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Modèle de consommation de l'alimentation 5V commune (servos + solénoïdes).
+// Chaque mouvement ou activation réserve un courant estimé sur une fenêtre de
+// temps ; les départs de doigts sont décalés de quelques ms quand la somme
+// dépasserait POWER_BUDGET_MA (évite les chutes de tension sur les pics
+// simultanés : 6 doigts + servo débit + appel du solénoïde).
+class PowerBudget {
+public:
+  PowerBudget();
+
+  // Cherche le premier départ dans [earliest, latest] (pas POWER_STAGGER_STEP_MS)
+  // où un mouvement (pic peakMa pendant peakMs puis runMa pendant runMs) tient
+  // dans le budget, et le réserve. Sans place : départ au pic le plus faible.
+  unsigned long schedule(uint16_t peakMa, unsigned long peakMs,
+                         uint16_t runMa, unsigned long runMs,
+                         unsigned long earliest, unsigned long latest);
+
+  // Réserve une charge imposée (non décalable : solénoïde, servo débit)
+  // Un même owner prolonge sa réservation en cours au lieu d'en créer une autre
+  void addLoad(const void* owner, uint16_t mA, unsigned long from, unsigned long until);
+
+  // Ajoute/retire une charge permanente (maintien solénoïde)
+  void addContinuousLoad(int16_t deltaMa);
+
+  // Courant estimé à l'instant t (mA)
+  uint16_t currentAt(unsigned long t) const;
+
+  // Point de reprise pour une planification à blanc (prédiction)
+  uint8_t checkpoint(unsigned long now);
+  void rollback(uint8_t checkpoint);
+
+  // Met à jour les statistiques et la mesure d'alimentation (appelé dans loop())
+  void update();
+
+  // Tension de l'alimentation commune (mV, moyenne glissante sur ~4 passages
+  // de loop()) ; POWER_SUPPLY_NOMINAL_MV sans POWER_SUPPLY_SENSE_ENABLED
+  uint16_t getSupplyMillivolts() const { return _supplyMv; }
+
+  // Statistiques
+  uint16_t getPeakCurrent() const { return _peakCurrent; }
+  uint16_t getStaggerCount() const { return _staggerCount; }
+  uint16_t getMaxStaggerMs() const { return _maxStaggerMs; }
+  uint16_t getOverBudgetCount() const { return _overBudgetCount; }
+  void recordStagger(unsigned long delayMs);
+  void resetStats();
+
+private:
+  struct Reservation {
+    unsigned long start;
+    unsigned long end;
+    uint16_t mA;
+    const void* owner;
+  };
+
+  Reservation _reservations[POWER_MAX_RESERVATIONS];
+  uint8_t _count;
+  uint16_t _continuousMa;   // Base + servos au repos + maintien solénoïdes
+
+  uint16_t _peakCurrent;
+  uint16_t _staggerCount;
+  uint16_t _maxStaggerMs;
+  uint16_t _overBudgetCount;
+  bool _overBudget;         // Dépassement en cours (compté une fois)
+
+  uint16_t _supplyMv;
+  uint8_t _supplySamples;   // Conversions lues (la 1re après le choix d'entrée est ignorée)
+
+  // Lit la conversion ADC terminée et lance la suivante (jamais d'attente)
+  void sampleSupply();
+
+  // Courant maximal estimé sur [from, until)
+  uint16_t peakOver(unsigned long from, unsigned long until) const;
+
+  // Ajoute une réservation brute
+  void append(const void* owner, uint16_t mA, unsigned long from, unsigned long until);
+
+  // Supprime les réservations terminées
+  void purge(unsigned long now);
+};
+
+#endif
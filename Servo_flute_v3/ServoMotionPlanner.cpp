@@ -0,0 +1,165 @@
+#include "ServoMotionPlanner.h"
+
+// Vitesse max et accélération en dixièmes de degré par ms (et ms²)
+static const float MAX_SPEED = SERVO_MAX_SPEED_DEG_S * 10.0 / 1000.0;
+static const float ACCEL = SERVO_ACCEL_DEG_S2 * 10.0 / 1000000.0;
+
+ServoMotionPlanner::ServoMotionPlanner() {
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    _motions[i].start = 0;
+    _motions[i].target = 0;
+    _motions[i].startTime = 0;
+    _motions[i].accelTime = 0;
+    _motions[i].cruiseTime = 0;
+    _motions[i].peakSpeed = 0;
+    _motions[i].endTime = 0;
+    _motions[i].settleTime = 0;
+    _motions[i].known = false;
+  }
+}
+
+void ServoMotionPlanner::computeProfile(float distance, float& accelTime, float& cruiseTime, float& peakSpeed) {
+  // Distance parcourue pendant accélération + décélération à vitesse max
+  float rampDistance = MAX_SPEED * MAX_SPEED / ACCEL;
+
+  if (distance >= rampDistance) {
+    // Trapèze complet : accélération, croisière, décélération
+    accelTime = MAX_SPEED / ACCEL;
+    cruiseTime = (distance - rampDistance) / MAX_SPEED;
+    peakSpeed = MAX_SPEED;
+  } else {
+    // Triangle : la vitesse max n'est pas atteinte
+    accelTime = sqrt(distance / ACCEL);
+    cruiseTime = 0;
+    peakSpeed = ACCEL * accelTime;
+  }
+}
+
+unsigned long ServoMotionPlanner::predictDuration(uint16_t distanceDeci) {
+  if (distanceDeci == 0) {
+    return 0;
+  }
+
+  unsigned long accelMs, travelMs;
+  predictPhases(distanceDeci, accelMs, travelMs);
+  return travelMs + SERVO_SETTLE_MS;
+}
+
+void ServoMotionPlanner::predictPhases(uint16_t distanceDeci, unsigned long& accelMs, unsigned long& travelMs) {
+  float accelTime, cruiseTime, peakSpeed;
+  computeProfile(distanceDeci, accelTime, cruiseTime, peakSpeed);
+  accelMs = (unsigned long)ceil(accelTime);
+  travelMs = (unsigned long)ceil(2 * accelTime + cruiseTime);
+}
+
+unsigned long ServoMotionPlanner::moveTo(uint8_t channel, uint16_t targetDeci, unsigned long startTime) {
+  Motion& m = _motions[channel];
+
+  if (!m.known) {
+    return jumpTo(channel, targetDeci, startTime);
+  }
+
+  // Repartir de la position au moment du départ (trajectoire éventuellement interrompue)
+  uint16_t current;
+  sample(channel, startTime, current);
+
+  uint16_t distance = (targetDeci > current) ? targetDeci - current : current - targetDeci;
+
+  m.start = current;
+  m.target = targetDeci;
+  m.startTime = startTime;
+  computeProfile(distance, m.accelTime, m.cruiseTime, m.peakSpeed);
+  m.endTime = startTime + (unsigned long)ceil(2 * m.accelTime + m.cruiseTime);
+  m.settleTime = (distance == 0) ? m.settleTime : m.endTime + SERVO_SETTLE_MS;
+
+  return m.settleTime;
+}
+
+unsigned long ServoMotionPlanner::jumpTo(uint8_t channel, uint16_t targetDeci, unsigned long now) {
+  Motion& m = _motions[channel];
+
+  m.start = targetDeci;
+  m.target = targetDeci;
+  m.startTime = now;
+  m.accelTime = 0;
+  m.cruiseTime = 0;
+  m.peakSpeed = 0;
+  m.endTime = now;
+  m.settleTime = now + servoToSolenoidDelayMs();
+  m.known = true;
+
+  return m.settleTime;
+}
+
+bool ServoMotionPlanner::sample(uint8_t channel, unsigned long now, uint16_t& positionDeci) {
+  const Motion& m = _motions[channel];
+
+  if ((long)(now - m.endTime) >= 0) {
+    positionDeci = m.target;
+    return false;
+  }
+
+  // Départ différé : le servo reste à sa position de départ
+  if ((long)(now - m.startTime) < 0) {
+    positionDeci = m.start;
+    return true;
+  }
+
+  float distance = (m.target > m.start) ? m.target - m.start : m.start - m.target;
+  float t = now - m.startTime;
+  float total = 2 * m.accelTime + m.cruiseTime;
+  float travelled;
+
+  if (t < m.accelTime) {
+    // Accélération
+    travelled = 0.5 * ACCEL * t * t;
+  } else if (t < m.accelTime + m.cruiseTime) {
+    // Vitesse constante
+    travelled = 0.5 * ACCEL * m.accelTime * m.accelTime + m.peakSpeed * (t - m.accelTime);
+  } else {
+    // Décélération (symétrique de l'accélération)
+    float remaining = total - t;
+    travelled = distance - 0.5 * ACCEL * remaining * remaining;
+  }
+
+  if (travelled > distance) travelled = distance;
+  if (travelled < 0) travelled = 0;
+
+  if (m.target > m.start) {
+    positionDeci = m.start + (uint16_t)travelled;
+  } else {
+    positionDeci = m.start - (uint16_t)travelled;
+  }
+  return true;
+}
+
+uint16_t ServoMotionPlanner::getTarget(uint8_t channel) const {
+  return _motions[channel].target;
+}
+
+bool ServoMotionPlanner::isKnown(uint8_t channel) const {
+  return _motions[channel].known;
+}
+
+unsigned long ServoMotionPlanner::getSettleTime() const {
+  unsigned long latest = _motions[0].settleTime;
+  for (int i = 1; i < NUMBER_SERVOS_FINGER; i++) {
+    if ((long)(_motions[i].settleTime - latest) > 0) {
+      latest = _motions[i].settleTime;
+    }
+  }
+  return latest;
+}
+
+bool ServoMotionPlanner::isSettled(unsigned long now) const {
+  return (long)(now - getSettleTime()) >= 0;
+}
+
+bool ServoMotionPlanner::isMoving(unsigned long now) const {
+  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+    if ((long)(now - _motions[i].endTime) < 0) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,69 @@
+#ifndef SERVO_MOTION_PLANNER_H
+#define SERVO_MOTION_PLANNER_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Planificateur de trajectoires trapézoïdales (accélération / croisière /
+// décélération) pour un groupe de servos. Les angles sont en dixièmes de
+// degré. Chaque canal garde l'instant prévu où il sera en place (fin de
+// trajectoire + SERVO_SETTLE_MS), ce qui permet d'ouvrir la valve dès que le
+// dernier doigt est posé au lieu d'attendre un délai fixe.
+class ServoMotionPlanner {
+public:
+  ServoMotionPlanner();
+
+  // Démarre une trajectoire vers targetDeci (dixièmes de degré) à startTime
+  // (éventuellement dans le futur : départ décalé par le budget de courant)
+  // Retourne l'instant prévu (millis) où le servo sera stabilisé
+  unsigned long moveTo(uint8_t channel, uint16_t targetDeci, unsigned long startTime);
+
+  // Commande immédiate (position de départ inconnue) : stabilisation
+  // estimée au pire cas SERVO_TO_SOLENOID_DELAY_MS
+  unsigned long jumpTo(uint8_t channel, uint16_t targetDeci, unsigned long now);
+
+  // Position planifiée à l'instant now (dixièmes de degré)
+  // Retourne true si le canal est encore en mouvement
+  bool sample(uint8_t channel, unsigned long now, uint16_t& positionDeci);
+
+  // Position finale commandée (dixièmes de degré)
+  uint16_t getTarget(uint8_t channel) const;
+
+  // true si la position du canal est connue (au moins une commande envoyée)
+  bool isKnown(uint8_t channel) const;
+
+  // Instant où le dernier servo sera stabilisé
+  unsigned long getSettleTime() const;
+
+  // true si tous les servos sont prévus en place à l'instant now
+  bool isSettled(unsigned long now) const;
+
+  // true si au moins un canal a une trajectoire en cours à l'instant now
+  bool isMoving(unsigned long now) const;
+
+  // Durée prévue (ms, stabilisation comprise) pour parcourir distanceDeci
+  static unsigned long predictDuration(uint16_t distanceDeci);
+
+  // Durées de la phase d'accélération et du trajet complet (ms, sans stabilisation)
+  static void predictPhases(uint16_t distanceDeci, unsigned long& accelMs, unsigned long& travelMs);
+
+private:
+  struct Motion {
+    uint16_t start;           // Position de départ (dixièmes de degré)
+    uint16_t target;          // Position cible (dixièmes de degré)
+    unsigned long startTime;  // Début de trajectoire (millis)
+    float accelTime;          // Durée des phases accélération/décélération (ms)
+    float cruiseTime;         // Durée de la phase vitesse constante (ms)
+    float peakSpeed;          // Vitesse atteinte (dixièmes de degré / ms)
+    unsigned long endTime;    // Fin de trajectoire (millis)
+    unsigned long settleTime; // Servo prévu en place (millis)
+    bool known;               // Position connue
+  };
+
+  Motion _motions[NUMBER_SERVOS_FINGER];
+
+  // Calcule les phases d'un trapèze pour une distance donnée
+  static void computeProfile(float distance, float& accelTime, float& cruiseTime, float& peakSpeed);
+};
+
+#endif
@@ -2,7 +2,8 @@
  * SERVO FLUTE V3 - Automated Recorder Player
  *
  * Architecture améliorée avec :
- * - Mode binaire uniquement (ouvert/fermé, pas de demi-ouvert)
+ * - Doigtés compactés 2 bits/doigt : fermé, ouvert, demi-trou et quart de trou
+ *   (ouverture calibrée par doigt, doigtés fingering(...) dans settings.h)
  * - Contrôle d'air hybride : servo débit + solénoïde valve
  * - Gestion du timing non-bloquante avec EventQueue
  * - Respect des délais relatifs entre notes MIDI
@@ -10,7 +11,7 @@
  *
  * Hardware:
  * - Arduino Leonardo/Micro (USB MIDI natif)
- * - PCA9685 PWM Driver (I2C)
+ * - PCA9685 PWM Driver (I2C) - une carte par flûte en mode ensemble
  * - 10 servos SG90 pour les doigts
  * - 1 servo pour le débit d'air
  * - 1 solénoïde pour valve on/off
@@ -27,11 +28,19 @@
 
 #include "settings.h"
 #include "EventQueue.h"
+#include "ServoMotionPlanner.h"
+#include "PowerBudget.h"
 #include "FingerController.h"
 #include "AirflowController.h"
 #include "NoteSequencer.h"
+#include "FluteVoice.h"
+#include "VoiceAllocator.h"
+#include "NoteRemapper.h"
+#include "ConfigStore.h"
+#include "SysexHandler.h"
 #include "InstrumentManager.h"
 #include "MidiHandler.h"
+#include "Telemetry.h"
 
 // Instances globales
 InstrumentManager* instrument = nullptr;
@@ -44,26 +53,31 @@ MidiHandler* midiHandler = nullptr;
  * un reset watchdog ou une erreur système.
  */
 void initSafeState() {
-  // Initialiser I2C pour accéder au PCA9685
-  Wire.begin();
-
-  // Créer une instance temporaire du PWM driver (adresse par défaut 0x40)
-  Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver();
-  pwm.begin();
-  pwm.setPWMFreq(SERVO_FREQUENCY);
+  #if LIVE_CONFIG_ENABLED
+  // Configuration sauvegardée (EEPROM) : doigts fermés à leurs vrais angles
+  configStore.begin();
+  #endif
 
-  // Mettre le solénoïde en état sûr (FERMÉ)
-  pinMode(SOLENOID_PIN, OUTPUT);
-  digitalWrite(SOLENOID_PIN, LOW);  // Solénoïde fermé
-
-  // Mettre le servo airflow en position repos
-  uint16_t pulseWidth = map(SERVO_AIRFLOW_OFF, 0, 180, SERVO_PULSE_MIN, SERVO_PULSE_MAX);
-  pwm.setPWM(NUM_SERVO_AIRFLOW, 0, pulseWidth);
+  // Initialiser I2C pour accéder aux PCA9685
+  Wire.begin();
 
-  // Mettre tous les servos doigts en position fermée (sécuritaire)
-  for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
-    pulseWidth = map(FINGERS[i].closedAngle, 0, 180, SERVO_PULSE_MIN, SERVO_PULSE_MAX);
-    pwm.setPWM(i, 0, pulseWidth);
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    // Créer une instance temporaire du PWM driver pour cette flûte
+    Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver(FLUTES[v].pcaAddress);
+    pwm.begin();
+    pwm.setPWMFreq(SERVO_FREQUENCY);
+
+    // Mettre le solénoïde en état sûr (FERMÉ, selon sa polarité)
+    Actuation::Solenoid::begin(FLUTES[v].solenoidPin);
+
+    // Servo airflow au repos et doigts fermés (sécuritaire), même conversion
+    // PWM que les contrôleurs : un seul envoi par lot
+    Actuation::Frame servos(FLUTES[v].pcaAddress);
+    servos.setAngle(NUM_SERVO_AIRFLOW, SERVO_AIRFLOW_OFF);
+    for (int i = 0; i < NUMBER_SERVOS_FINGER; i++) {
+      servos.setAngle(fingerChannel(i), fingerClosedAngle(i));
+    }
+    servos.flush();
   }
 
   // Petit délai pour que les servos atteignent la position
@@ -92,6 +106,7 @@ void setup() {
 
   // Créer le MIDI handler
   midiHandler = new MidiHandler(*instrument);
+  midiHandler->begin();
 
   if (DEBUG) {
     Serial.println("========================================");
@@ -104,13 +119,24 @@ void setup() {
     Serial.print(" (MIDI ");
     Serial.print(FIRST_MIDI_NOTE);
     Serial.print(" - ");
-    Serial.print(FIRST_MIDI_NOTE + NUMBER_NOTES - 1);
+    Serial.print(noteMidi(NUMBER_NOTES - 1));
     Serial.println(")");
     Serial.print("  - Servos doigts: ");
     Serial.println(NUMBER_SERVOS_FINGER);
+    Serial.print("  - Flûtes (ensemble): ");
+    Serial.println(NUMBER_FLUTES);
     Serial.print("  - Délai servos→solénoïde: ");
-    Serial.print(SERVO_TO_SOLENOID_DELAY_MS);
+    Serial.print(servoToSolenoidDelayMs());
     Serial.println(" ms");
+    #if LIVE_CONFIG_ENABLED
+    Serial.print("  - Configuration: ");
+    if (configStore.isLoadedFromEeprom()) {
+      Serial.print("EEPROM profil ");
+      Serial.println(configStore.getProfile());
+    } else {
+      Serial.println("settings.h");
+    }
+    #endif
     Serial.print("  - Taille queue: ");
     Serial.print(EVENT_QUEUE_SIZE);
     Serial.println(" événements");
@@ -139,5 +165,10 @@ void loop() {
   // Mettre à jour l'instrument (state machine + power management)
   instrument->update();
 
+  #if TELEMETRY_ENABLED
+  // Télémétrie vers l'hôte (au plus un message, jamais d'attente)
+  telemetry.update();
+  #endif
+
   // Pas de delay() pour garder la boucle réactive
 }
@@ -0,0 +1,134 @@
+#include "SolenoidHoldTimer.h"
+
+#if SOLENOID_HOLD_TIMER_ENABLED
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+// Pas du Timer3 : F_CPU / 64 = 250 kHz -> 4 µs
+#define TICKS_PER_MS (F_CPU / 64UL / 1000UL)
+
+// Broche 5 (OC3A) : sa PWM (analogWrite) vient du Timer3, repris ici
+#define TIMER3_PWM_PIN 5
+
+#if SOLENOID_USE_PWM
+constexpr bool solenoidsAvoidTimer3(uint8_t flute = 0) {
+  return flute >= NUMBER_FLUTES ||
+         (FLUTES[flute].solenoidPin != TIMER3_PWM_PIN && solenoidsAvoidTimer3(flute + 1));
+}
+static_assert(solenoidsAvoidTimer3(),
+              "Solénoïde sur la broche 5 (PWM du Timer3) : changer de broche ou SOLENOID_HOLD_TIMER_ENABLED false");
+#endif
+
+volatile SolenoidHoldTimer::Slot SolenoidHoldTimer::_slots[NUMBER_FLUTES];
+uint8_t SolenoidHoldTimer::_count = 0;
+
+void SolenoidHoldTimer::begin() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR3A = 0;                              // Mode normal, sorties OC3x déconnectées
+    TCCR3B = (1 << CS31) | (1 << CS30);      // Prédiviseur 64
+    TIMSK3 = 0;                              // Comparaison activée seulement si échéance
+    TIFR3 = (1 << OCF3A);
+  }
+
+  if (DEBUG) {
+    Serial.println("DEBUG: SolenoidHoldTimer - Timer3 actif (maintien solénoïdes, pas 4µs)");
+  }
+}
+
+uint8_t SolenoidHoldTimer::attach(uint8_t pin) {
+  if (_count == 0) {
+    begin();
+  }
+
+  uint8_t slot = _count < NUMBER_FLUTES ? _count++ : NUMBER_FLUTES - 1;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _slots[slot].pin = pin;
+    _slots[slot].armed = false;
+    _slots[slot].fired = false;
+  }
+  return slot;
+}
+
+void SolenoidHoldTimer::arm(uint8_t slot, uint8_t holdingPwm, uint16_t delayMs) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _slots[slot].holdingPwm = holdingPwm;
+    _slots[slot].start = TCNT3;
+    _slots[slot].ticks = (uint16_t)(delayMs * TICKS_PER_MS);
+    _slots[slot].armed = true;
+    _slots[slot].fired = false;
+    schedule();
+  }
+}
+
+void SolenoidHoldTimer::cancel(uint8_t slot) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    _slots[slot].armed = false;
+    _slots[slot].fired = false;
+    schedule();
+  }
+}
+
+bool SolenoidHoldTimer::takeFired(uint8_t slot, unsigned long& firedAt) {
+  bool fired;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    fired = _slots[slot].fired;
+    firedAt = _slots[slot].firedAt;
+    _slots[slot].fired = false;
+  }
+  return fired;
+}
+
+void SolenoidHoldTimer::schedule() {
+  // La comparaison ne se déclenche qu'à l'égalité : une échéance dépassée
+  // (ou trop proche pour être programmée) est servie tout de suite.
+  // Temps écoulé depuis l'armement en non signé : valable sur tout le tour
+  // du compteur (262 ms), au-delà des 131 ms d'un écart signé
+  for (;;) {
+    uint16_t now = TCNT3;
+    int8_t next = -1;
+    uint16_t nextRemaining = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+      if (!_slots[i].armed) {
+        continue;
+      }
+      uint16_t elapsed = now - _slots[i].start;
+      uint16_t ticks = _slots[i].ticks;
+      if (elapsed >= ticks || ticks - elapsed <= 2) {
+        Actuation::Solenoid::write(_slots[i].pin, _slots[i].holdingPwm);
+        _slots[i].firedAt = millis();
+        _slots[i].armed = false;
+        _slots[i].fired = true;
+      } else if (next < 0 || ticks - elapsed < nextRemaining) {
+        next = i;
+        nextRemaining = ticks - elapsed;
+      }
+    }
+
+    if (next < 0) {
+      TIMSK3 &= ~(1 << OCIE3A);
+      return;
+    }
+
+    OCR3A = _slots[next].start + _slots[next].ticks;
+    TIFR3 = (1 << OCF3A);
+    TIMSK3 |= (1 << OCIE3A);
+
+    // Échéance toujours devant le compteur : la comparaison la servira
+    uint16_t elapsed = TCNT3 - _slots[next].start;
+    if (elapsed < _slots[next].ticks && _slots[next].ticks - elapsed > 1) {
+      return;
+    }
+  }
+}
+
+void SolenoidHoldTimer::service() {
+  schedule();
+}
+
+ISR(TIMER3_COMPA_vect) {
+  SolenoidHoldTimer::service();
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef SOLENOID_HOLD_TIMER_H
+#define SOLENOID_HOLD_TIMER_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+#if SOLENOID_HOLD_TIMER_ENABLED
+
+/***********************************************************************************************
+ * Passage activation → maintien des solénoïdes sur échéance matérielle (Timer3).
+ *
+ * Timer3 en comptage libre (prédiviseur 64 : 4 µs par pas, tour complet en 262 ms) ;
+ * l'interruption de comparaison A écrit le PWM de maintien à l'échéance la plus proche
+ * puis se reprogramme sur la suivante. Une échéance par flûte (slot).
+ *
+ * L'écriture du maintien ne dépend plus du passage de loop() (plusieurs ms pendant une
+ * rafale MIDI ou un envoi I2C) : durée d'activation au pas de 4 µs, attaque régulière.
+ * La boucle principale récupère ensuite l'heure du passage (takeFired) pour le modèle
+ * thermique et les statistiques.
+ ***********************************************************************************************/
+class SolenoidHoldTimer {
+public:
+  // Configure le Timer3 (une fois, au premier attach)
+  static void begin();
+
+  // Réserve un slot pour le solénoïde de la broche pin
+  static uint8_t attach(uint8_t pin);
+
+  // Écrit holdingPwm sur la broche du slot dans delayMs (remplace l'échéance en cours)
+  static void arm(uint8_t slot, uint8_t holdingPwm, uint16_t delayMs);
+
+  // Annule l'échéance du slot (fermeture avant la fin de l'activation)
+  static void cancel(uint8_t slot);
+
+  // true une fois après le passage au maintien, avec son heure (millis)
+  static bool takeFired(uint8_t slot, unsigned long& firedAt);
+
+  // Appelé par l'interruption de comparaison
+  static void service();
+
+private:
+  static_assert(SOLENOID_ACTIVATION_MAX_MS <= 200,
+                "SOLENOID_ACTIVATION_MAX_MS : 200 ms maximum (tour du Timer3 = 262 ms)");
+
+  struct Slot {
+    uint8_t pin;
+    uint8_t holdingPwm;
+    uint16_t start;            // TCNT3 à l'armement
+    uint16_t ticks;            // Durée jusqu'à l'échéance (pas de 4 µs)
+    unsigned long firedAt;     // millis() du passage au maintien
+    bool armed;
+    bool fired;
+  };
+
+  static volatile Slot _slots[NUMBER_FLUTES];
+  static uint8_t _count;
+
+  // Programme la comparaison sur l'échéance la plus proche (interruptions coupées)
+  static void schedule();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+#include "SolenoidThermal.h"
+
+#if SOLENOID_THERMAL_ENABLED
+
+static_assert(SOLENOID_THERMAL_LIMIT_C > SOLENOID_THERMAL_WARN_C,
+              "SOLENOID_THERMAL_LIMIT_C doit dépasser SOLENOID_THERMAL_WARN_C");
+
+SolenoidThermal::SolenoidThermal()
+  : _pwm(0), _pwmSince(0), _stepStart(0), _energy(0),
+    _temperature(SOLENOID_THERMAL_AMBIENT_C) {
+}
+
+void SolenoidThermal::setPwm(uint8_t pwm, unsigned long now) {
+  accumulate(now);
+  _pwm = pwm;
+}
+
+void SolenoidThermal::accumulate(unsigned long now) {
+  // Changement daté avant le dernier (passage au maintien relevé après un pas
+  // du modèle) : compté à partir de ce pas
+  if ((long)(now - _pwmSince) < 0) {
+    return;
+  }
+  // 255² x 65 s tient sur 32 bits : aucun débordement même si loop() a calé
+  _energy += (uint32_t)_pwm * _pwm * (now - _pwmSince);
+  _pwmSince = now;
+}
+
+bool SolenoidThermal::update(unsigned long now) {
+  unsigned long dt = now - _stepStart;
+  if (dt < SOLENOID_THERMAL_PERIOD_MS) {
+    return false;
+  }
+  accumulate(now);
+
+  // Température d'équilibre pour la puissance moyenne du pas, puis
+  // rapprochement exponentiel (exact pour une puissance constante sur le pas)
+  float power = (float)_energy / (65025.0 * dt);
+  float target = SOLENOID_THERMAL_AMBIENT_C + SOLENOID_THERMAL_RISE_C * power;
+  _temperature = target + (_temperature - target) * exp(-(float)dt / (SOLENOID_THERMAL_TAU_S * 1000.0));
+
+  _energy = 0;
+  _stepStart = now;
+  return true;
+}
+
+ThermalLevel SolenoidThermal::getLevel() const {
+  if (_temperature >= SOLENOID_THERMAL_LIMIT_C) {
+    return THERMAL_LIMIT;
+  }
+  if (_temperature >= SOLENOID_THERMAL_WARN_C) {
+    return THERMAL_DERATING;
+  }
+  return THERMAL_NORMAL;
+}
+
+uint8_t SolenoidThermal::holdingPwm(uint8_t nominal) const {
+  if (_temperature <= SOLENOID_THERMAL_WARN_C || nominal <= SOLENOID_PWM_HOLDING_MIN) {
+    return nominal;
+  }
+
+  // Réduction linéaire de nominal (WARN) à SOLENOID_PWM_HOLDING_MIN (LIMIT)
+  float ratio = (_temperature - SOLENOID_THERMAL_WARN_C) /
+                (float)(SOLENOID_THERMAL_LIMIT_C - SOLENOID_THERMAL_WARN_C);
+  if (ratio > 1.0) {
+    ratio = 1.0;
+  }
+  return nominal - (uint8_t)((nominal - SOLENOID_PWM_HOLDING_MIN) * ratio + 0.5);
+}
+
+#endif
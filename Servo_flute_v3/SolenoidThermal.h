@@ -0,0 +1,45 @@
+#ifndef SOLENOID_THERMAL_H
+#define SOLENOID_THERMAL_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Niveaux thermiques de la bobine
+enum ThermalLevel {
+  THERMAL_NORMAL,       // Sous SOLENOID_THERMAL_WARN_C
+  THERMAL_DERATING,     // Maintien réduit, valve gardée ouverte plus longtemps
+  THERMAL_LIMIT         // Au-delà de SOLENOID_THERMAL_LIMIT_C : maintien au minimum
+};
+
+// Modèle thermique du 1er ordre d'une bobine de solénoïde :
+//   dT/dt = (AMBIENT + RISE x P - T) / TAU,  P = moyenne de (PWM/255)²
+// La puissance est intégrée exactement entre deux changements de PWM, puis
+// la température avance d'un pas (SOLENOID_THERMAL_PERIOD_MS) par update().
+class SolenoidThermal {
+public:
+  SolenoidThermal();
+
+  // PWM appliqué à la bobine à partir de now (0 = fermée ; now peut précéder
+  // le dernier pas de quelques ms, le changement compte alors depuis ce pas)
+  void setPwm(uint8_t pwm, unsigned long now);
+
+  // Avance le modèle si un pas est écoulé ; true si un pas a été calculé
+  bool update(unsigned long now);
+
+  float getTemperature() const { return _temperature; }
+  ThermalLevel getLevel() const;
+
+  // PWM de maintien réduit selon la température (nominal sous le seuil)
+  uint8_t holdingPwm(uint8_t nominal) const;
+
+private:
+  uint8_t _pwm;                 // PWM actuel
+  unsigned long _pwmSince;      // Début de l'intervalle à PWM constant
+  unsigned long _stepStart;     // Début du pas en cours
+  uint32_t _energy;             // Somme de PWM² x ms sur le pas en cours
+  float _temperature;           // °C
+
+  void accumulate(unsigned long now);
+};
+
+#endif
@@ -0,0 +1,188 @@
+#include "SysexHandler.h"
+
+#if LIVE_CONFIG_ENABLED
+
+SysexHandler::SysexHandler(ConfigStore& config)
+  : _config(config) {
+}
+
+void SysexHandler::handleMessage(const byte* data, uint8_t length) {
+  // En-tête : fabricant + appareil + commande
+  if (length < 3 || data[0] != SYSEX_MANUFACTURER_ID || data[1] != SYSEX_DEVICE_ID) {
+    return;  // SysEx destiné à un autre appareil
+  }
+
+  byte command = data[2];
+  const byte* args = data + 3;
+  uint8_t argLength = length - 3;
+
+  switch (command) {
+    case CMD_IDENTIFY:
+      sendIdentify();
+      break;
+
+    case CMD_GET_FINGER:
+      if (argLength != 1 || args[0] >= NUMBER_SERVOS_FINGER) {
+        sendAck(command, CONFIG_ERR_INDEX);
+      } else {
+        sendFinger(args[0]);
+      }
+      break;
+
+    case CMD_SET_FINGER:
+      if (argLength != 1 + 5 * SYSEX_FIELD_SIZE) {
+        sendAck(command, CONFIG_ERR_FORMAT);
+      } else {
+        FingerConfig finger;
+        finger.pcaChannel = SysexMessage::decodeField(args + 1);
+        finger.closedAngle = SysexMessage::decodeField(args + 1 + SYSEX_FIELD_SIZE);
+        finger.direction = (int8_t)(int16_t)SysexMessage::decodeField(args + 1 + 2 * SYSEX_FIELD_SIZE);
+        finger.halfAngle = SysexMessage::decodeField(args + 1 + 3 * SYSEX_FIELD_SIZE);
+        finger.quarterAngle = SysexMessage::decodeField(args + 1 + 4 * SYSEX_FIELD_SIZE);
+        sendAck(command, _config.setFinger(args[0], finger));
+      }
+      break;
+
+    case CMD_GET_NOTE:
+      if (argLength != 1 || args[0] >= NUMBER_NOTES) {
+        sendAck(command, CONFIG_ERR_INDEX);
+      } else {
+        sendNote(args[0]);
+      }
+      break;
+
+    case CMD_SET_NOTE:
+      if (argLength != 1 + 4 * SYSEX_FIELD_SIZE) {
+        sendAck(command, CONFIG_ERR_FORMAT);
+      } else {
+        NoteDefinition note;
+        note.midiNote = SysexMessage::decodeField(args + 1);
+        note.fingerPattern = SysexMessage::decodeField(args + 1 + SYSEX_FIELD_SIZE);
+        note.airflowMinPercent = SysexMessage::decodeField(args + 1 + 2 * SYSEX_FIELD_SIZE);
+        note.airflowMaxPercent = SysexMessage::decodeField(args + 1 + 3 * SYSEX_FIELD_SIZE);
+        sendAck(command, _config.setNote(args[0], note));
+      }
+      break;
+
+    case CMD_GET_TIMING:
+      sendTiming();
+      break;
+
+    case CMD_SET_TIMING:
+      if (argLength != 4 * SYSEX_FIELD_SIZE) {
+        sendAck(command, CONFIG_ERR_FORMAT);
+      } else {
+        TimingConfig timing;
+        timing.servoToSolenoidDelayMs = SysexMessage::decodeField(args);
+        timing.minNoteIntervalForValveCloseMs = SysexMessage::decodeField(args + SYSEX_FIELD_SIZE);
+        timing.solenoidPwmActivation = SysexMessage::decodeField(args + 2 * SYSEX_FIELD_SIZE);
+        timing.solenoidPwmHolding = SysexMessage::decodeField(args + 3 * SYSEX_FIELD_SIZE);
+        sendAck(command, _config.setTiming(timing));
+      }
+      break;
+
+    case CMD_BEGIN_EDIT:
+      sendAck(command, _config.beginEdit());
+      break;
+
+    case CMD_LOAD_DEFAULT:
+      sendAck(command, _config.loadDefaults());
+      break;
+
+    case CMD_APPLY:
+      sendAck(command, _config.apply());
+      break;
+
+    case CMD_SAVE:
+      // Sans argument : profil courant
+      if (argLength > 1) {
+        sendAck(command, CONFIG_ERR_FORMAT);
+      } else {
+        sendAck(command, argLength == 1 ? _config.save(args[0]) : _config.save());
+      }
+      break;
+
+    case CMD_SELECT:
+      if (argLength != 1) {
+        sendAck(command, CONFIG_ERR_FORMAT);
+      } else {
+        sendAck(command, _config.selectProfile(args[0]));
+      }
+      break;
+
+    case CMD_TELEMETRY:
+      #if TELEMETRY_ENABLED
+      if (argLength != 1 || args[0] > 1) {
+        sendAck(command, CONFIG_ERR_FORMAT);
+      } else {
+        telemetry.setActive(args[0] == 1);
+        sendAck(command, CONFIG_OK);
+      }
+      #else
+      sendAck(command, CONFIG_ERR_FORMAT);  // Firmware compilé sans télémétrie
+      #endif
+      break;
+
+    default:
+      sendAck(command, CONFIG_ERR_FORMAT);
+      break;
+  }
+
+  if (DEBUG) {
+    Serial.print("DEBUG: SysexHandler - Commande 0x");
+    Serial.println(command, HEX);
+  }
+}
+
+void SysexHandler::sendIdentify() {
+  byte flags = (_config.isLoadedFromEeprom() ? 0x01 : 0) | (_config.isSwapPending() ? 0x02 : 0);
+  #if TELEMETRY_ENABLED
+  flags |= telemetry.isActive() ? 0x04 : 0;
+  #endif
+  byte payload[] = { CMD_IDENTIFY, PROTOCOL_VERSION, NUMBER_SERVOS_FINGER, NUMBER_NOTES, flags,
+                     _config.getProfile(), CONFIG_PROFILE_COUNT };
+  SysexMessage::send(payload, sizeof(payload));
+}
+
+void SysexHandler::sendFinger(uint8_t index) {
+  const FingerConfig& finger = _config.getFinger(index);
+  byte payload[2 + 5 * SYSEX_FIELD_SIZE] = { CMD_GET_FINGER, index };
+  SysexMessage::encodeField(payload + 2, finger.pcaChannel);
+  SysexMessage::encodeField(payload + 2 + SYSEX_FIELD_SIZE, finger.closedAngle);
+  SysexMessage::encodeField(payload + 2 + 2 * SYSEX_FIELD_SIZE, (uint16_t)(int16_t)finger.direction);
+  SysexMessage::encodeField(payload + 2 + 3 * SYSEX_FIELD_SIZE, finger.halfAngle);
+  SysexMessage::encodeField(payload + 2 + 4 * SYSEX_FIELD_SIZE, finger.quarterAngle);
+  SysexMessage::send(payload, sizeof(payload));
+}
+
+void SysexHandler::sendNote(uint8_t index) {
+  const NoteDefinition& note = _config.getNote(index);
+  byte payload[2 + 4 * SYSEX_FIELD_SIZE] = { CMD_GET_NOTE, index };
+  SysexMessage::encodeField(payload + 2, note.midiNote);
+  SysexMessage::encodeField(payload + 2 + SYSEX_FIELD_SIZE, note.fingerPattern);
+  SysexMessage::encodeField(payload + 2 + 2 * SYSEX_FIELD_SIZE, note.airflowMinPercent);
+  SysexMessage::encodeField(payload + 2 + 3 * SYSEX_FIELD_SIZE, note.airflowMaxPercent);
+  SysexMessage::send(payload, sizeof(payload));
+}
+
+void SysexHandler::sendTiming() {
+  const TimingConfig& timing = _config.getTiming();
+  byte payload[1 + 4 * SYSEX_FIELD_SIZE] = { CMD_GET_TIMING };
+  SysexMessage::encodeField(payload + 1, timing.servoToSolenoidDelayMs);
+  SysexMessage::encodeField(payload + 1 + SYSEX_FIELD_SIZE, timing.minNoteIntervalForValveCloseMs);
+  SysexMessage::encodeField(payload + 1 + 2 * SYSEX_FIELD_SIZE, timing.solenoidPwmActivation);
+  SysexMessage::encodeField(payload + 1 + 3 * SYSEX_FIELD_SIZE, timing.solenoidPwmHolding);
+  SysexMessage::send(payload, sizeof(payload));
+}
+
+void SysexHandler::sendAck(byte command, ConfigStatus status) {
+  byte payload[] = { CMD_ACK, (byte)(command & 0x7F), (byte)status };
+  SysexMessage::send(payload, sizeof(payload));
+
+  if (DEBUG && status != CONFIG_OK) {
+    Serial.print("DEBUG: SysexHandler - Commande refusée, statut ");
+    Serial.println(status);
+  }
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef SYSEX_HANDLER_H
+#define SYSEX_HANDLER_H
+
+#include <Arduino.h>
+#include <MIDIUSB.h>
+#include "ConfigStore.h"
+#include "SysexMessage.h"
+#include "Telemetry.h"
+#include "settings.h"
+
+// Protocole SysEx de configuration en direct (voir docs/LIVE_CONFIG_SYSEX.md)
+//   F0 7D 01 <commande> <données...> F7
+// Valeurs 16 bits sur 3 octets de 7 bits (MSB d'abord), signées en complément à 2.
+// Chaque écriture est acquittée : F0 7D 01 7F <commande> <statut> F7
+class SysexHandler {
+public:
+  SysexHandler(ConfigStore& config);
+
+  // Traite un message SysEx complet (octets entre F0 et F7 exclus)
+  void handleMessage(const byte* data, uint8_t length);
+
+  // Commandes (hôte → flûte)
+  static const byte CMD_IDENTIFY     = 0x01;  // Réponse : version, doigts, notes, état, profils
+  static const byte CMD_GET_FINGER   = 0x10;  // <index> → réponse même commande
+  static const byte CMD_SET_FINGER   = 0x11;  // <index> canal fermé sens demi quart
+  static const byte CMD_GET_NOTE     = 0x20;  // <index> → réponse même commande
+  static const byte CMD_SET_NOTE     = 0x21;  // <index> midi doigté min% max%
+  static const byte CMD_GET_TIMING   = 0x30;  // → réponse même commande
+  static const byte CMD_SET_TIMING   = 0x31;  // délai doigts→valve, intervalle, PWM x2
+  static const byte CMD_BEGIN_EDIT   = 0x40;  // Préparation = configuration active
+  static const byte CMD_LOAD_DEFAULT = 0x41;  // Préparation = tables flash
+  static const byte CMD_APPLY        = 0x42;  // Valider, échanger entre deux notes
+  static const byte CMD_SAVE         = 0x43;  // [profil] Configuration active → EEPROM
+  static const byte CMD_SELECT       = 0x44;  // <profil> EEPROM → préparation (= Program Change)
+  static const byte CMD_TELEMETRY    = Telemetry::CMD_TELEMETRY;  // <0|1> télémétrie coupée/active
+  static const byte CMD_ACK          = 0x7F;  // Réponse : <commande> <statut>
+
+  static const byte PROTOCOL_VERSION = 3;
+
+private:
+  ConfigStore& _config;
+
+  // Réponses (lectures)
+  void sendIdentify();
+  void sendFinger(uint8_t index);
+  void sendNote(uint8_t index);
+  void sendTiming();
+
+  // Acquittement d'une commande (statut ConfigStatus)
+  void sendAck(byte command, ConfigStatus status);
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "SysexMessage.h"
+
+#if LIVE_CONFIG_ENABLED || TELEMETRY_ENABLED
+
+// En-tête F0 <fabricant> <appareil> + F7 final
+#define SYSEX_FRAMING_SIZE 4
+
+uint16_t SysexMessage::decodeField(const byte* data) {
+  return ((uint16_t)(data[0] & 0x03) << 14) | ((uint16_t)(data[1] & 0x7F) << 7) | (data[2] & 0x7F);
+}
+
+void SysexMessage::encodeField(byte* data, uint16_t value) {
+  data[0] = (value >> 14) & 0x03;
+  data[1] = (value >> 7) & 0x7F;
+  data[2] = value & 0x7F;
+}
+
+uint8_t SysexMessage::packetCount(uint8_t length) {
+  return (length + SYSEX_FRAMING_SIZE + 2) / 3;
+}
+
+void SysexMessage::send(const byte* payload, uint8_t length) {
+  uint8_t size = length + SYSEX_FRAMING_SIZE;
+
+  // Paquets USB-MIDI : CIN 0x4 (3 octets, suite) puis 0x5/0x6/0x7 (fin sur 1/2/3 octets)
+  uint8_t pos = 0;
+  while (pos < size) {
+    uint8_t remaining = size - pos;
+    midiEventPacket_t packet;
+    packet.header = (remaining > 3) ? 0x04 : 0x04 + remaining;
+    packet.byte1 = messageByte(payload, length, pos);
+    packet.byte2 = (remaining > 1) ? messageByte(payload, length, pos + 1) : 0;
+    packet.byte3 = (remaining > 2) ? messageByte(payload, length, pos + 2) : 0;
+    pos += (remaining > 3) ? 3 : remaining;
+    MidiUSB.sendMIDI(packet);
+  }
+  MidiUSB.flush();
+}
+
+byte SysexMessage::messageByte(const byte* payload, uint8_t length, uint8_t pos) {
+  if (pos == 0) return 0xF0;
+  if (pos == 1) return SYSEX_MANUFACTURER_ID;
+  if (pos == 2) return SYSEX_DEVICE_ID;
+  if (pos < length + 3) return payload[pos - 3];
+  return 0xF7;
+}
+
+#endif
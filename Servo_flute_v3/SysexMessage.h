@@ -0,0 +1,32 @@
+#ifndef SYSEX_MESSAGE_H
+#define SYSEX_MESSAGE_H
+
+#include <Arduino.h>
+#include <MIDIUSB.h>
+#include "settings.h"
+
+// Taille d'un champ codé (16 bits sur 3 x 7 bits)
+#define SYSEX_FIELD_SIZE 3
+
+// Messages SysEx de la flûte vers l'hôte, partagés par la configuration en
+// direct (SysexHandler) et la télémétrie (Telemetry) :
+//   F0 <SYSEX_MANUFACTURER_ID> <SYSEX_DEVICE_ID> <payload> F7
+// Valeurs 16 bits sur 3 octets de 7 bits (MSB d'abord), signées en complément à 2.
+class SysexMessage {
+public:
+  // Codage des champs 16 bits sur 3 octets de 7 bits
+  static uint16_t decodeField(const byte* data);
+  static void encodeField(byte* data, uint16_t value);
+
+  // Paquets USB-MIDI du message complet pour length octets de payload
+  static uint8_t packetCount(uint8_t length);
+
+  // Envoie F0 7D 01 <payload> F7 en paquets USB-MIDI
+  static void send(const byte* payload, uint8_t length);
+
+private:
+  // Octet pos du message complet (lu dans le payload, sans copie)
+  static byte messageByte(const byte* payload, uint8_t length, uint8_t pos);
+};
+
+#endif
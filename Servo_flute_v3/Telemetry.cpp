@@ -0,0 +1,176 @@
+#include "Telemetry.h"
+
+#if TELEMETRY_ENABLED
+
+// Champs du rapport d'état
+#define STATUS_FIELDS 11
+
+#ifdef ARDUINO_ARCH_AVR
+// Endpoint IN de MIDIUSB (pluggedEndpoint + 1, comme MIDI_TX dans MIDIUSB.h).
+// Membre protégé de PluggableUSBModule : lu par un pointeur sur membre.
+struct MidiEndpoint : PluggableUSBModule {
+  static uint8_t in() { return MidiUSB.*(&MidiEndpoint::pluggedEndpoint) + 1; }
+};
+#endif
+
+Telemetry telemetry;
+
+Telemetry::Telemetry()
+  : _active(TELEMETRY_START_ACTIVE), _sequence(0),
+    _solenoidsOpen(0), _solenoidSince(0), _solenoidOpenMs(0),
+    _coilTemperature(0), _holdingPwm(0), _thermalLevel(0),
+    _droppedEvents(0), _lostMessages(0),
+    _onsetHead(0), _onsetCount(0) {
+  resetWindow(0);
+}
+
+void Telemetry::setActive(bool active) {
+  if (active && !_active) {
+    // Nouvelle fenêtre : pas de temps de boucle mesuré pendant la coupure
+    _onsetCount = 0;
+    resetWindow(millis());
+  }
+  _active = active;
+
+  if (DEBUG) {
+    Serial.print("DEBUG: Telemetry - ");
+    Serial.println(active ? "Activée" : "Coupée");
+  }
+}
+
+void Telemetry::update() {
+  if (!_active) {
+    return;
+  }
+
+  // Temps de boucle : écart entre deux appels (un par passage de loop())
+  unsigned long nowMicros = micros();
+  unsigned long loopMicros = nowMicros - _lastLoopMicros;
+  _lastLoopMicros = nowMicros;
+  _loopTotalMicros += loopMicros;
+  _loopCount++;
+  if (loopMicros > _loopMaxMicros) {
+    _loopMaxMicros = (loopMicros > 0xFFFF) ? 0xFFFF : (uint16_t)loopMicros;
+  }
+
+  // Un seul message par passage : rapport d'état à l'échéance, sinon une attaque
+  unsigned long now = millis();
+  if (now - _windowStart >= TELEMETRY_PERIOD_MS) {
+    if (!sendStatus(now)) {
+      _lostMessages++;  // Abandonné : le suivant porte sa propre fenêtre
+    }
+    resetWindow(now);
+  } else if (_onsetCount > 0 && sendOnset()) {
+    _onsetHead = (_onsetHead + 1) % TELEMETRY_ONSET_BUFFER;
+    _onsetCount--;
+  }
+}
+
+void Telemetry::noteSounded(byte midiNote, byte velocity, long onsetErrorMs) {
+  if (!_active) {
+    return;
+  }
+  if (_onsetCount >= TELEMETRY_ONSET_BUFFER) {
+    _lostMessages++;
+    return;
+  }
+
+  Onset& onset = _onsets[(_onsetHead + _onsetCount) % TELEMETRY_ONSET_BUFFER];
+  onset.midiNote = midiNote;
+  onset.velocity = velocity;
+  onset.errorMs = (int16_t)constrain(onsetErrorMs, -32768L, 32767L);
+  _onsetCount++;
+}
+
+void Telemetry::solenoidChanged(bool open) {
+  accumulateSolenoids(millis());
+  if (open) {
+    _solenoidsOpen++;
+  } else if (_solenoidsOpen > 0) {
+    _solenoidsOpen--;
+  }
+}
+
+void Telemetry::solenoidThermal(float temperatureC, uint8_t holdingPwm, uint8_t level) {
+  int16_t temperature = (int16_t)(temperatureC * 10.0 + 0.5);
+  if (_thermalReports == 0) {
+    _coilTemperature = temperature;
+    _holdingPwm = holdingPwm;
+    _thermalLevel = level;
+  } else {
+    if (temperature > _coilTemperature) _coilTemperature = temperature;
+    if (holdingPwm < _holdingPwm) _holdingPwm = holdingPwm;
+    if (level > _thermalLevel) _thermalLevel = level;
+  }
+  if (_thermalReports < 0xFF) {
+    _thermalReports++;
+  }
+}
+
+void Telemetry::accumulateSolenoids(unsigned long now) {
+  _solenoidOpenMs += (unsigned long)_solenoidsOpen * (now - _solenoidSince);
+  _solenoidSince = now;
+}
+
+void Telemetry::resetWindow(unsigned long now) {
+  _windowStart = now;
+  _lastLoopMicros = micros();
+  _loopTotalMicros = 0;
+  _loopCount = 0;
+  _loopMaxMicros = 0;
+  _inputQueuePeak = 0;
+  _eventQueuePeak = 0;
+  _solenoidSince = now;
+  _solenoidOpenMs = 0;
+  _thermalReports = 0;
+}
+
+bool Telemetry::sendOnset() {
+  const Onset& onset = _onsets[_onsetHead];
+  byte payload[3 + SYSEX_FIELD_SIZE] = { CMD_TELEMETRY_ONSET, onset.midiNote, onset.velocity };
+  SysexMessage::encodeField(payload + 3, (uint16_t)onset.errorMs);
+  return send(payload, sizeof(payload));
+}
+
+bool Telemetry::sendStatus(unsigned long now) {
+  accumulateSolenoids(now);
+  unsigned long window = now - _windowStart;
+
+  uint16_t values[STATUS_FIELDS] = {
+    (uint16_t)(_loopCount ? _loopTotalMicros / _loopCount : 0),   // Boucle moyenne (µs)
+    _loopMaxMicros,                                               // Boucle max (µs)
+    _inputQueuePeak,                                              // File d'entrée MIDI (max)
+    _eventQueuePeak,                                              // Queues des flûtes (max)
+    _droppedEvents,                                               // Événements perdus (cumul)
+    (uint16_t)(_solenoidOpenMs * 1000UL / (window * NUMBER_FLUTES)),  // Solénoïdes ouverts (‰)
+    _lostMessages,                                                // Télémétrie perdue (cumul)
+    (uint16_t)window,                                             // Durée de la fenêtre (ms)
+    (uint16_t)_coilTemperature,                                   // Bobine la plus chaude (0.1 °C)
+    _holdingPwm,                                                  // PWM de maintien (min)
+    _thermalLevel                                                 // Niveau thermique (max)
+  };
+
+  byte payload[2 + STATUS_FIELDS * SYSEX_FIELD_SIZE] = { CMD_TELEMETRY_STATUS, _sequence };
+  for (uint8_t i = 0; i < STATUS_FIELDS; i++) {
+    SysexMessage::encodeField(payload + 2 + i * SYSEX_FIELD_SIZE, values[i]);
+  }
+
+  _sequence = (_sequence + 1) & 0x7F;  // Avance même si abandonné : l'hôte voit le trou
+  return send(payload, sizeof(payload));
+}
+
+bool Telemetry::send(const byte* payload, uint8_t length) {
+  #ifdef ARDUINO_ARCH_AVR
+  // Place dans l'endpoint pour tout le message, sinon rien : USB_Send()
+  // attendrait l'hôte (jusqu'à 250 ms) au lieu de rendre la main
+  if (!USBDevice.configured() ||
+      USB_SendSpace(MidiEndpoint::in()) < SysexMessage::packetCount(length) * sizeof(midiEventPacket_t)) {
+    return false;
+  }
+  #endif
+
+  SysexMessage::send(payload, length);
+  return true;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <MIDIUSB.h>
+#include "SysexMessage.h"
+#include "settings.h"
+
+// Télémétrie SysEx vers l'hôte (voir docs/TELEMETRY.md)
+//   F0 7D 01 51 <séquence> <11 champs> F7          rapport d'état (TELEMETRY_PERIOD_MS)
+//   F0 7D 01 52 <note> <vélocité> <erreur> F7      note sonnée, erreur d'attaque (ms)
+// Champs 16 bits sur 3 octets de 7 bits (comme la configuration en direct).
+// Les modules signalent leurs mesures (quelques instructions, sans envoi) ;
+// update() envoie au plus un message par passage, sans jamais attendre l'USB.
+class Telemetry {
+public:
+  Telemetry();
+
+  // Appelée à chaque passage de loop() : temps de boucle, envoi éventuel
+  void update();
+
+  // Activation (commande SysEx CMD_TELEMETRY)
+  void setActive(bool active);
+  bool isActive() const { return _active; }
+
+  // Mesures signalées par les modules
+  void noteSounded(byte midiNote, byte velocity, long onsetErrorMs);
+  void eventDropped() { _droppedEvents++; }
+  void inputQueueDepth(uint8_t depth) { if (depth > _inputQueuePeak) _inputQueuePeak = depth; }
+  void eventQueueDepth(uint8_t depth) { if (depth > _eventQueuePeak) _eventQueuePeak = depth; }
+  void solenoidChanged(bool open);
+  void solenoidThermal(float temperatureC, uint8_t holdingPwm, uint8_t level);
+
+  // Messages (hôte → flûte : CMD_TELEMETRY <0|1>, acquittée)
+  static const byte CMD_TELEMETRY        = 0x50;
+  static const byte CMD_TELEMETRY_STATUS = 0x51;
+  static const byte CMD_TELEMETRY_ONSET  = 0x52;
+
+private:
+  struct Onset {
+    byte midiNote;
+    byte velocity;
+    int16_t errorMs;
+  };
+
+  bool _active;
+  uint8_t _sequence;                 // Numéro des rapports d'état (7 bits)
+
+  // Fenêtre du rapport en cours
+  unsigned long _windowStart;        // millis()
+  unsigned long _lastLoopMicros;
+  unsigned long _loopTotalMicros;
+  uint16_t _loopCount;
+  uint16_t _loopMaxMicros;
+  uint8_t _inputQueuePeak;
+  uint8_t _eventQueuePeak;
+
+  // Rapport cyclique des solénoïdes : intégrale (ms x solénoïdes ouverts)
+  uint8_t _solenoidsOpen;
+  unsigned long _solenoidSince;
+  unsigned long _solenoidOpenMs;
+
+  // Modèle thermique des bobines : pire flûte de la fenêtre (valeurs
+  // précédentes conservées si aucun pas du modèle n'est tombé dedans)
+  uint8_t _thermalReports;
+  int16_t _coilTemperature;          // 0.1 °C, maximum
+  uint8_t _holdingPwm;               // Minimum
+  uint8_t _thermalLevel;             // Maximum
+
+  // Compteurs cumulés depuis le démarrage
+  uint16_t _droppedEvents;           // Événements perdus (queue de flûte pleine)
+  uint16_t _lostMessages;            // Télémétrie non envoyée (endpoint plein)
+
+  // Attaques en attente d'envoi
+  Onset _onsets[TELEMETRY_ONSET_BUFFER];
+  uint8_t _onsetHead;
+  uint8_t _onsetCount;
+
+  void resetWindow(unsigned long now);
+  void accumulateSolenoids(unsigned long now);
+
+  bool sendOnset();
+  bool sendStatus(unsigned long now);
+
+  // Envoie F0 7D 01 <payload> F7 s'il tient dans l'endpoint (sinon false)
+  bool send(const byte* payload, uint8_t length);
+};
+
+// Instance unique : mesures signalées directement par les modules
+extern Telemetry telemetry;
+
+#endif
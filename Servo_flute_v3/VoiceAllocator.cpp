@@ -0,0 +1,82 @@
+#include "VoiceAllocator.h"
+
+VoiceAllocator::VoiceAllocator()
+  : _allocCounter(0) {
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _heldNote[v] = 0;
+    _lastNote[v] = 0;
+    _allocOrder[v] = 0;
+  }
+}
+
+int VoiceAllocator::allocate(byte midiNote, byte& stolenNote) {
+  stolenNote = 0;
+  int best = -1;
+
+  // Note déjà tenue (re-déclenchement) : même flûte
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    if (_heldNote[v] == midiNote) {
+      best = v;
+      break;
+    }
+  }
+
+  // Flûte libre demandant le moins de mouvements servos
+  if (best < 0) {
+    uint8_t bestMoves = 0xFF;
+    for (int v = 0; v < NUMBER_FLUTES; v++) {
+      if (_heldNote[v] != 0) continue;
+
+      uint8_t moves = countFingerChanges(_lastNote[v], midiNote);
+      if (moves < bestMoves) {
+        bestMoves = moves;
+        best = v;
+      }
+    }
+  }
+
+  // Aucune flûte libre : réutiliser la plus ancienne allocation
+  if (best < 0) {
+    best = 0;
+    for (int v = 1; v < NUMBER_FLUTES; v++) {
+      if ((uint16_t)(_allocCounter - _allocOrder[v]) > (uint16_t)(_allocCounter - _allocOrder[best])) {
+        best = v;
+      }
+    }
+    stolenNote = _heldNote[best];
+  }
+
+  _heldNote[best] = midiNote;
+  _lastNote[best] = midiNote;
+  _allocOrder[best] = ++_allocCounter;
+
+  if (DEBUG) {
+    Serial.print("DEBUG: VoiceAllocator - Note ");
+    Serial.print(midiNote);
+    Serial.print(" -> flûte ");
+    Serial.print(best);
+    if (stolenNote != 0) {
+      Serial.print(" (vole note ");
+      Serial.print(stolenNote);
+      Serial.print(")");
+    }
+    Serial.println();
+  }
+
+  return best;
+}
+
+void VoiceAllocator::assign(int voice, byte soundingNote) {
+  _heldNote[voice] = soundingNote;
+  if (soundingNote != 0) {
+    _lastNote[voice] = soundingNote;
+  }
+}
+
+void VoiceAllocator::reset() {
+  // Après All Sound Off, tous les doigts sont fermés (doigté de repos)
+  for (int v = 0; v < NUMBER_FLUTES; v++) {
+    _heldNote[v] = 0;
+    _lastNote[v] = 0;
+  }
+}
@@ -0,0 +1,33 @@
+#ifndef VOICE_ALLOCATOR_H
+#define VOICE_ALLOCATOR_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Répartit les notes polyphoniques entrantes sur les flûtes de l'ensemble.
+// Priorité : flûte libre dont le doigté actuel demande le moins de servos
+// à déplacer (latence d'attaque minimale). Si aucune n'est libre, la flûte
+// qui tient la note la plus ancienne est réutilisée (voice stealing) : sa
+// note reste dans la pile des notes tenues de la flûte (HeldNoteStack).
+class VoiceAllocator {
+public:
+  VoiceAllocator();
+
+  // Choisit une flûte pour la note et la marque occupée
+  // stolenNote reçoit la note interrompue (0 si la flûte était libre)
+  int allocate(byte midiNote, byte& stolenNote);
+
+  // Note qui sonne sur une flûte après un Note On/Off (0 = flûte libre)
+  void assign(int voice, byte soundingNote);
+
+  // Libère toutes les flûtes (All Sound Off)
+  void reset();
+
+private:
+  byte _heldNote[NUMBER_FLUTES];       // Note qui sonne sur chaque flûte (0 = libre)
+  byte _lastNote[NUMBER_FLUTES];       // Dernière note jouée (doigté actuel)
+  uint16_t _allocOrder[NUMBER_FLUTES]; // Ordre d'allocation (pour voice stealing)
+  uint16_t _allocCounter;
+};
+
+#endif
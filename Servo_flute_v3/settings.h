@@ -6,22 +6,51 @@ Architecture avec servo débit + solénoïde valve + mode binaire (ouvert/fermé
 #ifndef SETTINGS_H
 #define SETTINGS_H
 #include "stdint.h"
+#include <avr/pgmspace.h>
+#include <ServoFluteCore.h>  // Actionneurs partagés avec Calibration_Tool (libraries/)
 
 #define DEBUG 1
 
 /*******************************************************************************
 -------------------------   CONFIGURATION INSTRUMENT  ------------------------
-FLÛTE IRLANDAISE EN C (Irish Flute / Tin Whistle)
-- 6 trous
-- Tonalité: C majeur (Do majeur)
-- Gamme: A#5 (La#5) à C7 (Do7)
+Profil d'instrument (ServoFluteCore/InstrumentProfiles.h) : nombre de doigts,
+tessiture et doigtés théoriques, vérifiés à la compilation.
+  IrishFluteC      6 trous, A#5 à G7 (défaut)
+  SopranoRecorder  8 doigts (pouce + 7 trous), C5 à A6
+  TinWhistleD      6 trous, D5 à B6
+  LowWhistleD      6 trous, D4 à B5
+Changer de profil : FINGERS[] et NOTES[] ci-dessous doivent être refaits pour
+cet instrument (valeurs de départ : table du profil, puis Calibration_Tool
+avec le même profil). Voir docs/INSTRUMENTS_GUIDE.md.
 ******************************************************************************/
+typedef IrishFluteC Instrument;
 
 // Nombre de servos pour les doigts
-#define NUMBER_SERVOS_FINGER 6
+#define NUMBER_SERVOS_FINGER (Instrument::FINGERS)
 
 // Nombre de notes jouables
-#define NUMBER_NOTES 14
+#define NUMBER_NOTES (Instrument::NOTES)
+
+/*******************************************************************************
+------------------   CONFIGURATION EN DIRECT (SYSEX)     --------------------
+FINGERS[], NOTES[] et les délais/PWM de la valve sont copiés en RAM au
+démarrage (ConfigStore) et modifiables par SysEx sans reflasher : écriture
+dans une copie de préparation, validation, échange entre deux notes,
+sauvegarde EEPROM optionnelle (rechargée au démarrage).
+Plusieurs profils EEPROM (un par flûte physique ou condition de jeu), écrits
+par SysEx ou par Calibration_Tool, sélectionnables par Program Change.
+Coût : 2 copies des tables en SRAM (~250 octets).
+false = tables lues directement en flash (comportement historique).
+******************************************************************************/
+#define LIVE_CONFIG_ENABLED true
+#define SYSEX_MANUFACTURER_ID 0x7D        // ID réservé usage non commercial
+#define SYSEX_DEVICE_ID 0x01              // Servo Flute
+#define SYSEX_BUFFER_SIZE 32              // Octets max entre F0 et F7
+#define CONFIG_EEPROM_ADDRESS 0           // Début des profils EEPROM
+#define CONFIG_PROFILE_COUNT 4            // Profils sauvegardables (4 x 160 = 640 octets)
+#define CONFIG_PROFILE_SIZE 160           // Octets par profil (128 utilisés, marge pour les tables)
+#define CONFIG_BOOT_PROFILE 0             // Profil chargé au démarrage (repli : settings.h)
+#define PROGRAM_CHANGE_SELECTS_PROFILE true  // Program Change n = profil n (entre deux notes)
 
 /*******************************************************************************
 ---------------------------   TIMING SETTINGS (ms)    ------------------------
@@ -34,10 +63,55 @@ FLÛTE IRLANDAISE EN C (Irish Flute / Tin Whistle)
 
 #define MIN_NOTE_DURATION_MS    10
 
+/*******************************************************************************
+-------------------   PROFILS DE MOUVEMENT SERVOS DOIGTS   -------------------
+Les doigts suivent une trajectoire trapézoïdale (accélération limitée, vitesse
+plafonnée) rafraîchie à chaque trame PWM au lieu d'un saut instantané :
+moins de dépassement, de bourdonnement et de pics de courant sur les SG90.
+Le séquenceur ouvre la valve dès que le dernier doigt en mouvement est prévu
+en place (fin de trajectoire + SERVO_SETTLE_MS) plutôt qu'après le délai fixe
+SERVO_TO_SOLENOID_DELAY_MS, qui reste utilisé si le profil est désactivé.
+
+Course 30° : ~85ms + 20ms = 105ms (équivalent au délai fixe historique)
+Demi-trou 15° : ~52ms + 20ms = 72ms
+******************************************************************************/
+#define SERVO_MOTION_PROFILE true         // false = commande directe + délai fixe
+#define SERVO_FRAME_MS 20                 // Période PWM PCA9685 (50Hz)
+#define SERVO_MAX_SPEED_DEG_S 450         // Vitesse max (SG90 à vide : ~600°/s)
+#define SERVO_ACCEL_DEG_S2 25000          // Accélération / décélération
+#define SERVO_SETTLE_MS 20                // Marge trame PWM + amortissement mécanique
+
+/*******************************************************************************
+-------------------   ORNEMENTS (TRILLES, CUTS, ROLLS)    --------------------
+Alternance rapide entre deux notes (A-B-A...) détectée dans la queue :
+l'air reste ouvert, seuls les doigts qui diffèrent bougent et le délai de
+positionnement est réduit au temps de course d'un seul doigt.
+******************************************************************************/
+#define ORNAMENT_ENABLED true
+#define ORNAMENT_MAX_INTERVAL_MS 150      // Écart max entre attaques (≥ ~7 notes/s)
+#define ORNAMENT_MAX_FINGER_CHANGES 2     // Nombre max de doigts différents
+#define ORNAMENT_SERVO_DELAY_MS 50        // Course d'un doigt (SG90 : ~0.1s/60°)
+
 /*******************************************************************************
 ---------------------------   EVENT QUEUE SETTINGS    ------------------------
 ******************************************************************************/
-#define EVENT_QUEUE_SIZE 16
+#define EVENT_QUEUE_SIZE 32        // Tables notes/doigts en flash : SRAM libérée
+
+/*******************************************************************************
+-------------------------   NOTES TENUES (MONOPHONIE)   ----------------------
+Chaque flûte garde la pile des touches enfoncées (HeldNoteStack) et ne fait
+sonner qu'une note, choisie selon la priorité (NoteArbiter) ; relâcher la note
+qui sonne revient à une note encore tenue, comme un synthé monophonique. La
+queue ne reçoit ainsi que des Note On/Off alternés pour la note qui sonne,
+même quand une note sonnant déjà est enfoncée à nouveau (Note Off puis Note On).
+  NOTE_PRIORITY_LAST  dernière note enfoncée (legato clavier, défaut)
+  NOTE_PRIORITY_HIGH  note la plus aiguë (ligne de chant d'accords)
+  NOTE_PRIORITY_LOW   note la plus grave (basse)
+Au-delà de HELD_NOTE_STACK_SIZE touches, la plus ancienne est oubliée (jamais
+la note qui sonne : la suivante l'est à sa place).
+******************************************************************************/
+#define HELD_NOTE_PRIORITY NOTE_PRIORITY_LAST
+#define HELD_NOTE_STACK_SIZE 8            // Touches mémorisées par flûte (4 octets chacune)
 
 /*******************************************************************************
 ---------------------------     SOLENOID VALVE        ------------------------
@@ -53,6 +127,68 @@ FLÛTE IRLANDAISE EN C (Irish Flute / Tin Whistle)
 #define SOLENOID_PWM_HOLDING    128
 #define SOLENOID_ACTIVATION_TIME_MS 50
 
+// MODÈLE THERMIQUE DE LA BOBINE (SolenoidThermal, un par flûte)
+// Température estimée au 1er ordre à partir du PWM réellement appliqué
+// (puissance ∝ (PWM/255)², moyenne sur chaque pas d'intégration), départ à
+// l'ambiante au démarrage. Au-delà de SOLENOID_THERMAL_WARN_C :
+//   - PWM de maintien réduit linéairement jusqu'à SOLENOID_PWM_HOLDING_MIN
+//     (atteint à SOLENOID_THERMAL_LIMIT_C) ;
+//   - valve gardée ouverte entre deux notes tant que le maintien pendant le
+//     silence chauffe moins qu'une nouvelle impulsion d'activation, au plus
+//     SOLENOID_THERMAL_KEEP_OPEN_MS (mode PWM uniquement) ;
+//   - alerte en télémétrie (et DEBUG).
+// RISE et TAU se mesurent : bobine maintenue à PWM 255, relever l'échauffement
+// final (RISE) et le temps pour en atteindre 63% (TAU).
+#define SOLENOID_THERMAL_ENABLED true
+#define SOLENOID_THERMAL_AMBIENT_C 25     // Température de départ (°C)
+#define SOLENOID_THERMAL_RISE_C 60        // Échauffement en régime permanent à PWM 255 (°C)
+#define SOLENOID_THERMAL_TAU_S 180        // Constante de temps thermique de la bobine (s)
+#define SOLENOID_THERMAL_WARN_C 70        // Début de la réduction du maintien (°C)
+#define SOLENOID_THERMAL_LIMIT_C 85       // Maintien au minimum (°C)
+#define SOLENOID_PWM_HOLDING_MIN 90       // PWM minimal qui tient encore la valve ouverte (à mesurer)
+#define SOLENOID_THERMAL_KEEP_OPEN_MS 250 // Silence max valve ouverte quand la bobine chauffe
+#define SOLENOID_THERMAL_PERIOD_MS 100    // Pas d'intégration du modèle
+
+// ATTAQUE ADAPTATIVE (mode PWM) : à chaque ouverture, durée et PWM
+// d'activation et PWM de maintien sont choisis pour un courant constant :
+//   - tension d'alimentation mesurée (POWER_SUPPLY_SENSE_ENABLED) ;
+//   - résistance de la bobine selon sa température estimée (cuivre) ;
+//   - durée de la note si son Note Off est déjà en queue : une note courte
+//     passe au maintien au moins SOLENOID_RELEASE_HOLD_MS avant sa fin
+//     (relâchement plus rapide depuis le courant de maintien).
+// SOLENOID_ACTIVATION_TIME_MS reste la durée nominale (alim et bobine
+// nominales, note longue), bornée à [MIN, MAX] après correction.
+#define SOLENOID_ACTIVATION_MIN_MS 20     // Temps d'attraction de la palette (à mesurer)
+#define SOLENOID_ACTIVATION_MAX_MS 100    // Alim faible ou bobine chaude
+#define SOLENOID_RELEASE_HOLD_MS 20       // Maintien minimal avant la fin d'une note courte
+
+// Passage au maintien sur échéance du Timer3 (interruption de comparaison,
+// résolution 4 µs) au lieu d'attendre le prochain passage de loop().
+// Reprend le Timer3 : plus de PWM (analogWrite) sur la broche 5 ni de tone().
+#define SOLENOID_HOLD_TIMER_ENABLED true
+
+// Délais et PWM valve modifiables en direct (SysEx) : lire via les accesseurs
+// ci-dessous, les #define ne sont que les valeurs par défaut
+struct TimingConfig {
+  uint16_t servoToSolenoidDelayMs;        // SERVO_TO_SOLENOID_DELAY_MS
+  uint16_t minNoteIntervalForValveCloseMs; // MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS
+  uint8_t solenoidPwmActivation;          // SOLENOID_PWM_ACTIVATION
+  uint8_t solenoidPwmHolding;             // SOLENOID_PWM_HOLDING
+};
+
+#if LIVE_CONFIG_ENABLED
+extern const TimingConfig* liveTiming;    // Valeurs actives (ConfigStore)
+inline uint16_t servoToSolenoidDelayMs()         { return liveTiming->servoToSolenoidDelayMs; }
+inline uint16_t minNoteIntervalForValveCloseMs() { return liveTiming->minNoteIntervalForValveCloseMs; }
+inline uint8_t solenoidPwmActivation()           { return liveTiming->solenoidPwmActivation; }
+inline uint8_t solenoidPwmHolding()              { return liveTiming->solenoidPwmHolding; }
+#else
+inline uint16_t servoToSolenoidDelayMs()         { return SERVO_TO_SOLENOID_DELAY_MS; }
+inline uint16_t minNoteIntervalForValveCloseMs() { return MIN_NOTE_INTERVAL_FOR_VALVE_CLOSE_MS; }
+inline uint8_t solenoidPwmActivation()           { return SOLENOID_PWM_ACTIVATION; }
+inline uint8_t solenoidPwmHolding()              { return SOLENOID_PWM_HOLDING; }
+#endif
+
 /*******************************************************************************
 ---------------------------   AIR FLOW SERVO          ------------------------
 ******************************************************************************/
@@ -61,19 +197,85 @@ FLÛTE IRLANDAISE EN C (Irish Flute / Tin Whistle)
 #define SERVO_AIRFLOW_MIN 60      // Angle minimum absolu
 #define SERVO_AIRFLOW_MAX 100     // Angle maximum absolu
 
+/*******************************************************************************
+------------------------   ENSEMBLE (MULTI-FLÛTES)    ------------------------
+Plusieurs flûtes pilotées par un seul contrôleur.
+Chaque flûte possède sa propre carte PCA9685 (adresse I2C distincte, pontets
+A0-A5) et son propre solénoïde. Le câblage des canaux PCA est identique sur
+chaque carte (FINGERS[] et NUM_SERVO_AIRFLOW s'appliquent à toutes).
+
+Structure : {adresse_I2C, pin_solénoïde}
+
+Les notes entrantes sont réparties par le VoiceAllocator : il choisit la
+flûte libre dont le doigté actuel demande le moins de servos à déplacer.
+******************************************************************************/
+#define NUMBER_FLUTES 1
+
+struct FluteConfig {
+  uint8_t pcaAddress;   // Adresse I2C de la carte PCA9685
+  uint8_t solenoidPin;  // Pin solénoïde (doit être PWM si SOLENOID_USE_PWM ;
+                        // pas la broche 5 avec SOLENOID_HOLD_TIMER_ENABLED)
+};
+
+constexpr FluteConfig FLUTES[NUMBER_FLUTES] = {
+  // Adresse  Solénoïde
+  {  0x40,    SOLENOID_PIN  }   // Flûte 1
+  // {  0x41,    11  }          // Flûte 2 (exemple, pontet A0 soudé)
+};
+
 /*******************************************************************************
 ---------------------------   POWER MANAGEMENT        ------------------------
 ******************************************************************************/
+// Coupure des servos (OE PCA9685) après TIMEUNPOWER ms sans événement en attente
+// ni note en cours. Tout événement ajouté à une queue réveille l'alimentation.
 #define TIMEUNPOWER 200
 #define PIN_SERVOS_OFF 5
+#define SERVO_RELOCK_MS 20        // Reprise de position après réveil (1 trame PWM)
+
+/*******************************************************************************
+--------------------   BUDGET DE COURANT (ALIM 5V 5A)    ---------------------
+Consommation estimée de chaque actionneur (PowerBudget). Quand la somme des
+départs simultanés dépasserait POWER_BUDGET_MA, les doigts démarrent en
+décalé par pas de POWER_STAGGER_STEP_MS : les plus longues courses partent
+d'abord, les courtes (qui ont de la marge) sont retardées. La prédiction de
+stabilisation du séquenceur inclut ce décalage : la note reste à l'heure.
+Nécessite SERVO_MOTION_PROFILE (sinon les doigts partent tous ensemble).
+******************************************************************************/
+#define POWER_BUDGET_ENABLED true
+#define POWER_BUDGET_MA 4000              // Alim 5A avec 20% de marge
+#define POWER_BASE_MA 150                 // Leonardo + PCA9685
+#define POWER_SERVO_IDLE_MA 10            // SG90 immobile (maintien)
+#define POWER_SERVO_STARTUP_MA 650        // SG90 en accélération (pic)
+#define POWER_SERVO_MOVING_MA 250         // SG90 à vitesse constante
+#define POWER_SOLENOID_ACTIVATION_MA 1000 // Solénoïde à pleine puissance
+#if SOLENOID_USE_PWM
+// Courant de maintien pour un PWM de maintien donné (calcul 32 bits : int = 16 bits sur AVR)
+#define POWER_SOLENOID_HOLD_MA(pwm) ((uint16_t)((uint32_t)POWER_SOLENOID_ACTIVATION_MA * (pwm) / 255))
+#else
+#define POWER_SOLENOID_HOLD_MA(pwm) POWER_SOLENOID_ACTIVATION_MA
+#endif
+#define POWER_STAGGER_STEP_MS 4           // Pas de décalage entre départs
+#define POWER_MAX_STAGGER_MS 40           // Décalage max d'un doigt
+#define POWER_MAX_RESERVATIONS 24         // Fenêtres de consommation suivies
+
+// Mesure de l'alimentation 5V commune (= VCC de la carte) : référence interne
+// 1.1 V lue par l'ADC contre AVCC, une conversion non bloquante par passage de
+// loop(). Sert à l'attaque adaptative des solénoïdes. Réserve l'ADC (pas
+// d'analogRead() ailleurs). Solénoïdes sur une alim séparée : mettre à false
+// (tension nominale supposée).
+#define POWER_SUPPLY_SENSE_ENABLED true
+#define POWER_SUPPLY_NOMINAL_MV 5000      // Tension pour laquelle les PWM sont réglés
+#define POWER_SUPPLY_BANDGAP_MV 1100      // Référence interne (1.0-1.2 V, à étalonner au voltmètre)
 
 /*******************************************************************************
 ------------------   CONFIGURATION SERVOS DOIGTS       ----------------------
-Structure : {PCA_channel, angle_fermé, sens_ouverture}
+Structure : {PCA_channel, angle_fermé, sens_ouverture, demi, quart}
 
 PCA_channel     : Canal PCA9685 (0-15)
 angle_fermé     : Angle servo en position fermée (0-180°)
 sens_ouverture  : 1 = horaire, -1 = anti-horaire
+demi            : Ouverture demi-trou (degrés depuis fermé, calibrée par doigt)
+quart           : Ouverture quart de trou (degrés depuis fermé)
 
 ORDRE DES TROUS (Irish Flute standard) :
   0 = Trou 1 (haut, main gauche - index)
@@ -89,24 +291,46 @@ struct FingerConfig {
   byte pcaChannel;      // Canal PCA9685
   uint16_t closedAngle; // Angle position fermée
   int8_t direction;     // 1=horaire, -1=anti-horaire
+  uint8_t halfAngle;    // Ouverture demi-trou (degrés, < ANGLE_OPEN)
+  uint8_t quarterAngle; // Ouverture quart de trou (degrés, < halfAngle)
 };
 
-const FingerConfig FINGERS[NUMBER_SERVOS_FINGER] = {
-  // PCA  Fermé  Sens
-  {  0,   90,   -1  },  // Trou 1 (haut)
-  {  1,   95,    1  },  // Trou 2
-  {  2,   90,    1  },  // Trou 3
-  {  3,   100,   1  },  // Trou 4
-  {  4,   95,   -1  },  // Trou 5
-  {  5,   90,    1  }   // Trou 6 (bas)
+// Table en flash (PROGMEM) : lire via les accesseurs finger*()
+const FingerConfig FINGERS[NUMBER_SERVOS_FINGER] PROGMEM = {
+  // PCA  Fermé  Sens  Demi  Quart
+  {  0,   90,   -1,   15,    8  },  // Trou 1 (haut)
+  {  1,   95,    1,   15,    8  },  // Trou 2
+  {  2,   90,    1,   15,    8  },  // Trou 3
+  {  3,   100,   1,   15,    8  },  // Trou 4
+  {  4,   95,   -1,   15,    8  },  // Trou 5
+  {  5,   90,    1,   15,    8  }   // Trou 6 (bas)
 };
 
+#if LIVE_CONFIG_ENABLED
+// Accesseurs FINGERS[] (copie RAM active, FINGERS[] = valeurs par défaut)
+extern const FingerConfig* liveFingers;   // Table active (ConfigStore)
+inline byte fingerChannel(int i)         { return liveFingers[i].pcaChannel; }
+inline uint16_t fingerClosedAngle(int i) { return liveFingers[i].closedAngle; }
+inline int8_t fingerDirection(int i)     { return liveFingers[i].direction; }
+inline uint8_t fingerHalfAngle(int i)    { return liveFingers[i].halfAngle; }
+inline uint8_t fingerQuarterAngle(int i) { return liveFingers[i].quarterAngle; }
+#else
+// Accesseurs FINGERS[] (lecture flash)
+inline byte fingerChannel(int i)         { return pgm_read_byte(&FINGERS[i].pcaChannel); }
+inline uint16_t fingerClosedAngle(int i) { return pgm_read_word(&FINGERS[i].closedAngle); }
+inline int8_t fingerDirection(int i)     { return (int8_t)pgm_read_byte(&FINGERS[i].direction); }
+inline uint8_t fingerHalfAngle(int i)    { return pgm_read_byte(&FINGERS[i].halfAngle); }
+inline uint8_t fingerQuarterAngle(int i) { return pgm_read_byte(&FINGERS[i].quarterAngle); }
+#endif
+
 /*******************************************************************************
 -----------------   CONFIGURATION DES NOTES JOUABLES   ----------------------
-Structure : {MIDI, {doigtés}, flow_min%, flow_max%}
+Structure : {MIDI, fingering(doigtés), flow_min%, flow_max%}
+(NoteDefinition, fingering(), FingerPattern : ServoFluteCore/InstrumentProfile.h,
+ 2 bits par doigt : 0 = fermé, 1 = ouvert, 2 = demi-trou, 3 = quart de trou)
 
-MIDI         : Numéro MIDI (82-96 pour A#5-C7)
-Doigtés      : Tableau 6 trous (0=fermé, 1=ouvert)
+MIDI         : Numéro MIDI (82-103 pour A#5-G7)
+Doigtés      : 6 trous (0=fermé, 1=ouvert, 2=demi, 3=quart)
 flow_min%    : Pourcentage MIN ouverture servo flow (0-100%)
 flow_max%    : Pourcentage MAX ouverture servo flow (0-100%)
 
@@ -114,7 +338,9 @@ Les pourcentages sont appliqués sur la plage [SERVO_AIRFLOW_MIN, SERVO_AIRFLOW_
 
 DOIGTÉS IRISH FLUTE EN C :
   000000 = C (note de base selon octave)
+  000002 = C# (demi-trou 6)
   000001 = D
+  000021 = D# (demi-trou 5)
   000011 = E
   000111 = F
   001111 = G
@@ -124,70 +350,85 @@ DOIGTÉS IRISH FLUTE EN C :
   Octaves : même doigtés avec plus d'air
 ******************************************************************************/
 
-struct NoteDefinition {
-  byte midiNote;                            // Numéro MIDI
-  bool fingerPattern[NUMBER_SERVOS_FINGER]; // Doigtés (0=fermé, 1=ouvert)
-  byte airflowMinPercent;                   // % min servo flow (0-100)
-  byte airflowMaxPercent;                   // % max servo flow (0-100)
-};
-
 // TABLE DES NOTES - Flûte irlandaise en C (à partir de A#5)
 // LOGIQUE PHYSIQUE : Plus de trous fermés = colonne d'air longue = PLUS d'air
 //                    Plus de trous ouverts = colonne d'air courte = MOINS d'air
-const NoteDefinition NOTES[NUMBER_NOTES] = {
+// Table en flash (PROGMEM) : lire via les accesseurs note*(), jamais NOTES[i] directement
+const NoteDefinition NOTES[NUMBER_NOTES] PROGMEM = {
   // OCTAVE BASSE - Notes graves (A#5 à B5)
-  // MIDI  Doigtés (6 trous)  Min%  Max%
-  {  82,  {0,1,1,1,1,1},  10,  60  },  // A#5 (La#5) - 1 fermé
-  {  83,  {1,1,1,1,1,1},  0,   50  },  // B5  (Si5) - Tous ouverts, moins d'air
+  // MIDI  Doigtés (6 trous)             Min%  Max%
+  {  82,  fingering(0,1,1,1,1,1),  10,  60  },  // A#5 (La#5) - 1 fermé
+  {  83,  fingering(1,1,1,1,1,1),  0,   50  },  // B5  (Si5) - Tous ouverts, moins d'air
 
   // OCTAVE 1 - MÉDIUM (C6 à B6)
-  {  84,  {0,0,0,0,0,0},  20,  75  },  // C6  (Do6) - Tous fermés, PLUS d'air
-  {  86,  {0,0,0,0,0,1},  15,  70  },  // D6  (Ré6) - 5 fermés
-  {  88,  {0,0,0,0,1,1},  10,  65  },  // E6  (Mi6) - 4 fermés
-  {  89,  {0,0,0,1,1,1},  10,  60  },  // F6  (Fa6) - 3 fermés
-  {  91,  {0,0,1,1,1,1},  5,   55  },  // G6  (Sol6) - 2 fermés
-  {  93,  {0,1,1,1,1,1},  5,   50  },  // A6  (La6) - 1 fermé
-  {  95,  {1,1,1,1,1,1},  0,   45  },  // B6  (Si6) - Tous ouverts, MOINS d'air
+  {  84,  fingering(0,0,0,0,0,0),  20,  75  },  // C6  (Do6) - Tous fermés, PLUS d'air
+  {  85,  fingering(0,0,0,0,0,2),  18,  72  },  // C#6 (Do#6) - Demi-trou 6
+  {  86,  fingering(0,0,0,0,0,1),  15,  70  },  // D6  (Ré6) - 5 fermés
+  {  87,  fingering(0,0,0,0,2,1),  12,  68  },  // D#6 (Ré#6) - Demi-trou 5
+  {  88,  fingering(0,0,0,0,1,1),  10,  65  },  // E6  (Mi6) - 4 fermés
+  {  89,  fingering(0,0,0,1,1,1),  10,  60  },  // F6  (Fa6) - 3 fermés
+  {  91,  fingering(0,0,1,1,1,1),  5,   55  },  // G6  (Sol6) - 2 fermés
+  {  93,  fingering(0,1,1,1,1,1),  5,   50  },  // A6  (La6) - 1 fermé
+  {  95,  fingering(1,1,1,1,1,1),  0,   45  },  // B6  (Si6) - Tous ouverts, MOINS d'air
 
   // OCTAVE 2 - AIGU (C7 à G7) - Octave sup = plus d'air partout
-  {  96,  {0,0,0,0,0,0},  50,  100 },  // C7  (Do7) - Tous fermés, octave haute
-  {  98,  {0,0,0,0,0,1},  45,  95  },  // D7  (Ré7)
-  {  100, {0,0,0,0,1,1},  40,  90  },  // E7  (Mi7)
-  {  101, {0,0,0,1,1,1},  35,  85  },  // F7  (Fa7)
-  {  103, {0,0,1,1,1,1},  30,  80  }   // G7  (Sol7) - Moins fermé, moins d'air
+  {  96,  fingering(0,0,0,0,0,0),  50,  100 },  // C7  (Do7) - Tous fermés, octave haute
+  {  98,  fingering(0,0,0,0,0,1),  45,  95  },  // D7  (Ré7)
+  {  100, fingering(0,0,0,0,1,1),  40,  90  },  // E7  (Mi7)
+  {  101, fingering(0,0,0,1,1,1),  35,  85  },  // F7  (Fa7)
+  {  103, fingering(0,0,1,1,1,1),  30,  80  }   // G7  (Sol7) - Moins fermé, moins d'air
 };
 
+#if LIVE_CONFIG_ENABLED
+// Accesseurs NOTES[] (copie RAM active, NOTES[] = valeurs par défaut)
+extern const NoteDefinition* liveNotes;   // Table active (ConfigStore)
+inline byte noteMidi(int i)                { return liveNotes[i].midiNote; }
+inline FingerPattern noteFingering(int i)  { return liveNotes[i].fingerPattern; }
+inline byte noteAirflowMin(int i)          { return liveNotes[i].airflowMinPercent; }
+inline byte noteAirflowMax(int i)          { return liveNotes[i].airflowMaxPercent; }
+#else
+// Accesseurs NOTES[] (lecture flash)
+inline byte noteMidi(int i)                { return pgm_read_byte(&NOTES[i].midiNote); }
+inline FingerPattern noteFingering(int i)  { return pgm_read_word(&NOTES[i].fingerPattern); }
+inline byte noteAirflowMin(int i)          { return pgm_read_byte(&NOTES[i].airflowMinPercent); }
+inline byte noteAirflowMax(int i)          { return pgm_read_byte(&NOTES[i].airflowMaxPercent); }
+#endif
+
 // Note MIDI la plus basse (calculée automatiquement)
-#define FIRST_MIDI_NOTE (NOTES[0].midiNote)
-
-// Fonction utilitaire pour obtenir une note par MIDI
-inline const NoteDefinition* getNoteByMidi(byte midiNote) {
-  for (int i = 0; i < NUMBER_NOTES; i++) {
-    if (NOTES[i].midiNote == midiNote) {
-      return &NOTES[i];
-    }
-  }
-  return nullptr;
-}
+#define FIRST_MIDI_NOTE (noteMidi(0))
 
-// Fonction utilitaire pour obtenir l'index d'une note
+// Fonction utilitaire pour obtenir l'index d'une note (-1 si non jouable)
 inline int getNoteIndex(byte midiNote) {
-  for (int i = 0; i < NUMBER_NOTES; i++) {
-    if (NOTES[i].midiNote == midiNote) {
-      return i;
-    }
+  return Instrument::indexOf(noteMidi, midiNote);
+}
+
+// Nombre de doigts à déplacer pour passer d'une note à l'autre
+// (note inconnue ou 0 = doigté de repos, tous fermés)
+inline uint8_t countFingerChanges(byte fromNote, byte toNote) {
+  int from = getNoteIndex(fromNote);
+  int to = getNoteIndex(toNote);
+
+  if (to < 0) {
+    return NUMBER_SERVOS_FINGER;
   }
-  return -1;
+
+  // Doigté de repos : tous fermés (0)
+  FingerPattern fromPattern = (from >= 0) ? noteFingering(from) : 0;
+  return Instrument::countChanges(fromPattern, noteFingering(to));
 }
 
 /*******************************************************************************
 -----------------------    SERVO PWM PARAMETERS       ------------------------
+Mêmes valeurs que Calibration_Tool/settings_template.h : la conversion
+angle → PWM (ServoFluteCore) est alors identique dans les deux sketches.
 ******************************************************************************/
-#define SERVO_MIN_ANGLE 0
-#define SERVO_MAX_ANGLE 180
-const uint16_t SERVO_PULSE_MIN = 550;
-const uint16_t SERVO_PULSE_MAX = 2450;
-const uint16_t SERVO_FREQUENCY = 50;
+#define SERVO_PULSE_MIN 550       // Impulsion à 0° (µs)
+#define SERVO_PULSE_MAX 2450      // Impulsion à 180° (µs)
+#define SERVO_FREQUENCY 50        // Fréquence PWM servos (Hz)
+
+// Actionneurs (conversion PWM, trame PCA9685, doigts, valve)
+typedef ActuationCore<SERVO_PULSE_MIN, SERVO_PULSE_MAX, SERVO_FREQUENCY, ANGLE_OPEN,
+                      SOLENOID_ACTIVE_HIGH, SOLENOID_USE_PWM> Actuation;
 
 /*******************************************************************************
 -------------------------     MIDI SETTINGS           ------------------------
@@ -195,11 +436,72 @@ const uint16_t SERVO_FREQUENCY = 50;
 // Canal MIDI (0 = omni mode, écoute tous les canaux | 1-16 = canal spécifique)
 #define MIDI_CHANNEL 0                    // 0 = omni, 1-16 = canal MIDI
 
+/*******************************************************************************
+-----------------------   ENTRÉE MIDI DIN (5 BROCHES)   ----------------------
+Entrée MIDI série en plus de l'USB : prise DIN → optocoupleur (6N138) → RX1
+(broche 0 du Leonardo), 31250 bauds. Octets reçus sous interruption dans un
+tampon circulaire, analysés (running status, temps réel, SysEx) puis traités
+comme les paquets USB, les deux sources fusionnées par heure d'arrivée.
+Les réponses SysEx partent toujours sur l'USB (pas de sortie DIN).
+L'interruption RX de l'USART1 est reprise : ne pas utiliser Serial1.
+******************************************************************************/
+#define DIN_MIDI_ENABLED true
+#define DIN_MIDI_BUFFER_SIZE 64           // Octets (puissance de 2) : 20 ms à pleine densité
+
+/*******************************************************************************
+-----------------------   FILE D'ENTRÉE MIDI (RAFALES)   ---------------------
+Chaque passage de loop() vide d'abord les entrées (endpoint USB, tampon DIN)
+dans une file de paquets datés à l'arrivée, puis en traite au plus
+MIDI_DISPATCH_BUDGET : une rafale (accord, SysEx de profil) n'affame plus le
+séquenceur, et les écarts entre notes restent ceux de l'arrivée, pas ceux du
+traitement. File pleine : les paquets restent dans l'endpoint USB (l'hôte
+attend) ou le tampon DIN, rien n'est perdu ici.
+******************************************************************************/
+#define MIDI_INPUT_QUEUE_SIZE 16          // Paquets (6 octets chacun)
+#define MIDI_DISPATCH_BUDGET 4            // Paquets traités par passage de loop()
+
+/*******************************************************************************
+------------------------   TÉLÉMÉTRIE (SYSEX SORTANT)   ----------------------
+État interne envoyé à l'hôte en SysEx sur l'USB-MIDI (docs/TELEMETRY.md),
+lisible depuis le DAW ou tools/servo_flute_telemetry.py (tracé en direct) :
+  - chaque note sonnée : note, vélocité, erreur d'attaque mesurée (ms)
+  - toutes les TELEMETRY_PERIOD_MS : temps de boucle (moyen/max), remplissage
+    des files, événements perdus, rapport cyclique des solénoïdes
+Au plus un message par passage de loop(), et seulement s'il tient dans
+l'endpoint USB : jamais d'attente, un rapport sans place est abandonné
+(l'hôte qui ne lit pas ne ralentit pas le séquenceur).
+Activée/coupée par SysEx (commande 0x50) ; TELEMETRY_START_ACTIVE à true
+si LIVE_CONFIG_ENABLED est à false (pas de SysEx entrant).
+******************************************************************************/
+#define TELEMETRY_ENABLED true
+#define TELEMETRY_START_ACTIVE false      // Émission dès le démarrage
+#define TELEMETRY_PERIOD_MS 100           // Période des rapports d'état
+#define TELEMETRY_ONSET_BUFFER 8          // Attaques en attente d'envoi
+
+/*******************************************************************************
+-------------------   TRANSPOSITION / REPLI DES NOTES    --------------------
+Table de correspondance 128 entrées construite au démarrage (NoteRemapper) :
+  1. Transposition par canal (RPN 0x0002 Coarse Tuning, Data Entry 64 = 0)
+  2. Repli d'octave dans la plage jouable (notes trop graves/aiguës)
+  3. Substitution par la note jouable la plus proche (chromatiques absentes)
+Le repli/substitution peut être désactivé par canal (CC NOTE_FOLD_CC < 64) :
+seules les notes exactes de NOTES[] sont alors jouées.
+La note jouée est mémorisée par touche (canal, note reçue) au Note On : le
+Note Off relâche cette note même si la transposition, le repli ou le profil
+ont changé entre-temps.
+******************************************************************************/
+#define NOTE_TRANSPOSE_DEFAULT 0          // Transposition par défaut (demi-tons)
+#define NOTE_FOLD_DEFAULT true            // Repli + substitution actifs par défaut
+#define NOTE_FOLD_CC 85                   // CC (non défini GM) : >= 64 repli ON, < 64 OFF
+#define NOTE_REMAP_HELD_KEYS 16           // Touches enfoncées mémorisées (3 octets chacune)
+
 /*******************************************************************************
 -----------------------  CONTROL CHANGE (CC) SETTINGS  -----------------------
 ******************************************************************************/
-// Rate limiting des Control Changes (protection surcharge)
-#define CC_RATE_LIMIT_PER_SECOND 10       // Limite: 10 CC par seconde
+// Les CC sont absorbés à la vitesse du câble (dernière valeur gagnante) puis
+// appliqués à l'airflow une fois par période de contrôle : aucun CC perdu,
+// coût CPU constant quelle que soit la densité des messages.
+#define CC_CONTROL_PERIOD_MS 10           // Période d'application des CC (100Hz)
 
 // Vibrato (CC1 - Modulation)
 #define VIBRATO_FREQUENCY_HZ 6.0          // Fréquence vibrato en Hz (standard musical)
@@ -219,10 +521,25 @@ const uint16_t SERVO_FREQUENCY = 50;
 // Simule l'intensité du souffle d'un musicien (via contrôleur physique ou DAW)
 
 #define CC2_ENABLED true                  // Activer contrôle breath (true/false)
-#define CC2_RATE_LIMIT_PER_SECOND 50      // Rate limit séparé pour CC2 (haute fréquence)
 #define CC2_SILENCE_THRESHOLD 10          // Seuil silence: CC2 < 10 → valve fermée
-#define CC2_SMOOTHING_BUFFER_SIZE 5       // Taille buffer lissage (moyenne glissante)
+#define CC2_SMOOTHING_BUFFER_SIZE 5       // Taille buffer lissage (5 périodes de contrôle = 50ms)
 #define CC2_RESPONSE_CURVE 1.4            // Courbe exponentielle (1.0=linéaire, 1.4=naturel)
 #define CC2_TIMEOUT_MS 1000               // Timeout fallback velocity (ms, 0=désactivé)
 
+/*******************************************************************************
+---------------  PITCH BEND / CHANNEL PRESSURE SETTINGS   --------------------
+Sur une flûte, la hauteur s'ajuste par la pression du souffle et l'ombrage
+partiel d'un trou :
+  - Pitch bend : décale l'airflow dans la plage [flow_min%, flow_max%] de la note
+  - Bend vers le bas au-delà du seuil : ombrage du premier trou non fermé
+    (ouvert → demi, demi → quart), si le doigt a une position demi/quart
+  - Channel pressure (aftertouch canal) : source de souffle alternative au CC2
+Appliqués par la même boucle de contrôle que les CC (CC_CONTROL_PERIOD_MS).
+******************************************************************************/
+#define PITCH_BEND_ENABLED true           // Pitch bend → airflow de la note
+#define PITCH_BEND_AIRFLOW_PERCENT 25     // Décalage max (% de la plage de la note, bend ±8192)
+#define PITCH_BEND_SHADING_ENABLED true   // Ombrage d'un trou pour les bends vers le bas
+#define PITCH_BEND_SHADING_THRESHOLD 4096 // Bend <= -seuil → trou ombré (4096 = mi-course)
+#define CHANNEL_PRESSURE_AS_BREATH true   // Aftertouch canal traité comme CC2 (nécessite CC2_ENABLED)
+
 #endif
@@ -0,0 +1,38 @@
+#ifndef SERVO_FLUTE_CORE_FINGER_GEOMETRY_H
+#define SERVO_FLUTE_CORE_FINGER_GEOMETRY_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>  // Compilé sur PC par tools/instrument_profiles_check.cpp
+#endif
+
+// Positions d'un doigt dans un doigté compacté (2 bits par doigt)
+#define FINGER_CLOSED  0
+#define FINGER_OPEN    1
+#define FINGER_HALF    2
+#define FINGER_QUARTER 3
+
+// Angle d'un servo doigt selon sa position, depuis son angle fermé calibré :
+//   angle = fermé + ouverture(position) × sens, borné à 0-180°
+template <uint8_t ANGLE_OPEN_DEG>
+struct FingerGeometry {
+  static inline uint8_t opening(uint8_t position, uint8_t halfAngle, uint8_t quarterAngle) {
+    switch (position) {
+      case FINGER_OPEN:    return ANGLE_OPEN_DEG;
+      case FINGER_HALF:    return halfAngle;
+      case FINGER_QUARTER: return quarterAngle;
+      default:             return 0;  // Fermé
+    }
+  }
+
+  static inline uint16_t angle(uint16_t closedAngle, int8_t direction, uint8_t position,
+                               uint8_t halfAngle, uint8_t quarterAngle) {
+    int16_t angle = (int16_t)closedAngle + (int16_t)opening(position, halfAngle, quarterAngle) * direction;
+    if (angle < 0) angle = 0;
+    if (angle > 180) angle = 180;
+    return (uint16_t)angle;
+  }
+};
+
+#endif
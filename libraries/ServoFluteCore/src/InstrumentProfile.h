@@ -0,0 +1,124 @@
+#ifndef SERVO_FLUTE_CORE_INSTRUMENT_PROFILE_H
+#define SERVO_FLUTE_CORE_INSTRUMENT_PROFILE_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>  // Compilé sur PC par tools/instrument_profiles_check.cpp
+#endif
+#include "FingerGeometry.h"
+
+/*******************************************************************************
+-----------------   POSITIONS DES DOIGTS (DOIGTÉS)    ------------------------
+Chaque doigt occupe 2 bits dans un FingerPattern (jusqu'à 8 doigts) :
+  0 = fermé   1 = ouvert   2 = demi-trou   3 = quart de trou
+Les valeurs 0/1 gardent le sens historique des doigtés binaires.
+******************************************************************************/
+
+typedef uint16_t FingerPattern;
+
+// Construit un doigté compacté (trou 1 en premier)
+constexpr FingerPattern fingering(uint8_t f0 = 0, uint8_t f1 = 0, uint8_t f2 = 0, uint8_t f3 = 0,
+                                  uint8_t f4 = 0, uint8_t f5 = 0, uint8_t f6 = 0, uint8_t f7 = 0) {
+  return (FingerPattern)((f0 & 3) | ((f1 & 3) << 2) | ((f2 & 3) << 4) | ((f3 & 3) << 6) |
+                         ((f4 & 3) << 8) | ((f5 & 3) << 10) | ((f6 & 3) << 12) | ((f7 & 3) << 14));
+}
+
+// Position d'un doigt dans un doigté compacté
+inline uint8_t getFingerPosition(FingerPattern pattern, int fingerIndex) {
+  return (pattern >> (fingerIndex * 2)) & 0x03;
+}
+
+// Doigts à déplacer entre deux doigtés : un seul XOR, champ 2 bits non nul = doigt changé
+inline FingerPattern fingerChanges(FingerPattern from, FingerPattern to) {
+  return from ^ to;
+}
+
+// Note jouable : {MIDI, doigté, flow_min%, flow_max%}
+// Les pourcentages s'appliquent sur la plage [SERVO_AIRFLOW_MIN, SERVO_AIRFLOW_MAX]
+struct NoteDefinition {
+  uint8_t midiNote;              // Numéro MIDI
+  FingerPattern fingerPattern;   // Doigtés compactés (2 bits/doigt)
+  uint8_t airflowMinPercent;     // % min servo flow (0-100)
+  uint8_t airflowMaxPercent;     // % max servo flow (0-100)
+};
+
+// Vérifications d'une table de notes à la compilation (mêmes règles que ConfigStore)
+constexpr bool notesAscending(const NoteDefinition* notes, uint8_t count) {
+  return count < 2 || (notes[0].midiNote < notes[1].midiNote && notesAscending(notes + 1, count - 1));
+}
+
+constexpr bool notesValid(const NoteDefinition* notes, uint8_t count, FingerPattern patternMask) {
+  return count == 0 ||
+         (notes[0].midiNote > 0 && notes[0].midiNote <= 127 &&
+          (notes[0].fingerPattern & ~patternMask) == 0 &&
+          notes[0].airflowMinPercent <= notes[0].airflowMaxPercent && notes[0].airflowMaxPercent <= 100 &&
+          notesValid(notes + 1, count - 1, patternMask));
+}
+
+// Profil d'instrument : nombre de doigts et table de notes par défaut, figés
+// à la compilation. Les tailles de tableaux, masques de doigtés et bornes
+// MIDI en dérivent ; une table incohérente (MIDI non croissant, doigt au-delà
+// de FINGERS, % hors limites, nombre de notes faux) ne compile pas.
+//
+// La table n'est lue qu'à la compilation par le firmware (ses valeurs
+// calibrées restent dans settings.h) : elle n'occupe ni flash ni RAM tant
+// que notes() n'est pas appelé.
+template <uint8_t FINGER_COUNT, uint8_t NOTE_COUNT, const NoteDefinition (&TABLE)[NOTE_COUNT]>
+struct InstrumentProfile {
+  static_assert(FINGER_COUNT >= 1 && FINGER_COUNT <= 8, "InstrumentProfile: 1 à 8 doigts (2 bits/doigt)");
+  static_assert(NOTE_COUNT >= 1, "InstrumentProfile: table de notes vide");
+
+  static constexpr uint8_t FINGERS = FINGER_COUNT;
+  static constexpr uint8_t NOTES = NOTE_COUNT;
+  static constexpr uint8_t FIRST_MIDI = TABLE[0].midiNote;
+  static constexpr uint8_t LAST_MIDI = TABLE[NOTE_COUNT - 1].midiNote;
+
+  // Bits de doigté utilisés / tous les doigts ouverts
+  static constexpr FingerPattern PATTERN_MASK = (FingerPattern)((1UL << (FINGER_COUNT * 2)) - 1);
+  static constexpr FingerPattern ALL_OPEN = (FingerPattern)(0x5555 & PATTERN_MASK);
+
+  static_assert(notesAscending(TABLE, NOTE_COUNT), "InstrumentProfile: notes MIDI non croissantes");
+  static_assert(notesValid(TABLE, NOTE_COUNT, PATTERN_MASK),
+                "InstrumentProfile: note invalide (MIDI, doigt hors profil ou % hors 0-100)");
+
+  // Table de notes par défaut (doigtés théoriques, % de départ)
+  static constexpr const NoteDefinition* notes() { return TABLE; }
+
+  // Note MIDI dans la tessiture du profil
+  static constexpr bool inRange(uint8_t midiNote) { return midiNote >= FIRST_MIDI && midiNote <= LAST_MIDI; }
+
+  // Index de midiNote dans une table de NOTES entrées au format du profil,
+  // lue par midiAt(i) (flash, copie RAM en direct ou table par défaut) ;
+  // -1 si absente. Boucle de longueur fixe, déroulée par le compilateur
+  template <typename MidiAt>
+  static int8_t indexOf(MidiAt midiAt, uint8_t midiNote) {
+    for (uint8_t i = 0; i < NOTE_COUNT; i++) {
+      if (midiAt(i) == midiNote) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Nombre de doigts à déplacer d'un doigté à l'autre
+  static uint8_t countChanges(FingerPattern from, FingerPattern to) {
+    FingerPattern changed = fingerChanges(from, to);
+    uint8_t changes = 0;
+    for (uint8_t i = 0; i < FINGER_COUNT; i++) {
+      if (getFingerPosition(changed, i) != 0) {
+        changes++;
+      }
+    }
+    return changes;
+  }
+};
+
+template <uint8_t F, uint8_t N, const NoteDefinition (&T)[N]> constexpr uint8_t InstrumentProfile<F, N, T>::FINGERS;
+template <uint8_t F, uint8_t N, const NoteDefinition (&T)[N]> constexpr uint8_t InstrumentProfile<F, N, T>::NOTES;
+template <uint8_t F, uint8_t N, const NoteDefinition (&T)[N]> constexpr uint8_t InstrumentProfile<F, N, T>::FIRST_MIDI;
+template <uint8_t F, uint8_t N, const NoteDefinition (&T)[N]> constexpr uint8_t InstrumentProfile<F, N, T>::LAST_MIDI;
+template <uint8_t F, uint8_t N, const NoteDefinition (&T)[N]> constexpr FingerPattern InstrumentProfile<F, N, T>::PATTERN_MASK;
+template <uint8_t F, uint8_t N, const NoteDefinition (&T)[N]> constexpr FingerPattern InstrumentProfile<F, N, T>::ALL_OPEN;
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef SERVO_FLUTE_CORE_INSTRUMENT_PROFILES_H
+#define SERVO_FLUTE_CORE_INSTRUMENT_PROFILES_H
+
+#include "InstrumentProfile.h"
+
+// Profils fournis. Doigtés : trou 1 (haut) en premier,
+// 0 = fermé, 1 = ouvert, 2 = demi-trou, 3 = quart de trou.
+// Les % sont des valeurs de départ, à affiner avec Calibration_Tool.
+
+/*******************************************************************************
+FLÛTE IRLANDAISE EN C - 6 trous, A#5 à G7, demi-trous pour C#6/D#6
+LOGIQUE PHYSIQUE : Plus de trous fermés = colonne d'air longue = PLUS d'air
+******************************************************************************/
+constexpr NoteDefinition IRISH_FLUTE_C_NOTES[] = {
+  // MIDI  Doigtés (6 trous)        Min%  Max%
+  {  82,  fingering(0,1,1,1,1,1),  10,  60  },  // A#5 (La#5)
+  {  83,  fingering(1,1,1,1,1,1),  0,   50  },  // B5  (Si5)
+  {  84,  fingering(0,0,0,0,0,0),  20,  75  },  // C6  (Do6)
+  {  85,  fingering(0,0,0,0,0,2),  18,  72  },  // C#6 (Do#6) - Demi-trou 6
+  {  86,  fingering(0,0,0,0,0,1),  15,  70  },  // D6  (Ré6)
+  {  87,  fingering(0,0,0,0,2,1),  12,  68  },  // D#6 (Ré#6) - Demi-trou 5
+  {  88,  fingering(0,0,0,0,1,1),  10,  65  },  // E6  (Mi6)
+  {  89,  fingering(0,0,0,1,1,1),  10,  60  },  // F6  (Fa6)
+  {  91,  fingering(0,0,1,1,1,1),  5,   55  },  // G6  (Sol6)
+  {  93,  fingering(0,1,1,1,1,1),  5,   50  },  // A6  (La6)
+  {  95,  fingering(1,1,1,1,1,1),  0,   45  },  // B6  (Si6)
+  {  96,  fingering(0,0,0,0,0,0),  50,  100 },  // C7  (Do7) - Octave haute
+  {  98,  fingering(0,0,0,0,0,1),  45,  95  },  // D7  (Ré7)
+  {  100, fingering(0,0,0,0,1,1),  40,  90  },  // E7  (Mi7)
+  {  101, fingering(0,0,0,1,1,1),  35,  85  },  // F7  (Fa7)
+  {  103, fingering(0,0,1,1,1,1),  30,  80  }   // G7  (Sol7)
+};
+typedef InstrumentProfile<6, 16, IRISH_FLUTE_C_NOTES> IrishFluteC;
+
+/*******************************************************************************
+FLÛTE À BEC SOPRANO (doigté baroque) - 8 doigts, C5 à A6
+  Doigt 1 = pouce (demi = pouce pincé, 2e octave)
+  Doigts 2-4 = main gauche, 5-8 = main droite
+  Doigts 7-8 = trous doubles : demi-trou = petit trou seul ouvert
+******************************************************************************/
+constexpr NoteDefinition SOPRANO_RECORDER_NOTES[] = {
+  // MIDI  Doigtés (8 doigts)              Min%  Max%
+  {  72,  fingering(0,0,0,0,0,0,0,0),  5,   40  },  // C5  (Do5)
+  {  73,  fingering(0,0,0,0,0,0,0,2),  5,   40  },  // C#5 (Do#5)
+  {  74,  fingering(0,0,0,0,0,0,0,1),  5,   42  },  // D5  (Ré5)
+  {  75,  fingering(0,0,0,0,0,0,2,1),  6,   43  },  // D#5 (Ré#5)
+  {  76,  fingering(0,0,0,0,0,0,1,1),  6,   45  },  // E5  (Mi5)
+  {  77,  fingering(0,0,0,0,0,1,0,0),  8,   46  },  // F5  (Fa5)
+  {  78,  fingering(0,0,0,0,1,0,0,1),  8,   48  },  // F#5 (Fa#5)
+  {  79,  fingering(0,0,0,0,1,1,1,1),  10,  50  },  // G5  (Sol5)
+  {  80,  fingering(0,0,0,1,0,0,2,1),  10,  52  },  // G#5 (Sol#5)
+  {  81,  fingering(0,0,0,1,1,1,1,1),  12,  54  },  // A5  (La5)
+  {  82,  fingering(0,0,1,0,0,1,1,1),  12,  56  },  // A#5 (La#5)
+  {  83,  fingering(0,0,1,1,1,1,1,1),  14,  58  },  // B5  (Si5)
+  {  84,  fingering(0,1,0,1,1,1,1,1),  15,  60  },  // C6  (Do6)
+  {  85,  fingering(1,0,0,1,1,1,1,1),  16,  62  },  // C#6 (Do#6)
+  {  86,  fingering(1,1,0,1,1,1,1,1),  18,  64  },  // D6  (Ré6)
+  {  87,  fingering(1,1,0,0,0,0,0,1),  20,  66  },  // D#6 (Ré#6)
+  {  88,  fingering(2,0,0,0,0,0,1,1),  30,  75  },  // E6  (Mi6) - Pouce pincé
+  {  89,  fingering(2,0,0,0,0,1,0,1),  32,  78  },  // F6  (Fa6)
+  {  90,  fingering(2,0,0,0,1,0,1,1),  34,  80  },  // F#6 (Fa#6)
+  {  91,  fingering(2,0,0,0,1,1,1,1),  36,  82  },  // G6  (Sol6)
+  {  92,  fingering(2,0,0,1,0,1,1,1),  38,  85  },  // G#6 (Sol#6)
+  {  93,  fingering(2,0,0,1,1,1,1,1),  40,  88  }   // A6  (La6)
+};
+typedef InstrumentProfile<8, 22, SOPRANO_RECORDER_NOTES> SopranoRecorder;
+
+/*******************************************************************************
+TIN WHISTLE EN D - 6 trous, D5 à B6, demi-trous pour F5/G#5
+******************************************************************************/
+constexpr NoteDefinition TIN_WHISTLE_D_NOTES[] = {
+  // MIDI  Doigtés (6 trous)        Min%  Max%
+  {  74,  fingering(0,0,0,0,0,0),  20,  75  },  // D5  (Ré5)
+  {  76,  fingering(0,0,0,0,0,1),  15,  70  },  // E5  (Mi5)
+  {  77,  fingering(0,0,0,0,2,1),  12,  68  },  // F5  (Fa5) - Demi-trou 5
+  {  78,  fingering(0,0,0,0,1,1),  10,  65  },  // F#5 (Fa#5)
+  {  79,  fingering(0,0,0,1,1,1),  10,  60  },  // G5  (Sol5)
+  {  80,  fingering(0,0,2,1,1,1),  8,   58  },  // G#5 (Sol#5) - Demi-trou 3
+  {  81,  fingering(0,0,1,1,1,1),  5,   55  },  // A5  (La5)
+  {  83,  fingering(0,1,1,1,1,1),  5,   50  },  // B5  (Si5)
+  {  84,  fingering(1,0,0,1,1,1),  3,   48  },  // C6  (Do6) - Doigté croisé
+  {  85,  fingering(1,1,1,1,1,1),  0,   45  },  // C#6 (Do#6)
+  {  86,  fingering(0,0,0,0,0,0),  50,  100 },  // D6  (Ré6) - Octave haute
+  {  88,  fingering(0,0,0,0,0,1),  45,  95  },  // E6  (Mi6)
+  {  90,  fingering(0,0,0,0,1,1),  40,  90  },  // F#6 (Fa#6)
+  {  91,  fingering(0,0,0,1,1,1),  35,  85  },  // G6  (Sol6)
+  {  93,  fingering(0,0,1,1,1,1),  30,  80  },  // A6  (La6)
+  {  95,  fingering(0,1,1,1,1,1),  30,  75  }   // B6  (Si6)
+};
+typedef InstrumentProfile<6, 16, TIN_WHISTLE_D_NOTES> TinWhistleD;
+
+/*******************************************************************************
+LOW WHISTLE EN D - doigtés du tin whistle une octave plus bas (D4 à B5),
+perce large : airflow réduit (% du tin whistle divisés par 1.5)
+******************************************************************************/
+constexpr NoteDefinition LOW_WHISTLE_D_NOTES[] = {
+  // MIDI  Doigtés (6 trous)        Min%  Max%
+  {  62,  fingering(0,0,0,0,0,0),  13,  50  },  // D4  (Ré4)
+  {  64,  fingering(0,0,0,0,0,1),  10,  47  },  // E4  (Mi4)
+  {  65,  fingering(0,0,0,0,2,1),  8,   45  },  // F4  (Fa4) - Demi-trou 5
+  {  66,  fingering(0,0,0,0,1,1),  7,   43  },  // F#4 (Fa#4)
+  {  67,  fingering(0,0,0,1,1,1),  7,   40  },  // G4  (Sol4)
+  {  68,  fingering(0,0,2,1,1,1),  5,   39  },  // G#4 (Sol#4) - Demi-trou 3
+  {  69,  fingering(0,0,1,1,1,1),  3,   37  },  // A4  (La4)
+  {  71,  fingering(0,1,1,1,1,1),  3,   33  },  // B4  (Si4)
+  {  72,  fingering(1,0,0,1,1,1),  2,   32  },  // C5  (Do5) - Doigté croisé
+  {  73,  fingering(1,1,1,1,1,1),  0,   30  },  // C#5 (Do#5)
+  {  74,  fingering(0,0,0,0,0,0),  33,  67  },  // D5  (Ré5) - Octave haute
+  {  76,  fingering(0,0,0,0,0,1),  30,  63  },  // E5  (Mi5)
+  {  78,  fingering(0,0,0,0,1,1),  27,  60  },  // F#5 (Fa#5)
+  {  79,  fingering(0,0,0,1,1,1),  23,  57  },  // G5  (Sol5)
+  {  81,  fingering(0,0,1,1,1,1),  20,  53  },  // A5  (La5)
+  {  83,  fingering(0,1,1,1,1,1),  20,  50  }   // B5  (Si5)
+};
+typedef InstrumentProfile<6, 16, LOW_WHISTLE_D_NOTES> LowWhistleD;
+
+// Tous les profils sont instanciés (et donc vérifiés) à chaque compilation,
+// quel que soit celui sélectionné par le sketch
+static_assert(IrishFluteC::FIRST_MIDI < IrishFluteC::LAST_MIDI, "IrishFluteC");
+static_assert(SopranoRecorder::FIRST_MIDI < SopranoRecorder::LAST_MIDI, "SopranoRecorder");
+static_assert(TinWhistleD::FIRST_MIDI < TinWhistleD::LAST_MIDI, "TinWhistleD");
+static_assert(LowWhistleD::FIRST_MIDI < LowWhistleD::LAST_MIDI, "LowWhistleD");
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SERVO_FLUTE_CORE_PCA_FRAME_H
+#define SERVO_FLUTE_CORE_PCA_FRAME_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Trame des 16 sorties d'un PCA9685, écrite par lots.
+//
+// set()/setAngle() ne font que noter la nouvelle valeur ; flush() envoie les
+// canaux modifiés, les canaux consécutifs dans une seule transaction I2C
+// (auto-incrément du PCA9685, activé par Adafruit_PWMServoDriver::setPWMFreq()).
+// Un doigté de 6 doigts part ainsi en une transaction de 25 octets au lieu de
+// 6 transactions de 5 octets, et une valeur inchangée n'est jamais renvoyée.
+//
+// Le PCA9685 doit avoir été initialisé (begin() + setPWMFreq()) avant le
+// premier flush().
+template <class Pulse>
+class PcaFrame {
+public:
+  static const uint8_t CHANNELS = 16;
+
+  explicit PcaFrame(uint8_t address = 0x40, TwoWire& wire = Wire)
+    : _wire(wire), _address(address), _dirty(0) {
+    for (uint8_t i = 0; i < CHANNELS; i++) {
+      _ticks[i] = TICKS_UNKNOWN;
+    }
+  }
+
+  // Valeur PCA brute d'un canal (écrite au prochain flush() si elle change)
+  void set(uint8_t channel, uint16_t ticks) {
+    if (channel >= CHANNELS || _ticks[channel] == ticks) return;
+    _ticks[channel] = ticks;
+    _dirty |= (uint16_t)1 << channel;
+  }
+
+  // Angle en dixièmes de degré / en degrés
+  void setAngleDeci(uint8_t channel, uint16_t angleDeci) { set(channel, Pulse::ticksDeci(angleDeci)); }
+  void setAngle(uint8_t channel, uint16_t angle)         { set(channel, Pulse::ticks(angle)); }
+
+  // Écriture immédiate d'un seul canal
+  void writeAngle(uint8_t channel, uint16_t angle) {
+    setAngle(channel, angle);
+    flush();
+  }
+
+  // Envoie les canaux modifiés depuis le dernier flush()
+  void flush() {
+    uint8_t channel = 0;
+    while (_dirty != 0) {
+      // Premier canal modifié puis canaux modifiés consécutifs (limite du tampon Wire)
+      while (!(_dirty & ((uint16_t)1 << channel))) channel++;
+      uint8_t count = 0;
+      while (channel + count < CHANNELS && count < MAX_PER_TRANSACTION &&
+             (_dirty & ((uint16_t)1 << (channel + count)))) {
+        count++;
+      }
+
+      _wire.beginTransmission(_address);
+      _wire.write(REG_LED0_ON_L + 4 * channel);
+      for (uint8_t i = 0; i < count; i++) {
+        uint16_t ticks = _ticks[channel + i];
+        _wire.write(0);                     // ON  = 0
+        _wire.write(0);
+        _wire.write(ticks & 0xFF);          // OFF = largeur d'impulsion
+        _wire.write(ticks >> 8);
+        _dirty &= ~((uint16_t)1 << (channel + i));
+      }
+      _wire.endTransmission();
+      channel += count;
+    }
+  }
+
+  // Oublie les valeurs envoyées (PCA réinitialisé ou réalimenté) :
+  // tout canal déjà commandé sera réécrit au prochain flush()
+  void invalidate() {
+    for (uint8_t i = 0; i < CHANNELS; i++) {
+      if (_ticks[i] != TICKS_UNKNOWN) _dirty |= (uint16_t)1 << i;
+    }
+  }
+
+  // Dernière valeur commandée (TICKS_UNKNOWN si jamais commandé)
+  uint16_t ticks(uint8_t channel) const { return _ticks[channel]; }
+
+  static const uint16_t TICKS_UNKNOWN = 0xFFFF;
+
+private:
+  static const uint8_t REG_LED0_ON_L = 0x06;
+#ifdef BUFFER_LENGTH
+  static const uint8_t MAX_PER_TRANSACTION = (BUFFER_LENGTH - 1) / 4;
+#else
+  static const uint8_t MAX_PER_TRANSACTION = 7;   // Tampon Wire AVR : 32 octets
+#endif
+
+  TwoWire& _wire;
+  uint8_t _address;
+  uint16_t _ticks[CHANNELS];   // Dernière valeur commandée par canal
+  uint16_t _dirty;             // Canaux à envoyer (1 bit par canal)
+};
+
+#endif
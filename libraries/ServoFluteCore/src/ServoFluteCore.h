@@ -0,0 +1,42 @@
+/***********************************************************************************************
+ * SERVO FLUTE CORE
+ *
+ * Commande des actionneurs partagée par Servo_flute_v3 et Calibration_Tool :
+ * un angle calibré dans l'outil produit exactement la même impulsion sur scène.
+ *
+ *   ServoPulse      angle → valeur PCA9685 (entier, constantes calculées à la compilation)
+ *   PcaFrame        trame d'un PCA9685, canaux modifiés envoyés par lots I2C
+ *   FingerGeometry  position d'un doigt (fermé/ouvert/demi/quart) → angle servo
+ *   SolenoidDriver  sortie valve (polarité, PWM ou tout-ou-rien)
+ *   InstrumentProfile(s)  doigtés, NoteDefinition et profils d'instruments constexpr
+ *                   (IrishFluteC, SopranoRecorder, TinWhistleD, LowWhistleD)
+ *
+ * Header-only. Chaque sketch instancie ActuationCore avec sa configuration
+ * (settings.h / settings_template.h) :
+ *
+ *   typedef ActuationCore<SERVO_PULSE_MIN, SERVO_PULSE_MAX, SERVO_FREQUENCY, ANGLE_OPEN,
+ *                         SOLENOID_ACTIVE_HIGH, SOLENOID_USE_PWM> Actuation;
+ *
+ * et sélectionne son instrument :
+ *
+ *   typedef IrishFluteC Instrument;
+ ***********************************************************************************************/
+#ifndef SERVO_FLUTE_CORE_H
+#define SERVO_FLUTE_CORE_H
+
+#include "ServoPulse.h"
+#include "PcaFrame.h"
+#include "FingerGeometry.h"
+#include "SolenoidDriver.h"
+#include "InstrumentProfiles.h"
+
+template <uint16_t PULSE_MIN_US, uint16_t PULSE_MAX_US, uint16_t FREQUENCY_HZ,
+          uint8_t ANGLE_OPEN_DEG, bool SOLENOID_ACTIVE_HIGH, bool SOLENOID_PWM>
+struct ActuationCore {
+  typedef ServoPulse<PULSE_MIN_US, PULSE_MAX_US, FREQUENCY_HZ> Pulse;
+  typedef PcaFrame<Pulse> Frame;
+  typedef FingerGeometry<ANGLE_OPEN_DEG> Geometry;
+  typedef SolenoidDriver<SOLENOID_ACTIVE_HIGH, SOLENOID_PWM> Solenoid;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SERVO_FLUTE_CORE_SERVO_PULSE_H
+#define SERVO_FLUTE_CORE_SERVO_PULSE_H
+
+#include <Arduino.h>
+
+// Conversion angle → valeur PCA9685 (pas de 1/4096 de période), entière.
+//
+// Toutes les constantes sont calculées à la compilation à partir des
+// paramètres du servo : une conversion coûte une multiplication 32 bits et
+// un décalage, sans flottant ni division. Le firmware et Calibration_Tool
+// utilisent la même formule et envoient donc exactement les mêmes valeurs.
+//
+//   impulsion (µs) = PULSE_MIN + (PULSE_MAX - PULSE_MIN) × angle / 180°
+//   valeur PCA     = impulsion × FREQUENCY × 4096 / 1 000 000   (arrondie)
+template <uint16_t PULSE_MIN_US, uint16_t PULSE_MAX_US, uint16_t FREQUENCY_HZ>
+struct ServoPulse {
+  static_assert(PULSE_MIN_US < PULSE_MAX_US, "ServoPulse: PULSE_MIN >= PULSE_MAX");
+  static_assert(FREQUENCY_HZ >= 24 && FREQUENCY_HZ <= 1526, "ServoPulse: fréquence hors PCA9685 (24-1526 Hz)");
+  static_assert((uint32_t)PULSE_MAX_US * FREQUENCY_HZ < 1000000UL, "ServoPulse: impulsion plus longue que la période");
+
+  static const uint16_t ANGLE_MAX_DECI = 1800;   // 180.0°
+
+  // Valeur PCA à 0° et pente par dixième de degré, en virgule fixe Q22,
+  // arrondies au plus proche (écart < 0.001 pas sur toute la course)
+  static constexpr uint32_t TICKS_MIN_Q22 =
+    (uint32_t)(((uint64_t)PULSE_MIN_US * FREQUENCY_HZ * 4096UL * 4194304UL + 500000UL) / 1000000UL);
+  static constexpr uint32_t TICKS_PER_DECI_Q22 =
+    (uint32_t)(((uint64_t)(PULSE_MAX_US - PULSE_MIN_US) * FREQUENCY_HZ * 4096UL * 4194304UL +
+                1000000ULL * ANGLE_MAX_DECI / 2) / (1000000ULL * ANGLE_MAX_DECI));
+  static_assert((uint64_t)TICKS_MIN_Q22 + (uint64_t)TICKS_PER_DECI_Q22 * ANGLE_MAX_DECI + 0x200000UL < 0x100000000ULL,
+                "ServoPulse: impulsion > 25% de la période (dépassement Q22)");
+
+  static constexpr uint16_t TICKS_MIN = (uint16_t)((TICKS_MIN_Q22 + 0x200000UL) >> 22);
+  static constexpr uint16_t TICKS_MAX =
+    (uint16_t)((TICKS_MIN_Q22 + TICKS_PER_DECI_Q22 * ANGLE_MAX_DECI + 0x200000UL) >> 22);
+
+  // Angle en dixièmes de degré (borné à 0-180°) → valeur PCA
+  static inline uint16_t ticksDeci(uint16_t angleDeci) {
+    if (angleDeci > ANGLE_MAX_DECI) angleDeci = ANGLE_MAX_DECI;
+    return (uint16_t)((TICKS_MIN_Q22 + TICKS_PER_DECI_Q22 * angleDeci + 0x200000UL) >> 22);
+  }
+
+  // Angle en degrés (borné à 0-180°) → valeur PCA
+  static inline uint16_t ticks(uint16_t angle) {
+    return ticksDeci(angle > 180 ? ANGLE_MAX_DECI : angle * 10);
+  }
+};
+
+template <uint16_t A, uint16_t B, uint16_t C> constexpr uint32_t ServoPulse<A, B, C>::TICKS_MIN_Q22;
+template <uint16_t A, uint16_t B, uint16_t C> constexpr uint32_t ServoPulse<A, B, C>::TICKS_PER_DECI_Q22;
+template <uint16_t A, uint16_t B, uint16_t C> constexpr uint16_t ServoPulse<A, B, C>::TICKS_MIN;
+template <uint16_t A, uint16_t B, uint16_t C> constexpr uint16_t ServoPulse<A, B, C>::TICKS_MAX;
+template <uint16_t A, uint16_t B, uint16_t C> const uint16_t ServoPulse<A, B, C>::ANGLE_MAX_DECI;
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SERVO_FLUTE_CORE_SOLENOID_DRIVER_H
+#define SERVO_FLUTE_CORE_SOLENOID_DRIVER_H
+
+#include <Arduino.h>
+
+// Sortie du solénoïde (valve), polarité et mode fixés à la compilation.
+// Puissance 0 = fermé, 255 = pleine puissance ; en mode tout-ou-rien
+// (USE_PWM = false), toute puissance non nulle ouvre la valve.
+template <bool ACTIVE_HIGH, bool USE_PWM>
+struct SolenoidDriver {
+  // Broche en sortie, valve fermée
+  static inline void begin(uint8_t pin) {
+    digitalWrite(pin, ACTIVE_HIGH ? LOW : HIGH);
+    pinMode(pin, OUTPUT);
+  }
+
+  static inline void write(uint8_t pin, uint8_t power) {
+    if (USE_PWM) {
+      analogWrite(pin, ACTIVE_HIGH ? power : 255 - power);
+    } else {
+      digitalWrite(pin, ((power != 0) == ACTIVE_HIGH) ? HIGH : LOW);
+    }
+  }
+
+  static inline void open(uint8_t pin)  { write(pin, 255); }
+  static inline void close(uint8_t pin) { write(pin, 0); }
+};
+
+#endif
@@ -0,0 +1,96 @@
+// Test sur PC du lissage du souffle (BreathSmoother), avec exactement le code qui tourne
+// sur l'Arduino.
+//
+// Compilation :
+//   g++ -O2 -I Servo_flute_v3 tools/breath_smoothing_check.cpp Servo_flute_v3/BreathSmoother.cpp -o breath_smoothing_check
+//
+// Utilisation :
+//   breath_smoothing_check [itérations] [graine]      (défaut : 20000, graine 1)
+//
+// Chaque période de contrôle suit InstrumentManager::applyPendingCC() : CC2 reçu pendant
+// la période (seul le dernier compte, registre "dernière valeur gagnante") -> push(),
+// sinon settle().
+//   1. balayage 127 -> 0 regroupé en une seule période, puis plus aucun CC2 : la moyenne
+//      doit retomber à 0 (avant : 127,127,127,127,0 -> 101, la flûte soufflait encore) ;
+//   2. saut 0 -> 127 puis silence MIDI : la moyenne doit atteindre 127 ;
+//   3. CC2 aléatoires et clairsemés, tailles de buffer 1 à 10 : au plus size - 1 périodes
+//      sans CC2 après la dernière valeur, la moyenne vaut cette valeur et settle()
+//      ne fait plus rien (coût constant au repos).
+// Le code de sortie vaut 0 si tout passe.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "BreathSmoother.h"
+
+static int failures = 0;
+
+// Périodes sans CC2 jusqu'à ce que la moyenne atteigne la dernière valeur
+static int settlePeriods(BreathSmoother& smoother, int limit) {
+  int periods = 0;
+  while (periods < limit && smoother.settle()) {
+    periods++;
+  }
+  return periods;
+}
+
+static void expectSettled(BreathSmoother& smoother, uint8_t size, const char* context) {
+  int periods = settlePeriods(smoother, 1000);
+  if (smoother.average() != smoother.latest() || periods > size - 1 || smoother.settle()) {
+    printf("  ÉCHEC (%s, buffer %u) : moyenne %u, dernière valeur %u après %d période(s)\n", context, size,
+           smoother.average(), smoother.latest(), periods);
+    failures++;
+  }
+}
+
+int main(int argc, char** argv) {
+  long iterations = (argc > 1) ? atol(argv[1]) : 20000;
+  unsigned seed = (argc > 2) ? (unsigned)atol(argv[2]) : 1;
+  if (seed == 0) seed = (unsigned)time(nullptr);
+  srand(seed);
+
+  // 1. Souffle coupé d'un coup, plus aucun CC2 ensuite
+  {
+    BreathSmoother smoother(5);  // CC2_SMOOTHING_BUFFER_SIZE par défaut
+    for (int i = 0; i < 5; i++) {
+      smoother.push(127);
+    }
+    smoother.push(0);  // 127 ... 0 reçus dans la même période : seul 0 reste
+    printf("Coupure 127 -> 0 : moyenne %u juste après", smoother.average());
+    expectSettled(smoother, 5, "coupure 127 -> 0");
+    printf(", %u ensuite\n", smoother.average());
+  }
+
+  // 2. Souffle établi d'un coup
+  {
+    BreathSmoother smoother(5);
+    smoother.push(0);
+    smoother.push(0);
+    smoother.push(127);
+    expectSettled(smoother, 5, "saut 0 -> 127");
+    printf("Saut 0 -> 127 : moyenne %u\n", smoother.average());
+  }
+
+  // 3. CC2 aléatoires
+  for (uint8_t size = 1; size <= 10; size++) {
+    BreathSmoother smoother(size);
+    if (smoother.settle()) {
+      printf("  ÉCHEC (buffer %u vide) : settle() a recopié une valeur\n", size);
+      failures++;
+    }
+    for (long i = 0; i < iterations / 10; i++) {
+      if (rand() % 3 == 0) {
+        smoother.push(rand() % 128);
+      } else {
+        smoother.settle();
+      }
+      if (rand() % 50 == 0) {
+        expectSettled(smoother, size, "CC2 aléatoires");
+      }
+    }
+    expectSettled(smoother, size, "CC2 aléatoires, fin");
+  }
+
+  printf("%s (graine %u)\n", failures ? "ÉCHEC" : "Tous les cas passent", seed);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""Calibration scriptée de la Servo Flute V3 via le protocole machine de Calibration_Tool.
+
+Pilote l'outil de calibration par le port série (commandes "@...") sans
+intervention au clavier : doigts connus poussés depuis un JSON, plages
+airflow mesurées au micro (@AUTO), profil EEPROM écrit, configuration relue.
+Plusieurs flûtes peuvent être calibrées en parallèle (--port répété).
+Protocole : docs/CALIBRATION_PROTOCOL.md
+
+Dépendances : pip install pyserial
+
+Exemples :
+  calibration_batch.py --port /dev/ttyACM0 ping
+  calibration_batch.py --port /dev/ttyACM0 dump flute.json
+  calibration_batch.py --port /dev/ttyACM0 push doigts.json
+  calibration_batch.py --port /dev/ttyACM0 --port /dev/ttyACM1 auto --fingers doigts.json --save 0 --out flute.json
+  calibration_batch.py --port /dev/ttyACM0 run session.txt
+
+Test sans matériel : tools/calibration_mock.py (pseudo-terminal).
+"""
+
+import argparse
+import json
+import os
+import sys
+import threading
+import time
+
+import serial
+
+BAUD_RATE = 115200
+
+# Durée max d'une réponse (les commandes temporisées répondent à la fin)
+TIMEOUT_DEFAULT = 2.0
+TIMEOUT_LONG = {"VALVE": 15.0, "SWEEP": 60.0, "AUTO": 60.0}
+
+# Même format que tools/servo_flute_sysex.py (dump / push interchangeables)
+FINGER_FIELDS = ["channel", "closed", "direction", "half", "quarter"]
+
+
+def pack_fingering(positions):
+    """[0,1,1,1,1,1] (trou 1 d'abord, 0=fermé 1=ouvert 2=demi 3=quart) -> 2 bits/doigt."""
+    pattern = 0
+    for i, position in enumerate(positions):
+        pattern |= (position & 3) << (i * 2)
+    return pattern
+
+
+def unpack_fingering(pattern, fingers):
+    return [(pattern >> (i * 2)) & 3 for i in range(fingers)]
+
+
+def parse_fields(words):
+    """["channel=0", "closed=92"] -> {"channel": 0, "closed": 92}"""
+    fields = {}
+    for word in words:
+        key, _, value = word.partition("=")
+        if value:
+            fields[key] = int(value)
+    return fields
+
+
+class ProtocolError(RuntimeError):
+    pass
+
+
+class CalibrationTool:
+    """Connexion à Calibration_Tool (menu principal affiché)."""
+
+    def __init__(self, port, log=None):
+        self.port = port
+        self.serial = serial.Serial(port, BAUD_RATE, timeout=0.05)
+        self.log = log
+        self.buffer = b""
+        self.info = None
+
+    def close(self):
+        self.serial.close()
+
+    def read_line(self, deadline):
+        while b"\n" not in self.buffer:
+            if time.monotonic() > deadline:
+                return None
+            self.buffer += self.serial.read(256)
+        line, _, self.buffer = self.buffer.partition(b"\n")
+        return line.decode("utf-8", "replace").strip("\r")
+
+    def command(self, text, on_line=None):
+        """Envoie "@<text>", retourne (lignes de données, champs du OK). ERR -> ProtocolError."""
+        name = text.split()[0].upper()
+        self.serial.write(("@" + text + "\n").encode())
+        deadline = time.monotonic() + TIMEOUT_LONG.get(name, TIMEOUT_DEFAULT)
+        data = []
+        while True:
+            line = self.read_line(deadline)
+            if line is None:
+                raise TimeoutError("%s : pas de réponse à @%s" % (self.port, text))
+            if self.log:
+                self.log(self.port, line)
+            words = line.split()
+            if len(words) >= 2 and words[0] == "OK" and words[1] == name:
+                return data, parse_fields(words[2:])
+            if len(words) >= 3 and words[0] == "ERR" and words[1].upper() == name:
+                raise ProtocolError("%s : @%s -> %s" % (self.port, text, words[2]))
+            if words and words[0] in ("FINGER", "NOTE", "STEP", "SYNC"):
+                data.append(words)
+                if on_line:
+                    on_line(words)
+
+    def connect(self, attempts=10):
+        """Attend que l'outil réponde (démarrage, menu en cours d'affichage)."""
+        for _ in range(attempts):
+            try:
+                _, self.info = self.command("PING")
+                return self.info
+            except (TimeoutError, ProtocolError):
+                self.serial.reset_input_buffer()
+                self.buffer = b""
+        raise TimeoutError("%s : l'outil ne répond pas (menu principal affiché ?)" % self.port)
+
+    def read_profile(self):
+        data, _ = self.command("DUMP")
+        fingers, notes = [], []
+        for words in data:
+            fields = parse_fields(words[2:])
+            if words[0] == "FINGER":
+                fingers.append({key: fields[key] for key in FINGER_FIELDS})
+            elif words[0] == "NOTE":
+                notes.append({
+                    "midi": fields["midi"],
+                    "fingering": unpack_fingering(fields["pattern"], self.info["fingers"]),
+                    "flow_min": fields["min"],
+                    "flow_max": fields["max"],
+                })
+        return {"fingers": fingers, "notes": notes}
+
+    def write_profile(self, profile):
+        """Sections "fingers" / "notes" du JSON (doigté et canal fixés par l'outil)."""
+        for i, finger in enumerate(profile.get("fingers", [])):
+            self.command("FINGER %d %d %d %d" % (i, finger["closed"], finger["direction"], finger["half"]))
+        for i, note in enumerate(profile.get("notes", [])):
+            self.command("NOTE %d %d %d" % (i, note["flow_min"], note["flow_max"]))
+
+
+def calibrate(port, args, results, log):
+    """Calibration complète d'une flûte (un thread par port)."""
+    tool = CalibrationTool(port, log)
+    try:
+        tool.connect()
+        tool.command("RESET")
+        if args.fingers:
+            with open(args.fingers) as f:
+                tool.write_profile({"fingers": json.load(f)["fingers"]})
+
+        notes = range(tool.info["notes"]) if args.notes is None else args.notes
+        failed = []
+        start = time.monotonic()
+        for index in notes:
+            try:
+                _, fields = tool.command("AUTO %d" % index)
+                print("%s : note %d -> %d%% - %d%%" % (port, index, fields["min"], fields["max"]))
+            except ProtocolError:
+                failed.append(index)
+                print("%s : note %d -> aucune plage stable" % (port, index))
+
+        if args.save is not None:
+            tool.command("SAVE %d" % args.save)
+        results[port] = {"profile": tool.read_profile(), "failed": failed,
+                         "seconds": time.monotonic() - start}
+    except (ProtocolError, TimeoutError, serial.SerialException) as error:
+        results[port] = {"error": str(error)}
+    finally:
+        tool.close()
+
+
+def output_name(base, index, count):
+    if count == 1:
+        return base
+    stem, ext = os.path.splitext(base)
+    return "%s_%d%s" % (stem, index, ext or ".json")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Calibration scriptée Servo Flute V3 (Calibration_Tool)")
+    parser.add_argument("--port", action="append", required=True,
+                        help="port série de l'outil (répéter pour plusieurs flûtes)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="affiche toutes les lignes reçues")
+    sub = parser.add_subparsers(dest="action", required=True)
+    sub.add_parser("ping", help="version du protocole, tailles des tables")
+    dump = sub.add_parser("dump", help="lit la calibration en cours (JSON)")
+    dump.add_argument("file", nargs="?", help="fichier de sortie (défaut : stdout)")
+    push = sub.add_parser("push", help="envoie doigts et plages d'un JSON")
+    push.add_argument("file")
+    push.add_argument("--save", type=int, metavar="PROFIL", help="puis écrire le profil EEPROM")
+    auto = sub.add_parser("auto", help="calibration automatique de toutes les notes (micro)")
+    auto.add_argument("--fingers", help="JSON des doigts déjà calibrés (section fingers)")
+    auto.add_argument("--notes", type=int, nargs="+", help="notes à calibrer (défaut : toutes)")
+    auto.add_argument("--save", type=int, metavar="PROFIL", help="écrire le profil EEPROM")
+    auto.add_argument("--out", help="JSON de sortie (suffixe _N si plusieurs ports)")
+    run = sub.add_parser("run", help="envoie un script de commandes (une par ligne, sans @)")
+    run.add_argument("file")
+    args = parser.parse_args()
+
+    log = (lambda port, line: print("[%s] %s" % (port, line), file=sys.stderr)) if args.verbose else None
+
+    if args.action == "auto":
+        results = {}
+        threads = [threading.Thread(target=calibrate, args=(port, args, results, log)) for port in args.port]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        status = 0
+        for index, port in enumerate(args.port):
+            result = results[port]
+            if "error" in result:
+                print("%s : ÉCHEC %s" % (port, result["error"]))
+                status = 1
+                continue
+            print("%s : %d notes en %.0f s, %d sans plage" % (
+                port, len(result["profile"]["notes"]), result["seconds"], len(result["failed"])))
+            if args.out:
+                with open(output_name(args.out, index, len(args.port)), "w") as f:
+                    json.dump(result["profile"], f, indent=2)
+                    f.write("\n")
+        sys.exit(status)
+
+    tool = CalibrationTool(args.port[0], log)
+    try:
+        tool.connect()
+        if args.action == "ping":
+            print(json.dumps(tool.info, indent=2))
+        elif args.action == "dump":
+            text = json.dumps(tool.read_profile(), indent=2)
+            if args.file:
+                with open(args.file, "w") as f:
+                    f.write(text + "\n")
+            else:
+                print(text)
+        elif args.action == "push":
+            with open(args.file) as f:
+                tool.write_profile(json.load(f))
+            if args.save is not None:
+                tool.command("SAVE %d" % args.save)
+        elif args.action == "run":
+            with open(args.file) as f:
+                for line in f:
+                    line = line.split("#")[0].strip().lstrip("@")
+                    if line:
+                        data, fields = tool.command(line)
+                        for words in data:
+                            print(" ".join(words))
+                        print("OK %s %s" % (line.split()[0].upper(),
+                                            " ".join("%s=%d" % item for item in fields.items())))
+    except (ProtocolError, TimeoutError) as error:
+        sys.exit("erreur : %s" % error)
+    finally:
+        tool.close()
+
+
+if __name__ == "__main__":
+    main()
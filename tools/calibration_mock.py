@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Faux Calibration_Tool sur pseudo-terminal, pour tester le protocole machine sans matériel.
+
+Crée un pseudo-terminal (Linux / macOS), affiche son chemin, puis répond aux
+commandes "@..." comme l'outil au menu principal : mêmes réponses, mêmes
+validations, mêmes codes d'erreur. La flûte est simulée : chaque note a une
+plage de débit "vraie" que @AUTO retrouve (marge comprise) et que @SWEEP
+parcourt. Protocole : docs/CALIBRATION_PROTOCOL.md
+
+Exemple :
+  python3 tools/calibration_mock.py --speed 20 &
+  # -> Calibration_Tool simulé sur /dev/pts/7
+  python3 tools/calibration_batch.py --port /dev/pts/7 auto --save 0 --out flute.json
+"""
+
+import argparse
+import os
+import sys
+import time
+import tty
+
+PROTOCOL_VERSION = 1
+ANGLE_OPEN = 30
+PROFILE_COUNT = 4
+AUTO_MARGIN_PERCENT = 2
+SWEEP_LOG_STEP_PERCENT = 5
+SWEEP_LOG_HOLD_MS = 400
+SWEEP_LOG_GAP_MS = 200
+
+# Template de settings_template.h : (MIDI, doigté compacté, min%, max%)
+NOTES_TEMPLATE = [
+    (82, 1364, 10, 60), (83, 1365, 0, 50), (84, 0, 20, 75), (85, 2048, 18, 72),
+    (86, 1024, 15, 70), (87, 1536, 12, 68), (88, 1280, 10, 65), (89, 1344, 10, 60),
+    (91, 1360, 5, 55), (93, 1364, 5, 50), (95, 1365, 0, 45), (96, 0, 50, 100),
+    (98, 1024, 45, 95), (100, 1280, 40, 90), (101, 1344, 35, 85), (103, 1360, 30, 80),
+]
+FINGERS = 6
+
+
+class MockTool:
+    def __init__(self, fd, speed, fail):
+        self.fd = fd
+        self.speed = speed
+        self.fail = set(fail)
+        self.start = time.monotonic()
+        self.prompt_open = False
+        self.reset()
+
+    def reset(self):
+        self.fingers = [[i, 90, 1, 15, 8] for i in range(FINGERS)]
+        self.notes = [list(note) for note in NOTES_TEMPLATE]
+
+    def millis(self):
+        return int((time.monotonic() - self.start) * 1000 * self.speed)
+
+    def sleep(self, ms):
+        time.sleep(ms / 1000.0 / self.speed)
+
+    def write(self, text=""):
+        os.write(self.fd, (text + "\r\n").encode())
+
+    def true_range(self, index):
+        """Plage où la fondamentale sonne (aiguës : plus de débit)."""
+        low = 8 + 3 * index
+        return low, min(100, low + 38)
+
+    def menu(self):
+        os.write(self.fd, "\r\n1. ... 5. (menu simulé)\r\nVotre choix (1-5): ".encode())
+        self.prompt_open = True
+
+    def handle(self, line):
+        if not line.startswith("@"):
+            if line:
+                self.write()
+                self.write("❌ Choix invalide!")
+                self.menu()
+            return
+        if self.prompt_open:
+            self.write()
+            self.prompt_open = False
+
+        words = line[1:].split()
+        name = words[0].upper() if words else ""
+        try:
+            values = [int(word) for word in words[1:]]
+        except ValueError:
+            values = None
+
+        handler = getattr(self, "cmd_" + name.lower(), None)
+        if handler is None:
+            self.write("ERR %s UNKNOWN" % (words[0] if words else ""))
+            return
+        count = handler.__code__.co_argcount - 1
+        if values is None or len(values) != count:
+            self.write("ERR %s ARGS" % name)
+            return
+        error = handler(*values)
+        if error:
+            self.write("ERR %s %s" % (name, error))
+
+    # Commandes (retour : code d'erreur ou None)
+    def cmd_ping(self):
+        self.write("OK PING version=%d fingers=%d notes=%d profiles=%d auto=1" % (
+            PROTOCOL_VERSION, FINGERS, len(self.notes), PROFILE_COUNT))
+
+    def cmd_angle(self, channel, angle):
+        if not (0 <= channel <= 15 and 0 <= angle <= 180):
+            return "RANGE"
+        self.write("OK ANGLE channel=%d angle=%d" % (channel, angle))
+
+    def cmd_finger(self, index, closed, direction, half):
+        opened = closed + ANGLE_OPEN * direction
+        if not (0 <= index < FINGERS and 0 <= closed <= 180 and direction in (1, -1)
+                and 1 <= half < ANGLE_OPEN and 0 <= opened <= 180):
+            return "RANGE"
+        self.fingers[index] = [index, closed, direction, half, half // 2]
+        self.print_finger(index)
+        self.write("OK FINGER")
+
+    def cmd_fingering(self, index):
+        if not 0 <= index < len(self.notes):
+            return "RANGE"
+        self.write("  [Servos positionnés selon doigté]")
+        self.write("OK FINGERING note=%d pattern=%d" % (index, self.notes[index][1]))
+
+    def cmd_air(self, percent):
+        if not 0 <= percent <= 100:
+            return "RANGE"
+        self.write("OK AIR percent=%d angle=%d" % (percent, 20 + percent * 140 // 100))
+
+    def cmd_valve(self, ms):
+        if not 0 <= ms <= 10000:
+            return "RANGE"
+        on = self.millis()
+        self.sleep(ms)
+        self.write("OK VALVE on=%d off=%d" % (on, self.millis()))
+
+    def cmd_note(self, index, low, high):
+        if not (0 <= index < len(self.notes) and 0 <= low <= high <= 100):
+            return "RANGE"
+        self.notes[index][2:4] = [low, high]
+        self.print_note(index)
+        self.write("OK NOTE")
+
+    def cmd_sweep(self, index):
+        if not 0 <= index < len(self.notes):
+            return "RANGE"
+        midi, pattern = self.notes[index][:2]
+        self.write("# Note %d/%d" % (index + 1, len(self.notes)))
+        self.write("NOTE %d %d %d" % (index, midi, pattern))
+        for percent in range(0, 101, SWEEP_LOG_STEP_PERCENT):
+            self.sleep(SWEEP_LOG_GAP_MS)
+            on = self.millis()
+            self.sleep(SWEEP_LOG_HOLD_MS)
+            self.write("STEP %d %d %d %d %d" % (on, self.millis(), index, midi, percent))
+        self.write("OK SWEEP note=%d" % index)
+
+    def cmd_auto(self, index):
+        if not 0 <= index < len(self.notes):
+            return "RANGE"
+        self.write("Note %d/%d (simulée)" % (index + 1, len(self.notes)))
+        self.sleep(3000)  # ~ balayage réel d'une note
+        if index in self.fail:
+            self.write("❌ Aucune plage stable (template conservé)")
+            return "NOTFOUND"
+        low, high = self.true_range(index)
+        self.notes[index][2:4] = [low + AUTO_MARGIN_PERCENT, high - AUTO_MARGIN_PERCENT]
+        self.write("OK AUTO note=%d min=%d max=%d" % (index, self.notes[index][2], self.notes[index][3]))
+
+    def cmd_dump(self):
+        for i in range(FINGERS):
+            self.print_finger(i)
+        for i in range(len(self.notes)):
+            self.print_note(i)
+        self.write("OK DUMP")
+
+    def cmd_save(self, profile):
+        if not 0 <= profile < PROFILE_COUNT:
+            return "RANGE"
+        self.write("OK SAVE profile=%d" % profile)
+
+    def cmd_reset(self):
+        self.reset()
+        self.write("OK RESET")
+
+    def print_finger(self, i):
+        self.write("FINGER %d channel=%d closed=%d direction=%d half=%d quarter=%d" % (i, *self.fingers[i]))
+
+    def print_note(self, i):
+        self.write("NOTE %d midi=%d pattern=%d min=%d max=%d" % (i, *self.notes[i]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Calibration_Tool simulé (pseudo-terminal)")
+    parser.add_argument("--speed", type=float, default=1.0, help="accélération du temps simulé")
+    parser.add_argument("--fail", type=int, nargs="*", default=[], help="notes sans plage détectée (@AUTO)")
+    args = parser.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print("Calibration_Tool simulé sur %s" % os.ttyname(slave), flush=True)
+
+    tool = MockTool(master, args.speed, args.fail)
+    tool.write("   CALIBRATION TOOL - SERVO FLUTE V3 (simulé)")
+    tool.menu()
+
+    buffer = b""
+    try:
+        while True:
+            try:
+                chunk = os.read(master, 256)
+            except OSError:
+                time.sleep(0.05)  # Aucun client ouvert
+                continue
+            # Fin de ligne CR, LF ou CR+LF (lignes vides ignorées au menu)
+            buffer += chunk.replace(b"\r", b"\n")
+            while b"\n" in buffer:
+                line, _, buffer = buffer.partition(b"\n")
+                tool.handle(line.decode("utf-8", "replace").strip())
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(slave)
+        os.close(master)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
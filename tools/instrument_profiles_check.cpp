@@ -0,0 +1,110 @@
+// Test sur PC des profils d'instrument de ServoFluteCore : les quatre profils
+// (IrishFluteC, SopranoRecorder, TinWhistleD, LowWhistleD) sont instanciés côte
+// à côte dans le même binaire, avec exactement les en-têtes compilés sur l'Arduino.
+//
+// Compilation :
+//   g++ -O2 -I libraries/ServoFluteCore/src tools/instrument_profiles_check.cpp -o instrument_profiles_check
+//
+// Utilisation :
+//   instrument_profiles_check
+//
+// Pour chaque profil :
+//   1. indexOf() retrouve chaque note de la table par défaut, -1 hors table ;
+//   2. countChanges() : nul sur un même doigté, FINGERS de tout fermé à tout ouvert,
+//      symétrique, borné par FINGERS et respectant l'inégalité triangulaire
+//      (c'est le coût de transition utilisé par le choix de doigté alternatif) ;
+//   3. aucun doigté n'utilise de bits au-delà de PATTERN_MASK ;
+//   4. FingerGeometry donne un angle dans 0-180° pour chaque doigt et chaque note,
+//      avec des angles fermés et des sens de montage synthétiques.
+// Le code de sortie vaut 0 si tous les profils passent.
+
+#include <stdio.h>
+#include "InstrumentProfiles.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      printf("  ÉCHEC : " __VA_ARGS__); \
+      printf("\n"); \
+      failures++; \
+    } \
+  } while (0)
+
+template <typename Profile>
+static void check(const char* name) {
+  const NoteDefinition* notes = Profile::notes();
+  auto midiAt = [notes](uint8_t i) { return notes[i].midiNote; };
+  int before = failures;
+
+  printf("%-16s %u doigts, %2u notes (MIDI %u-%u)\n", name, Profile::FINGERS, Profile::NOTES,
+         Profile::FIRST_MIDI, Profile::LAST_MIDI);
+
+  // 1. Recherche de note
+  for (uint8_t i = 0; i < Profile::NOTES; i++) {
+    CHECK(Profile::indexOf(midiAt, notes[i].midiNote) == i, "indexOf(%u) != %u", notes[i].midiNote, i);
+    CHECK(Profile::inRange(notes[i].midiNote), "note %u hors tessiture", notes[i].midiNote);
+  }
+  for (uint8_t midi = 0; midi < 128; midi++) {
+    bool present = false;
+    for (uint8_t i = 0; i < Profile::NOTES; i++) {
+      present |= notes[i].midiNote == midi;
+    }
+    if (!present) {
+      CHECK(Profile::indexOf(midiAt, midi) == -1, "indexOf(%u) trouvé hors table", midi);
+    }
+  }
+
+  // 2. Coût de transition entre doigtés
+  CHECK(Profile::countChanges(0, Profile::ALL_OPEN) == Profile::FINGERS,
+        "tout fermé -> tout ouvert : %u doigts", Profile::countChanges(0, Profile::ALL_OPEN));
+  for (uint8_t a = 0; a < Profile::NOTES; a++) {
+    FingerPattern pa = notes[a].fingerPattern;
+    CHECK(Profile::countChanges(pa, pa) == 0, "note %u : doigté identique compté", notes[a].midiNote);
+    for (uint8_t b = 0; b < Profile::NOTES; b++) {
+      FingerPattern pb = notes[b].fingerPattern;
+      uint8_t ab = Profile::countChanges(pa, pb);
+      CHECK(ab == Profile::countChanges(pb, pa), "notes %u/%u : non symétrique", notes[a].midiNote,
+            notes[b].midiNote);
+      CHECK(ab <= Profile::FINGERS, "notes %u/%u : %u doigts", notes[a].midiNote, notes[b].midiNote, ab);
+      for (uint8_t c = 0; c < Profile::NOTES; c++) {
+        FingerPattern pc = notes[c].fingerPattern;
+        CHECK(ab <= Profile::countChanges(pa, pc) + Profile::countChanges(pc, pb),
+              "notes %u/%u via %u : inégalité triangulaire", notes[a].midiNote, notes[b].midiNote,
+              notes[c].midiNote);
+      }
+    }
+  }
+
+  // 3. Doigtés dans le masque du profil
+  for (uint8_t i = 0; i < Profile::NOTES; i++) {
+    CHECK((notes[i].fingerPattern & ~Profile::PATTERN_MASK) == 0, "note %u : doigt au-delà de %u",
+          notes[i].midiNote, Profile::FINGERS);
+  }
+
+  // 4. Angles des servos doigts
+  for (uint8_t i = 0; i < Profile::NOTES; i++) {
+    for (uint8_t f = 0; f < Profile::FINGERS; f++) {
+      uint8_t position = getFingerPosition(notes[i].fingerPattern, f);
+      int8_t direction = (f & 1) ? -1 : 1;
+      uint16_t closed = (direction > 0) ? 10 + f * 20 : 170 - f * 20;
+      uint16_t angle = FingerGeometry<30>::angle(closed, direction, position, 15, 8);
+      CHECK(angle <= 180, "note %u doigt %u : angle %u", notes[i].midiNote, f, angle);
+      CHECK(position != FINGER_CLOSED || angle == closed, "note %u doigt %u : fermé à %u au lieu de %u",
+            notes[i].midiNote, f, angle, closed);
+    }
+  }
+
+  printf("  %s\n", failures == before ? "OK" : "ÉCHEC");
+}
+
+int main() {
+  check<IrishFluteC>("IrishFluteC");
+  check<SopranoRecorder>("SopranoRecorder");
+  check<TinWhistleD>("TinWhistleD");
+  check<LowWhistleD>("LowWhistleD");
+
+  printf("%s\n", failures ? "ÉCHEC" : "Tous les profils passent");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+// Test aléatoire sur PC de l'analyseur MIDI DIN du firmware (MidiStreamParser),
+// avec exactement le code qui tourne sur l'Arduino.
+//
+// Compilation :
+//   g++ -O2 -I Servo_flute_v3 tools/midi_stream_fuzz.cpp Servo_flute_v3/MidiStreamParser.cpp -o midi_stream_fuzz
+//
+// Utilisation :
+//   midi_stream_fuzz [itérations] [graine]      (défaut : 20000, graine 1)
+//
+// Chaque itération :
+//   1. octets aléatoires (bruit, prise branchée en cours de flux) : aucun paquet
+//      malformé ne doit sortir ;
+//   2. puis une suite de messages valides encodée comme sur un câble : running status
+//      pris au hasard, octets temps réel insérés à n'importe quelle position (y compris
+//      dans un message ou un SysEx), SysEx de longueur quelconque. Les paquets rendus
+//      doivent être exactement les paquets USB-MIDI attendus.
+// Le code de sortie vaut 0 si toutes les itérations passent.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "MidiStreamParser.h"
+
+struct Packet {
+  uint8_t b[4];
+  bool operator==(const Packet& o) const { return memcmp(b, o.b, 4) == 0; }
+};
+
+static uint32_t rngState = 1;
+
+static uint32_t rnd(uint32_t n) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState % n;
+}
+
+static Packet packet(uint8_t cin, uint8_t b1, uint8_t b2, uint8_t b3) {
+  Packet p = { { cin, b1, b2, b3 } };
+  return p;
+}
+
+static Packet toPacket(const MidiStreamPacket& p) {
+  return packet(p.header, p.byte1, p.byte2, p.byte3);
+}
+
+static void printPacket(const char* label, const Packet& p) {
+  printf("  %s %02X %02X %02X %02X\n", label, p.b[0], p.b[1], p.b[2], p.b[3]);
+}
+
+static const uint8_t REALTIME[] = { 0xF8, 0xFA, 0xFB, 0xFC, 0xFE, 0xFF };
+
+// Flux de test : octets sur le câble et paquets attendus, dans l'ordre
+struct Stream {
+  std::vector<uint8_t> bytes;
+  std::vector<Packet> expected;
+
+  // Octet de message, précédé parfois d'un octet temps réel (paquet immédiat)
+  void put(uint8_t data) {
+    if (rnd(8) == 0) {
+      uint8_t rt = REALTIME[rnd(sizeof(REALTIME))];
+      bytes.push_back(rt);
+      expected.push_back(packet(0x0F, rt, 0, 0));
+    }
+    bytes.push_back(data);
+  }
+};
+
+// Suite de messages valides ; le premier porte toujours son statut
+static void generateMessages(Stream& s, int count) {
+  uint8_t running = 0;
+  for (int i = 0; i < count; i++) {
+    uint32_t kind = rnd(10);
+
+    if (kind < 6) {
+      // Message de canal, running status une fois sur deux si possible
+      static const uint8_t TYPES[] = { 0x80, 0x90, 0xA0, 0xB0, 0xC0, 0xD0, 0xE0 };
+      uint8_t status = (running && rnd(2)) ? running : (uint8_t)(TYPES[rnd(7)] | rnd(16));
+      uint8_t length = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+      uint8_t d1 = rnd(128), d2 = (length == 2) ? rnd(128) : 0;
+      if (status != running) s.put(status);
+      s.put(d1);
+      if (length == 2) s.put(d2);
+      s.expected.push_back(packet(status >> 4, status, d1, d2));
+      running = status;
+
+    } else if (kind < 8) {
+      // SysEx : paquets de 3 octets (CIN 0x4) puis fin (CIN 0x5 à 0x7)
+      int length = rnd(40);
+      std::vector<uint8_t> message(1, 0xF0);
+      for (int j = 0; j < length; j++) message.push_back(rnd(128));
+      message.push_back(0xF7);
+
+      // Chaque paquet sort dès son dernier octet reçu
+      size_t j = 0;
+      while (message.size() - j > 3) {
+        s.put(message[j]); s.put(message[j + 1]); s.put(message[j + 2]);
+        s.expected.push_back(packet(0x04, message[j], message[j + 1], message[j + 2]));
+        j += 3;
+      }
+      size_t rest = message.size() - j;
+      for (size_t k = j; k < message.size(); k++) s.put(message[k]);
+      s.expected.push_back(packet(0x04 + rest, message[j], rest > 1 ? message[j + 1] : 0,
+                                  rest > 2 ? message[j + 2] : 0));
+      running = 0;
+
+    } else {
+      // Messages système communs (annulent le running status)
+      switch (rnd(4)) {
+        case 0: { uint8_t d = rnd(128); s.put(0xF1); s.put(d); s.expected.push_back(packet(0x02, 0xF1, d, 0)); break; }
+        case 1: { uint8_t a = rnd(128), b = rnd(128); s.put(0xF2); s.put(a); s.put(b); s.expected.push_back(packet(0x03, 0xF2, a, b)); break; }
+        case 2: { uint8_t d = rnd(128); s.put(0xF3); s.put(d); s.expected.push_back(packet(0x02, 0xF3, d, 0)); break; }
+        default: s.put(0xF6); s.expected.push_back(packet(0x05, 0xF6, 0, 0)); break;
+      }
+      running = 0;
+    }
+  }
+}
+
+// Paquet cohérent avec son Code Index Number
+static bool wellFormed(const Packet& p) {
+  const uint8_t* b = p.b;
+  switch (b[0]) {
+    case 0x02: return (b[1] == 0xF1 || b[1] == 0xF3) && b[2] < 0x80 && b[3] == 0;
+    case 0x03: return b[1] == 0xF2 && b[2] < 0x80 && b[3] < 0x80;
+    case 0x04: return (b[1] == 0xF0 || b[1] < 0x80) && b[2] < 0x80 && b[3] < 0x80;
+    case 0x05: return (b[1] == 0xF7 || b[1] == 0xF6) && b[2] == 0 && b[3] == 0;
+    case 0x06: return (b[1] == 0xF0 || b[1] < 0x80) && b[2] == 0xF7 && b[3] == 0;
+    case 0x07: return (b[1] == 0xF0 || b[1] < 0x80) && b[2] < 0x80 && b[3] == 0xF7;
+    case 0x0F: return b[1] >= 0xF8 && b[1] != 0xF9 && b[1] != 0xFD && b[2] == 0 && b[3] == 0;
+    case 0x0C:
+    case 0x0D: return (b[1] >> 4) == b[0] && b[2] < 0x80 && b[3] == 0;
+    case 0x08: case 0x09: case 0x0A: case 0x0B: case 0x0E:
+      return (b[1] >> 4) == b[0] && b[2] < 0x80 && b[3] < 0x80;
+    default: return false;
+  }
+}
+
+int main(int argc, char** argv) {
+  long iterations = (argc > 1) ? atol(argv[1]) : 20000;
+  rngState = (argc > 2) ? (uint32_t)atol(argv[2]) : 1;
+  if (rngState == 0) rngState = 1;
+
+  MidiStreamParser parser;
+  MidiStreamPacket out;
+  long failures = 0;
+  unsigned long totalBytes = 0;
+  clock_t start = clock();
+
+  for (long it = 0; it < iterations && failures < 5; it++) {
+    // 1. Bruit : seuls des paquets bien formés peuvent sortir
+    int noise = rnd(64);
+    for (int i = 0; i < noise; i++) {
+      uint8_t data = (rnd(3) == 0) ? (uint8_t)(0x80 | rnd(128)) : (uint8_t)rnd(128);
+      if (parser.parse(data, out) && !wellFormed(toPacket(out))) {
+        printf("ÉCHEC itération %ld : paquet malformé après bruit\n", it);
+        printPacket("reçu   ", toPacket(out));
+        failures++;
+      }
+    }
+    totalBytes += noise;
+
+    // 2. Messages valides : paquets exactement attendus
+    Stream s;
+    generateMessages(s, 1 + rnd(20));
+    std::vector<Packet> got;
+    for (size_t i = 0; i < s.bytes.size(); i++) {
+      if (parser.parse(s.bytes[i], out)) got.push_back(toPacket(out));
+    }
+    totalBytes += s.bytes.size();
+
+    if (got.size() != s.expected.size() || !std::equal(got.begin(), got.end(), s.expected.begin())) {
+      printf("ÉCHEC itération %ld : %zu paquets attendus, %zu reçus\n", it, s.expected.size(), got.size());
+      for (size_t i = 0; i < s.expected.size() || i < got.size(); i++) {
+        if (i < s.expected.size()) printPacket("attendu", s.expected[i]);
+        if (i < got.size()) printPacket("reçu   ", got[i]);
+        if (i < s.expected.size() && i < got.size() && !(s.expected[i] == got[i])) break;
+      }
+      failures++;
+    }
+  }
+
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("%lu octets analysés, %.1f ns/octet sur PC (budget à 31250 bauds : 320 us/octet)\n",
+         totalBytes, seconds * 1e9 / (totalBytes ? totalBytes : 1));
+  if (failures) {
+    printf("%ld échec(s)\n", failures);
+    return 1;
+  }
+  printf("OK (%ld itérations)\n", iterations);
+  return 0;
+}
@@ -0,0 +1,168 @@
+// Test sur PC de la monophonie d'une flûte (NoteArbiter + HeldNoteStack), avec exactement
+// le code qui tourne sur l'Arduino.
+//
+// Compilation :
+//   g++ -O2 -I Servo_flute_v3 tools/note_arbiter_check.cpp Servo_flute_v3/NoteArbiter.cpp Servo_flute_v3/HeldNoteStack.cpp -o note_arbiter_check
+//
+// Utilisation :
+//   note_arbiter_check [itérations] [graine]      (défaut : 20000, graine 1)
+//
+// Les événements rendus vont dans une queue consommée avec les règles de NoteSequencer :
+// au repos, un Note On démarre la note et un Note Off est ignoré ; pendant une note,
+// seul un Note Off de cette note en tête de queue est pris, tout autre événement
+// bloque la queue (c'est ce qui laissait une note bloquée jusqu'à All Sound Off).
+//
+//   1. même note enfoncée deux fois puis relâchée deux fois (deux touches repliées
+//      sur la même note par NoteRemapper, ou deux canaux en omni) ;
+//   2. pile pleine en priorité aiguë/grave alors que la note qui sonne est la plus
+//      ancienne ;
+//   3. touches aléatoires sur quelques notes, pile de 4 entrées (oublis fréquents),
+//      pour les trois priorités.
+// Après chaque touche la queue doit se vider, le séquenceur jouer la note qui sonne
+// (ou être au repos) et la note qui sonne être tenue. Touches relâchées : silence.
+// Le code de sortie vaut 0 si tout passe.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <deque>
+#include "NoteArbiter.h"
+
+struct Event {
+  bool on;
+  uint8_t note;
+};
+
+// Queue + règles de consommation de NoteSequencer (processNextEvent, handlePlaying)
+struct SequencerModel {
+  std::deque<Event> queue;
+  uint8_t current = 0;  // 0 = repos
+
+  void add(const NoteChange& change) {
+    if (change.offNote != 0) queue.push_back({false, change.offNote});
+    if (change.onNote != 0) queue.push_back({true, change.onNote});
+  }
+
+  void run() {
+    while (!queue.empty()) {
+      Event head = queue.front();
+      if (current == 0) {
+        if (head.on) current = head.note;  // Note Off au repos : ignoré
+      } else if (!head.on && head.note == current) {
+        current = 0;
+      } else {
+        return;  // Tête de queue bloquée
+      }
+      queue.pop_front();
+    }
+  }
+};
+
+static const char* PRIORITY_NAMES[] = { "dernière", "aiguë", "grave" };
+static int failures = 0;
+
+static bool check(const NoteArbiter& arbiter, const SequencerModel& sequencer, const char* context) {
+  const char* error = nullptr;
+  if (!sequencer.queue.empty()) {
+    error = "queue bloquée";
+  } else if (sequencer.current != arbiter.getSoundingNote()) {
+    error = "le séquenceur ne joue pas la note qui sonne";
+  } else if (arbiter.getSoundingNote() != 0 && !arbiter.isHolding(arbiter.getSoundingNote())) {
+    error = "note qui sonne oubliée de la pile";
+  }
+  if (error) {
+    printf("  ÉCHEC (%s) : %s, note qui sonne %u, séquenceur %u, %u événement(s) en attente\n", context,
+           error, arbiter.getSoundingNote(), sequencer.current, (unsigned)sequencer.queue.size());
+    failures++;
+    return false;
+  }
+  return true;
+}
+
+static void press(NoteArbiter& arbiter, SequencerModel& sequencer, uint8_t note) {
+  NoteChange change;
+  arbiter.press(note, 100, change);
+  sequencer.add(change);
+  sequencer.run();
+}
+
+static void release(NoteArbiter& arbiter, SequencerModel& sequencer, uint8_t note) {
+  NoteChange change;
+  arbiter.release(note, change);
+  sequencer.add(change);
+  sequencer.run();
+}
+
+int main(int argc, char** argv) {
+  long iterations = (argc > 1) ? atol(argv[1]) : 20000;
+  unsigned seed = (argc > 2) ? (unsigned)atol(argv[2]) : 1;
+  if (seed == 0) seed = (unsigned)time(nullptr);
+  srand(seed);
+
+  for (int p = 0; p < 3; p++) {
+    NotePriority priority = (NotePriority)p;
+    printf("Priorité %s\n", PRIORITY_NAMES[p]);
+
+    // 1. Re-déclenchement de la note qui sonne
+    {
+      NoteArbiter arbiter(8, priority);
+      SequencerModel sequencer;
+      press(arbiter, sequencer, 74);
+      press(arbiter, sequencer, 74);
+      check(arbiter, sequencer, "même note enfoncée deux fois");
+      release(arbiter, sequencer, 74);
+      release(arbiter, sequencer, 74);
+      if (check(arbiter, sequencer, "même note relâchée deux fois") && sequencer.current != 0) {
+        printf("  ÉCHEC : note %u encore jouée\n", sequencer.current);
+        failures++;
+      }
+    }
+
+    // 2. Pile pleine, note qui sonne la plus ancienne
+    {
+      NoteArbiter arbiter(4, priority);
+      SequencerModel sequencer;
+      uint8_t sounding = (priority == NOTE_PRIORITY_LOW) ? 60 : 80;
+      press(arbiter, sequencer, sounding);
+      for (uint8_t note = 70; note < 73; note++) {
+        press(arbiter, sequencer, note);
+      }
+      // Pile pleine : touche moins prioritaire que toutes les notes tenues
+      press(arbiter, sequencer, (priority == NOTE_PRIORITY_LOW) ? 80 : 60);
+      check(arbiter, sequencer, "pile pleine");
+      release(arbiter, sequencer, arbiter.getSoundingNote());
+      for (uint8_t note = 60; note <= 80; note++) {
+        release(arbiter, sequencer, note);
+      }
+      if (check(arbiter, sequencer, "pile pleine, tout relâché") && sequencer.current != 0) {
+        printf("  ÉCHEC : note %u encore jouée\n", sequencer.current);
+        failures++;
+      }
+    }
+
+    // 3. Touches aléatoires
+    NoteArbiter arbiter(4, priority);
+    SequencerModel sequencer;
+    for (long i = 0; i < iterations; i++) {
+      uint8_t note = 70 + rand() % 7;
+      if (rand() % 2) {
+        press(arbiter, sequencer, note);
+      } else {
+        release(arbiter, sequencer, note);
+      }
+      if (!check(arbiter, sequencer, "touches aléatoires")) {
+        break;
+      }
+    }
+    for (uint8_t note = 1; note < 128; note++) {
+      release(arbiter, sequencer, note);
+    }
+    if (check(arbiter, sequencer, "touches aléatoires, tout relâché") && sequencer.current != 0) {
+      printf("  ÉCHEC : note %u encore jouée\n", sequencer.current);
+      failures++;
+    }
+  }
+
+  printf("%s (graine %u)\n", failures ? "ÉCHEC" : "Toutes les séquences passent", seed);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+// Vérification sur PC du détecteur de hauteur de Calibration_Tool (PitchDetector)
+// sur un enregistrement WAV, avec exactement le code qui tourne sur l'Arduino.
+//
+// Compilation :
+//   g++ -O2 -I Calibration_Tool tools/pitch_wav_check.cpp Calibration_Tool/PitchDetector.cpp -o pitch_wav_check
+//
+// Utilisation :
+//   pitch_wav_check <fichier.wav> <note MIDI> [silence|instable|fondamentale|octave]
+//                   [--energy 4] [--tone 0.30] [--octave 1.0] [--spread 2.0] [--frames 3]
+//
+// Le WAV (PCM 8 ou 16 bits, mono ou stéréo : 1er canal) est ramené en 8 bits non signés
+// comme l'ADC, découpé en blocs de 256 échantillons, puis classé par groupes de
+// --frames blocs comme une mesure du balayage automatique. Avec une classe attendue,
+// le code de sortie vaut 0 si elle est majoritaire (enregistrements de référence).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "PitchDetector.h"
+
+static const uint16_t BLOCK_SIZE = 256;  // = MIC_BLOCK_SIZE
+
+static const char* CLASS_NAMES[] = { "silence", "instable", "fondamentale", "octave" };
+
+static uint32_t readLE(const uint8_t* p, int bytes) {
+  uint32_t value = 0;
+  for (int i = bytes - 1; i >= 0; i--) value = (value << 8) | p[i];
+  return value;
+}
+
+// Lit un WAV PCM : échantillons 8 bits non signés (1er canal) et fréquence
+static bool loadWav(const char* path, std::vector<uint8_t>& samples, float& sampleRate) {
+  FILE* file = fopen(path, "rb");
+  if (!file) return false;
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + n);
+  fclose(file);
+
+  if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) || memcmp(&data[8], "WAVE", 4)) return false;
+
+  uint16_t channels = 0, bits = 0;
+  size_t pos = 12;
+  while (pos + 8 <= data.size()) {
+    uint32_t size = readLE(&data[pos + 4], 4);
+    const uint8_t* body = &data[pos + 8];
+    if (!memcmp(&data[pos], "fmt ", 4)) {
+      if (readLE(body, 2) != 1) return false;  // PCM uniquement
+      channels = readLE(body + 2, 2);
+      sampleRate = (float)readLE(body + 4, 4);
+      bits = readLE(body + 14, 2);
+    } else if (!memcmp(&data[pos], "data", 4) && channels > 0) {
+      size_t frameBytes = channels * (bits / 8);
+      size_t available = data.size() - pos - 8;
+      if (size > available) size = available;
+      for (size_t i = 0; i + frameBytes <= size; i += frameBytes) {
+        if (bits == 8) {
+          samples.push_back(body[i]);
+        } else if (bits == 16) {
+          int16_t s = (int16_t)readLE(body + i, 2);
+          samples.push_back((uint8_t)((s >> 8) + 128));
+        } else {
+          return false;
+        }
+      }
+      return true;
+    }
+    pos += 8 + size + (size & 1);
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <fichier.wav> <note MIDI> [classe attendue] [--energy E] "
+                    "[--tone T] [--octave O] [--spread S] [--frames N]\n", argv[0]);
+    return 2;
+  }
+
+  const char* path = argv[1];
+  int midi = atoi(argv[2]);
+  int expected = -1;
+  float minEnergy = 4.0f, toneRatio = 0.30f, octaveRatio = 1.0f, spread = 2.0f;
+  int frames = 3;
+
+  for (int i = 3; i < argc; i++) {
+    if (!strcmp(argv[i], "--energy") && i + 1 < argc) minEnergy = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--tone") && i + 1 < argc) toneRatio = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--octave") && i + 1 < argc) octaveRatio = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--spread") && i + 1 < argc) spread = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+    else {
+      for (int c = 0; c < 4; c++) {
+        if (!strcmp(argv[i], CLASS_NAMES[c])) expected = c;
+      }
+    }
+  }
+
+  std::vector<uint8_t> samples;
+  float sampleRate = 0.0f;
+  if (!loadWav(path, samples, sampleRate)) {
+    fprintf(stderr, "%s : WAV PCM 8/16 bits illisible\n", path);
+    return 2;
+  }
+
+  PitchDetector detector;
+  detector.configure(sampleRate, PitchDetector::midiToHz(midi));
+  detector.setThresholds(minEnergy, toneRatio, octaveRatio);
+
+  printf("%s : %.0f Hz, %zu échantillons, fondamentale %.1f Hz\n",
+         path, sampleRate, samples.size(), PitchDetector::midiToHz(midi));
+
+  int counts[4] = { 0, 0, 0, 0 };
+  size_t groupSize = (size_t)BLOCK_SIZE * frames;
+  for (size_t start = 0; start + groupSize <= samples.size(); start += groupSize) {
+    PitchResult result = { 0.0f, 0.0f, 0.0f, PITCH_SILENT };
+    detector.reset();
+    for (int f = 0; f < frames; f++) {
+      result = detector.analyze(&samples[start + f * BLOCK_SIZE], BLOCK_SIZE);
+      detector.addFrame(result);
+    }
+    PitchClass pitchClass = detector.stableClass(frames, spread);
+    counts[pitchClass]++;
+    printf("%8.3fs  %-12s énergie %7.1f  f0 %.2f  octave %.2f\n", start / sampleRate,
+           CLASS_NAMES[pitchClass], result.energy, result.fundamentalRatio, result.octaveRatio);
+  }
+
+  int total = counts[0] + counts[1] + counts[2] + counts[3];
+  int majority = 0;
+  for (int c = 1; c < 4; c++) {
+    if (counts[c] > counts[majority]) majority = c;
+  }
+  printf("Résumé : silence %d, instable %d, fondamentale %d, octave %d -> %s\n",
+         counts[0], counts[1], counts[2], counts[3], total ? CLASS_NAMES[majority] : "-");
+
+  if (expected >= 0) {
+    bool ok = total > 0 && majority == expected;
+    printf("Attendu %s : %s\n", CLASS_NAMES[expected], ok ? "OK" : "ÉCHEC");
+    return ok ? 0 : 1;
+  }
+  return 0;
+}
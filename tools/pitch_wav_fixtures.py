@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Tests sur PC du détecteur de hauteur de Calibration_Tool (PitchDetector).
+
+Génère des enregistrements de référence déterministes (WAV PCM 16 bits, mono,
+à la fréquence de l'ADC du micro), compile tools/pitch_wav_check.cpp avec le
+PitchDetector.cpp de l'Arduino, puis vérifie la classe majoritaire de chaque
+enregistrement avec les seuils par défaut (AUTO_* de settings_template.h).
+
+Cas couverts (Ré6, MIDI 86) :
+  silence       bruit de fond du micro seul
+  souffle       souffle sans note (bruit large bande)      -> instable
+  tremolo       note qui hésite (amplitude qui s'effondre) -> instable
+  fondamentale  note juste, octave faible
+  octave        sur-soufflage, octave dominante
+
+Dépendances : python3 (bibliothèque standard) et g++.
+
+Exemples :
+  pitch_wav_fixtures.py                      # génère, compile, vérifie (code 0 si tout passe)
+  pitch_wav_fixtures.py --keep fixtures/     # conserve les WAV pour les écouter
+  pitch_wav_fixtures.py --checker ./pitch_wav_check
+"""
+
+import argparse
+import math
+import os
+import random
+import struct
+import subprocess
+import sys
+import tempfile
+import wave
+
+SAMPLE_RATE = 38461          # MIC_NOMINAL_SAMPLE_RATE (ADC free-running, prescaler 32)
+DURATION_S = 1.0
+MIDI_NOTE = 86               # Ré6
+SEED = 1234                  # Bruit reproductible d'une exécution à l'autre
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def midi_to_hz(midi):
+    return 440.0 * 2 ** ((midi - 69) / 12.0)
+
+
+def tone(f0, fundamental, octave, noise, rng, envelope=None):
+    """Fondamentale + octave (amplitudes 0..1) + bruit gaussien."""
+    samples = []
+    for n in range(int(SAMPLE_RATE * DURATION_S)):
+        t = n / SAMPLE_RATE
+        gain = envelope(t) if envelope else 1.0
+        x = gain * (fundamental * math.sin(2 * math.pi * f0 * t) +
+                    octave * math.sin(4 * math.pi * f0 * t))
+        samples.append(x + rng.gauss(0.0, noise))
+    return samples
+
+
+def tremolo(t):
+    # Note qui s'éteint et repart 6 fois par seconde : énergie de la
+    # fondamentale très variable d'un bloc à l'autre
+    return 0.05 + 0.95 * (0.5 + 0.5 * math.sin(2 * math.pi * 6.0 * t)) ** 4
+
+
+def fixtures():
+    f0 = midi_to_hz(MIDI_NOTE)
+    rng = random.Random(SEED)
+    return [
+        ("silence", tone(f0, 0.0, 0.0, 0.002, rng), "silence"),
+        ("souffle", tone(f0, 0.0, 0.0, 0.2, rng), "instable"),
+        ("tremolo", tone(f0, 0.3, 0.05, 0.01, rng, tremolo), "instable"),
+        ("fondamentale", tone(f0, 0.3, 0.05, 0.01, rng), "fondamentale"),
+        ("octave", tone(f0, 0.05, 0.3, 0.01, rng), "octave"),
+    ]
+
+
+def write_wav(path, samples):
+    with wave.open(path, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(SAMPLE_RATE)
+        w.writeframes(b"".join(
+            struct.pack("<h", int(max(-1.0, min(1.0, x)) * 32767)) for x in samples))
+
+
+def build_checker(directory):
+    binary = os.path.join(directory, "pitch_wav_check")
+    command = ["g++", "-O2", "-I", os.path.join(REPO, "Calibration_Tool"),
+               os.path.join(REPO, "tools", "pitch_wav_check.cpp"),
+               os.path.join(REPO, "Calibration_Tool", "PitchDetector.cpp"),
+               "-o", binary]
+    subprocess.run(command, check=True)
+    return binary
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--keep", metavar="DOSSIER", help="écrire les WAV dans ce dossier")
+    parser.add_argument("--checker", help="pitch_wav_check déjà compilé (sinon compilé ici)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="afficher l'analyse bloc par bloc")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as work:
+        directory = args.keep or work
+        os.makedirs(directory, exist_ok=True)
+        checker = args.checker or build_checker(work)
+
+        failures = 0
+        for name, samples, expected in fixtures():
+            path = os.path.join(directory, name + ".wav")
+            write_wav(path, samples)
+            result = subprocess.run([checker, path, str(MIDI_NOTE), expected],
+                                    capture_output=True, text=True)
+            lines = result.stdout.strip().splitlines()
+            if args.verbose:
+                print(result.stdout, end="")
+            summary = next((l for l in lines if l.startswith("Résumé")), "")
+            ok = result.returncode == 0
+            failures += not ok
+            print("%-13s attendu %-13s %s  (%s)" % (name, expected, "OK" if ok else "ÉCHEC",
+                                                   summary.split(" : ", 1)[-1]))
+
+    print("%d/%d enregistrements reconnus" % (len(fixtures()) - failures, len(fixtures())))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
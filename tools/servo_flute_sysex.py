@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+"""Configuration en direct de la Servo Flute V3 par SysEx (LIVE_CONFIG_ENABLED).
+
+Lit et écrit les tables FINGERS[] / NOTES[] et les délais de la valve sans
+recompiler ni reflasher. Protocole : docs/LIVE_CONFIG_SYSEX.md
+
+Dépendances : pip install mido python-rtmidi
+
+Exemples :
+  servo_flute_sysex.py ports
+  servo_flute_sysex.py info
+  servo_flute_sysex.py dump profil.json
+  servo_flute_sysex.py push profil.json --save --slot 1
+  servo_flute_sysex.py select 1
+  servo_flute_sysex.py defaults
+"""
+
+import argparse
+import json
+import sys
+import time
+
+import mido
+
+MANUFACTURER_ID = 0x7D
+DEVICE_ID = 0x01
+
+CMD_IDENTIFY = 0x01
+CMD_GET_FINGER = 0x10
+CMD_SET_FINGER = 0x11
+CMD_GET_NOTE = 0x20
+CMD_SET_NOTE = 0x21
+CMD_GET_TIMING = 0x30
+CMD_SET_TIMING = 0x31
+CMD_BEGIN_EDIT = 0x40
+CMD_LOAD_DEFAULT = 0x41
+CMD_APPLY = 0x42
+CMD_SAVE = 0x43
+CMD_SELECT = 0x44
+CMD_TELEMETRY = 0x50
+CMD_ACK = 0x7F
+
+STATUS = [
+    "OK",
+    "index hors table",
+    "doigt invalide (canal, angles, sens)",
+    "note invalide (MIDI, doigté, débit)",
+    "notes non strictement croissantes",
+    "délais / PWM invalides",
+    "échange déjà en attente",
+    "EEPROM",
+    "message mal formé",
+]
+
+FINGER_FIELDS = ["channel", "closed", "direction", "half", "quarter"]
+NOTE_FIELDS = ["midi", "fingering", "flow_min", "flow_max"]
+TIMING_FIELDS = [
+    "servo_to_solenoid_delay_ms",
+    "min_note_interval_for_valve_close_ms",
+    "solenoid_pwm_activation",
+    "solenoid_pwm_holding",
+]
+
+
+def encode_field(value):
+    """Valeur 16 bits (signée en complément à 2) sur 3 octets de 7 bits."""
+    value &= 0xFFFF
+    return [(value >> 14) & 0x03, (value >> 7) & 0x7F, value & 0x7F]
+
+
+def decode_field(data, signed=False):
+    value = ((data[0] & 0x03) << 14) | ((data[1] & 0x7F) << 7) | (data[2] & 0x7F)
+    if signed and value & 0x8000:
+        value -= 0x10000
+    return value
+
+
+def decode_fields(data, count):
+    return [decode_field(data[i * 3:i * 3 + 3]) for i in range(count)]
+
+
+def pack_fingering(positions):
+    """[0,1,1,1,1,1] (trou 1 d'abord, 0=fermé 1=ouvert 2=demi 3=quart) -> 2 bits/doigt."""
+    pattern = 0
+    for i, position in enumerate(positions):
+        pattern |= (position & 3) << (i * 2)
+    return pattern
+
+
+def unpack_fingering(pattern, fingers):
+    return [(pattern >> (i * 2)) & 3 for i in range(fingers)]
+
+
+class ServoFlute:
+    def __init__(self, port_name, timeout=0.5):
+        self.inport = mido.open_input(port_name)
+        self.outport = mido.open_output(port_name)
+        self.timeout = timeout
+        # Vider les messages en attente
+        for _ in self.inport.iter_pending():
+            pass
+
+    def close(self):
+        self.inport.close()
+        self.outport.close()
+
+    def request(self, command, args=()):
+        """Envoie une commande, retourne la réponse (octets après la commande)."""
+        self.outport.send(mido.Message("sysex", data=[MANUFACTURER_ID, DEVICE_ID, command] + list(args)))
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            message = self.inport.poll()
+            if message is None:
+                time.sleep(0.0005)
+                continue
+            if message.type != "sysex" or len(message.data) < 3:
+                continue
+            data = list(message.data)
+            if data[0] != MANUFACTURER_ID or data[1] != DEVICE_ID:
+                continue
+            if data[2] == CMD_ACK and len(data) >= 5 and data[3] == command:
+                return data[3:]
+            if data[2] == command:
+                return data[3:]
+        raise TimeoutError("pas de réponse à la commande 0x%02X" % command)
+
+    def command(self, command, args=()):
+        """Commande acquittée : lève une erreur si le statut n'est pas OK."""
+        reply = self.request(command, args)
+        if len(reply) < 2 or reply[0] != command:
+            raise RuntimeError("réponse inattendue à la commande 0x%02X" % command)
+        status = reply[1]
+        if status != 0:
+            text = STATUS[status] if status < len(STATUS) else "statut %d" % status
+            raise RuntimeError("commande 0x%02X refusée : %s" % (command, text))
+
+    def identify(self):
+        reply = self.request(CMD_IDENTIFY)
+        info = {
+            "protocol": reply[0],
+            "fingers": reply[1],
+            "notes": reply[2],
+            "from_eeprom": bool(reply[3] & 0x01),
+            "swap_pending": bool(reply[3] & 0x02),
+        }
+        if reply[0] >= 3:
+            info["telemetry"] = bool(reply[3] & 0x04)
+        if reply[0] >= 2:
+            info["profile"] = reply[4]
+            info["profile_count"] = reply[5]
+        return info
+
+    def save(self, slot=None):
+        """Sauvegarde EEPROM (profil courant si slot est None)."""
+        self.wait_swap()
+        self.command(CMD_SAVE, [] if slot is None else [slot])
+
+    def select(self, slot):
+        """Charge un profil EEPROM (équivalent au Program Change)."""
+        self.command(CMD_SELECT, [slot])
+        self.wait_swap()
+
+    def read_profile(self):
+        info = self.identify()
+        profile = {"fingers": [], "notes": [], "timing": {}}
+        for i in range(info["fingers"]):
+            reply = self.request(CMD_GET_FINGER, [i])
+            values = decode_fields(reply[1:], len(FINGER_FIELDS))
+            values[2] = decode_field(reply[7:10], signed=True)
+            profile["fingers"].append(dict(zip(FINGER_FIELDS, values)))
+        for i in range(info["notes"]):
+            reply = self.request(CMD_GET_NOTE, [i])
+            values = decode_fields(reply[1:], len(NOTE_FIELDS))
+            values[1] = unpack_fingering(values[1], info["fingers"])
+            profile["notes"].append(dict(zip(NOTE_FIELDS, values)))
+        reply = self.request(CMD_GET_TIMING)
+        profile["timing"] = dict(zip(TIMING_FIELDS, decode_fields(reply, len(TIMING_FIELDS))))
+        return profile
+
+    def write_profile(self, profile, save=False, slot=None):
+        self.command(CMD_BEGIN_EDIT)
+        for i, finger in enumerate(profile.get("fingers", [])):
+            args = [i]
+            for field in FINGER_FIELDS:
+                args += encode_field(finger[field])
+            self.command(CMD_SET_FINGER, args)
+        for i, note in enumerate(profile.get("notes", [])):
+            fingering = note["fingering"]
+            if isinstance(fingering, list):
+                fingering = pack_fingering(fingering)
+            args = [i] + encode_field(note["midi"]) + encode_field(fingering)
+            args += encode_field(note["flow_min"]) + encode_field(note["flow_max"])
+            self.command(CMD_SET_NOTE, args)
+        if "timing" in profile:
+            args = []
+            for field in TIMING_FIELDS:
+                args += encode_field(profile["timing"][field])
+            self.command(CMD_SET_TIMING, args)
+        self.command(CMD_APPLY)
+        if save:
+            self.save(slot)
+
+    def wait_swap(self, timeout=10.0):
+        """L'échange a lieu entre deux notes : attendre qu'il soit fait."""
+        deadline = time.monotonic() + timeout
+        while self.identify()["swap_pending"]:
+            if time.monotonic() > deadline:
+                raise TimeoutError("échange non effectué (note en cours ?)")
+            time.sleep(0.01)
+
+
+def find_port(name):
+    names = mido.get_output_names()
+    if name:
+        matches = [n for n in names if name in n]
+    else:
+        matches = [n for n in names if "Arduino" in n or "Leonardo" in n or "Micro" in n]
+    if not matches:
+        raise SystemExit("port MIDI introuvable (disponibles : %s)" % ", ".join(names))
+    return matches[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Configuration SysEx Servo Flute V3")
+    parser.add_argument("--port", help="nom (ou partie du nom) du port MIDI")
+    sub = parser.add_subparsers(dest="action", required=True)
+    sub.add_parser("ports", help="liste les ports MIDI")
+    sub.add_parser("info", help="version du protocole, tailles des tables, état")
+    dump = sub.add_parser("dump", help="lit la configuration active (JSON)")
+    dump.add_argument("file", nargs="?", help="fichier de sortie (défaut : stdout)")
+    push = sub.add_parser("push", help="envoie un profil JSON (appliqué entre deux notes)")
+    push.add_argument("file")
+    push.add_argument("--save", action="store_true", help="sauvegarder en EEPROM")
+    push.add_argument("--slot", type=int, help="profil EEPROM (défaut : profil courant)")
+    defaults = sub.add_parser("defaults", help="revient aux tables de settings.h")
+    defaults.add_argument("--save", action="store_true", help="sauvegarder en EEPROM")
+    defaults.add_argument("--slot", type=int, help="profil EEPROM (défaut : profil courant)")
+    save = sub.add_parser("save", help="sauvegarde la configuration active en EEPROM")
+    save.add_argument("--slot", type=int, help="profil EEPROM (défaut : profil courant)")
+    select = sub.add_parser("select", help="charge un profil EEPROM (appliqué entre deux notes)")
+    select.add_argument("slot", type=int)
+    args = parser.parse_args()
+
+    if args.action == "ports":
+        for name in mido.get_output_names():
+            print(name)
+        return
+
+    flute = ServoFlute(find_port(args.port))
+    try:
+        start = time.monotonic()
+        if args.action == "info":
+            print(json.dumps(flute.identify(), indent=2))
+        elif args.action == "dump":
+            text = json.dumps(flute.read_profile(), indent=2)
+            if args.file:
+                with open(args.file, "w") as f:
+                    f.write(text + "\n")
+            else:
+                print(text)
+        elif args.action == "push":
+            with open(args.file) as f:
+                profile = json.load(f)
+            flute.write_profile(profile, save=args.save, slot=args.slot)
+            print("profil envoyé en %.0f ms" % ((time.monotonic() - start) * 1000))
+        elif args.action == "defaults":
+            flute.command(CMD_LOAD_DEFAULT)
+            flute.command(CMD_APPLY)
+            if args.save:
+                flute.save(args.slot)
+        elif args.action == "save":
+            flute.save(args.slot)
+        elif args.action == "select":
+            flute.select(args.slot)
+            print("profil %d actif en %.0f ms" % (args.slot, (time.monotonic() - start) * 1000))
+    except (RuntimeError, TimeoutError) as error:
+        sys.exit("erreur : %s" % error)
+    finally:
+        flute.close()
+
+
+if __name__ == "__main__":
+    main()
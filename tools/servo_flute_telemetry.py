@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Télémétrie en direct de la Servo Flute V3 (TELEMETRY_ENABLED).
+
+Active l'envoi par SysEx, décode les messages et trace en direct :
+  - l'erreur d'attaque de chaque note sonnée (ms, + = en retard) ;
+  - le temps de boucle moyen et maximal (µs) ;
+  - le remplissage des files (entrée MIDI, queues des flûtes) ;
+  - le rapport cyclique des solénoïdes (%).
+Les compteurs cumulés (événements perdus, télémétrie perdue, rapports
+manquants) sont affichés dans le titre. Protocole : docs/TELEMETRY.md
+
+Dépendances : pip install mido python-rtmidi matplotlib
+
+Exemples :
+  servo_flute_telemetry.py
+  servo_flute_telemetry.py --window 60 --csv seance.csv
+  servo_flute_telemetry.py --text          # sans tracé (terminal)
+"""
+
+import argparse
+import collections
+import sys
+import time
+
+from servo_flute_sysex import (CMD_TELEMETRY, DEVICE_ID, MANUFACTURER_ID,
+                               ServoFlute, decode_field, find_port)
+
+CMD_TELEMETRY_STATUS = 0x51
+CMD_TELEMETRY_ONSET = 0x52
+
+STATUS_FIELDS = [
+    "loop_avg_us",
+    "loop_max_us",
+    "input_queue_peak",
+    "event_queue_peak",
+    "dropped_events",
+    "solenoid_duty_permille",
+    "lost_telemetry",
+    "window_ms",
+    "coil_temp_decicelsius",
+    "holding_pwm",
+    "thermal_level",
+]
+SIGNED_FIELDS = {"coil_temp_decicelsius"}
+THERMAL_LEVELS = ["normal", "maintien réduit", "limite"]
+
+
+def decode_message(data):
+    """Message SysEx (sans F0/F7) -> ("status", dict) / ("onset", dict) / None."""
+    if len(data) < 3 or data[0] != MANUFACTURER_ID or data[1] != DEVICE_ID:
+        return None
+    command, body = data[2], data[3:]
+    if command == CMD_TELEMETRY_STATUS and len(body) == 1 + 3 * len(STATUS_FIELDS):
+        status = {field: decode_field(body[1 + i * 3:4 + i * 3], signed=field in SIGNED_FIELDS)
+                  for i, field in enumerate(STATUS_FIELDS)}
+        status["sequence"] = body[0]
+        return "status", status
+    if command == CMD_TELEMETRY_ONSET and len(body) == 5:
+        return "onset", {"note": body[0], "velocity": body[1],
+                         "error_ms": decode_field(body[2:5], signed=True)}
+    return None
+
+
+class Recorder:
+    """Historique borné (fenêtre glissante) et compteurs de la séance."""
+
+    def __init__(self, window, csv_file=None):
+        self.window = window
+        self.start = time.monotonic()
+        self.status = collections.deque()
+        self.onsets = collections.deque()
+        self.last = None
+        self.missing_reports = 0
+        self.sequence = None
+        self.csv = csv_file
+        if self.csv:
+            self.csv.write("t_s,type,%s,note,velocity,error_ms\n" % ",".join(STATUS_FIELDS))
+
+    def add(self, kind, values):
+        t = time.monotonic() - self.start
+        if kind == "status":
+            if self.sequence is not None:
+                self.missing_reports += (values["sequence"] - self.sequence - 1) & 0x7F
+            self.sequence = values["sequence"]
+            self.status.append((t, values))
+            self.last = values
+            row = [str(values[f]) for f in STATUS_FIELDS] + ["", "", ""]
+        else:
+            self.onsets.append((t, values))
+            row = [""] * len(STATUS_FIELDS) + [str(values["note"]), str(values["velocity"]),
+                                               str(values["error_ms"])]
+        if self.csv:
+            self.csv.write("%.3f,%s,%s\n" % (t, kind, ",".join(row)))
+        for history in (self.status, self.onsets):
+            while history and history[0][0] < t - self.window:
+                history.popleft()
+
+    def summary(self):
+        if self.last is None:
+            return "en attente de télémétrie..."
+        text = ("événements perdus %d | télémétrie perdue %d | rapports manquants %d"
+                % (self.last["dropped_events"], self.last["lost_telemetry"], self.missing_reports))
+        level = self.last["thermal_level"]
+        if level:
+            text += " | BOBINE %.1f °C : %s (PWM %d)" % (
+                self.last["coil_temp_decicelsius"] / 10.0,
+                THERMAL_LEVELS[min(level, len(THERMAL_LEVELS) - 1)], self.last["holding_pwm"])
+        return text
+
+
+def poll(flute, recorder, text=False):
+    for message in flute.inport.iter_pending():
+        if message.type != "sysex":
+            continue
+        decoded = decode_message(list(message.data))
+        if decoded is None:
+            continue
+        recorder.add(*decoded)
+        if text:
+            kind, values = decoded
+            if kind == "onset":
+                print("note %3d vel %3d  erreur %+4d ms" % (values["note"], values["velocity"],
+                                                            values["error_ms"]))
+            else:
+                print("boucle %5d/%5d us  files %2d/%2d  solénoïdes %5.1f %%  bobine %5.1f °C  | %s"
+                      % (values["loop_avg_us"], values["loop_max_us"], values["input_queue_peak"],
+                         values["event_queue_peak"], values["solenoid_duty_permille"] / 10.0,
+                         values["coil_temp_decicelsius"] / 10.0, recorder.summary()))
+
+
+def run_text(flute, recorder):
+    while True:
+        poll(flute, recorder, text=True)
+        time.sleep(0.01)
+
+
+def run_plot(flute, recorder):
+    import matplotlib.pyplot as plt
+    from matplotlib.animation import FuncAnimation
+
+    figure, (ax_onset, ax_loop, ax_queue, ax_duty, ax_coil) = plt.subplots(
+        5, 1, sharex=True, figsize=(10, 11))
+    onset_points = ax_onset.scatter([], [], s=12)
+    ax_onset.axhline(0, color="grey", linewidth=0.5)
+    ax_onset.set_ylabel("attaque (ms)")
+    loop_avg, = ax_loop.plot([], [], label="moyenne")
+    loop_max, = ax_loop.plot([], [], label="max")
+    ax_loop.set_ylabel("boucle (µs)")
+    ax_loop.legend(loc="upper left")
+    queue_input, = ax_queue.step([], [], where="post", label="entrée MIDI")
+    queue_events, = ax_queue.step([], [], where="post", label="flûtes")
+    ax_queue.set_ylabel("files (max)")
+    ax_queue.legend(loc="upper left")
+    duty, = ax_duty.plot([], [])
+    ax_duty.set_ylabel("solénoïdes (%)")
+    ax_duty.set_ylim(0, 100)
+    coil, = ax_coil.plot([], [], color="tab:red")
+    ax_coil.set_ylabel("bobine (°C)")
+    ax_coil.set_xlabel("temps (s)")
+
+    def refresh(_frame):
+        poll(flute, recorder)
+        t_now = time.monotonic() - recorder.start
+        if recorder.onsets:
+            onset_points.set_offsets([(t, v["error_ms"]) for t, v in recorder.onsets])
+            errors = [v["error_ms"] for _, v in recorder.onsets]
+            ax_onset.set_ylim(min(errors + [-5]) - 2, max(errors + [5]) + 2)
+        if recorder.status:
+            t = [s[0] for s in recorder.status]
+            column = lambda field: [s[1][field] for s in recorder.status]
+            loop_avg.set_data(t, column("loop_avg_us"))
+            loop_max.set_data(t, column("loop_max_us"))
+            queue_input.set_data(t, column("input_queue_peak"))
+            queue_events.set_data(t, column("event_queue_peak"))
+            duty.set_data(t, [v / 10.0 for v in column("solenoid_duty_permille")])
+            coil.set_data(t, [v / 10.0 for v in column("coil_temp_decicelsius")])
+            for axis in (ax_loop, ax_queue, ax_coil):
+                axis.relim()
+                axis.autoscale_view(scalex=False)
+        ax_coil.set_xlim(max(0, t_now - recorder.window), max(recorder.window, t_now))
+        figure.suptitle(recorder.summary())
+        return ()
+
+    animation = FuncAnimation(figure, refresh, interval=100, cache_frame_data=False)
+    plt.show()
+    return animation
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Télémétrie en direct Servo Flute V3")
+    parser.add_argument("--port", help="nom (ou partie du nom) du port MIDI")
+    parser.add_argument("--window", type=float, default=30.0, help="durée affichée (s, défaut 30)")
+    parser.add_argument("--csv", help="enregistre tous les messages décodés (CSV)")
+    parser.add_argument("--text", action="store_true", help="affichage texte, sans tracé")
+    args = parser.parse_args()
+
+    csv_file = open(args.csv, "w") if args.csv else None
+    flute = ServoFlute(find_port(args.port))
+    try:
+        flute.command(CMD_TELEMETRY, [1])
+        recorder = Recorder(args.window, csv_file)
+        if args.text:
+            run_text(flute, recorder)
+        else:
+            run_plot(flute, recorder)
+    except KeyboardInterrupt:
+        pass
+    except (RuntimeError, TimeoutError) as error:
+        sys.exit("erreur : %s" % error)
+    finally:
+        try:
+            flute.command(CMD_TELEMETRY, [0])
+        except (RuntimeError, TimeoutError):
+            pass
+        flute.close()
+        if csv_file:
+            csv_file.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,417 @@
+#!/usr/bin/env python3
+"""Analyse d'un balayage enregistré de Calibration_Tool (mode « e »).
+
+Entrées :
+  - le journal série du balayage (lignes SYNC / NOTE / STEP horodatées en ms) ;
+  - l'enregistrement audio du même balayage (téléphone posé près de
+    l'embouchure), en WAV PCM.
+
+Pour chaque pas de débit, on mesure par FFT la hauteur, le rapport
+d'harmoniques (octave / fondamentale), la part de bruit et la latence
+d'attaque. Le script produit ensuite NOTES[] (min% / max%), la latence
+d'attaque par note et le seuil de sur-soufflage.
+
+L'audio est lu en flux, par blocs de taille fixe : la mémoire reste bornée
+par la durée d'un pas, quelle que soit la longueur de l'enregistrement.
+
+Dépendances : pip install numpy
+
+Exemples :
+  sweep_analyzer.py journal.txt balayage.wav
+  sweep_analyzer.py journal.txt balayage.wav --json resultats.json
+  ffmpeg -i balayage.m4a -ac 1 balayage.wav   # conversion d'un enregistrement de téléphone
+"""
+
+import argparse
+import json
+import math
+import sys
+import wave
+
+import numpy as np
+
+NOTE_NAMES = ["C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"]
+
+SILENT = "silence"
+NOISY = "instable"
+FUNDAMENTAL = "fondamentale"
+OVERBLOWN = "octave"
+
+BLOCK_FRAMES = 4096          # Lecture WAV par blocs fixes
+FFT_SIZE = 2048              # Analyse stable (moyenne de Welch)
+ONSET_FFT_SIZE = 1024        # Analyse d'attaque
+ONSET_HOP = 256
+
+
+def midi_to_hz(midi):
+    return 440.0 * 2.0 ** ((midi - 69) / 12.0)
+
+
+def note_name(midi):
+    return "%s%d" % (NOTE_NAMES[midi % 12], midi // 12 - 1)
+
+
+# ---------------------------------------------------------------------------
+# Journal
+# ---------------------------------------------------------------------------
+
+def parse_log(path):
+    """Lit les lignes SYNC / NOTE / STEP (le reste du journal est ignoré)."""
+    syncs, notes, steps = [], {}, []
+    with open(path, errors="replace") as f:
+        for line in f:
+            fields = line.split()
+            if not fields:
+                continue
+            try:
+                if fields[0] == "SYNC" and len(fields) >= 3:
+                    syncs.append((int(fields[1]), int(fields[2])))
+                elif fields[0] == "NOTE" and len(fields) >= 4:
+                    notes[int(fields[1])] = {"midi": int(fields[2]), "pattern": int(fields[3])}
+                elif fields[0] == "STEP" and len(fields) >= 6:
+                    steps.append({
+                        "on": int(fields[1]), "off": int(fields[2]),
+                        "index": int(fields[3]), "midi": int(fields[4]), "percent": int(fields[5]),
+                    })
+            except ValueError:
+                continue  # Ligne tronquée (copier-coller du moniteur série)
+    if not syncs or not steps:
+        raise SystemExit("%s : aucune ligne SYNC/STEP (journal du mode « e » ?)" % path)
+    steps.sort(key=lambda s: s["on"])
+    return syncs, notes, steps
+
+
+# ---------------------------------------------------------------------------
+# Audio en flux
+# ---------------------------------------------------------------------------
+
+class WavStream:
+    """Lecture séquentielle d'un WAV : segment(début, fin) en échantillons,
+    avec des débuts croissants. Seul l'intervalle demandé est gardé en mémoire."""
+
+    def __init__(self, path):
+        self.wav = wave.open(path, "rb")
+        if self.wav.getcomptype() != "NONE":
+            raise SystemExit("%s : WAV PCM non compressé uniquement" % path)
+        self.rate = self.wav.getframerate()
+        self.channels = self.wav.getnchannels()
+        self.width = self.wav.getsampwidth()
+        self.length = self.wav.getnframes()
+        self.buffer = np.zeros(0, dtype=np.float32)
+        self.buffer_start = 0  # Index (échantillons) du premier élément de buffer
+
+    def close(self):
+        self.wav.close()
+
+    def _read_block(self):
+        raw = self.wav.readframes(BLOCK_FRAMES)
+        if not raw:
+            return None
+        if self.width == 1:
+            data = (np.frombuffer(raw, dtype=np.uint8).astype(np.float32) - 128.0) / 128.0
+        elif self.width == 2:
+            data = np.frombuffer(raw, dtype="<i2").astype(np.float32) / 32768.0
+        elif self.width == 3:
+            b = np.frombuffer(raw, dtype=np.uint8).reshape(-1, 3).astype(np.int32)
+            value = b[:, 0] | (b[:, 1] << 8) | (b[:, 2] << 16)
+            value = np.where(value & 0x800000, value - 0x1000000, value)
+            data = value.astype(np.float32) / 8388608.0
+        else:
+            data = np.frombuffer(raw, dtype="<i4").astype(np.float32) / 2147483648.0
+        return data[::self.channels]  # Premier canal
+
+    def segment(self, start, end):
+        start = max(0, start)
+        end = min(self.length, end)
+        if end <= start:
+            return np.zeros(0, dtype=np.float32)
+        # Oublier ce qui précède le début demandé (mémoire bornée)
+        if start > self.buffer_start:
+            drop = min(start - self.buffer_start, len(self.buffer))
+            self.buffer = self.buffer[drop:]
+            self.buffer_start += drop
+        while self.buffer_start + len(self.buffer) < end:
+            block = self._read_block()
+            if block is None:
+                break
+            self.buffer = np.concatenate((self.buffer, block))
+            if self.buffer_start + len(self.buffer) <= start:
+                # Bloc entièrement avant le segment : jeté aussitôt
+                self.buffer_start += len(self.buffer)
+                self.buffer = self.buffer[:0]
+        lo = max(0, start - self.buffer_start)
+        return self.buffer[lo:end - self.buffer_start]
+
+
+def rms_envelope(path, hop_seconds=0.005):
+    """Enveloppe RMS du fichier entier, calculée en flux (200 valeurs par seconde de son)."""
+    stream = WavStream(path)
+    hop = max(1, int(stream.rate * hop_seconds))
+    envelope = []
+    position = 0
+    while position < stream.length:
+        chunk = stream.segment(position, position + hop)
+        if len(chunk) == 0:
+            break
+        envelope.append(float(np.sqrt(np.mean(chunk * chunk))))
+        position += hop
+    rate = stream.rate
+    stream.close()
+    return np.array(envelope), hop / rate
+
+
+def find_onset(envelope, hop, start_s, end_s, threshold, near_s=None):
+    """Front montant au-dessus du seuil : le premier, ou le plus proche de near_s."""
+    lo = max(1, int(start_s / hop))
+    hi = min(len(envelope), int(end_s / hop))
+    above = envelope > threshold
+    rising = lo + np.nonzero(above[lo:hi] & ~above[lo - 1:hi - 1])[0]
+    if len(rising) == 0:
+        return None
+    if near_s is None:
+        return rising[0] * hop
+    return rising[np.argmin(np.abs(rising * hop - near_s))] * hop
+
+
+def align_clock(path, syncs, noise_factor):
+    """Correspondance ms journal -> secondes audio, à partir des salves SYNC.
+    Deux salves : décalage + dérive d'horloge ; une seule : décalage seul."""
+    envelope, hop = rms_envelope(path)
+    # Bruit de fond : médiane de l'enveloppe (le son n'occupe qu'une partie du balayage)
+    floor = float(np.median(envelope[: max(1, int(0.5 / hop))]))
+    threshold = max(floor * noise_factor, 1e-4)
+
+    first = find_onset(envelope, hop, 0.0, len(envelope) * hop, threshold)
+    if first is None:
+        raise SystemExit("salve SYNC introuvable dans l'enregistrement")
+    offset_s = first - syncs[0][0] / 1000.0
+    scale = 1.0 / 1000.0
+
+    if len(syncs) >= 2:
+        expected = syncs[-1][0] / 1000.0 + offset_s
+        last = find_onset(envelope, hop, expected - 1.0, expected + 1.0, threshold, expected)
+        if last is not None:
+            scale = (last - first) / float(syncs[-1][0] - syncs[0][0])
+            offset_s = first - syncs[0][0] * scale
+    drift_ppm = (scale * 1000.0 - 1.0) * 1e6
+    return (lambda ms: offset_s + ms * scale), drift_ppm, floor
+
+
+# ---------------------------------------------------------------------------
+# Analyse d'un pas
+# ---------------------------------------------------------------------------
+
+def band_power(spectrum, freqs, center, cents=50):
+    if center <= 0 or center >= freqs[-1]:
+        return 0.0
+    ratio = 2.0 ** (cents / 1200.0)
+    mask = (freqs >= center / ratio) & (freqs <= center * ratio)
+    return float(spectrum[mask].sum())
+
+
+def welch_spectrum(samples, size):
+    window = np.hanning(size).astype(np.float32)
+    hop = size // 2
+    spectra = []
+    for start in range(0, len(samples) - size + 1, hop):
+        frame = samples[start:start + size]
+        frame = (frame - frame.mean()) * window
+        spectra.append(np.abs(np.fft.rfft(frame)) ** 2)
+    if not spectra:
+        return None
+    return np.mean(spectra, axis=0)
+
+
+def analyze_step(samples, rate, f0, args, noise_power):
+    """Hauteur, harmoniques, bruit et latence d'attaque d'un pas (valve ouverte)."""
+    result = {"class": SILENT, "pitch_hz": None, "cents": None, "harmonic_ratio": None,
+              "noise_ratio": None, "level_db": None, "onset_ms": None}
+
+    # Attaque : première trame où la bande fondamentale (ou octave) émerge
+    window = np.hanning(ONSET_FFT_SIZE).astype(np.float32)
+    freqs_onset = np.fft.rfftfreq(ONSET_FFT_SIZE, 1.0 / rate)
+    band_history = []
+    for start in range(0, len(samples) - ONSET_FFT_SIZE + 1, ONSET_HOP):
+        frame = samples[start:start + ONSET_FFT_SIZE]
+        spectrum = np.abs(np.fft.rfft((frame - frame.mean()) * window)) ** 2
+        power = band_power(spectrum, freqs_onset, f0, 80) + band_power(spectrum, freqs_onset, 2 * f0, 80)
+        band_history.append((start + ONSET_FFT_SIZE / 2, power))
+
+    # Régime établi : après la fenêtre d'attaque
+    skip = int(rate * args.settle_ms / 1000.0)
+    steady = samples[skip:]
+    spectrum = welch_spectrum(steady, FFT_SIZE)
+    if spectrum is None:
+        return result
+    freqs = np.fft.rfftfreq(FFT_SIZE, 1.0 / rate)
+    audible = (freqs >= 150) & (freqs <= min(12000, rate / 2))
+    total = float(spectrum[audible].sum())
+    result["level_db"] = 10 * math.log10(max(total, 1e-20) / max(noise_power, 1e-20))
+
+    if result["level_db"] < args.silence_db:
+        return result
+
+    p1 = band_power(spectrum, freqs, f0)
+    p2 = band_power(spectrum, freqs, 2 * f0)
+    p3 = band_power(spectrum, freqs, 3 * f0)
+    result["harmonic_ratio"] = p2 / p1 if p1 > 0 else None
+    result["noise_ratio"] = max(0.0, 1.0 - (p1 + p2 + p3) / total)
+
+    # Hauteur : pic dominant autour de la fondamentale et de l'octave (interpolation parabolique)
+    search = (freqs >= f0 * 0.7) & (freqs <= f0 * 2.3)
+    indices = np.nonzero(search)[0]
+    peak = indices[np.argmax(spectrum[indices])]
+    if 0 < peak < len(spectrum) - 1:
+        a, b, c = np.log(spectrum[peak - 1:peak + 2] + 1e-20)
+        shift = 0.5 * (a - c) / (a - 2 * b + c) if (a - 2 * b + c) != 0 else 0.0
+    else:
+        shift = 0.0
+    pitch = (peak + shift) * rate / FFT_SIZE
+    result["pitch_hz"] = pitch
+    result["cents"] = 1200 * math.log2(pitch / f0)
+
+    tonal = (p1 + p2) / total
+    if tonal < args.tone_ratio:
+        result["class"] = NOISY
+    elif abs(result["cents"] - 1200) < args.pitch_tolerance and p2 >= p1 * args.octave_ratio:
+        result["class"] = OVERBLOWN
+    elif abs(result["cents"]) < args.pitch_tolerance:
+        result["class"] = FUNDAMENTAL
+    else:
+        result["class"] = NOISY
+
+    # Latence : seuil relatif au régime établi de la bande
+    if band_history and result["class"] in (FUNDAMENTAL, OVERBLOWN):
+        steady_band = np.median([p for _, p in band_history[len(band_history) // 2:]])
+        for center, power in band_history:
+            if power >= steady_band * 0.5:
+                result["onset_ms"] = center * 1000.0 / rate
+                break
+    return result
+
+
+# ---------------------------------------------------------------------------
+# Synthèse par note
+# ---------------------------------------------------------------------------
+
+def summarize(steps_by_note):
+    notes = []
+    for index in sorted(steps_by_note):
+        steps = sorted(steps_by_note[index], key=lambda s: s["percent"])
+        midi = steps[0]["midi"]
+        first = last = overblow = None
+        for step in steps:
+            cls = step["analysis"]["class"]
+            if cls == FUNDAMENTAL and overblow is None:
+                if first is None:
+                    first = step["percent"]
+                last = step["percent"]
+            elif cls == OVERBLOWN and first is not None and overblow is None:
+                overblow = step["percent"]
+        onsets = [s["analysis"]["onset_ms"] for s in steps
+                  if s["analysis"]["class"] == FUNDAMENTAL and s["analysis"]["onset_ms"] is not None]
+        onset_at_min = next((s["analysis"]["onset_ms"] for s in steps
+                             if s["percent"] == first), None)
+        notes.append({
+            "index": index, "midi": midi, "name": note_name(midi),
+            "min": first, "max": last, "overblow": overblow,
+            "onset_median_ms": float(np.median(onsets)) if onsets else None,
+            "onset_at_min_ms": onset_at_min,
+        })
+    return notes
+
+
+def fingering_args(pattern, fingers):
+    return ",".join(str((pattern >> (i * 2)) & 3) for i in range(fingers))
+
+
+def print_notes_section(notes, log_notes, fingers, margin):
+    print("const NoteDefinition NOTES[NUMBER_NOTES] PROGMEM = {")
+    print("  // MIDI  Doigtés (%d trous)             Min%%  Max%%" % fingers)
+    lines = []
+    for note in notes:
+        pattern = log_notes.get(note["index"], {}).get("pattern", 0)
+        if note["min"] is None:
+            lo, hi, comment = 0, 0, "  // %s - AUCUNE PLAGE STABLE (à calibrer à la main)" % note["name"]
+        else:
+            lo, hi = note["min"] + margin, note["max"] - margin
+            if lo > hi:
+                lo = hi = (note["min"] + note["max"]) // 2
+            comment = "  // %s" % note["name"]
+        # Même alignement que OutputGenerator::generateNotesSection()
+        lines.append("  {  %3d,  fingering(%s),  %2d,  %3d  }" % (note["midi"], fingering_args(pattern, fingers), lo, hi)
+                     + "%s" + comment)
+    for i, line in enumerate(lines):
+        print(line % ("," if i < len(lines) - 1 else " "))
+    print("};")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Analyse d'un balayage enregistré (Calibration_Tool)")
+    parser.add_argument("log", help="journal série (lignes SYNC / NOTE / STEP)")
+    parser.add_argument("wav", help="enregistrement WAV PCM du balayage")
+    parser.add_argument("--fingers", type=int, default=6, help="NUMBER_SERVOS_FINGER (défaut 6)")
+    parser.add_argument("--margin", type=int, default=0, help="marge retirée de min%%/max%% (défaut 0)")
+    parser.add_argument("--settle-ms", type=float, default=120, help="attaque ignorée pour le régime établi")
+    parser.add_argument("--silence-db", type=float, default=10, help="niveau au-dessus du bruit de fond")
+    parser.add_argument("--tone-ratio", type=float, default=0.3, help="part tonale minimale (0..1)")
+    parser.add_argument("--octave-ratio", type=float, default=1.0, help="octave/fondamentale => sur-soufflage")
+    parser.add_argument("--pitch-tolerance", type=float, default=60, help="écart de hauteur accepté (cents)")
+    parser.add_argument("--sync-factor", type=float, default=8, help="seuil de détection SYNC (x bruit RMS)")
+    parser.add_argument("--json", help="écrit aussi les mesures détaillées en JSON")
+    parser.add_argument("-v", "--verbose", action="store_true", help="affiche chaque pas")
+    args = parser.parse_args()
+
+    syncs, log_notes, steps = parse_log(args.log)
+    to_audio, drift_ppm, _ = align_clock(args.wav, syncs, args.sync_factor)
+    print("# Synchronisation : %d salve(s), dérive d'horloge %+.0f ppm" % (min(len(syncs), 2), drift_ppm),
+          file=sys.stderr)
+
+    stream = WavStream(args.wav)
+    rate = stream.rate
+
+    # Bruit de fond spectral : avant la première salve
+    noise = stream.segment(0, max(FFT_SIZE, int((to_audio(syncs[0][0]) - 0.1) * rate)))
+    noise_spectrum = welch_spectrum(noise, FFT_SIZE)
+    freqs = np.fft.rfftfreq(FFT_SIZE, 1.0 / rate)
+    audible = (freqs >= 150) & (freqs <= min(12000, rate / 2))
+    noise_power = float(noise_spectrum[audible].sum()) if noise_spectrum is not None else 1e-12
+
+    steps_by_note = {}
+    for step in steps:
+        start = int(to_audio(step["on"]) * rate)
+        end = int(to_audio(step["off"]) * rate)
+        samples = stream.segment(start, end)
+        step["analysis"] = analyze_step(samples, rate, midi_to_hz(step["midi"]), args, noise_power)
+        steps_by_note.setdefault(step["index"], []).append(step)
+        if args.verbose:
+            a = step["analysis"]
+            print("# %-4s %3d%%  %-12s niveau %5s dB  cents %6s  h2/h1 %5s  bruit %4s  attaque %s" % (
+                note_name(step["midi"]), step["percent"], a["class"],
+                "%.1f" % a["level_db"] if a["level_db"] is not None else "-",
+                "%+.0f" % a["cents"] if a["cents"] is not None else "-",
+                "%.2f" % a["harmonic_ratio"] if a["harmonic_ratio"] is not None else "-",
+                "%.2f" % a["noise_ratio"] if a["noise_ratio"] is not None else "-",
+                "%.0f ms" % a["onset_ms"] if a["onset_ms"] is not None else "-"))
+    stream.close()
+
+    notes = summarize(steps_by_note)
+
+    print("# Note   Min%  Max%  Sur-souffle  Attaque(min)  Attaque(médiane)")
+    for note in notes:
+        def fmt(value, unit=""):
+            return "-" if value is None else ("%.0f%s" % (value, unit))
+        print("# %-5s  %4s  %4s  %11s  %12s  %16s" % (
+            note["name"], fmt(note["min"]), fmt(note["max"]), fmt(note["overblow"], "%"),
+            fmt(note["onset_at_min_ms"], " ms"), fmt(note["onset_median_ms"], " ms")))
+    print()
+    print_notes_section(notes, log_notes, args.fingers, args.margin)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"drift_ppm": drift_ppm, "notes": notes, "steps": steps}, f, indent=2)
+            f.write("\n")
+
+
+if __name__ == "__main__":
+    main()